@@ -60,6 +60,16 @@ public:
 	{
 		OniStreamServices::releaseFrame(streamServices, pFrame);
 	}
+
+	OniFrame* acquireExternalFrame(void* data, int dataSize, OniFrameFreeBufferCallback freeBuffer, void* pCookie)
+	{
+		return OniStreamServices::acquireExternalFrame(streamServices, data, dataSize, freeBuffer, pCookie);
+	}
+
+	void setFrameStageTimestamp(OniFrame* pFrame, OniFrameStage stage, uint64_t timestamp)
+	{
+		OniStreamServices::setFrameStageTimestamp(streamServices, pFrame, stage, timestamp);
+	}
 };
 
 class StreamBase
@@ -87,6 +97,13 @@ public:
 	virtual void notifyAllProperties() { return; }
 
 	virtual OniStatus convertDepthToColorCoordinates(StreamBase* /*colorStream*/, int /*depthX*/, int /*depthY*/, OniDepthPixel /*depthZ*/, int* /*pColorX*/, int* /*pColorY*/) { return ONI_STATUS_NOT_SUPPORTED; }
+	// Called once per frame, before convertDepthFrameToColorCoordinates() is called for its rows, and never concurrently
+	// with it. Shared state the row calls need (tables for the color resolution, for example) should be set up here.
+	virtual OniStatus prepareDepthFrameToColorCoordinates(StreamBase* /*colorStream*/, const OniFrame* /*pDepthFrame*/) { return ONI_STATUS_NOT_SUPPORTED; }
+	// Maps rows [firstRow, firstRow + rowCount) of a depth frame to color coordinates, writing an (x, y) pair per pixel
+	// to pColorXY, or (-1, -1) for pixels that have none. May be called concurrently for different rows of the same frame,
+	// so it should only read state. If not supported, OpenNI calls convertDepthToColorCoordinates() for each pixel.
+	virtual OniStatus convertDepthFrameToColorCoordinates(StreamBase* /*colorStream*/, const OniFrame* /*pDepthFrame*/, int /*firstRow*/, int /*rowCount*/, int* /*pColorXY*/) { return ONI_STATUS_NOT_SUPPORTED; }
 
 protected:
 	void raiseNewFrame(OniFrame* pFrame) { (*m_newFrameCallback)(this, pFrame, m_newFrameCallbackCookie); }
@@ -363,6 +380,16 @@ ONI_C_API_EXPORT OniStatus oniDriverStreamConvertDepthToColorCoordinates(oni::dr
 	oni::driver::StreamBase* pColorStream, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY)		\
 {																															\
 	return pDepthStream->convertDepthToColorCoordinates(pColorStream, depthX, depthY, depthZ, pColorX, pColorY);			\
+}																															\
+ONI_C_API_EXPORT OniStatus oniDriverStreamPrepareDepthFrameToColorCoordinates(oni::driver::StreamBase* pDepthStream,		\
+	oni::driver::StreamBase* pColorStream, const OniFrame* pDepthFrame)														\
+{																															\
+	return pDepthStream->prepareDepthFrameToColorCoordinates(pColorStream, pDepthFrame);									\
+}																															\
+ONI_C_API_EXPORT OniStatus oniDriverStreamConvertDepthFrameToColorCoordinates(oni::driver::StreamBase* pDepthStream,			\
+	oni::driver::StreamBase* pColorStream, const OniFrame* pDepthFrame, int firstRow, int rowCount, int* pColorXY)			\
+{																															\
+	return pDepthStream->convertDepthFrameToColorCoordinates(pColorStream, pDepthFrame, firstRow, rowCount, pColorXY);		\
 }																															\
 																															\
 ONI_C_API_EXPORT void* oniDriverEnableFrameSync(oni::driver::StreamBase** pStreams, int streamCount)						\
@@ -48,6 +48,12 @@ struct OniStreamServices
 	OniFrame* (ONI_CALLBACK_TYPE* acquireFrame)(void* streamServices); // returns a frame with size corresponding to getRequiredFrameSize()
 	void (ONI_CALLBACK_TYPE* addFrameRef)(void* streamServices, OniFrame* pframe);
 	void (ONI_CALLBACK_TYPE* releaseFrame)(void* streamServices, OniFrame* pframe);
+	// returns a frame wrapping a buffer owned by the driver, or NULL if the stream needs its own buffers.
+	// The buffer may be read-only; applications that need writable frames get NULL here (see oniStreamSetFrameBuffersAllocator).
+	// freeBuffer is called once the frame is released. On NULL, the caller keeps ownership of the buffer.
+	OniFrame* (ONI_CALLBACK_TYPE* acquireExternalFrame)(void* streamServices, void* data, int dataSize, OniFrameFreeBufferCallback freeBuffer, void* pCookie);
+	// stamps a frame with the time it reached a stage, taken with xnOSGetHighResTimeStamp(). Ignored unless latency is tracked.
+	void (ONI_CALLBACK_TYPE* setFrameStageTimestamp)(void* streamServices, OniFrame* pFrame, OniFrameStage stage, uint64_t timestamp);
 };
 
 
@@ -0,0 +1,148 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Layout of the shared memory ring a frame publisher writes frames into, and
+/// the OniShm driver reads them from. Shared by both sides, so any change here
+/// must bump XN_SHM_RING_VERSION.
+
+#ifndef _ONI_SHM_FRAME_RING_H_
+#define _ONI_SHM_FRAME_RING_H_
+
+#include "OniCTypes.h"
+
+/// URIs of the form shm://<name> open the ring published under <name>.
+#define XN_SHM_URI_PREFIX				"shm://"
+
+#define XN_SHM_RING_MAGIC				0x4E52534F // "OSRN"
+#define XN_SHM_RING_VERSION				2
+
+#define XN_SHM_RING_MAX_STREAMS			4
+#define XN_SHM_RING_MAX_CONSUMERS		16
+#define XN_SHM_RING_MIN_SLOTS			2
+#define XN_SHM_RING_MAX_SLOTS			64
+#define XN_SHM_RING_DEFAULT_SLOTS		8
+
+/// Slot data is aligned so consumers can hand it out as frame data as is.
+#define XN_SHM_RING_DATA_ALIGNMENT		64
+
+/// A slot state. Non-negative values count the consumers holding the slot.
+#define XN_SHM_SLOT_WRITING				(-1)
+
+/// Each consumer bumps its heartbeat at least this often (in ms). The publisher
+/// releases the slots and the registration of a consumer whose heartbeat stopped
+/// for XN_SHM_CONSUMER_TIMEOUT ms, as it most likely crashed.
+#define XN_SHM_CONSUMER_HEARTBEAT_INTERVAL	500
+#define XN_SHM_CONSUMER_TIMEOUT				10000
+
+/// Format strings of the shared object and event names, given the ring name.
+#define XN_SHM_RING_MEMORY_NAME_FORMAT	"OpenNI2Shm_%s"
+#define XN_SHM_RING_EVENT_NAME_FORMAT	"OpenNI2Shm_%s_%u"
+
+namespace oni_shm {
+
+/// A single frame buffer in the ring.
+///
+/// The publisher takes a slot by moving its state from 0 to XN_SHM_SLOT_WRITING,
+/// fills it, bumps the sequence and sets the state back to 0. A consumer holds
+/// a slot by incrementing a non-negative state, and releases it by decrementing
+/// it once the application released the frame pointing into it. The publisher
+/// never writes a slot somebody holds, so consumers get the data zero-copy.
+/// Consumers also count their holds in holders, so the holds of a consumer that
+/// died can be taken back.
+typedef struct ShmSlot
+{
+	volatile int state;
+	/// Number of holds of each consumer.
+	volatile int holders[XN_SHM_RING_MAX_CONSUMERS];
+	/// Sequence number of the frame in the slot. 0 if the slot was never written.
+	volatile unsigned int sequence;
+
+	unsigned int dataSize;
+	int frameIndex;
+	uint64_t timestamp;
+
+	OniVideoMode videoMode;
+	int width;
+	int height;
+	int stride;
+	int croppingEnabled;
+	int cropOriginX;
+	int cropOriginY;
+} ShmSlot;
+
+/// A stream published into the ring. Fixed once the publisher has started.
+typedef struct ShmStreamInfo
+{
+	OniSensorType sensorType;
+	OniVideoMode videoMode;
+	float horizontalFov;
+	float verticalFov;
+	int minPixelValue;
+	int maxPixelValue;
+
+	unsigned int numSlots;
+	unsigned int slotDataSize;
+	/// Offsets of the slot array and of the first slot's data, from the start of the ring.
+	unsigned int slotsOffset;
+	unsigned int dataOffset;
+
+	/// Number of frames the publisher dropped because all slots were held.
+	volatile unsigned int droppedFrames;
+} ShmStreamInfo;
+
+/// The start of the shared memory.
+typedef struct ShmRingHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int totalSize;
+	unsigned int numStreams;
+
+	/// Cleared by the publisher before it goes away.
+	volatile int publisherAlive;
+	/// A consumer owns entry i while consumers[i] is 1, and is woken up through
+	/// the event named with index i.
+	volatile int consumers[XN_SHM_RING_MAX_CONSUMERS];
+	/// Bumped by consumer i while it is alive.
+	volatile unsigned int consumerHeartbeats[XN_SHM_RING_MAX_CONSUMERS];
+
+	ShmStreamInfo streams[XN_SHM_RING_MAX_STREAMS];
+} ShmRingHeader;
+
+inline unsigned int ShmAlign(unsigned int nValue)
+{
+	return (nValue + XN_SHM_RING_DATA_ALIGNMENT - 1) & ~(XN_SHM_RING_DATA_ALIGNMENT - 1);
+}
+
+inline ShmSlot* ShmGetSlots(ShmRingHeader* pHeader, unsigned int nStream)
+{
+	return (ShmSlot*)((unsigned char*)pHeader + pHeader->streams[nStream].slotsOffset);
+}
+
+inline void* ShmGetSlotData(ShmRingHeader* pHeader, unsigned int nStream, unsigned int nSlot)
+{
+	const ShmStreamInfo& info = pHeader->streams[nStream];
+	return (unsigned char*)pHeader + info.dataOffset + nSlot * info.slotDataSize;
+}
+
+} // namespace oni_shm
+
+#endif // _ONI_SHM_FRAME_RING_H_
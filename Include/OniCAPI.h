@@ -48,6 +48,22 @@ ONI_C_API void oniUnregisterDeviceCallbacks(OniCallbackHandle handle);
 /** Wait for any of the streams to have a new frame */
 ONI_C_API OniStatus oniWaitForAnyStream(OniStreamHandle* pStreams, int numStreams, int* pStreamIndex, int timeout);
 
+/**
+ * Synchronizes streams by their timestamps. From then on, each stream returns
+ * frames from sets whose timestamps are within the configured tolerance of
+ * each other. Unlike depth-color sync, the streams may belong to different
+ * devices and drivers, as long as their timestamps share a clock.
+ * @param	[in]	pStreams	The streams to synchronize.
+ * @param	[in]	numStreams	Number of streams.
+ * @param	[in]	pConfig		Matching configuration.
+ * @param	[out]	pFrameSync	Handle to the new frame sync.
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_BAD_PARAMETER If the configuration is invalid.
+ */
+ONI_C_API OniStatus oniCreateFrameSync(OniStreamHandle* pStreams, int numStreams, const OniFrameSyncConfig* pConfig, OniFrameSyncHandle* pFrameSync);
+/** Stops synchronizing the streams. Unread frames are discarded. */
+ONI_C_API void oniDestroyFrameSync(OniFrameSyncHandle frameSync);
+
 /** Get the current version of OpenNI2 */
 ONI_C_API OniVersion oniGetVersion();
 
@@ -124,7 +140,8 @@ ONI_C_API OniBool oniStreamIsPropertySupported(OniStreamHandle stream, int prope
 ONI_C_API OniStatus oniStreamInvoke(OniStreamHandle stream, int commandId, void* data, int dataSize);
 /** Check if a command is supported, for invoke */
 ONI_C_API OniBool oniStreamIsCommandSupported(OniStreamHandle stream, int commandId);
-/** Sets the stream buffer allocation functions. Note that this function may only be called while stream is not started. */
+/** Sets the stream buffer allocation functions. Note that this function may only be called while stream is not started.
+    Without an allocator, frame data may point into read-only driver memory (a memory-mapped recording, for example). Set one to get writable frames. */
 ONI_C_API OniStatus oniStreamSetFrameBuffersAllocator(OniStreamHandle stream, OniFrameAllocBufferCallback alloc, OniFrameFreeBufferCallback free, void* pCookie);
 
 ////
@@ -186,6 +203,53 @@ ONI_C_API void oniRecorderStop(OniRecorderHandle recorder);
  */
 ONI_C_API OniStatus oniRecorderDestroy(OniRecorderHandle* pRecorder);
 
+/** Set property in the recorder. Use the properties listed in OniCProperties.h: ONI_RECORDER_PROPERTY_... */
+ONI_C_API OniStatus oniRecorderSetProperty(OniRecorderHandle recorder, int propertyId, const void* data, int dataSize);
+/** Get property in the recorder. Use the properties listed in OniCProperties.h: ONI_RECORDER_PROPERTY_... */
+ONI_C_API OniStatus oniRecorderGetProperty(OniRecorderHandle recorder, int propertyId, void* data, int* pDataSize);
+
+/**
+ * Creates a frame publisher. Once started, it copies the frames of its streams
+ * into shared memory, and other processes on the same machine can open them as
+ * a device with the URI "shm://" followed by the publisher name.
+ * @param	[in]	name		The name consumers open the frames by.
+ * @param	[out]	pPublisher	Points to the handle to the newly created publisher.
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_BAD_PARAMETER If the name is empty or too long.
+ */
+ONI_C_API OniStatus oniCreateFramePublisher(const char* name, OniFramePublisherHandle* pPublisher);
+
+/**
+ * Attaches a stream to a frame publisher. Streams can't be attached after the
+ * publisher has started.
+ * @param	[in]	publisher	The handle to the publisher.
+ * @param	[in]	stream		The handle to the stream.
+ * @param	[in]	numSlots	Number of frames of the stream kept in shared memory. Consumers
+ *								hold a slot until they release the frame, and frames arriving while
+ *								all slots are held are dropped.
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_ERROR Upon any kind of failure.
+ */
+ONI_C_API OniStatus oniFramePublisherAttachStream(OniFramePublisherHandle publisher, OniStreamHandle stream, int numSlots);
+
+/**
+ * Creates the shared memory and starts publishing frames. Slot sizes are taken
+ * from the current video modes of the streams. Fails if a ring with the same
+ * name already exists.
+ * @param	[in]	publisher	The handle to the publisher.
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_ERROR Upon any kind of failure.
+ */
+ONI_C_API OniStatus oniFramePublisherStart(OniFramePublisherHandle publisher);
+
+/**
+ * Stops publishing and destroys a frame publisher. Consumers keep the frames
+ * they hold, but get no new ones.
+ * @param	[in,out]	pPublisher	The handle to the publisher, the handle will be
+ *									invalidated (nullified) when the function returns.
+ */
+ONI_C_API OniStatus oniFramePublisherDestroy(OniFramePublisherHandle* pPublisher);
+
 ONI_C_API OniStatus oniCoordinateConverterDepthToWorld(OniStreamHandle depthStream, float depthX, float depthY, float depthZ, float* pWorldX, float* pWorldY, float* pWorldZ);
 
 // @perevalovds
@@ -197,10 +261,62 @@ ONI_C_API OniStatus oniCoordinateConverterGetDepthToWorldCoeff(OniStreamHandle d
 	float* zFactor
 );
 
+/**
+ * Converts every pixel of a depth frame to world coordinates, in millimeters.
+ * Gives the same result as oniCoordinateConverterDepthToWorld would for each
+ * pixel. Pixels of a cropped frame are placed at their position in the full frame.
+ * @param	[in]	depthStream		The stream the frame was read from.
+ * @param	[in]	pDepthFrame		The depth frame.
+ * @param	[out]	pWorld			X, Y and Z of each pixel, row by row. Pixels without depth get (0, 0, 0).
+ * @param	[in]	worldBufferSize	Size of pWorld in bytes, at least width * height * 3 * sizeof(float).
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_BAD_PARAMETER If the buffer is too small or the frame is not a depth frame.
+ * @see ONI_STREAM_PROPERTY_COORDINATE_CONVERSION_THREADS
+ */
+ONI_C_API OniStatus oniCoordinateConverterDepthFrameToWorld(OniStreamHandle depthStream, const OniFrame* pDepthFrame, float* pWorld, int worldBufferSize);
+
 ONI_C_API OniStatus oniCoordinateConverterWorldToDepth(OniStreamHandle depthStream, float worldX, float worldY, float worldZ, float* pDepthX, float* pDepthY, float* pDepthZ);
 
 ONI_C_API OniStatus oniCoordinateConverterDepthToColor(OniStreamHandle depthStream, OniStreamHandle colorStream, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY);
 
+/**
+ * Maps every pixel of a depth frame to the color pixel that overlaps it.
+ * Gives the same result as oniCoordinateConverterDepthToColor would for each
+ * pixel, using the registration tables of the driver when it has them.
+ * @param	[in]	depthStream		The stream the frame was read from.
+ * @param	[in]	colorStream		A color stream of the same device.
+ * @param	[in]	pDepthFrame		The depth frame.
+ * @param	[out]	pColorXY		X and Y of the color pixel of each depth pixel, row by row. Pixels without a color pixel get (-1, -1).
+ * @param	[in]	colorBufferSize	Size of pColorXY in bytes, at least width * height * 2 * sizeof(int).
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_BAD_PARAMETER If the buffer is too small or the frame is not a depth frame.
+ * @see ONI_STREAM_PROPERTY_COORDINATE_CONVERSION_THREADS
+ */
+ONI_C_API OniStatus oniCoordinateConverterDepthFrameToColor(OniStreamHandle depthStream, OniStreamHandle colorStream, const OniFrame* pDepthFrame, int* pColorXY, int colorBufferSize);
+
+/******************************************** Metrics APIs */
+
+/**
+ * Takes a snapshot of the counters of all the streams and recorders.
+ * @param	[out]	pMetrics	Filled with the counters. Its arrays are allocated inside, and are freed by oniReleaseMetrics.
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_ERROR Upon any kind of failure.
+ */
+ONI_C_API OniStatus oniGetMetrics(OniMetrics* pMetrics);
+/** Releases the arrays of a snapshot taken by oniGetMetrics. */
+ONI_C_API void oniReleaseMetrics(OniMetrics* pMetrics);
+
+/**
+ * Writes a snapshot of the metrics to a file periodically, one JSON object per line.
+ * The file is replaced. Can also be turned on with DumpFile and DumpInterval in the Metrics section of OpenNI.ini.
+ * @param	[in]	fileName	Path of the file, or NULL to stop dumping.
+ * @param	[in]	intervalMs	Time between snapshots, in milliseconds.
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_BAD_PARAMETER If the interval is not positive.
+ * @retval ONI_STATUS_ERROR If the file could not be opened.
+ */
+ONI_C_API OniStatus oniSetMetricsDump(const char* fileName, int intervalMs);
+
 /******************************************** Log APIs */
 
 /** 
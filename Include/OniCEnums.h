@@ -75,6 +75,40 @@ typedef enum
 	ONI_IMAGE_REGISTRATION_DEPTH_TO_COLOR	= 1,
 } OniImageRegistrationMode;
 
+/** What a recorder does with a new frame when its queue is full */
+typedef enum
+{
+	ONI_RECORDER_QUEUE_POLICY_BLOCK			= 0, // the producing thread waits until the queue has room
+	ONI_RECORDER_QUEUE_POLICY_DROP_OLDEST	= 1, // the oldest queued frame is discarded
+	ONI_RECORDER_QUEUE_POLICY_DROP_NEWEST	= 2, // the new frame is discarded
+} OniRecorderQueuePolicy;
+
+/** What a stream does with a new frame when its frame queue is full */
+typedef enum
+{
+	ONI_FRAME_QUEUE_POLICY_DROP_OLDEST	= 0, // the oldest unread frame is discarded
+	ONI_FRAME_QUEUE_POLICY_DROP_NEWEST	= 1, // the new frame is discarded
+} OniFrameQueuePolicy;
+
+/** What a timestamp frame sync does when a stream has no frame to match */
+typedef enum
+{
+	ONI_FRAME_SYNC_POLICY_WAIT				= 0, // only complete sets are delivered
+	ONI_FRAME_SYNC_POLICY_SKIP_STRAGGLERS	= 1, // once a stream's buffer is full, the matching frames of the other streams are delivered without the missing ones
+} OniFrameSyncPolicy;
+
+/** Points of the frame pipeline at which frames are stamped, see ONI_STREAM_PROPERTY_LATENCY_TRACKING */
+typedef enum
+{
+	ONI_FRAME_STAGE_FIRST_PACKET	= 0, // the driver got the first data of the frame from the device
+	ONI_FRAME_STAGE_END_OF_FRAME	= 1, // the driver got the last data of the frame from the device
+	ONI_FRAME_STAGE_NEW_FRAME		= 2, // OpenNI got the frame from the driver
+	ONI_FRAME_STAGE_PUBLISHED		= 3, // the frame can be read by the application
+	ONI_FRAME_STAGE_READ			= 4, // the application read the frame
+
+	ONI_FRAME_STAGE_COUNT			= 5,
+} OniFrameStage;
+
 enum
 {
 	ONI_TIMEOUT_NONE = 0,
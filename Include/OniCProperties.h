@@ -52,6 +52,24 @@ enum
 
 	ONI_STREAM_PROPERTY_NUMBER_OF_FRAMES		= 8, // int
 
+	// Frame queue (handled by OpenNI, not by the driver)
+	ONI_STREAM_PROPERTY_FRAME_QUEUE_SIZE		= 9, // int: frames kept for readFrame. 1 (default) keeps only the latest
+	ONI_STREAM_PROPERTY_FRAME_QUEUE_POLICY		= 10, // OniFrameQueuePolicy
+	ONI_STREAM_PROPERTY_FRAME_QUEUE_STATS		= 11, // OniFrameQueueStats (get only)
+
+	// Frame buffer pool (handled by OpenNI, only while the sensor is stopped)
+	ONI_STREAM_PROPERTY_FRAME_POOL_SIZE		= 12, // int: frame buffers allocated up front. 0 (default) allocates on demand
+	ONI_STREAM_PROPERTY_FRAME_POOL_LARGE_PAGES	= 13, // OniBool
+	ONI_STREAM_PROPERTY_FRAME_POOL_STATS		= 14, // OniFramePoolStats (get only)
+
+	// Whole frame coordinate conversion (handled by OpenNI)
+	ONI_STREAM_PROPERTY_COORDINATE_CONVERSION_THREADS	= 15, // int: threads converting a frame to world or color coordinates. 1 (default) uses the calling thread only, 0 one per processor
+
+	// Frame latency (handled by OpenNI)
+	ONI_STREAM_PROPERTY_LATENCY_TRACKING		= 16, // OniBool: stamp frames at each OniFrameStage and time the new frame callbacks. Off by default. Turning it on resets the stats
+	ONI_STREAM_PROPERTY_LATENCY_STATS		= 17, // OniFrameLatencyStats (get only)
+	ONI_STREAM_PROPERTY_DRIVER_STATS		= 18, // OniStreamDriverStats (get only, handled by the driver if it supports it)
+
 	// Camera
 	ONI_STREAM_PROPERTY_AUTO_WHITE_BALANCE		= 100, // OniBool
 	ONI_STREAM_PROPERTY_AUTO_EXPOSURE			= 101, // OniBool
@@ -59,10 +77,22 @@ enum
 	ONI_STREAM_PROPERTY_GAIN					= 103, // int
 };
 
+// Recorder properties
+enum
+{
+	ONI_RECORDER_PROPERTY_MAX_QUEUE_FRAMES		= 0, // int: 0 means unlimited (default)
+	ONI_RECORDER_PROPERTY_MAX_QUEUE_BYTES		= 1, // uint64_t: 0 means unlimited (default)
+	ONI_RECORDER_PROPERTY_QUEUE_POLICY			= 2, // OniRecorderQueuePolicy
+	ONI_RECORDER_PROPERTY_QUEUE_STATS			= 3, // OniRecorderQueueStats (get only)
+	ONI_RECORDER_PROPERTY_WRITE_BUFFER_SIZE		= 4, // int: bytes of records buffered before writing, 0 disables buffering
+	ONI_RECORDER_PROPERTY_SYNC_INTERVAL		= 5, // uint64_t: bytes written between flushes to disk, 0 means never (default)
+};
+
 // Device commands (for Invoke)
 enum
 {
 	ONI_DEVICE_COMMAND_SEEK				= 1, // OniSeek
+	ONI_DEVICE_COMMAND_SEEK_TIMESTAMP	= 2, // uint64_t: timestamp of the recording, in microseconds
 };
 
 #endif // _ONI_C_PROPERTIES_H_
@@ -91,6 +91,12 @@ typedef _OniStream* OniStreamHandle;
 struct _OniRecorder;
 typedef _OniRecorder* OniRecorderHandle;
 
+struct _OniFrameSync;
+typedef _OniFrameSync* OniFrameSyncHandle;
+
+struct _OniFramePublisher;
+typedef _OniFramePublisher* OniFramePublisherHandle;
+
 /** All information of the current frame */
 typedef struct
 {
@@ -190,4 +196,143 @@ typedef struct
 	OniStreamHandle stream;
 } OniSeek;
 
+/** Recorder queue counters, see ONI_RECORDER_PROPERTY_QUEUE_STATS. Latencies are in microseconds. */
+typedef struct
+{
+	/** Number of frames currently waiting to be written. */
+	int queuedFrames;
+	/** Highest value queuedFrames has reached. */
+	int maxQueuedFrames;
+	/** Size of the frames currently waiting to be written. */
+	uint64_t queuedBytes;
+	/** Number of frames written to the file. */
+	uint64_t recordedFrames;
+	/** Number of frames discarded because the queue was full. */
+	uint64_t droppedFrames;
+	/** Time from queuing the last written frame until it was written. */
+	uint64_t lastWriteLatency;
+	/** Highest write latency seen. */
+	uint64_t maxWriteLatency;
+	/** Average write latency over all written frames. */
+	uint64_t averageWriteLatency;
+} OniRecorderQueueStats;
+
+/** Stream frame queue counters, see ONI_STREAM_PROPERTY_FRAME_QUEUE_STATS. */
+typedef struct
+{
+	/** Number of frames currently waiting to be read. */
+	int queuedFrames;
+	/** Highest value queuedFrames has reached. */
+	int maxQueuedFrames;
+	/** Number of frames received from the driver. */
+	uint64_t receivedFrames;
+	/** Number of frames discarded because the queue was full. */
+	uint64_t droppedFrames;
+} OniFrameQueueStats;
+
+/** Sensor frame buffer pool counters, see ONI_STREAM_PROPERTY_FRAME_POOL_STATS. */
+typedef struct
+{
+	/** Number of buffers allocated up front. */
+	int capacity;
+	/** Number of those buffers currently held by frames. */
+	int buffersInUse;
+	/** Highest value buffersInUse has reached. */
+	int maxBuffersInUse;
+	/** Number of frames that got a preallocated buffer. */
+	int hits;
+	/** Number of frames that could not get a preallocated buffer. */
+	int misses;
+} OniFramePoolStats;
+
+/** Timestamp frame sync configuration, see oniCreateFrameSync. */
+typedef struct
+{
+	/** Largest difference between the timestamps of frames in a synced set, in microseconds. */
+	uint64_t tolerance;
+	/** Number of unmatched frames kept for each stream. Oldest frames are dropped beyond that. */
+	int maxBufferedFrames;
+	/** What to do when a stream falls behind the others. */
+	OniFrameSyncPolicy policy;
+} OniFrameSyncConfig;
+
+/** Latency distribution of one part of the frame pipeline. Latencies are in microseconds. */
+typedef struct
+{
+	/** Number of frames measured. */
+	uint64_t count;
+	/** Median latency. */
+	uint64_t p50;
+	/** 99th percentile latency. */
+	uint64_t p99;
+	/** Highest latency. */
+	uint64_t max;
+} OniLatencyHistogram;
+
+/**
+ Stream latency counters, see ONI_STREAM_PROPERTY_LATENCY_STATS. Frames are measured when read, and only
+ on the parts of the pipeline they were stamped at both ends of (drivers may not stamp the first stages).
+ Percentiles are accurate to within 1/8 of their value.
+*/
+typedef struct
+{
+	/** From the first packet of the frame to its last one (ONI_FRAME_STAGE_FIRST_PACKET to ONI_FRAME_STAGE_END_OF_FRAME). */
+	OniLatencyHistogram transfer;
+	/** From the last packet to OpenNI (ONI_FRAME_STAGE_END_OF_FRAME to ONI_FRAME_STAGE_NEW_FRAME). */
+	OniLatencyHistogram driver;
+	/** From OpenNI to the frame being readable, including recorders and frame sync (ONI_FRAME_STAGE_NEW_FRAME to ONI_FRAME_STAGE_PUBLISHED). */
+	OniLatencyHistogram delivery;
+	/** From the frame being readable to the application reading it (ONI_FRAME_STAGE_PUBLISHED to ONI_FRAME_STAGE_READ). */
+	OniLatencyHistogram waiting;
+	/** From the earliest stage the frame was stamped at to the application reading it. */
+	OniLatencyHistogram total;
+} OniFrameLatencyStats;
+
+/** Driver counters of a stream, see ONI_STREAM_PROPERTY_DRIVER_STATS. */
+typedef struct
+{
+	/** Number of frames discarded because their data was lost or malformed. */
+	uint64_t corruptedFrames;
+	/** Number of gaps in the data received from the device (lost USB packets, for example). */
+	uint64_t transferErrors;
+} OniStreamDriverStats;
+
+/** Counters of a stream, see oniGetMetrics. */
+typedef struct
+{
+	/** URI of the device of the stream. */
+	char deviceUri[ONI_MAX_STR];
+	OniSensorType sensorType;
+	OniBool started;
+	/** Frames received and dropped by the frame queue. */
+	OniFrameQueueStats frameQueue;
+	/** Preallocated frame buffers of the sensor. */
+	OniFramePoolStats framePool;
+	/** FALSE if the driver doesn't report ONI_STREAM_PROPERTY_DRIVER_STATS, in which case driver is all zeros. */
+	OniBool hasDriverStats;
+	OniStreamDriverStats driver;
+	/** Time from a frame becoming readable until the new frame callbacks returned, in microseconds. Only counted while ONI_STREAM_PROPERTY_LATENCY_TRACKING is on. */
+	OniLatencyHistogram callbackDispatch;
+	/** Only counted while ONI_STREAM_PROPERTY_LATENCY_TRACKING is on. */
+	OniFrameLatencyStats latency;
+} OniStreamMetrics;
+
+/** Counters of a recorder, see oniGetMetrics. */
+typedef struct
+{
+	char fileName[ONI_MAX_STR];
+	OniRecorderQueueStats queue;
+} OniRecorderMetrics;
+
+/** A snapshot of the counters of all the streams and recorders, see oniGetMetrics. */
+typedef struct
+{
+	/** Host time the snapshot was taken at, in microseconds. */
+	uint64_t timestamp;
+	int streamCount;
+	OniStreamMetrics* streams;
+	int recorderCount;
+	OniRecorderMetrics* recorders;
+} OniMetrics;
+
 #endif // _ONI_TYPES_H_
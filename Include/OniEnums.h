@@ -78,6 +78,28 @@ typedef enum
 	IMAGE_REGISTRATION_DEPTH_TO_COLOR	= 1,
 } ImageRegistrationMode;
 
+/** What a @ref Recorder does with a new frame when its queue is full */
+typedef enum
+{
+	RECORDER_QUEUE_POLICY_BLOCK			= 0,
+	RECORDER_QUEUE_POLICY_DROP_OLDEST	= 1,
+	RECORDER_QUEUE_POLICY_DROP_NEWEST	= 2,
+} RecorderQueuePolicy;
+
+/** What a @ref VideoStream does with a new frame when its frame queue is full */
+typedef enum
+{
+	FRAME_QUEUE_POLICY_DROP_OLDEST	= 0,
+	FRAME_QUEUE_POLICY_DROP_NEWEST	= 1,
+} FrameQueuePolicy;
+
+/** What a timestamp frame sync does when a stream has no frame to match */
+typedef enum
+{
+	FRAME_SYNC_POLICY_WAIT				= 0,
+	FRAME_SYNC_POLICY_SKIP_STRAGGLERS	= 1,
+} FrameSyncPolicy;
+
 static const int TIMEOUT_NONE = 0;
 static const int TIMEOUT_FOREVER = -1;
 
@@ -55,6 +55,24 @@ enum
 
 	STREAM_PROPERTY_NUMBER_OF_FRAMES		= 8, // int
 
+	// Frame queue (handled by OpenNI, not by the driver)
+	STREAM_PROPERTY_FRAME_QUEUE_SIZE		= 9, // int: frames kept for readFrame. 1 (default) keeps only the latest
+	STREAM_PROPERTY_FRAME_QUEUE_POLICY		= 10, // FrameQueuePolicy
+	STREAM_PROPERTY_FRAME_QUEUE_STATS		= 11, // OniFrameQueueStats (get only)
+
+	// Frame buffer pool (handled by OpenNI, only while the sensor is stopped)
+	STREAM_PROPERTY_FRAME_POOL_SIZE			= 12, // int: frame buffers allocated up front. 0 (default) allocates on demand
+	STREAM_PROPERTY_FRAME_POOL_LARGE_PAGES		= 13, // OniBool
+	STREAM_PROPERTY_FRAME_POOL_STATS		= 14, // OniFramePoolStats (get only)
+
+	// Whole frame coordinate conversion (handled by OpenNI)
+	STREAM_PROPERTY_COORDINATE_CONVERSION_THREADS	= 15, // int: threads converting a frame to world or color coordinates. 1 (default) uses the calling thread only, 0 one per processor
+
+	// Frame latency (handled by OpenNI)
+	STREAM_PROPERTY_LATENCY_TRACKING		= 16, // OniBool: stamp frames at each stage of the pipeline and time the new frame callbacks. Off by default. Turning it on resets the stats
+	STREAM_PROPERTY_LATENCY_STATS			= 17, // OniFrameLatencyStats (get only)
+	STREAM_PROPERTY_DRIVER_STATS		= 18, // OniStreamDriverStats (get only, handled by the driver if it supports it)
+
 	// Camera
 	STREAM_PROPERTY_AUTO_WHITE_BALANCE		= 100, // OniBool
 	STREAM_PROPERTY_AUTO_EXPOSURE			= 101, // OniBool
@@ -63,10 +81,22 @@ enum
 
 };
 
+// Recorder properties
+enum
+{
+	RECORDER_PROPERTY_MAX_QUEUE_FRAMES		= 0, // int: 0 means unlimited (default)
+	RECORDER_PROPERTY_MAX_QUEUE_BYTES		= 1, // uint64_t: 0 means unlimited (default)
+	RECORDER_PROPERTY_QUEUE_POLICY			= 2, // RecorderQueuePolicy
+	RECORDER_PROPERTY_QUEUE_STATS			= 3, // OniRecorderQueueStats (get only)
+	RECORDER_PROPERTY_WRITE_BUFFER_SIZE		= 4, // int: bytes of records buffered before writing, 0 disables buffering
+	RECORDER_PROPERTY_SYNC_INTERVAL		= 5, // uint64_t: bytes written between flushes to disk, 0 means never (default)
+};
+
 // Device commands (for Invoke)
 enum
 {
 	DEVICE_COMMAND_SEEK				= 1, // OniSeek
+	DEVICE_COMMAND_SEEK_TIMESTAMP	= 2, // uint64_t: timestamp of the recording, in microseconds
 };
 
 } // namespace openni
@@ -609,6 +609,12 @@ public:
 		return m_pFrame;
 	}
 
+	/** @internal */
+	const OniFrame* _getFrame() const
+	{
+		return m_pFrame;
+	}
+
 private:
 	friend class VideoStream;
 	inline void setReference(OniFrame* pFrame)
@@ -857,6 +863,8 @@ public:
 
 	/**
 	Sets the frame buffers allocator for this video stream.
+	Without an allocator, frame data may point into read-only driver memory (a memory-mapped recording, for example).
+	Set one if the application writes to its frames.
 	@param [in] pAllocator Pointer to the frame buffers allocator object. Pass NULL to return to default frame allocator.
 	@returns ONI_STATUS_OUT_OF_FLOW The frame buffers allocator cannot be set while stream is streaming.
 	*/
@@ -1784,6 +1792,24 @@ public:
 		return m_pDevice->invoke(DEVICE_COMMAND_SEEK, seek);
 	}
 
+	/**
+	* Seeks all streams of the recording to a given moment in time. Each stream is moved to the last frame
+	* it recorded at or before that moment.  If the recording has no seek tables, playback instead continues
+	* from the first frame at or after that moment.
+	*
+	* @param [in] timestamp Timestamp to move playback to, in microseconds, as reported by
+	*			  @ref VideoFrameRef::getTimestamp() during playback
+	* @returns Status code indicating success or failure of this operation
+	*/
+	Status seek(uint64_t timestamp)
+	{
+		if (!isValid())
+		{
+			return STATUS_NO_DEVICE;
+		}
+		return m_pDevice->invoke(DEVICE_COMMAND_SEEK_TIMESTAMP, timestamp);
+	}
+
 	/**
 	 * Provides the a count of frames that this recording contains for a given stream.  This is useful
 	 * both to determine the length of the recording, and to ensure that a valid Frame Index is set when using
@@ -2333,6 +2359,33 @@ public:
 		return (Status)oniSetLogFileOutput(bFileOutput);
 	}
 
+	/**
+	Takes a snapshot of the counters of all the streams and recorders.
+	@param [out] pMetrics Filled with the counters. Must be released with @ref releaseMetrics().
+	*/
+	static Status getMetrics(OniMetrics* pMetrics)
+	{
+		return (Status)oniGetMetrics(pMetrics);
+	}
+
+	/**
+	Releases a snapshot taken by @ref getMetrics().
+	*/
+	static void releaseMetrics(OniMetrics* pMetrics)
+	{
+		oniReleaseMetrics(pMetrics);
+	}
+
+	/**
+	Writes a snapshot of the metrics to a file periodically, one JSON object per line.
+	@param [in] fileName Path of the file, or NULL to stop dumping.
+	@param [in] intervalMs Time between snapshots, in milliseconds.
+	*/
+	static Status setMetricsDump(const char* fileName, int intervalMs)
+	{
+		return (Status)oniSetMetricsDump(fileName, intervalMs);
+	}
+
 	#if ONI_PLATFORM == ONI_PLATFORM_ANDROID_ARM
 	/** 
 	 * Configures if log entries will be printed to the Android log.
@@ -2460,6 +2513,20 @@ public:
 		return (Status)oniCoordinateConverterDepthToWorld(depthStream._getHandle(), depthX, depthY, depthZ, pWorldX, pWorldY, pWorldZ);
 	}
 
+	/**
+	Converts every pixel of a depth frame from the Depth coordinate system to the World coordinate system.
+	The result is the same as calling convertDepthToWorld for each pixel, in a single call. Use
+	STREAM_PROPERTY_COORDINATE_CONVERSION_THREADS to split the work between threads.
+	@param [in] depthStream Reference to the openni::VideoStream that produced the frame
+	@param [in] depthFrame The depth frame to convert. Pixels of a cropped frame are placed at their position in the full frame.
+	@param [out] pWorld X, Y and Z of each pixel, row by row, measured in millimeters in World coordinates. Pixels without depth get (0, 0, 0).
+	@param [in] worldBufferSize Size of pWorld in bytes, at least width * height * 3 * sizeof(float)
+	*/
+	static Status convertDepthFrameToWorld(const VideoStream& depthStream, const VideoFrameRef& depthFrame, float* pWorld, int worldBufferSize)
+	{
+		return (Status)oniCoordinateConverterDepthFrameToWorld(depthStream._getHandle(), depthFrame._getFrame(), pWorld, worldBufferSize);
+	}
+
 	// @perevalovds
 	/**
 	Values for converting packet of points from depth to world.
@@ -2515,6 +2582,21 @@ public:
 	{
 		return (Status)oniCoordinateConverterDepthToColor(depthStream._getHandle(), colorStream._getHandle(), depthX, depthY, depthZ, pColorX, pColorY);
 	}
+
+	/**
+	Finds the color pixel that overlaps each pixel of a depth frame. The result is the same as calling
+	convertDepthToColor for each pixel, in a single call. Use STREAM_PROPERTY_COORDINATE_CONVERSION_THREADS
+	to split the work between threads.
+	@param [in] depthStream Reference to the openni::VideoStream that produced the frame
+	@param [in] colorStream Reference to a color openni::VideoStream of the same device
+	@param [in] depthFrame The depth frame to map. Pixels of a cropped frame are placed at their position in the full frame.
+	@param [out] pColorXY X and Y of the overlapping color pixel of each depth pixel, row by row. Pixels without one get (-1, -1).
+	@param [in] colorBufferSize Size of pColorXY in bytes, at least width * height * 2 * sizeof(int)
+	*/
+	static Status convertDepthFrameToColor(const VideoStream& depthStream, const VideoStream& colorStream, const VideoFrameRef& depthFrame, int* pColorXY, int colorBufferSize)
+	{
+		return (Status)oniCoordinateConverterDepthFrameToColor(depthStream._getHandle(), colorStream._getHandle(), depthFrame._getFrame(), pColorXY, colorBufferSize);
+	}
 };
 
 /**
@@ -2640,6 +2722,69 @@ public:
 		}
 	}
 
+	/**
+	General function for getting the value of recorder properties (see RECORDER_PROPERTY_...).
+
+	@param [in] propertyId The numerical ID of the property to be queried.
+	@param [out] data Place to store the value of the property.
+	@param [in, out] dataSize IN: Size of the buffer passed in the @c data argument. OUT: the actual written size.
+	@returns Status code indicating success or failure of this operation.
+	*/
+	Status getProperty(int propertyId, void* data, int* dataSize) const
+	{
+		if (!isValid())
+		{
+			return STATUS_ERROR;
+		}
+
+		return (Status)oniRecorderGetProperty(m_recorder, propertyId, data, dataSize);
+	}
+
+	/**
+	General function for setting the value of recorder properties (see RECORDER_PROPERTY_...).
+
+	@param [in] propertyId The numerical ID of the property to be set.
+	@param [in] data Place to store the data to be written to the property.
+	@param [in] dataSize Size of the data to be written to the property.
+	@returns Status code indicating success or failure of this operation.
+	*/
+	Status setProperty(int propertyId, const void* data, int dataSize)
+	{
+		if (!isValid())
+		{
+			return STATUS_ERROR;
+		}
+
+		return (Status)oniRecorderSetProperty(m_recorder, propertyId, data, dataSize);
+	}
+
+	/**
+	Function for setting a recorder property using an arbitrary input type.
+	@tparam [in] T Data type of the value to be passed to the property.
+	@param [in] propertyId The numerical ID of the property to be set.
+	@param [in] value Data to be sent to the property.
+	@returns Status code indicating success or failure of this operation.
+	*/
+	template <class T>
+	Status setProperty(int propertyId, const T& value)
+	{
+		return setProperty(propertyId, &value, sizeof(T));
+	}
+
+	/**
+	Function for getting the value from a recorder property using an arbitrary output type.
+	@tparam [in] T Data type of the value to be read.
+	@param [in] propertyId The numerical ID of the property to be read.
+	@param [in, out] value Pointer to a place to store the value read from the property.
+	@returns Status code indicating success or failure of this operation.
+	*/
+	template <class T>
+	Status getProperty(int propertyId, T* value) const
+	{
+		int size = sizeof(T);
+		return getProperty(propertyId, value, &size);
+	}
+
 private:
 	Recorder(const Recorder&);
 	Recorder& operator=(const Recorder&);
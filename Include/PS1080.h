@@ -193,6 +193,10 @@ enum
 	/*******************************************************************/
 	/** Integer */ 
 	XN_STREAM_PROPERTY_FLICKER = 0x10802001, // "Flicker"
+	/** XnDebayeringMethod. Used when Bayer images are converted to RGB888 on the host */
+	XN_STREAM_PROPERTY_DEBAYERING_METHOD = 0x10802002, // "DebayeringMethod"
+	/** unsigned long long. Threads debayering a frame on the host. 0 means one per processor */
+	XN_STREAM_PROPERTY_DEBAYERING_THREADS = 0x10802003, // "DebayeringThreads"
 };
 
 typedef enum 
@@ -312,6 +316,13 @@ typedef enum XnFirmwareCroppingMode
 	XN_FIRMWARE_CROPPING_MODE_INCREASED_FPS = 2,
 } XnFirmwareCroppingMode;
 
+typedef enum XnDebayeringMethod
+{
+	XN_DEBAYERING_BILINEAR = 0,
+	XN_DEBAYERING_EDGE_AWARE = 1,
+	XN_DEBAYERING_EDGE_AWARE_WEIGHTED = 2,
+} XnDebayeringMethod;
+
 typedef enum
 {
 	XnLogFilterDebug		= 0x0001,
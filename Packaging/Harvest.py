@@ -90,6 +90,7 @@ class Harvest:
         targetDriversDir = os.path.join(targetDir, 'OpenNI2', 'Drivers')
         os.makedirs(targetDriversDir)
         self.copySharedObject(binDriversDir, 'OniFile', targetDriversDir)
+        self.copySharedObject(binDriversDir, 'OniShm', targetDriversDir)
         self.copySharedObject(binDriversDir, 'PS1080', targetDriversDir)
         self.copySharedObject(binDriversDir, 'PSLink', targetDriversDir)
         shutil.copy(os.path.join(self.rootDir, 'Config', 'OpenNI2', 'Drivers', 'PS1080.ini'), targetDriversDir)
@@ -26,7 +26,4 @@
 
 #define OniStatusFromXnStatus(status) ((status) == XN_STATUS_OK ? ONI_STATUS_OK : ONI_STATUS_ERROR)
 
-struct _OniFrameSync;
-typedef _OniFrameSync* OniFrameSyncHandle;
-
 #endif // _ONI_COMMON_H_
\ No newline at end of file
@@ -20,6 +20,7 @@
 *****************************************************************************/
 #include "OniContext.h"
 #include "OniStreamFrameHolder.h"
+#include "OniTimestampSyncedStreamsFrameHolder.h"
 #include <XnLog.h>
 #include <XnOSCpp.h>
 
@@ -32,7 +33,7 @@ ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 OniBool Context::s_valid = FALSE;
 
-Context::Context() : m_errorLogger(xnl::ErrorLogger::GetInstance()), m_initializationCounter(0)
+Context::Context() : m_errorLogger(xnl::ErrorLogger::GetInstance()), m_metricsDump(*this), m_initializationCounter(0)
 {
 	xnOSMemSet(m_overrideDevice, 0, XN_FILE_MAX_PATH);
 }
@@ -150,6 +151,18 @@ OniStatus Context::initialize()
 			repositoryOverridden = TRUE;
 		}
 
+		XnChar strMetricsFile[XN_FILE_MAX_PATH] = {0};
+		rc = xnOSReadStringFromINI(strOniConfigurationFile, "Metrics", "DumpFile", strMetricsFile, XN_FILE_MAX_PATH);
+		if (rc == XN_STATUS_OK)
+		{
+			XnInt32 nInterval = 1000;
+			xnOSReadIntFromINI(strOniConfigurationFile, "Metrics", "DumpInterval", &nInterval);
+			if (m_metricsDump.start(strMetricsFile, nInterval) != ONI_STATUS_OK)
+			{
+				xnLogWarning(XN_MASK_ONI_CONTEXT, "Failed to start dumping metrics to '%s'", strMetricsFile);
+			}
+		}
+
 
 
 		xnLogVerbose(XN_MASK_ONI_CONTEXT, "Configuration has been read from '%s'", strOniConfigurationFile);
@@ -293,6 +306,9 @@ void Context::shutdown()
 
 	s_valid = FALSE;
 
+	// The dump takes snapshots of what is about to be destroyed.
+	m_metricsDump.stop();
+
 	m_cs.Lock();
 
     // Close all recorders.
@@ -302,6 +318,15 @@ void Context::shutdown()
         recorderClose(pRecorder);
     }
 
+	// Close all frame publishers.
+	while (m_framePublishers.Begin() != m_framePublishers.End())
+	{
+		OniFramePublisherHandle publisher = *m_framePublishers.Begin();
+		m_framePublishers.Remove(publisher);
+		XN_DELETE(publisher->pPublisher);
+		publisher->pPublisher = NULL;
+	}
+
 	// Destroy all streams
 	while (m_streams.Begin() != m_streams.End())
 	{
@@ -513,8 +538,6 @@ OniStatus Context::createStream(OniDeviceHandle device, OniSensorType sensorType
 		return ONI_STATUS_ERROR;
 	}
 
-	pMyStream->setNewFrameCallback(newFrameCallback, this);
-
 	// Create stream frame holder and connect it to the stream.
 	StreamFrameHolder* pFrameHolder = XN_NEW(StreamFrameHolder, m_frameManager, pMyStream);
 	if (pFrameHolder == NULL)
@@ -651,21 +674,12 @@ void Context::frameAddRef(OniFrame* pFrame)
 
 OniStatus Context::waitForStreams(OniStreamHandle* pStreams, int streamCount, int* pStreamIndex, int timeout)
 {
-	static const int MAX_WAITED_STREAMS = 50;
-	Device* deviceList[MAX_WAITED_STREAMS];
-	VideoStream* streamsList[MAX_WAITED_STREAMS];
+	xnl::Hash<VideoStream*, int> streamIndices;
+	xnl::Array<Device*> deviceList;
 
 	unsigned long long oldestTimestamp = XN_MAX_UINT64;
 	int oldestIndex = -1;
 
-	if (streamCount > MAX_WAITED_STREAMS)
-	{
-		m_errorLogger.Append("Cannot wait on more than %d streams", MAX_WAITED_STREAMS);
-		return ONI_STATUS_NOT_SUPPORTED;
-	}
-
-	int numDevices = 0;
-
 	for (int i = 0; i < streamCount; ++i)
 	{
 		if (pStreams[i] == NULL)
@@ -673,13 +687,19 @@ OniStatus Context::waitForStreams(OniStreamHandle* pStreams, int streamCount, in
 			continue;
 		}
 
-		streamsList[i] =  ((_OniStream*)pStreams[i])->pStream;
+		// Keep the first index of each stream.
+		VideoStream* pStream = ((_OniStream*)pStreams[i])->pStream;
+		if (streamIndices.Find(pStream) != streamIndices.End())
+		{
+			continue;
+		}
+		streamIndices.Set(pStream, i);
 
-		Device* pDevice = &streamsList[i]->getDevice();
+		Device* pDevice = &pStream->getDevice();
 
 		// Check if device already exists.
 		bool found = false;
-		for (int j = 0; j < numDevices; ++j)
+		for (XnUInt32 j = 0; j < deviceList.GetSize(); ++j)
 		{
 			if (deviceList[j] == pDevice)
 			{
@@ -691,32 +711,39 @@ OniStatus Context::waitForStreams(OniStreamHandle* pStreams, int streamCount, in
 		// Add new device to list.
 		if (!found)
 		{
-			deviceList[numDevices] = pDevice;
-			++numDevices;
+			deviceList.AddLast(pDevice);
 		}
 	}
 
-	XN_EVENT_HANDLE hEvent = getThreadEvent();
+	// Register with the streams before looking at them, so a frame arriving
+	// in between is not missed.
+	StreamWaiter waiter(getThreadEvent());
+	xnl::Array<VideoStream*> readyStreams;
+	for (xnl::Hash<VideoStream*, int>::Iterator it = streamIndices.Begin(); it != streamIndices.End(); ++it)
+	{
+		it->Key()->addWaiter(&waiter);
+
+		// Any stream might already hold a frame. From now on, only streams
+		// reported by the waiter need to be checked.
+		readyStreams.AddLast(it->Key());
+	}
 
 	XnUInt64 passedTime;
 	XnOSTimer workTimer;
 	XnUInt32 timeToWait = timeout;
 	xnOSStartTimer(&workTimer);
 
-	do
+	for (;;)
 	{
-		for (int i = 0; i < streamCount; ++i)
+		for (XnUInt32 i = 0; i < readyStreams.GetSize(); ++i)
 		{
-			if (pStreams[i] == NULL)
-				continue;
-
-			VideoStream* pStream = ((_OniStream*)pStreams[i])->pStream;
+			VideoStream* pStream = readyStreams[i];
 			pStream->lockFrame();
 			OniFrame* pFrame = pStream->peekFrame();
 			if (pFrame != NULL && pFrame->timestamp < oldestTimestamp)
 			{
 				oldestTimestamp = pFrame->timestamp;
-				oldestIndex = i;
+				streamIndices.Get(pStream, oldestIndex);
 			}
 			pStream->unlockFrame();
 		}
@@ -728,7 +755,7 @@ OniStatus Context::waitForStreams(OniStreamHandle* pStreams, int streamCount, in
 		}
 
 		// 'Poke' the driver to attempt to receive more frames.
-		for (int j = 0; j < numDevices; ++j)
+		for (XnUInt32 j = 0; j < deviceList.GetSize(); ++j)
 		{
 			deviceList[j]->tryManualTrigger();
 		}
@@ -744,10 +771,22 @@ OniStatus Context::waitForStreams(OniStreamHandle* pStreams, int streamCount, in
 			else
 				timeToWait = 0;
 		}
-	} while (XN_STATUS_OK == xnOSWaitEvent(hEvent, timeToWait));
+
+		if (XN_STATUS_OK != xnOSWaitEvent(waiter.getEvent(), timeToWait))
+		{
+			break;
+		}
+
+		waiter.takeReadyStreams(readyStreams);
+	}
 	
 	xnOSStopTimer(&workTimer);
 
+	for (xnl::Hash<VideoStream*, int>::Iterator it = streamIndices.Begin(); it != streamIndices.End(); ++it)
+	{
+		it->Key()->removeWaiter(&waiter);
+	}
+
 	if (oldestIndex != -1)
 	{
 		return ONI_STATUS_OK;
@@ -849,6 +888,73 @@ OniStatus Context::enableFrameSyncEx(VideoStream** pStreams, int numStreams, Dev
 
 }
 
+OniStatus Context::createFrameSync(OniStreamHandle* pStreams, int numStreams, const OniFrameSyncConfig* pConfig, OniFrameSyncHandle* pFrameSyncHandle)
+{
+	// Verify parameters.
+	if (pStreams == NULL || numStreams < 1 || pConfig == NULL || pFrameSyncHandle == NULL)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	if (pConfig->maxBufferedFrames < 1 ||
+		(pConfig->policy != ONI_FRAME_SYNC_POLICY_WAIT && pConfig->policy != ONI_FRAME_SYNC_POLICY_SKIP_STRAGGLERS))
+	{
+		m_errorLogger.Append("CreateFrameSync: invalid configuration");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	xnl::Array<VideoStream*> pStreamList(numStreams);
+	pStreamList.SetSize(numStreams);
+	for (int i = 0; i < numStreams; ++i)
+	{
+		if (pStreams[i] == NULL)
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		// Make sure stream does not already belong to a frame sync group.
+		if (pStreams[i]->pStream->getFrameHolder()->getNumStreams() > 1)
+		{
+			m_errorLogger.Append("CreateFrameSync: stream is already synced with other streams");
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		pStreamList[i] = pStreams[i]->pStream;
+	}
+
+	// Create the new frame sync group (it will link all the streams).
+	TimestampSyncedStreamsFrameHolder* pSyncedStreamsFrameHolder = XN_NEW(TimestampSyncedStreamsFrameHolder,
+																	m_frameManager, pStreamList.GetData(), numStreams, *pConfig);
+	XN_VALIDATE_PTR(pSyncedStreamsFrameHolder, ONI_STATUS_ERROR);
+
+	// Return the frame sync handle.
+	*pFrameSyncHandle = XN_NEW(_OniFrameSync);
+	if (*pFrameSyncHandle == NULL)
+	{
+		m_errorLogger.Append("Couldn't allocate memory for FrameSyncHandle");
+		XN_DELETE(pSyncedStreamsFrameHolder);
+		return ONI_STATUS_ERROR;
+	}
+	(*pFrameSyncHandle)->pSyncedStreamsFrameHolder = pSyncedStreamsFrameHolder;
+	(*pFrameSyncHandle)->pDeviceDriver = NULL;
+	(*pFrameSyncHandle)->pFrameSyncHandle = NULL;
+
+	// Update the frame holders of all the streams.
+	pSyncedStreamsFrameHolder->lock();
+	for (int j = 0; j < numStreams; ++j)
+	{
+		FrameHolder* pOldFrameHolder = pStreamList[j]->getFrameHolder();
+		pOldFrameHolder->lock();
+		pOldFrameHolder->setStreamEnabled(pStreamList[j], FALSE);
+		pStreamList[j]->setFrameHolder(pSyncedStreamsFrameHolder);
+		pOldFrameHolder->unlock();
+		XN_DELETE(pOldFrameHolder);
+	}
+	pSyncedStreamsFrameHolder->unlock();
+
+	return ONI_STATUS_OK;
+}
+
 void Context::disableFrameSync(OniFrameSyncHandle frameSyncHandle)
 {
 	if (frameSyncHandle == NULL)
@@ -858,7 +964,10 @@ void Context::disableFrameSync(OniFrameSyncHandle frameSyncHandle)
 	}
 
 	// Disable the frame sync in the driver.
-	frameSyncHandle->pDeviceDriver->disableFrameSync(frameSyncHandle->pFrameSyncHandle);
+	if (frameSyncHandle->pDeviceDriver != NULL)
+	{
+		frameSyncHandle->pDeviceDriver->disableFrameSync(frameSyncHandle->pFrameSyncHandle);
+	}
 
 	// Disable and clear the synced stream frame holder.
 	frameSyncHandle->pSyncedStreamsFrameHolder->setEnabled(FALSE);
@@ -947,7 +1056,9 @@ OniStatus Context::recorderOpen(const char* fileName, OniRecorderHandle* pRecord
     OniStatus status = (*pRecorder)->pRecorder->initialize(fileName);
     if (ONI_STATUS_OK == status) 
     {
+        m_cs.Lock();
         m_recorders.AddLast((*pRecorder)->pRecorder);
+        m_cs.Unlock();
     }
     else
     {
@@ -1010,38 +1121,145 @@ OniStatus Context::recorderClose(Recorder* pRecorder)
     }
     pRecorder->stop();
     pRecorder->detachAllStreams();
+    m_cs.Lock();
     m_recorders.Remove(pRecorder);
+    m_cs.Unlock();
     XN_DELETE(pRecorder);
     return ONI_STATUS_OK;
 }
 
-void Context::clearErrorLogger()
+OniStatus Context::framePublisherOpen(const char* name, OniFramePublisherHandle* pPublisher)
 {
-	m_errorLogger.Clear();
+	if (NULL == pPublisher || NULL == name)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	FramePublisher* pFramePublisher = XN_NEW(FramePublisher, m_errorLogger);
+	if (NULL == pFramePublisher)
+	{
+		return ONI_STATUS_ERROR;
+	}
+
+	OniStatus status = pFramePublisher->initialize(name);
+	if (ONI_STATUS_OK != status)
+	{
+		XN_DELETE(pFramePublisher);
+		return status;
+	}
+
+	*pPublisher = XN_NEW(_OniFramePublisher);
+	if (NULL == *pPublisher)
+	{
+		XN_DELETE(pFramePublisher);
+		return ONI_STATUS_ERROR;
+	}
+	(*pPublisher)->pPublisher = pFramePublisher;
+
+	m_cs.Lock();
+	m_framePublishers.AddLast(*pPublisher);
+	m_cs.Unlock();
+	return ONI_STATUS_OK;
 }
 
-void Context::addToLogger(const XnChar* cpFormat, ...)
+OniStatus Context::framePublisherClose(OniFramePublisherHandle* pPublisher)
 {
-	va_list args;
-	va_start(args, cpFormat);
-	m_errorLogger.AppendV(cpFormat, args);
-	va_end(args);
+	if (NULL == pPublisher || NULL == *pPublisher)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	// The publisher is already gone if the context was shut down.
+	if (NULL != (*pPublisher)->pPublisher)
+	{
+		m_cs.Lock();
+		m_framePublishers.Remove(*pPublisher);
+		m_cs.Unlock();
+
+		XN_DELETE((*pPublisher)->pPublisher);
+	}
+
+	XN_DELETE(*pPublisher);
+	*pPublisher = NULL;
+	return ONI_STATUS_OK;
 }
 
-void Context::onNewFrame()
+OniStatus Context::getMetrics(OniMetrics* pMetrics)
 {
+	if (pMetrics == NULL)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
 	m_cs.Lock();
-	for (xnl::Hash<XN_THREAD_ID, XN_EVENT_HANDLE>::Iterator it = m_waitingThreads.Begin(); it != m_waitingThreads.End(); ++it)
+
+	XnUInt64 timestamp;
+	xnOSGetHighResTimeStamp(&timestamp);
+	pMetrics->timestamp = timestamp;
+
+	pMetrics->streamCount = m_streams.Size();
+	pMetrics->streams = XN_NEW_ARR(OniStreamMetrics, pMetrics->streamCount);
+	int idx = 0;
+	for (xnl::List<VideoStream*>::ConstIterator iter = m_streams.Begin(); iter != m_streams.End(); ++iter, ++idx)
+	{
+		(*iter)->getMetrics(&pMetrics->streams[idx]);
+	}
+
+	pMetrics->recorderCount = m_recorders.Size();
+	pMetrics->recorders = XN_NEW_ARR(OniRecorderMetrics, pMetrics->recorderCount);
+	idx = 0;
+	for (xnl::List<Recorder*>::ConstIterator iter = m_recorders.Begin(); iter != m_recorders.End(); ++iter, ++idx)
 	{
-		xnOSSetEvent(it->Value());
+		OniRecorderMetrics& recorder = pMetrics->recorders[idx];
+		xnOSStrCopy(recorder.fileName, (*iter)->getFileName(), sizeof(recorder.fileName));
+		int dataSize = sizeof(recorder.queue);
+		if ((*iter)->getProperty(ONI_RECORDER_PROPERTY_QUEUE_STATS, &recorder.queue, &dataSize) != ONI_STATUS_OK)
+		{
+			xnOSMemSet(&recorder.queue, 0, sizeof(recorder.queue));
+		}
 	}
+
 	m_cs.Unlock();
+	return ONI_STATUS_OK;
 }
 
-void XN_CALLBACK_TYPE Context::newFrameCallback(void* pCookie)
+void Context::releaseMetrics(OniMetrics* pMetrics)
 {
-	Context* pThis = (Context*)pCookie;
-	pThis->onNewFrame();
+	if (pMetrics == NULL)
+	{
+		return;
+	}
+
+	XN_DELETE_ARR(pMetrics->streams);
+	XN_DELETE_ARR(pMetrics->recorders);
+	pMetrics->streams = NULL;
+	pMetrics->recorders = NULL;
+	pMetrics->streamCount = 0;
+	pMetrics->recorderCount = 0;
+}
+
+OniStatus Context::setMetricsDump(const char* fileName, int intervalMs)
+{
+	if (fileName == NULL)
+	{
+		m_metricsDump.stop();
+		return ONI_STATUS_OK;
+	}
+
+	return m_metricsDump.start(fileName, intervalMs);
+}
+
+void Context::clearErrorLogger()
+{
+	m_errorLogger.Clear();
+}
+
+void Context::addToLogger(const XnChar* cpFormat, ...)
+{
+	va_list args;
+	va_start(args, cpFormat);
+	m_errorLogger.AppendV(cpFormat, args);
+	va_end(args);
 }
 
 XN_EVENT_HANDLE Context::getThreadEvent()
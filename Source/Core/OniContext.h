@@ -23,6 +23,8 @@
 #include "OniSyncedStreamsFrameHolder.h"
 #include "OniDeviceDriver.h"
 #include "OniRecorder.h"
+#include "OniFramePublisher.h"
+#include "OniMetricsDump.h"
 #include "OniFrameManager.h"
 
 #include "XnList.h"
@@ -41,7 +43,8 @@ struct _OniStream
 };
 struct _OniFrameSync
 {
-	oni::implementation::SyncedStreamsFrameHolder* pSyncedStreamsFrameHolder;
+	oni::implementation::FrameHolder* pSyncedStreamsFrameHolder;
+	// NULL when the streams are synced by timestamps, without the driver.
 	oni::implementation::DeviceDriver* pDeviceDriver;
 	void* pFrameSyncHandle;
 };
@@ -49,6 +52,10 @@ struct _OniRecorder
 {
     oni::implementation::Recorder* pRecorder;
 };
+struct _OniFramePublisher
+{
+	oni::implementation::FramePublisher* pPublisher;
+};
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
@@ -92,6 +99,7 @@ public:
 	OniStatus enableFrameSync(OniStreamHandle* pStreams, int numStreams, OniFrameSyncHandle* pFrameSyncHandle);
 	OniStatus enableFrameSyncEx(VideoStream** pStreams, int numStreams, DeviceDriver* pDriver, OniFrameSyncHandle* pFrameSyncHandle);
 	void disableFrameSync(OniFrameSyncHandle frameSyncHandle);
+	OniStatus createFrameSync(OniStreamHandle* pStreams, int numStreams, const OniFrameSyncConfig* pConfig, OniFrameSyncHandle* pFrameSyncHandle);
 
 	void clearErrorLogger();
 	const char* getExtendedError();
@@ -102,6 +110,14 @@ public:
     OniStatus recorderClose(OniRecorderHandle* pRecorder);
     OniStatus recorderClose(Recorder* pRecorder);
 
+	OniStatus framePublisherOpen(const char* name, OniFramePublisherHandle* pPublisher);
+	OniStatus framePublisherClose(OniFramePublisherHandle* pPublisher);
+
+	OniStatus getMetrics(OniMetrics* pMetrics);
+	void releaseMetrics(OniMetrics* pMetrics);
+	// A NULL file name stops dumping.
+	OniStatus setMetricsDump(const char* fileName, int intervalMs);
+
 	static OniBool s_valid;
 protected:
 	OniStatus streamDestroy(VideoStream* pStream);
@@ -114,9 +130,7 @@ private:
 	Context& operator=(const Context&other);
 
 	XnStatus loadLibraries(const char* directoryName);
-	void onNewFrame();
 	XN_EVENT_HANDLE getThreadEvent();
-	static void XN_CALLBACK_TYPE newFrameCallback(void* pCookie);
 
 	FrameManager m_frameManager;
 
@@ -130,11 +144,15 @@ private:
 	xnl::List<oni::implementation::Device*> m_devices;
 	xnl::List<oni::implementation::VideoStream*> m_streams;
     xnl::List<oni::implementation::Recorder*> m_recorders;
+	// Handles stay valid after shutdown, so they're kept here to clear their publisher.
+	xnl::List<OniFramePublisherHandle> m_framePublishers;
 
 	xnl::Hash<XN_THREAD_ID, XN_EVENT_HANDLE> m_waitingThreads;
 
 	xnl::CriticalSection m_cs;
 
+	MetricsDump m_metricsDump;
+
 	char m_overrideDevice[XN_FILE_MAX_PATH];
 
 	int m_initializationCounter;
@@ -81,14 +81,14 @@ void RecordAssembler::initialize()
     } 
 }
 
-OniStatus RecordAssembler::serialize(XN_FILE_HANDLE file)
+OniStatus RecordAssembler::serialize(WriteBehindFile& file)
 {
     // NOTE(oleksii): strange, but fieldsSize includes the size of header as
     // well...
     XnUInt32 serializedSize_bytes = 
         m_header->fieldsSize +
         m_header->payloadSize;
-    XnStatus status = xnOSWriteFile(file, m_pBuffer, serializedSize_bytes);
+    XnStatus status = file.write(m_pBuffer, serializedSize_bytes);
     return XN_STATUS_OK == status ? ONI_STATUS_OK : ONI_STATUS_ERROR;
 }
 
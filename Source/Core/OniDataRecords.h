@@ -26,6 +26,7 @@
 
 #include "OniCommon.h"
 #include "OniCTypes.h"
+#include "OniWriteBehindFile.h"
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 #if (ONI_PLATFORM != ONI_PLATFORM_ARC)
@@ -146,7 +147,7 @@ public:
     void initialize();
 
     ///
-    OniStatus serialize(XN_FILE_HANDLE file);
+    OniStatus serialize(WriteBehindFile& file);
 
     ///
     OniStatus emit_RECORD_NODE_ADDED_1_0_0_5(
@@ -0,0 +1,195 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniDepthToWorldConverter.h"
+#include "XnSIMD.h"
+
+// Rows converted by one thread at a time.
+#define DEPTH_TO_WORLD_ROWS_PER_BAND 16
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+DepthToWorldConverter::DepthToWorldConverter() :
+	m_xzFactor(0),
+	m_yzFactor(0),
+	m_convertToMillimeters(1)
+{
+	xnOSMemSet(&m_tablesVideoMode, 0, sizeof(m_tablesVideoMode));
+}
+
+void DepthToWorldConverter::setFieldOfView(float xzFactor, float yzFactor)
+{
+	xnl::AutoCSLocker lock(m_cs);
+	m_xzFactor = xzFactor;
+	m_yzFactor = yzFactor;
+	m_tablesVideoMode.resolutionX = 0;
+}
+
+void DepthToWorldConverter::refreshTables(const OniVideoMode& videoMode)
+{
+	// Same normalization as VideoStream::convertDepthToWorldCoordinates.
+	m_normalizedX.SetSize(videoMode.resolutionX);
+	for (int x = 0; x < videoMode.resolutionX; ++x)
+	{
+		m_normalizedX[x] = (float)x / videoMode.resolutionX - .5f;
+	}
+
+	m_normalizedY.SetSize(videoMode.resolutionY);
+	for (int y = 0; y < videoMode.resolutionY; ++y)
+	{
+		m_normalizedY[y] = .5f - (float)y / videoMode.resolutionY;
+	}
+
+	m_convertToMillimeters = (videoMode.pixelFormat == ONI_PIXEL_FORMAT_DEPTH_100_UM) ? 10.f : 1.f;
+	m_tablesVideoMode = videoMode;
+}
+
+OniStatus DepthToWorldConverter::convertFrame(const OniFrame& frame, float* pWorld, xnl::ThreadPool& threadPool)
+{
+	if (frame.videoMode.pixelFormat != ONI_PIXEL_FORMAT_DEPTH_1_MM && frame.videoMode.pixelFormat != ONI_PIXEL_FORMAT_DEPTH_100_UM)
+	{
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	// Pixel (x, y) of a cropped frame is pixel (cropOriginX + x, cropOriginY + y) of the full frame.
+	int originX = frame.croppingEnabled ? frame.cropOriginX : 0;
+	int originY = frame.croppingEnabled ? frame.cropOriginY : 0;
+	if (originX < 0 || originY < 0 || frame.width < 0 || frame.height < 0 ||
+		originX + frame.width > frame.videoMode.resolutionX ||
+		originY + frame.height > frame.videoMode.resolutionY ||
+		frame.stride < frame.width * (int)sizeof(OniDepthPixel))
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	xnl::AutoCSLocker lock(m_cs);
+
+	if (m_tablesVideoMode.resolutionX != frame.videoMode.resolutionX ||
+		m_tablesVideoMode.resolutionY != frame.videoMode.resolutionY ||
+		m_tablesVideoMode.pixelFormat != frame.videoMode.pixelFormat)
+	{
+		refreshTables(frame.videoMode);
+	}
+
+	if (threadPool.GetThreadCount() == 0 || frame.height <= DEPTH_TO_WORLD_ROWS_PER_BAND)
+	{
+		convertRows(frame, 0, frame.height, pWorld);
+		return ONI_STATUS_OK;
+	}
+
+	Job job;
+	job.pThis = this;
+	job.pFrame = &frame;
+	job.pWorld = pWorld;
+	job.rowsPerBand = DEPTH_TO_WORLD_ROWS_PER_BAND;
+	threadPool.ParallelFor((frame.height + job.rowsPerBand - 1) / job.rowsPerBand, convertBand, &job);
+
+	return ONI_STATUS_OK;
+}
+
+void XN_CALLBACK_TYPE DepthToWorldConverter::convertBand(XnUInt32 band, void* pCookie)
+{
+	Job* pJob = (Job*)pCookie;
+	int firstRow = band * pJob->rowsPerBand;
+	int lastRow = XN_MIN(firstRow + pJob->rowsPerBand, pJob->pFrame->height);
+	pJob->pThis->convertRows(*pJob->pFrame, firstRow, lastRow, pJob->pWorld + (XnSizeT)firstRow * pJob->pFrame->width * 3);
+}
+
+void DepthToWorldConverter::convertRows(const OniFrame& frame, int firstRow, int lastRow, float* pWorld) const
+{
+	int originX = frame.croppingEnabled ? frame.cropOriginX : 0;
+	int originY = frame.croppingEnabled ? frame.cropOriginY : 0;
+	const float* pNormalizedX = m_normalizedX.GetData() + originX;
+	const float xzFactor = m_xzFactor;
+	const float yzFactor = m_yzFactor;
+	const float convertToMillimeters = m_convertToMillimeters;
+
+	// Every pixel goes through the same operations, in the same order, as
+	// VideoStream::convertDepthToWorldCoordinates, so results are bit-exact.
+	for (int y = firstRow; y < lastRow; ++y)
+	{
+		const OniDepthPixel* pDepth = (const OniDepthPixel*)((const XnUInt8*)frame.data + (XnSizeT)y * frame.stride);
+		const float normalizedY = m_normalizedY[originY + y];
+		int x = 0;
+
+#if defined(XN_NEON)
+		// NEON has no exact division; dividing by 1 is a no-op, so only 1 mm frames take this path.
+		if (convertToMillimeters == 1.f)
+		{
+			const float32x4_t vNormalizedY = vdupq_n_f32(normalizedY);
+			for (; x + 4 <= frame.width; x += 4)
+			{
+				float32x4_t z = vcvtq_f32_u32(vmovl_u16(vld1_u16(pDepth + x)));
+				float32x4x3_t xyz;
+				xyz.val[0] = vmulq_n_f32(vmulq_f32(vld1q_f32(pNormalizedX + x), z), xzFactor);
+				xyz.val[1] = vmulq_n_f32(vmulq_f32(vNormalizedY, z), yzFactor);
+				xyz.val[2] = z;
+				vst3q_f32(pWorld, xyz);
+				pWorld += 12;
+			}
+		}
+#elif defined(XN_SSE)
+		const __m128 vNormalizedY = _mm_set1_ps(normalizedY);
+		const __m128 vXZFactor = _mm_set1_ps(xzFactor);
+		const __m128 vYZFactor = _mm_set1_ps(yzFactor);
+		const __m128 vConvertToMillimeters = _mm_set1_ps(convertToMillimeters);
+		const __m128i zero = _mm_setzero_si128();
+		for (; x + 8 <= frame.width; x += 8)
+		{
+			__m128i depth = _mm_loadu_si128((const __m128i*)(pDepth + x));
+			__m128 z[2];
+			z[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(depth, zero));
+			z[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(depth, zero));
+
+			for (int half = 0; half < 2; ++half)
+			{
+				__m128 wx = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(pNormalizedX + x + half * 4), z[half]), vXZFactor);
+				__m128 wy = _mm_mul_ps(_mm_mul_ps(vNormalizedY, z[half]), vYZFactor);
+				wx = _mm_div_ps(wx, vConvertToMillimeters);
+				wy = _mm_div_ps(wy, vConvertToMillimeters);
+				__m128 wz = _mm_div_ps(z[half], vConvertToMillimeters);
+
+				// Interleave to x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+				__m128 xyLow = _mm_unpacklo_ps(wx, wy);
+				__m128 xyHigh = _mm_unpackhi_ps(wx, wy);
+				__m128 z0x1 = _mm_shuffle_ps(wz, wx, _MM_SHUFFLE(1, 1, 0, 0));
+				__m128 y1z1 = _mm_shuffle_ps(wy, wz, _MM_SHUFFLE(1, 1, 1, 1));
+				__m128 z2x3 = _mm_shuffle_ps(wz, xyHigh, _MM_SHUFFLE(2, 2, 2, 2));
+				__m128 y3z3 = _mm_shuffle_ps(xyHigh, wz, _MM_SHUFFLE(3, 3, 3, 3));
+				_mm_storeu_ps(pWorld, _mm_shuffle_ps(xyLow, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+				_mm_storeu_ps(pWorld + 4, _mm_shuffle_ps(y1z1, xyHigh, _MM_SHUFFLE(1, 0, 2, 0)));
+				_mm_storeu_ps(pWorld + 8, _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+				pWorld += 12;
+			}
+		}
+#endif
+
+		for (; x < frame.width; ++x)
+		{
+			float z = pDepth[x];
+			pWorld[0] = (pNormalizedX[x] * z * xzFactor) / convertToMillimeters;
+			pWorld[1] = (normalizedY * z * yzFactor) / convertToMillimeters;
+			pWorld[2] = z / convertToMillimeters;
+			pWorld += 3;
+		}
+	}
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
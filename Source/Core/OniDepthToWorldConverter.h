@@ -0,0 +1,77 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_DEPTH_TO_WORLD_CONVERTER_H_
+#define _ONI_DEPTH_TO_WORLD_CONVERTER_H_
+
+#include "OniCommon.h"
+#include "OniCTypes.h"
+#include "XnArray.h"
+#include "XnOSCpp.h"
+#include "XnThreadPool.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+// Converts whole depth frames to world coordinates. Keeps a table with the
+// normalized X/Y of every column/row, so each pixel skips the divisions by the
+// resolution. Tables are rebuilt when a frame's video mode changes.
+class DepthToWorldConverter
+{
+public:
+	DepthToWorldConverter();
+
+	// Sets the field of view factors (tan(fov / 2) * 2). Invalidates the tables.
+	void setFieldOfView(float xzFactor, float yzFactor);
+
+	// Writes X, Y and Z in millimeters for each pixel of the frame, row by row,
+	// in pWorld. Pixels without depth get (0, 0, 0). Rows are split between
+	// the threads of threadPool and the calling thread.
+	OniStatus convertFrame(const OniFrame& frame, float* pWorld, xnl::ThreadPool& threadPool);
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(DepthToWorldConverter);
+
+	struct Job
+	{
+		DepthToWorldConverter* pThis;
+		const OniFrame* pFrame;
+		float* pWorld;
+		int rowsPerBand;
+	};
+
+	void refreshTables(const OniVideoMode& videoMode);
+	void convertRows(const OniFrame& frame, int firstRow, int lastRow, float* pWorld) const;
+	static void XN_CALLBACK_TYPE convertBand(XnUInt32 band, void* pCookie);
+
+	xnl::CriticalSection m_cs;
+
+	float m_xzFactor;
+	float m_yzFactor;
+
+	// The video mode the tables were built for. resolutionX is 0 when invalid.
+	OniVideoMode m_tablesVideoMode;
+	xnl::Array<float> m_normalizedX;
+	xnl::Array<float> m_normalizedY;
+	float m_convertToMillimeters;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // _ONI_DEPTH_TO_WORLD_CONVERTER_H_
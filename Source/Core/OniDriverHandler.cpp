@@ -33,6 +33,15 @@
 	}																							\
 }
 
+// Leaves the function NULL if the driver doesn't export it.
+#define OniGetOptionalProcAddress(function)														\
+{																								\
+	if (xnOSGetProcAddress(m_libHandle, XN_STRINGIFY(function), (XnFarProc*)&funcs.function) != XN_STATUS_OK)	\
+	{																							\
+		funcs.function = NULL;																	\
+	}																							\
+}
+
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 DriverHandler::DriverHandler(const char* library, xnl::ErrorLogger& errorLogger)
@@ -82,6 +91,8 @@ DriverHandler::DriverHandler(const char* library, xnl::ErrorLogger& errorLogger)
 	OniGetProcAddress(oniDriverStreamGetRequiredFrameSize);
 	OniGetProcAddress(oniDriverStreamSetNewFrameCallback);
 	OniGetProcAddress(oniDriverStreamConvertDepthToColorCoordinates);
+	OniGetOptionalProcAddress(oniDriverStreamPrepareDepthFrameToColorCoordinates);
+	OniGetOptionalProcAddress(oniDriverStreamConvertDepthFrameToColorCoordinates);
 
 	OniGetProcAddress(oniDriverEnableFrameSync);
 	OniGetProcAddress(oniDriverDisableFrameSync);
@@ -85,6 +85,9 @@ struct Funcs
 
 	void (ONI_C_DECL* oniDriverStreamSetNewFrameCallback)(void* streamHandle, OniDriverNewFrame handler, void* pCookie);
 	OniStatus (ONI_C_DECL* oniDriverStreamConvertDepthToColorCoordinates)(void* depthStreamHandle, void* colorStreamHandle, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY);
+	// Optional. NULL for drivers built before they were added.
+	OniStatus (ONI_C_DECL* oniDriverStreamPrepareDepthFrameToColorCoordinates)(void* depthStreamHandle, void* colorStreamHandle, const OniFrame* pDepthFrame);
+	OniStatus (ONI_C_DECL* oniDriverStreamConvertDepthFrameToColorCoordinates)(void* depthStreamHandle, void* colorStreamHandle, const OniFrame* pDepthFrame, int firstRow, int rowCount, int* pColorXY);
 
 	void* (ONI_C_DECL* oniDriverEnableFrameSync)(void** pStreamHandles, int streamCount);
 	void (ONI_C_DECL* oniDriverDisableFrameSync)(void* frameSyncGroup);
@@ -237,6 +240,24 @@ public:
 		return (*funcs.oniDriverStreamConvertDepthToColorCoordinates)(depthStreamHandle, colorStreamHandle, depthX, depthY, DepthZ, pColorX, pColorY);
 	}
 
+	OniStatus prepareDepthFrameToColor(void* depthStreamHandle, void* colorStreamHandle, const OniFrame* pDepthFrame) const
+	{
+		if (funcs.oniDriverStreamPrepareDepthFrameToColorCoordinates == NULL)
+		{
+			return ONI_STATUS_NOT_SUPPORTED;
+		}
+		return (*funcs.oniDriverStreamPrepareDepthFrameToColorCoordinates)(depthStreamHandle, colorStreamHandle, pDepthFrame);
+	}
+
+	OniStatus convertDepthFrameRowsToColor(void* depthStreamHandle, void* colorStreamHandle, const OniFrame* pDepthFrame, int firstRow, int rowCount, int* pColorXY) const
+	{
+		if (funcs.oniDriverStreamConvertDepthFrameToColorCoordinates == NULL)
+		{
+			return ONI_STATUS_NOT_SUPPORTED;
+		}
+		return (*funcs.oniDriverStreamConvertDepthFrameToColorCoordinates)(depthStreamHandle, colorStreamHandle, pDepthFrame, firstRow, rowCount, pColorXY);
+	}
+
 	void* enableFrameSync(void** streamHandles, int streamCount) const
 	{
 		return (*funcs.oniDriverEnableFrameSync)(streamHandles, streamCount);
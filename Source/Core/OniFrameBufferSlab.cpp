@@ -0,0 +1,177 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniFrameBufferSlab.h"
+
+// Buffers start on separate cache lines.
+#define FRAME_BUFFER_SLAB_ALIGN		64
+// Large pages are 2MB on the supported platforms.
+#define FRAME_BUFFER_SLAB_LARGE_PAGE_SIZE	(2 * 1024 * 1024)
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+FrameBufferSlab* FrameBufferSlab::create(int bufferSize, int bufferCount, OniBool largePages)
+{
+	if (bufferSize <= 0 || bufferCount <= 0 || bufferCount > MAX_BUFFERS)
+	{
+		return NULL;
+	}
+
+	int bufferStride = (bufferSize + FRAME_BUFFER_SLAB_ALIGN - 1) / FRAME_BUFFER_SLAB_ALIGN * FRAME_BUFFER_SLAB_ALIGN;
+	XnSizeT memorySize = (XnSizeT)bufferStride * bufferCount;
+	if (largePages)
+	{
+		memorySize = (memorySize + FRAME_BUFFER_SLAB_LARGE_PAGE_SIZE - 1) / FRAME_BUFFER_SLAB_LARGE_PAGE_SIZE * FRAME_BUFFER_SLAB_LARGE_PAGE_SIZE;
+	}
+
+	void* pMemory = xnOSAllocPages(memorySize, largePages);
+	if (pMemory == NULL)
+	{
+		return NULL;
+	}
+
+	// Touch the memory now, so pages aren't faulted in while streaming.
+	xnOSMemSet(pMemory, 0, memorySize);
+
+	FrameBufferSlab* pSlab = XN_NEW(FrameBufferSlab, pMemory, memorySize, bufferSize, bufferStride, bufferCount);
+	if (pSlab == NULL)
+	{
+		xnOSFreePages(pMemory, memorySize);
+		return NULL;
+	}
+
+	if (pSlab->m_pNextFree == NULL)
+	{
+		pSlab->release();
+		return NULL;
+	}
+
+	return pSlab;
+}
+
+FrameBufferSlab::FrameBufferSlab(void* pMemory, XnSizeT memorySize, int bufferSize, int bufferStride, int bufferCount) :
+	m_pMemory((XnUInt8*)pMemory),
+	m_memorySize(memorySize),
+	m_bufferSize(bufferSize),
+	m_bufferStride(bufferStride),
+	m_bufferCount(bufferCount),
+	m_freeHead(0),
+	m_refCount(1),
+	m_buffersInUse(0),
+	m_maxBuffersInUse(0)
+{
+	m_pNextFree = XN_NEW_ARR(XnUInt16, bufferCount);
+	if (m_pNextFree == NULL)
+	{
+		return;
+	}
+
+	// Chain all the buffers, first one on top.
+	for (int i = 0; i < bufferCount; ++i)
+	{
+		m_pNextFree[i] = (XnUInt16)((i + 1 < bufferCount) ? i + 2 : 0);
+	}
+	m_freeHead = 1;
+}
+
+FrameBufferSlab::~FrameBufferSlab()
+{
+	XN_DELETE_ARR(m_pNextFree);
+	xnOSFreePages(m_pMemory, m_memorySize);
+}
+
+void FrameBufferSlab::addRef()
+{
+	xnOSAtomicIncrement(&m_refCount);
+}
+
+void FrameBufferSlab::release()
+{
+	if (xnOSAtomicDecrement(&m_refCount) == 0)
+	{
+		XN_DELETE(this);
+	}
+}
+
+void* FrameBufferSlab::acquireBuffer()
+{
+	XnInt32 head;
+	XnUInt32 index;
+	for (;;)
+	{
+		head = m_freeHead;
+		index = head & 0xFFFF;
+		if (index == 0)
+		{
+			return NULL;
+		}
+
+		XnInt32 newHead = (XnInt32)((((XnUInt32)head + 0x10000) & 0xFFFF0000) | m_pNextFree[index - 1]);
+		if (xnOSAtomicCompareExchange(&m_freeHead, newHead, head) == head)
+		{
+			break;
+		}
+	}
+
+	// The buffer keeps the slab alive.
+	addRef();
+
+	XnInt32 inUse = xnOSAtomicIncrement(&m_buffersInUse);
+	XnInt32 maxInUse = m_maxBuffersInUse;
+	while (inUse > maxInUse)
+	{
+		XnInt32 prevMax = xnOSAtomicCompareExchange(&m_maxBuffersInUse, inUse, maxInUse);
+		if (prevMax == maxInUse)
+		{
+			break;
+		}
+		maxInUse = prevMax;
+	}
+
+	return m_pMemory + (XnSizeT)(index - 1) * m_bufferStride;
+}
+
+void FrameBufferSlab::releaseBuffer(void* pBuffer)
+{
+	XnUInt32 index = (XnUInt32)(((XnUInt8*)pBuffer - m_pMemory) / m_bufferStride) + 1;
+	XN_ASSERT(index >= 1 && index <= (XnUInt32)m_bufferCount);
+
+	xnOSAtomicDecrement(&m_buffersInUse);
+
+	for (;;)
+	{
+		XnInt32 head = m_freeHead;
+		m_pNextFree[index - 1] = (XnUInt16)(head & 0xFFFF);
+		XnInt32 newHead = (XnInt32)((((XnUInt32)head + 0x10000) & 0xFFFF0000) | index);
+		if (xnOSAtomicCompareExchange(&m_freeHead, newHead, head) == head)
+		{
+			break;
+		}
+	}
+
+	release();
+}
+
+void ONI_CALLBACK_TYPE FrameBufferSlab::releaseBufferCallback(void* pBuffer, void* pCookie)
+{
+	((FrameBufferSlab*)pCookie)->releaseBuffer(pBuffer);
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
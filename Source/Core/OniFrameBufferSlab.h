@@ -0,0 +1,87 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_FRAME_BUFFER_SLAB_H_
+#define _ONI_FRAME_BUFFER_SLAB_H_
+
+#include "OniCommon.h"
+#include "OniCTypes.h"
+#include <XnOS.h>
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+// A fixed number of equally sized frame buffers, allocated up front as a
+// single block. Buffers are acquired and released without locking, so the
+// driver's thread never waits for the application releasing frames.
+// The slab is reference counted: its owner holds one reference and each
+// acquired buffer holds another, so the slab stays alive as long as frames
+// still point into it.
+class FrameBufferSlab
+{
+public:
+	enum { MAX_BUFFERS = 0xFFFF };
+
+	// Allocates and touches all the buffers. Returns NULL on failure.
+	static FrameBufferSlab* create(int bufferSize, int bufferCount, OniBool largePages);
+
+	void addRef();
+	void release();
+
+	// Returns NULL if all the buffers are in use.
+	void* acquireBuffer();
+
+	// Frame buffer free callback for buffers of the slab. pCookie is the slab.
+	static void ONI_CALLBACK_TYPE releaseBufferCallback(void* pBuffer, void* pCookie);
+
+	int getBufferSize() const { return m_bufferSize; }
+	int getBufferCount() const { return m_bufferCount; }
+	int getBuffersInUse() const { return m_buffersInUse; }
+	int getMaxBuffersInUse() const { return m_maxBuffersInUse; }
+
+private:
+	FrameBufferSlab(void* pMemory, XnSizeT memorySize, int bufferSize, int bufferStride, int bufferCount);
+	~FrameBufferSlab();
+
+	XN_DISABLE_COPY_AND_ASSIGN(FrameBufferSlab);
+
+	void releaseBuffer(void* pBuffer);
+
+	XnUInt8* m_pMemory;
+	XnSizeT m_memorySize;
+	int m_bufferSize;
+	int m_bufferStride;
+	int m_bufferCount;
+
+	// Free buffers form a stack. Its head holds (index + 1) of the top buffer
+	// in the low 16 bits (0 when empty), and a tag in the high 16 bits that
+	// changes on every update, so compare-exchange can't confuse a head that
+	// was popped and pushed back in the meantime.
+	volatile XnInt32 m_freeHead;
+	XnUInt16* m_pNextFree;
+
+	// only modified through xnOSAtomic* functions
+	volatile XnInt32 m_refCount;
+	volatile XnInt32 m_buffersInUse;
+	volatile XnInt32 m_maxBuffersInUse;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // _ONI_FRAME_BUFFER_SLAB_H_
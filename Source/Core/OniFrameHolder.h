@@ -68,7 +68,7 @@ public:
 	void unlock() { m_cs.Unlock(); }
 
 	// Set whether frame holder is enabled.
-	void setEnabled(OniBool enabled) { m_enabled = enabled; }
+	virtual void setEnabled(OniBool enabled) { m_enabled = enabled; }
 
 // Data members:
 protected:
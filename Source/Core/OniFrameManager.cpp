@@ -36,6 +36,7 @@ OniFrameInternal* FrameManager::acquireFrame()
 	pFrame->refCount = 1; // this is the only reference
 	pFrame->freeBufferFunc = NULL;
 	pFrame->freeBufferFuncCookie = NULL;
+	xnOSMemSet(pFrame->stageTimestamps, 0, sizeof(pFrame->stageTimestamps));
 
 	return pFrame;
 }
@@ -43,16 +44,14 @@ OniFrameInternal* FrameManager::acquireFrame()
 void FrameManager::addRef(OniFrame* pFrame)
 {
 	OniFrameInternal* pInternal = (OniFrameInternal*)pFrame;
-	m_frames.Lock();
-	++pInternal->refCount;
-	m_frames.Unlock();
+	xnOSAtomicIncrement(&pInternal->refCount);
 }
 
 void FrameManager::release(OniFrame* pFrame)
 {
 	OniFrameInternal* pInternal = (OniFrameInternal*)pFrame;
-	m_frames.Lock();
-	if (--pInternal->refCount == 0)
+	// the pool is only locked once the last reference is gone (inside m_frames.Release())
+	if (xnOSAtomicDecrement(&pInternal->refCount) == 0)
 	{
 		// notify frame is back to pool
         if (pInternal->backToPoolFunc != NULL)
@@ -63,7 +62,6 @@ void FrameManager::release(OniFrame* pFrame)
 		// and return frame to pool
 		m_frames.Release(pInternal);
 	}
-	m_frames.Unlock();
 }
 
 ONI_NAMESPACE_IMPLEMENTATION_END
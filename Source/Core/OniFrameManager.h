@@ -14,13 +14,20 @@ typedef void (ONI_CALLBACK_TYPE* FreeBufferFuncPtr)(void* data, void* pCookie);
 
 struct OniFrameInternal : public OniFrame
 {
-	int refCount;
+	volatile XnInt32 refCount; // only modified through xnOSAtomic* functions
 	BackToPoolFuncPtr backToPoolFunc; // callback function to be called when frame reached zero refs and returned to pool
 	void* backToPoolFuncCookie;
 	FreeBufferFuncPtr freeBufferFunc; // callback function for freeing the frame buffer
 	void* freeBufferFuncCookie;
+	XnUInt64 stageTimestamps[ONI_FRAME_STAGE_COUNT]; // host time the frame reached each stage, 0 if it wasn't stamped
 };
 
+// Stamps a frame with the current time, as it reaches a stage. Only used while latency is tracked.
+inline void stampFrame(OniFrame* pFrame, OniFrameStage stage)
+{
+	xnOSGetHighResTimeStamp(&((OniFrameInternal*)pFrame)->stageTimestamps[stage]);
+}
+
 class FrameManager
 {
 public:
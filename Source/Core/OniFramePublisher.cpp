@@ -0,0 +1,465 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniFramePublisher.h"
+#include "OniStream.h"
+#include "XnLog.h"
+
+#define XN_MASK_ONI_FRAME_PUBLISHER "OniFramePublisher"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+using namespace oni_shm;
+
+FramePublisher::FramePublisher(xnl::ErrorLogger& errorLogger) :
+	m_errorLogger(errorLogger),
+	m_numStreams(0),
+	m_hSharedMemory(NULL),
+	m_pHeader(NULL),
+	m_lastConsumerCheck(0),
+	m_started(FALSE)
+{
+	m_name[0] = '\0';
+	xnOSMemSet(m_consumerEvents, 0, sizeof(m_consumerEvents));
+	xnOSMemSet(m_consumerHeartbeats, 0, sizeof(m_consumerHeartbeats));
+	xnOSMemSet(m_consumerHeartbeatTimes, 0, sizeof(m_consumerHeartbeatTimes));
+}
+
+FramePublisher::~FramePublisher()
+{
+	stop();
+	detachAllStreams();
+}
+
+OniStatus FramePublisher::initialize(const char* name)
+{
+	if (name == NULL || name[0] == '\0' || xnOSStrLen(name) >= ONI_MAX_STR - 32)
+	{
+		m_errorLogger.Append("FramePublisher: invalid name");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	xnOSStrCopy(m_name, name, sizeof(m_name));
+	return ONI_STATUS_OK;
+}
+
+XnInt32 FramePublisher::findStream(const VideoStream* pStream)
+{
+	for (XnUInt32 i = 0; i < m_numStreams; ++i)
+	{
+		if (m_streams[i].pStream == pStream)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+OniStatus FramePublisher::attachStream(VideoStream& stream, int numSlots)
+{
+	// The stream calls publish() under its own lock, so it is never called
+	// while holding m_cs.
+	{
+		xnl::AutoCSLocker lock(m_cs);
+		OniStatus rc = addStream(stream, numSlots);
+		if (rc != ONI_STATUS_OK)
+		{
+			return rc;
+		}
+	}
+
+	stream.addPublisher(*this);
+	return ONI_STATUS_OK;
+}
+
+OniStatus FramePublisher::addStream(VideoStream& stream, int numSlots)
+{
+	if (m_started)
+	{
+		m_errorLogger.Append("FramePublisher: streams can't be attached after start");
+		return ONI_STATUS_OUT_OF_FLOW;
+	}
+	if (numSlots < XN_SHM_RING_MIN_SLOTS || numSlots > XN_SHM_RING_MAX_SLOTS)
+	{
+		m_errorLogger.Append("FramePublisher: number of slots must be between %d and %d", XN_SHM_RING_MIN_SLOTS, XN_SHM_RING_MAX_SLOTS);
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+	if (findStream(&stream) >= 0)
+	{
+		m_errorLogger.Append("FramePublisher: stream is already attached");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+	if (m_numStreams == XN_SHM_RING_MAX_STREAMS)
+	{
+		m_errorLogger.Append("FramePublisher: can't publish more than %d streams", XN_SHM_RING_MAX_STREAMS);
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	PublishedStream& published = m_streams[m_numStreams++];
+	published.pStream = &stream;
+	published.numSlots = numSlots;
+	published.sequence = 0;
+	return ONI_STATUS_OK;
+}
+
+OniStatus FramePublisher::detachStream(VideoStream& stream)
+{
+	{
+		xnl::AutoCSLocker lock(m_cs);
+		XnInt32 nStream = findStream(&stream);
+		if (nStream < 0)
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		// Keep the entry, so the indices of the other streams in the ring don't change.
+		m_streams[nStream].pStream = NULL;
+	}
+
+	stream.removePublisher(*this);
+	return ONI_STATUS_OK;
+}
+
+void FramePublisher::detachAllStreams()
+{
+	for (XnUInt32 i = 0; i < m_numStreams; ++i)
+	{
+		if (m_streams[i].pStream != NULL)
+		{
+			detachStream(*m_streams[i].pStream);
+		}
+	}
+}
+
+OniStatus FramePublisher::start()
+{
+	xnl::AutoCSLocker lock(m_cs);
+
+	if (m_started)
+	{
+		return ONI_STATUS_OK;
+	}
+	if (m_name[0] == '\0' || m_numStreams == 0)
+	{
+		m_errorLogger.Append("FramePublisher: no streams attached");
+		return ONI_STATUS_OUT_OF_FLOW;
+	}
+
+	// Lay out the ring: the header, then each stream's slot array and slot data.
+	ShmStreamInfo infos[XN_SHM_RING_MAX_STREAMS];
+	xnOSMemSet(infos, 0, sizeof(infos));
+
+	XnUInt64 nOffset = ShmAlign(sizeof(ShmRingHeader));
+	for (XnUInt32 i = 0; i < m_numStreams; ++i)
+	{
+		VideoStream* pStream = m_streams[i].pStream;
+		ShmStreamInfo& info = infos[i];
+		if (pStream == NULL)
+		{
+			continue;
+		}
+
+		int dataSize = sizeof(info.videoMode);
+		if (pStream->getProperty(ONI_STREAM_PROPERTY_VIDEO_MODE, &info.videoMode, &dataSize) != ONI_STATUS_OK)
+		{
+			m_errorLogger.Append("FramePublisher: failed to get the video mode of stream %u", i);
+			return ONI_STATUS_ERROR;
+		}
+
+		// The rest is informational only.
+		dataSize = sizeof(info.horizontalFov);
+		pStream->getProperty(ONI_STREAM_PROPERTY_HORIZONTAL_FOV, &info.horizontalFov, &dataSize);
+		dataSize = sizeof(info.verticalFov);
+		pStream->getProperty(ONI_STREAM_PROPERTY_VERTICAL_FOV, &info.verticalFov, &dataSize);
+		dataSize = sizeof(info.minPixelValue);
+		pStream->getProperty(ONI_STREAM_PROPERTY_MIN_VALUE, &info.minPixelValue, &dataSize);
+		dataSize = sizeof(info.maxPixelValue);
+		pStream->getProperty(ONI_STREAM_PROPERTY_MAX_VALUE, &info.maxPixelValue, &dataSize);
+
+		int requiredFrameSize = pStream->getRequiredFrameSize();
+		if (requiredFrameSize <= 0)
+		{
+			m_errorLogger.Append("FramePublisher: stream %u has no frame size", i);
+			return ONI_STATUS_ERROR;
+		}
+
+		info.sensorType = pStream->getSensorInfo()->sensorType;
+		info.numSlots = m_streams[i].numSlots;
+		info.slotDataSize = ShmAlign(requiredFrameSize);
+		info.slotsOffset = (XnUInt32)nOffset;
+		nOffset += ShmAlign(info.numSlots * sizeof(ShmSlot));
+		info.dataOffset = (XnUInt32)nOffset;
+		nOffset += (XnUInt64)info.numSlots * info.slotDataSize;
+
+		if (nOffset > XN_MAX_UINT32)
+		{
+			m_errorLogger.Append("FramePublisher: ring is too large");
+			return ONI_STATUS_NOT_SUPPORTED;
+		}
+	}
+
+	XnChar strMemoryName[ONI_MAX_STR];
+	XnUInt32 nCharsWritten = 0;
+	xnOSStrFormat(strMemoryName, sizeof(strMemoryName), &nCharsWritten, XN_SHM_RING_MEMORY_NAME_FORMAT, m_name);
+
+	// Never take over a ring with the same name, its publisher may still be running.
+	XnStatus rc = xnOSCreateSharedMemory(strMemoryName, (XnUInt32)nOffset, XN_OS_FILE_READ | XN_OS_FILE_WRITE | XN_OS_FILE_CREATE_NEW_ONLY, &m_hSharedMemory);
+	if (rc == XN_STATUS_OS_FILE_ALREDY_EXISTS)
+	{
+		m_errorLogger.Append("FramePublisher: a ring named '%s' already exists", m_name);
+		return ONI_STATUS_ERROR;
+	}
+	else if (rc != XN_STATUS_OK)
+	{
+		m_errorLogger.Append("FramePublisher: failed to create shared memory '%s': %s", strMemoryName, xnGetStatusString(rc));
+		return ONI_STATUS_ERROR;
+	}
+	xnOSSharedMemoryGetAddress(m_hSharedMemory, (void**)&m_pHeader);
+
+	for (XnUInt32 i = 0; i < XN_SHM_RING_MAX_CONSUMERS; ++i)
+	{
+		XnChar strEventName[ONI_MAX_STR];
+		xnOSStrFormat(strEventName, sizeof(strEventName), &nCharsWritten, XN_SHM_RING_EVENT_NAME_FORMAT, m_name, i);
+		rc = xnOSCreateNamedEvent(&m_consumerEvents[i], strEventName, FALSE);
+		if (rc != XN_STATUS_OK)
+		{
+			m_errorLogger.Append("FramePublisher: failed to create event '%s': %s", strEventName, xnGetStatusString(rc));
+			closeRing();
+			return ONI_STATUS_ERROR;
+		}
+	}
+
+	// The object is new, so it is all zeros. Consumers check the magic, so it's written last.
+	m_pHeader->version = XN_SHM_RING_VERSION;
+	m_pHeader->totalSize = (XnUInt32)nOffset;
+	m_pHeader->numStreams = m_numStreams;
+	m_pHeader->publisherAlive = TRUE;
+	xnOSMemCopy(m_pHeader->streams, infos, sizeof(infos));
+	xnOSAtomicCompareExchange((volatile XnInt32*)&m_pHeader->magic, XN_SHM_RING_MAGIC, 0);
+
+	xnOSMemSet(m_consumerHeartbeats, 0, sizeof(m_consumerHeartbeats));
+	xnOSMemSet(m_consumerHeartbeatTimes, 0, sizeof(m_consumerHeartbeatTimes));
+	m_lastConsumerCheck = 0;
+
+	m_started = TRUE;
+	return ONI_STATUS_OK;
+}
+
+void FramePublisher::stop()
+{
+	xnl::AutoCSLocker lock(m_cs);
+
+	if (!m_started)
+	{
+		return;
+	}
+
+	m_started = FALSE;
+	closeRing();
+}
+
+void FramePublisher::closeRing()
+{
+	if (m_pHeader != NULL)
+	{
+		// Wake up the consumers, so they notice the publisher is gone.
+		m_pHeader->publisherAlive = FALSE;
+		for (XnUInt32 i = 0; i < XN_SHM_RING_MAX_CONSUMERS; ++i)
+		{
+			if (m_consumerEvents[i] != NULL && m_pHeader->consumers[i])
+			{
+				xnOSSetEvent(m_consumerEvents[i]);
+			}
+		}
+		m_pHeader = NULL;
+	}
+
+	for (XnUInt32 i = 0; i < XN_SHM_RING_MAX_CONSUMERS; ++i)
+	{
+		if (m_consumerEvents[i] != NULL)
+		{
+			xnOSCloseEvent(&m_consumerEvents[i]);
+			m_consumerEvents[i] = NULL;
+		}
+	}
+
+	// Consumers that still have the memory mapped keep it until they unmap it.
+	if (m_hSharedMemory != NULL)
+	{
+		xnOSCloseSharedMemory(m_hSharedMemory);
+		m_hSharedMemory = NULL;
+	}
+}
+
+XnInt32 FramePublisher::acquireSlot(XnUInt32 nStream)
+{
+	ShmSlot* pSlots = ShmGetSlots(m_pHeader, nStream);
+	XnUInt32 numSlots = m_pHeader->streams[nStream].numSlots;
+
+	// Take the free slot holding the oldest frame. A consumer may grab it
+	// between the scan and the exchange, so scan again if that happens.
+	for (XnUInt32 nAttempt = 0; nAttempt < numSlots; ++nAttempt)
+	{
+		XnInt32 nOldest = -1;
+		for (XnUInt32 i = 0; i < numSlots; ++i)
+		{
+			if (pSlots[i].state == 0 &&
+				(nOldest < 0 || (XnInt32)(pSlots[i].sequence - pSlots[nOldest].sequence) < 0))
+			{
+				nOldest = i;
+			}
+		}
+
+		if (nOldest < 0)
+		{
+			return -1;
+		}
+
+		if (xnOSAtomicCompareExchange(&pSlots[nOldest].state, XN_SHM_SLOT_WRITING, 0) == 0)
+		{
+			return nOldest;
+		}
+	}
+
+	return -1;
+}
+
+void FramePublisher::releaseDeadConsumers()
+{
+	XnUInt64 nNow;
+	xnOSGetTimeStamp(&nNow);
+	if (nNow - m_lastConsumerCheck < XN_SHM_CONSUMER_HEARTBEAT_INTERVAL)
+	{
+		return;
+	}
+	m_lastConsumerCheck = nNow;
+
+	for (XnUInt32 i = 0; i < XN_SHM_RING_MAX_CONSUMERS; ++i)
+	{
+		XnUInt32 nHeartbeat = m_pHeader->consumerHeartbeats[i];
+		if (!m_pHeader->consumers[i] || nHeartbeat != m_consumerHeartbeats[i])
+		{
+			m_consumerHeartbeats[i] = nHeartbeat;
+			m_consumerHeartbeatTimes[i] = nNow;
+		}
+		else if (nNow - m_consumerHeartbeatTimes[i] >= XN_SHM_CONSUMER_TIMEOUT)
+		{
+			xnLogWarning(XN_MASK_ONI_FRAME_PUBLISHER, "%s: consumer %u stopped responding, releasing its slots", m_name, i);
+			releaseConsumer(i);
+		}
+	}
+}
+
+void FramePublisher::releaseConsumer(XnUInt32 nConsumer)
+{
+	for (XnUInt32 nStream = 0; nStream < m_pHeader->numStreams; ++nStream)
+	{
+		ShmSlot* pSlots = ShmGetSlots(m_pHeader, nStream);
+		for (XnUInt32 i = 0; i < m_pHeader->streams[nStream].numSlots; ++i)
+		{
+			// Take the holds away first, so a late release by the consumer becomes a no-op.
+			volatile XnInt32* pHolds = &pSlots[i].holders[nConsumer];
+			XnInt32 nHolds;
+			do
+			{
+				nHolds = *pHolds;
+			} while (nHolds > 0 && xnOSAtomicCompareExchange(pHolds, 0, nHolds) != nHolds);
+
+			volatile XnInt32* pState = &pSlots[i].state;
+			XnInt32 nState;
+			while (nHolds > 0)
+			{
+				nState = *pState;
+				if (xnOSAtomicCompareExchange(pState, nState - nHolds, nState) == nState)
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	xnOSAtomicCompareExchange(&m_pHeader->consumers[nConsumer], 0, 1);
+}
+
+void FramePublisher::publish(VideoStream& stream, const OniFrame& frame)
+{
+	// Held while copying, so stop() can't unmap the ring under our feet.
+	xnl::AutoCSLocker lock(m_cs);
+	if (!m_started)
+	{
+		return;
+	}
+
+	XnInt32 nStream = findStream(&stream);
+	if (nStream < 0)
+	{
+		return;
+	}
+
+	releaseDeadConsumers();
+
+	ShmStreamInfo& info = m_pHeader->streams[nStream];
+	if (frame.dataSize < 0 || (XnUInt32)frame.dataSize > info.slotDataSize)
+	{
+		++info.droppedFrames;
+		return;
+	}
+
+	// All slots are held by consumers.
+	XnInt32 nSlot = acquireSlot(nStream);
+	if (nSlot < 0)
+	{
+		++info.droppedFrames;
+		return;
+	}
+
+	ShmSlot& slot = ShmGetSlots(m_pHeader, nStream)[nSlot];
+	xnOSMemCopy(ShmGetSlotData(m_pHeader, nStream, nSlot), frame.data, frame.dataSize);
+	slot.dataSize = frame.dataSize;
+	slot.frameIndex = frame.frameIndex;
+	slot.timestamp = frame.timestamp;
+	slot.videoMode = frame.videoMode;
+	slot.width = frame.width;
+	slot.height = frame.height;
+	slot.stride = frame.stride;
+	slot.croppingEnabled = frame.croppingEnabled;
+	slot.cropOriginX = frame.cropOriginX;
+	slot.cropOriginY = frame.cropOriginY;
+
+	// Sequence 0 marks a slot that was never written.
+	if (++m_streams[nStream].sequence == 0)
+	{
+		m_streams[nStream].sequence = 1;
+	}
+	slot.sequence = m_streams[nStream].sequence;
+
+	// The exchange is a full barrier, so consumers see the frame before the slot is free.
+	xnOSAtomicCompareExchange(&slot.state, 0, XN_SHM_SLOT_WRITING);
+
+	for (XnUInt32 i = 0; i < XN_SHM_RING_MAX_CONSUMERS; ++i)
+	{
+		if (m_pHeader->consumers[i])
+		{
+			xnOSSetEvent(m_consumerEvents[i]);
+		}
+	}
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
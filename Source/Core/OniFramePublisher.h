@@ -0,0 +1,98 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_FRAME_PUBLISHER_H_
+#define _ONI_FRAME_PUBLISHER_H_
+
+#include "OniCommon.h"
+#include "OniCTypes.h"
+#include "XnErrorLogger.h"
+#include "XnOSCpp.h"
+
+#include "Driver/OniShmFrameRing.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+class VideoStream;
+
+// Publishes the frames of attached streams into a named shared memory ring,
+// where other processes can open them as a device through the OniShm driver
+// (shm://<name>). Frames are copied once into the ring; consumers read them
+// in place.
+class FramePublisher
+{
+public:
+	FramePublisher(xnl::ErrorLogger& errorLogger);
+	~FramePublisher();
+
+	OniStatus initialize(const char* name);
+
+	// Streams can only be attached before start(). numSlots is the number of
+	// frames of the stream that can be in the ring at the same time.
+	OniStatus attachStream(VideoStream& stream, int numSlots);
+	OniStatus detachStream(VideoStream& stream);
+	void detachAllStreams();
+
+	// Creates the ring and starts publishing frames.
+	OniStatus start();
+	// Stops publishing and removes the ring. Consumers keep the frames they hold.
+	void stop();
+
+	// Copies a new frame of the stream into the ring.
+	void publish(VideoStream& stream, const OniFrame& frame);
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(FramePublisher)
+
+	struct PublishedStream
+	{
+		VideoStream* pStream;
+		XnUInt32 numSlots;
+		XnUInt32 sequence;
+	};
+
+	OniStatus addStream(VideoStream& stream, int numSlots);
+	XnInt32 findStream(const VideoStream* pStream);
+	XnInt32 acquireSlot(XnUInt32 nStream);
+	// Releases the entry and slots of consumers whose heartbeat stopped.
+	void releaseDeadConsumers();
+	void releaseConsumer(XnUInt32 nConsumer);
+	void closeRing();
+
+	xnl::ErrorLogger& m_errorLogger;
+	xnl::CriticalSection m_cs;
+
+	XnChar m_name[ONI_MAX_STR];
+	PublishedStream m_streams[XN_SHM_RING_MAX_STREAMS];
+	XnUInt32 m_numStreams;
+
+	XN_SHARED_MEMORY_HANDLE m_hSharedMemory;
+	oni_shm::ShmRingHeader* m_pHeader;
+	XN_EVENT_HANDLE m_consumerEvents[XN_SHM_RING_MAX_CONSUMERS];
+	// Last heartbeat seen from each consumer, and when it was seen.
+	XnUInt32 m_consumerHeartbeats[XN_SHM_RING_MAX_CONSUMERS];
+	XnUInt64 m_consumerHeartbeatTimes[XN_SHM_RING_MAX_CONSUMERS];
+	XnUInt64 m_lastConsumerCheck;
+	XnBool m_started;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // _ONI_FRAME_PUBLISHER_H_
@@ -0,0 +1,173 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniLatencyTracker.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+void LatencyHistogram::reset()
+{
+	xnOSMemSet(m_buckets, 0, sizeof(m_buckets));
+	m_count = 0;
+	m_max = 0;
+}
+
+XnUInt32 LatencyHistogram::bucketOf(XnUInt64 latency)
+{
+	if (latency < SUB_BUCKETS)
+	{
+		return (XnUInt32)latency;
+	}
+
+	XnUInt32 topBit = SUB_BUCKET_BITS;
+	while (topBit < MAX_LATENCY_BITS - 1 && (latency >> (topBit + 1)) != 0)
+	{
+		++topBit;
+	}
+
+	if ((latency >> (topBit + 1)) != 0)
+	{
+		// Above the cap, counted in the last bucket.
+		return BUCKET_COUNT - 1;
+	}
+
+	// The SUB_BUCKET_BITS bits below the top one pick the bucket inside the power of two.
+	XnUInt32 subBucket = (XnUInt32)(latency >> (topBit - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+	return (topBit - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+XnUInt64 LatencyHistogram::bucketTop(XnUInt32 bucket)
+{
+	if (bucket < SUB_BUCKETS)
+	{
+		return bucket;
+	}
+
+	XnUInt32 shift = bucket / SUB_BUCKETS - 1;
+	XnUInt64 bottom = (XnUInt64)(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+	return bottom + ((XnUInt64)1 << shift) - 1;
+}
+
+void LatencyHistogram::add(XnUInt64 latency)
+{
+	++m_buckets[bucketOf(latency)];
+	++m_count;
+	if (latency > m_max)
+	{
+		m_max = latency;
+	}
+}
+
+XnUInt64 LatencyHistogram::percentile(XnUInt32 percent) const
+{
+	if (m_count == 0)
+	{
+		return 0;
+	}
+
+	// The rank of the sample at that percentile, rounded up.
+	XnUInt64 rank = (m_count * percent + 99) / 100;
+	XnUInt64 seen = 0;
+	for (XnUInt32 i = 0; i < BUCKET_COUNT; ++i)
+	{
+		seen += m_buckets[i];
+		if (seen >= rank)
+		{
+			return XN_MIN(bucketTop(i), m_max);
+		}
+	}
+
+	return m_max;
+}
+
+void LatencyHistogram::getStats(OniLatencyHistogram* pStats) const
+{
+	pStats->count = m_count;
+	pStats->p50 = percentile(50);
+	pStats->p99 = percentile(99);
+	pStats->max = m_max;
+}
+
+void FrameLatencyTracker::setEnabled(OniBool enabled)
+{
+	xnl::AutoCSLocker lock(m_cs);
+	if (enabled && !m_enabled)
+	{
+		for (int i = 0; i < ONI_FRAME_STAGE_COUNT - 1; ++i)
+		{
+			m_stages[i].reset();
+		}
+		m_total.reset();
+	}
+	m_enabled = enabled;
+}
+
+void FrameLatencyTracker::frameRead(const OniFrame* pFrame)
+{
+	const OniFrameInternal* pInternal = (const OniFrameInternal*)pFrame;
+	XnUInt64 stamps[ONI_FRAME_STAGE_COUNT];
+	xnOSMemCopy(stamps, pInternal->stageTimestamps, sizeof(stamps));
+	xnOSGetHighResTimeStamp(&stamps[ONI_FRAME_STAGE_READ]);
+
+	xnl::AutoCSLocker lock(m_cs);
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	XnUInt64 first = 0;
+	for (int i = 0; i < ONI_FRAME_STAGE_COUNT; ++i)
+	{
+		if (stamps[i] == 0)
+		{
+			continue;
+		}
+
+		if (first == 0)
+		{
+			first = stamps[i];
+		}
+
+		// Only stages both stamped are measured, and clocks of different threads may be slightly off.
+		if (i > 0 && stamps[i - 1] != 0 && stamps[i] >= stamps[i - 1])
+		{
+			m_stages[i - 1].add(stamps[i] - stamps[i - 1]);
+		}
+	}
+
+	if (first != 0 && stamps[ONI_FRAME_STAGE_READ] >= first)
+	{
+		m_total.add(stamps[ONI_FRAME_STAGE_READ] - first);
+	}
+}
+
+void FrameLatencyTracker::getStats(OniFrameLatencyStats* pStats)
+{
+	OniLatencyHistogram* stages[ONI_FRAME_STAGE_COUNT - 1] = { &pStats->transfer, &pStats->driver, &pStats->delivery, &pStats->waiting };
+
+	xnl::AutoCSLocker lock(m_cs);
+	for (int i = 0; i < ONI_FRAME_STAGE_COUNT - 1; ++i)
+	{
+		m_stages[i].getStats(stages[i]);
+	}
+	m_total.getStats(&pStats->total);
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
@@ -0,0 +1,93 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_LATENCY_TRACKER_H_
+#define _ONI_LATENCY_TRACKER_H_
+
+#include "OniCommon.h"
+#include "OniCTypes.h"
+#include "OniFrameManager.h"
+#include <XnOSCpp.h>
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+// Counts latencies in buckets, without storing the samples. Latencies below 8
+// get a bucket each, and every power of two above that is split into 8 buckets,
+// so percentiles are off by at most 1/8 of their value.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram() { reset(); }
+
+	void reset();
+	void add(XnUInt64 latency);
+	void getStats(OniLatencyHistogram* pStats) const;
+
+private:
+	enum
+	{
+		SUB_BUCKET_BITS = 3,
+		SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+		// Latencies are capped at 2^MAX_LATENCY_BITS - 1 (about 12 days in microseconds).
+		MAX_LATENCY_BITS = 40,
+		BUCKET_COUNT = (MAX_LATENCY_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS,
+	};
+
+	static XnUInt32 bucketOf(XnUInt64 latency);
+	// The highest latency counted in a bucket.
+	static XnUInt64 bucketTop(XnUInt32 bucket);
+	XnUInt64 percentile(XnUInt32 percent) const;
+
+	XnUInt32 m_buckets[BUCKET_COUNT];
+	XnUInt64 m_count;
+	XnUInt64 m_max;
+};
+
+// Latencies of the frames read from a stream, between each stage they were
+// stamped at (see stampFrame()). The stream stamps and measures frames only
+// while tracking is enabled.
+class FrameLatencyTracker
+{
+public:
+	FrameLatencyTracker() : m_enabled(FALSE) {}
+
+	// Enabling resets the counters.
+	void setEnabled(OniBool enabled);
+	OniBool isEnabled() const { return m_enabled; }
+
+	// Measures a frame which was just read. Takes the read time itself.
+	void frameRead(const OniFrame* pFrame);
+
+	void getStats(OniFrameLatencyStats* pStats);
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(FrameLatencyTracker);
+
+	// m_stages[i] holds the latencies from stage i to stage i + 1.
+	LatencyHistogram m_stages[ONI_FRAME_STAGE_COUNT - 1];
+	LatencyHistogram m_total;
+
+	volatile OniBool m_enabled;
+	xnl::CriticalSection m_cs;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // _ONI_LATENCY_TRACKER_H_
@@ -0,0 +1,222 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniMetricsDump.h"
+#include "OniContext.h"
+#include <XnLog.h>
+
+#define XN_MASK_ONI_METRICS "OniMetrics"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+// Large enough for the counters of a stream, with its device URI escaped.
+static const XnUInt32 METRICS_LINE_BUFFER_SIZE = 2048 + 2 * ONI_MAX_STR;
+
+// Copies a string as the contents of a JSON string literal.
+static void escapeJsonString(const char* str, char* escaped, XnUInt32 escapedSize)
+{
+	XnUInt32 pos = 0;
+	for (; *str != '\0' && pos + 2 < escapedSize; ++str)
+	{
+		char c = *str;
+		if (c == '"' || c == '\\')
+		{
+			escaped[pos++] = '\\';
+			escaped[pos++] = c;
+		}
+		else if ((unsigned char)c >= ' ')
+		{
+			escaped[pos++] = c;
+		}
+	}
+	escaped[pos] = '\0';
+}
+
+static XnUInt32 formatHistogram(char* buffer, XnUInt32 bufferSize, const char* name, const OniLatencyHistogram& histogram)
+{
+	XnUInt32 written = 0;
+	xnOSStrFormat(buffer, bufferSize, &written, "\"%s\":{\"count\":%llu,\"p50\":%llu,\"p99\":%llu,\"max\":%llu}", name,
+		(unsigned long long)histogram.count, (unsigned long long)histogram.p50, (unsigned long long)histogram.p99, (unsigned long long)histogram.max);
+	return written;
+}
+
+MetricsDump::MetricsDump(Context& context) :
+	m_context(context),
+	m_file(XN_INVALID_FILE_HANDLE),
+	m_intervalMs(0),
+	m_thread(NULL),
+	m_running(FALSE)
+{
+	m_stopEvent.Create(FALSE);
+}
+
+MetricsDump::~MetricsDump()
+{
+	stop();
+}
+
+OniStatus MetricsDump::start(const char* fileName, int intervalMs)
+{
+	if (fileName == NULL || intervalMs <= 0)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	stop();
+	// The last stop() may have left the event set, if the thread exited without waiting on it.
+	m_stopEvent.Reset();
+
+	XnStatus rc = xnOSOpenFile(fileName, XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE, &m_file);
+	if (rc != XN_STATUS_OK)
+	{
+		xnLogError(XN_MASK_ONI_METRICS, "Failed to open metrics file '%s': %s", fileName, xnGetStatusString(rc));
+		return ONI_STATUS_ERROR;
+	}
+
+	m_intervalMs = (XnUInt32)intervalMs;
+	m_running = TRUE;
+	rc = xnOSCreateThread(threadMain, this, &m_thread);
+	if (rc != XN_STATUS_OK)
+	{
+		m_running = FALSE;
+		xnOSCloseFile(&m_file);
+		return ONI_STATUS_ERROR;
+	}
+
+	xnLogInfo(XN_MASK_ONI_METRICS, "Dumping metrics to '%s' every %d ms", fileName, intervalMs);
+	return ONI_STATUS_OK;
+}
+
+void MetricsDump::stop()
+{
+	if (m_thread == NULL)
+	{
+		return;
+	}
+
+	m_running = FALSE;
+	m_stopEvent.Set();
+	xnOSWaitForThreadExit(m_thread, XN_WAIT_INFINITE);
+	xnOSCloseThread(&m_thread);
+	m_thread = NULL;
+
+	xnOSCloseFile(&m_file);
+}
+
+XN_THREAD_PROC MetricsDump::threadMain(XN_THREAD_PARAM pThreadParam)
+{
+	MetricsDump* pSelf = (MetricsDump*)pThreadParam;
+	pSelf->mainLoop();
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+void MetricsDump::mainLoop()
+{
+	while (m_running)
+	{
+		// Times out unless stopped.
+		m_stopEvent.Wait(m_intervalMs);
+		if (!m_running)
+		{
+			break;
+		}
+
+		OniMetrics metrics;
+		if (m_context.getMetrics(&metrics) == ONI_STATUS_OK)
+		{
+			writeMetrics(metrics);
+			m_context.releaseMetrics(&metrics);
+		}
+	}
+}
+
+void MetricsDump::writeMetrics(const OniMetrics& metrics)
+{
+	char line[METRICS_LINE_BUFFER_SIZE];
+	char escaped[2 * ONI_MAX_STR];
+	XnUInt32 written = 0;
+
+	xnOSStrFormat(line, sizeof(line), &written, "{\"timestamp\":%llu,\"streams\":[", (unsigned long long)metrics.timestamp);
+	xnOSWriteFile(m_file, line, written);
+
+	for (int i = 0; i < metrics.streamCount; ++i)
+	{
+		const OniStreamMetrics& stream = metrics.streams[i];
+		escapeJsonString(stream.deviceUri, escaped, sizeof(escaped));
+
+		XnUInt32 pos = 0;
+		xnOSStrFormat(line, sizeof(line), &written,
+			"%s{\"device\":\"%s\",\"sensor\":%d,\"started\":%s,"
+			"\"frameQueue\":{\"queued\":%d,\"maxQueued\":%d,\"received\":%llu,\"dropped\":%llu},"
+			"\"framePool\":{\"capacity\":%d,\"inUse\":%d,\"maxInUse\":%d,\"hits\":%d,\"misses\":%d},",
+			i == 0 ? "" : ",", escaped, (int)stream.sensorType, stream.started ? "true" : "false",
+			stream.frameQueue.queuedFrames, stream.frameQueue.maxQueuedFrames,
+			(unsigned long long)stream.frameQueue.receivedFrames, (unsigned long long)stream.frameQueue.droppedFrames,
+			stream.framePool.capacity, stream.framePool.buffersInUse, stream.framePool.maxBuffersInUse,
+			stream.framePool.hits, stream.framePool.misses);
+		pos += written;
+
+		if (stream.hasDriverStats)
+		{
+			xnOSStrFormat(line + pos, sizeof(line) - pos, &written, "\"driver\":{\"corruptedFrames\":%llu,\"transferErrors\":%llu},",
+				(unsigned long long)stream.driver.corruptedFrames, (unsigned long long)stream.driver.transferErrors);
+			pos += written;
+		}
+
+		pos += formatHistogram(line + pos, sizeof(line) - pos, "callbackDispatch", stream.callbackDispatch);
+		xnOSStrFormat(line + pos, sizeof(line) - pos, &written, ",\"latency\":{");
+		pos += written;
+		pos += formatHistogram(line + pos, sizeof(line) - pos, "transfer", stream.latency.transfer);
+		line[pos++] = ',';
+		pos += formatHistogram(line + pos, sizeof(line) - pos, "driver", stream.latency.driver);
+		line[pos++] = ',';
+		pos += formatHistogram(line + pos, sizeof(line) - pos, "delivery", stream.latency.delivery);
+		line[pos++] = ',';
+		pos += formatHistogram(line + pos, sizeof(line) - pos, "waiting", stream.latency.waiting);
+		line[pos++] = ',';
+		pos += formatHistogram(line + pos, sizeof(line) - pos, "total", stream.latency.total);
+		xnOSStrFormat(line + pos, sizeof(line) - pos, &written, "}}");
+		pos += written;
+
+		xnOSWriteFile(m_file, line, pos);
+	}
+
+	xnOSWriteFile(m_file, "],\"recorders\":[", 15);
+
+	for (int i = 0; i < metrics.recorderCount; ++i)
+	{
+		const OniRecorderMetrics& recorder = metrics.recorders[i];
+		escapeJsonString(recorder.fileName, escaped, sizeof(escaped));
+
+		xnOSStrFormat(line, sizeof(line), &written,
+			"%s{\"file\":\"%s\",\"queued\":%d,\"maxQueued\":%d,\"queuedBytes\":%llu,\"recorded\":%llu,\"dropped\":%llu,"
+			"\"lastWriteLatency\":%llu,\"maxWriteLatency\":%llu,\"averageWriteLatency\":%llu}",
+			i == 0 ? "" : ",", escaped, recorder.queue.queuedFrames, recorder.queue.maxQueuedFrames,
+			(unsigned long long)recorder.queue.queuedBytes, (unsigned long long)recorder.queue.recordedFrames,
+			(unsigned long long)recorder.queue.droppedFrames, (unsigned long long)recorder.queue.lastWriteLatency,
+			(unsigned long long)recorder.queue.maxWriteLatency, (unsigned long long)recorder.queue.averageWriteLatency);
+		xnOSWriteFile(m_file, line, written);
+	}
+
+	xnOSWriteFile(m_file, "]}\n", 3);
+	xnOSFlushFile(m_file);
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
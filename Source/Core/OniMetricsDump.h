@@ -0,0 +1,61 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_METRICS_DUMP_H_
+#define _ONI_METRICS_DUMP_H_
+
+#include "OniCommon.h"
+#include "OniCTypes.h"
+#include "XnOSCpp.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+class Context;
+
+// Writes a snapshot of the context metrics to a file periodically, one JSON
+// object per line, so the file can be followed while the application runs.
+class MetricsDump
+{
+public:
+	MetricsDump(Context& context);
+	~MetricsDump();
+
+	// Replaces the file if dumping already. Fails if the file can't be opened.
+	OniStatus start(const char* fileName, int intervalMs);
+	void stop();
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(MetricsDump);
+
+	static XN_THREAD_PROC threadMain(XN_THREAD_PARAM pThreadParam);
+	void mainLoop();
+	void writeMetrics(const OniMetrics& metrics);
+
+	Context& m_context;
+	XN_FILE_HANDLE m_file;
+	XnUInt32 m_intervalMs;
+	XN_THREAD_HANDLE m_thread;
+	xnl::OSEvent m_stopEvent;
+	volatile XnBool m_running;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // _ONI_METRICS_DUMP_H_
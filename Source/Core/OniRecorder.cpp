@@ -33,6 +33,16 @@
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
+// The time a producer blocked on a full queue waits before checking again.
+#define RECORDER_QUEUE_SPACE_WAIT_TIMEOUT 100
+
+// Records are collected into chunks of this size before being written.
+#define RECORDER_DEFAULT_WRITE_BUFFER_SIZE (8 * 1024 * 1024)
+
+// Codec workers of each recorder. A recorder mostly compresses a depth and a color stream, so a
+// couple of workers keep up with it, and several recorders don't start a thread per CPU each.
+#define RECORDER_MAX_CODEC_WORKERS 2
+
 // NOTE: XnLib does not define UINT*_C like macros for some reason...
 #define XN_UINT64_C(x) ((x) + (XN_MAX_UINT64 - XN_MAX_UINT64))
 #define XN_UINT32_C(x) ((x) + (XN_MAX_UINT32 - XN_MAX_UINT32))
@@ -135,8 +145,11 @@ public:
     {
         m_needRollback = true;
 
-        XnStatus status = xnOSTellFile64(m_pRecorder->m_file, &m_offset);
-        if (status != XN_STATUS_OK)
+        if (m_pRecorder != NULL && m_pRecorder->m_file.isOpen())
+        {
+            m_offset = m_pRecorder->m_file.tell();
+        }
+        else
         {
             m_pRecorder = NULL;
         }
@@ -149,7 +162,7 @@ public:
     {
         if (m_pRecorder != NULL)
         {
-            xnOSSeekFile64(m_pRecorder->m_file, XN_OS_SEEK_SET, m_offset);
+            m_pRecorder->m_file.seek(m_offset);
         }
     }
 
@@ -168,7 +181,7 @@ public:
     {
         if (m_pRecorder != NULL)
         {
-            xnOSSeekFile64(m_pRecorder->m_file, XN_OS_SEEK_SET, pos);
+            m_pRecorder->m_file.seek(pos);
         }
     }
 
@@ -184,12 +197,21 @@ Recorder::Recorder(FrameManager& frameManager, xnl::ErrorLogger& errorLogger, On
           m_handle(handle),
           m_maxId(0),
           m_configurationId(0),
+          m_maxQueueFrames(0),
+          m_maxQueueBytes(0),
+          m_queuePolicy(ONI_RECORDER_QUEUE_POLICY_BLOCK),
+          m_totalWriteLatency(0),
+          m_writeBufferSize(RECORDER_DEFAULT_WRITE_BUFFER_SIZE),
+          m_syncInterval(0),
 		  m_propertyPriority(ms_priorityNormal),
-          m_file(XN_INVALID_FILE_HANDLE),
+          m_maxPendingJobs(1),
           m_running(FALSE),
           m_started(FALSE),
           m_wasStarted(FALSE)
 {
+    xnOSMemSet(&m_queueStats, 0, sizeof(m_queueStats));
+    m_queueEvent.Create(FALSE);
+    m_queueSpaceEvent.Create(FALSE);
 }
 
 Recorder::~Recorder()
@@ -199,6 +221,11 @@ Recorder::~Recorder()
     send(Message::MESSAGE_TERMINATE);
     xnOSWaitForThreadExit(m_thread, XN_WAIT_INFINITE);
 	xnOSCloseThread(&m_thread);
+    m_codecWorkers.Destroy();
+    for (CompressionJobs::Iterator i = m_freeJobs.Begin(); i != m_freeJobs.End(); ++i)
+    {
+        XN_DELETE(*i);
+    }
     if (NULL != m_handle)
     {
         m_handle->pRecorder = NULL;
@@ -222,6 +249,16 @@ OniStatus Recorder::initialize(const char* fileName)
     xnOSCloseFile(&fileHandle);
 
     m_assembler.initialize();   
+
+    // Without workers, frames are simply compressed on the recorder thread.
+    XnUInt32 codecWorkers = RECORDER_MAX_CODEC_WORKERS;
+    XnUInt32 processors = 0;
+    if (XN_STATUS_OK == xnOSGetProcessorCount(&processors) && processors < codecWorkers)
+    {
+        codecWorkers = XN_MAX(processors, 1);
+    }
+    m_codecWorkers.Create(codecWorkers);
+    m_maxPendingJobs = XN_MAX(1, 2 * m_codecWorkers.GetThreadCount());
     
     status = xnOSCreateThread(threadMain, this, &m_thread);
     if (XN_STATUS_OK != status)
@@ -253,6 +290,7 @@ OniStatus Recorder::attachStream(VideoStream& stream, OniBool allowLossyCompress
             m_streams[pStream].lastOutputTimestamp       = 0;
             m_streams[pStream].lastInputTimestamp        = 0;
             m_streams[pStream].lastNewDataRecordPosition = 0;
+            m_streams[pStream].bufferSize                = 0;
             m_streams[pStream].dataIndex.Clear();
             send(Message::MESSAGE_ATTACH, pStream);
             return ONI_STATUS_OK;
@@ -297,6 +335,8 @@ OniStatus Recorder::start()
 void Recorder::stop()
 {
     m_started = false;
+    // release producers waiting for room in the queue
+    m_queueSpaceEvent.Set();
 }
 
 OniStatus Recorder::record(VideoStream& stream, OniFrame& aFrame)
@@ -305,6 +345,14 @@ OniStatus Recorder::record(VideoStream& stream, OniFrame& aFrame)
     {
         return ONI_STATUS_ERROR;
     }
+
+    // NOTE: this must be done before locking m_streams, as the recorder thread
+    // needs it to drain the queue.
+    if (m_queuePolicy == ONI_RECORDER_QUEUE_POLICY_BLOCK)
+    {
+        waitForQueueSpace(aFrame.dataSize);
+    }
+
     xnl::LockGuard< AttachedStreams > guard(m_streams);
     VideoStream* pStream = &stream;
     if (m_streams.Find(pStream) == m_streams.End())
@@ -337,6 +385,145 @@ OniStatus Recorder::recordStreamProperty(
     return ONI_STATUS_OK;
 }
 
+OniStatus Recorder::setProperty(int propertyId, const void* data, int dataSize)
+{
+    xnl::LockGuard<MessageQueue> guard(m_queue);
+    switch (propertyId)
+    {
+    case ONI_RECORDER_PROPERTY_MAX_QUEUE_FRAMES:
+        if (dataSize != sizeof(int) || *(const int*)data < 0)
+        {
+            m_errorLogger.Append("Recorder: MAX_QUEUE_FRAMES expects a non-negative int");
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        m_maxQueueFrames = *(const int*)data;
+        break;
+    case ONI_RECORDER_PROPERTY_MAX_QUEUE_BYTES:
+        if (dataSize == sizeof(XnUInt64))
+        {
+            m_maxQueueBytes = *(const XnUInt64*)data;
+        }
+        else if (dataSize == sizeof(int) && *(const int*)data >= 0)
+        {
+            m_maxQueueBytes = *(const int*)data;
+        }
+        else
+        {
+            m_errorLogger.Append("Recorder: MAX_QUEUE_BYTES expects a uint64_t");
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        break;
+    case ONI_RECORDER_PROPERTY_QUEUE_POLICY:
+        if (dataSize != sizeof(OniRecorderQueuePolicy))
+        {
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        switch (*(const OniRecorderQueuePolicy*)data)
+        {
+        case ONI_RECORDER_QUEUE_POLICY_BLOCK:
+        case ONI_RECORDER_QUEUE_POLICY_DROP_OLDEST:
+        case ONI_RECORDER_QUEUE_POLICY_DROP_NEWEST:
+            m_queuePolicy = *(const OniRecorderQueuePolicy*)data;
+            break;
+        default:
+            m_errorLogger.Append("Recorder: unknown queue policy %d", *(const int*)data);
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        break;
+    case ONI_RECORDER_PROPERTY_QUEUE_STATS:
+        return ONI_STATUS_NOT_SUPPORTED;
+    case ONI_RECORDER_PROPERTY_WRITE_BUFFER_SIZE:
+        if (dataSize != sizeof(int) || *(const int*)data < 0)
+        {
+            m_errorLogger.Append("Recorder: WRITE_BUFFER_SIZE expects a non-negative int");
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        m_writeBufferSize = *(const int*)data;
+        // have the recorder thread apply it
+        m_queueEvent.Set();
+        return ONI_STATUS_OK;
+    case ONI_RECORDER_PROPERTY_SYNC_INTERVAL:
+        if (dataSize == sizeof(XnUInt64))
+        {
+            m_syncInterval = *(const XnUInt64*)data;
+        }
+        else if (dataSize == sizeof(int) && *(const int*)data >= 0)
+        {
+            m_syncInterval = *(const int*)data;
+        }
+        else
+        {
+            m_errorLogger.Append("Recorder: SYNC_INTERVAL expects a uint64_t");
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        m_queueEvent.Set();
+        return ONI_STATUS_OK;
+    default:
+        m_errorLogger.Append("Recorder: unknown property %d", propertyId);
+        return ONI_STATUS_NOT_SUPPORTED;
+    }
+
+    // limits might have become looser
+    m_queueSpaceEvent.Set();
+    return ONI_STATUS_OK;
+}
+
+OniStatus Recorder::getProperty(int propertyId, void* data, int* pDataSize)
+{
+    xnl::LockGuard<MessageQueue> guard(m_queue);
+    switch (propertyId)
+    {
+    case ONI_RECORDER_PROPERTY_MAX_QUEUE_FRAMES:
+        if (*pDataSize != sizeof(int))
+        {
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        *(int*)data = (int)m_maxQueueFrames;
+        break;
+    case ONI_RECORDER_PROPERTY_MAX_QUEUE_BYTES:
+        if (*pDataSize != sizeof(XnUInt64))
+        {
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        *(XnUInt64*)data = m_maxQueueBytes;
+        break;
+    case ONI_RECORDER_PROPERTY_QUEUE_POLICY:
+        if (*pDataSize != sizeof(OniRecorderQueuePolicy))
+        {
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        *(OniRecorderQueuePolicy*)data = m_queuePolicy;
+        break;
+    case ONI_RECORDER_PROPERTY_QUEUE_STATS:
+        if (*pDataSize != sizeof(OniRecorderQueueStats))
+        {
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        m_queueStats.averageWriteLatency = (m_queueStats.recordedFrames == 0) ? 0 : m_totalWriteLatency / m_queueStats.recordedFrames;
+        *(OniRecorderQueueStats*)data = m_queueStats;
+        break;
+    case ONI_RECORDER_PROPERTY_WRITE_BUFFER_SIZE:
+        if (*pDataSize != sizeof(int))
+        {
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        *(int*)data = (int)m_writeBufferSize;
+        break;
+    case ONI_RECORDER_PROPERTY_SYNC_INTERVAL:
+        if (*pDataSize != sizeof(XnUInt64))
+        {
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+        *(XnUInt64*)data = m_syncInterval;
+        break;
+    default:
+        m_errorLogger.Append("Recorder: unknown property %d", propertyId);
+        return ONI_STATUS_NOT_SUPPORTED;
+    }
+
+    return ONI_STATUS_OK;
+}
+
 XN_THREAD_PROC Recorder::threadMain(XN_THREAD_PARAM pThreadParam)
 {
     Recorder* pSelf = reinterpret_cast<Recorder*>(pThreadParam);
@@ -352,16 +539,51 @@ XN_THREAD_PROC Recorder::threadMain(XN_THREAD_PARAM pThreadParam)
 }
 
 void Recorder::messagePump()
+{
+    // The event is auto-reset and set after every push, so any message pushed
+    // after we drained the queue will wake us up again.
+    m_queueEvent.Wait(XN_WAIT_INFINITE);
+
+    applyFileSettings();
+
+    // Messages are popped one by one (rather than swapping out the whole queue),
+    // so that high-priority messages sent while handling this batch (e.g. the
+    // properties sent during onAttach) still precede the ones already queued.
+    while (m_running && processNextMessage())
+    {
+    }
+
+    // the batch is over, don't keep frames waiting for the next one
+    writePendingRecords(0);
+}
+
+XnBool Recorder::processNextMessage()
 {
 	XnStatus nRetVal = XN_STATUS_OK;
-    Message msg = { Message::MESSAGE_NO_OPERATION, 0, NULL, {NULL}, 0, 0 };
+    Message msg = { Message::MESSAGE_NO_OPERATION, 0, NULL, {NULL}, 0, 0, 0 };
 
 	{
 		xnl::LockGuard<MessageQueue> guard(m_queue);
 		nRetVal = m_queue.Pop(msg);
+		if (XN_STATUS_OK == nRetVal && Message::MESSAGE_RECORD == msg.type)
+		{
+			--m_queueStats.queuedFrames;
+			m_queueStats.queuedBytes -= msg.pFrame->dataSize;
+			m_queueSpaceEvent.Set();
+		}
 	}
 
-    if (XN_STATUS_OK == nRetVal)
+    if (XN_STATUS_OK != nRetVal)
+    {
+        return FALSE;
+    }
+
+    // Every other message must see (and write after) all the frames before it.
+    if (Message::MESSAGE_RECORD != msg.type)
+    {
+        writePendingRecords(0);
+    }
+
     {
         switch (msg.type)
         {
@@ -393,7 +615,7 @@ void Recorder::messagePump()
                     if (i != m_streams.End())
                     {
                         onDetach(i->Value().nodeId);
-                        XN_DELETE(m_streams[msg.pStream].pCodec);
+                        freeCodecResources(i->Value());
                         m_streams.Remove(msg.pStream);
                     }
                 }
@@ -417,16 +639,12 @@ void Recorder::messagePump()
                     AttachedStreams::Iterator i = m_streams.Find(msg.pStream);
                     if (i != m_streams.End())
                     {
-                        XnCodecBase* pCodec = m_streams[msg.pStream].pCodec;
-                        XnUInt32 frameId    = ++m_streams[msg.pStream].frameId;
-                        XnUInt64 timestamp  = 0;
-                        if (frameId > 1)
-                        {
-                            timestamp = m_streams[msg.pStream].lastOutputTimestamp + (msg.pFrame->timestamp - m_streams[msg.pStream].lastInputTimestamp);
-                        }
-                        m_streams[msg.pStream].lastInputTimestamp = msg.pFrame->timestamp;
-                        m_streams[msg.pStream].lastOutputTimestamp = timestamp;
-                        onRecord(i->Value().nodeId, pCodec, msg.pFrame, frameId, timestamp);
+                        // the frame is released once it has been written
+                        dispatchRecord(msg);
+                        writePendingRecords(m_maxPendingJobs);
+                    }
+                    else
+                    {
                         m_frameManager.release(msg.pFrame);
                     }
                 }
@@ -451,6 +669,8 @@ void Recorder::messagePump()
                 ;
         }
     }
+
+    return TRUE;
 }
 
 void Recorder::send(
@@ -468,18 +688,263 @@ void Recorder::send(
         pStream,
         {pData},
         propertyId,
-        dataSize
+        dataSize,
+        0
     };
-    xnl::LockGuard<MessageQueue> guard(m_queue);
-    m_queue.Push(msg, priority);
+    {
+        xnl::LockGuard<MessageQueue> guard(m_queue);
+        if (Message::MESSAGE_RECORD == type)
+        {
+            if (!makeRoomForFrame(msg.pFrame->dataSize))
+            {
+                ++m_queueStats.droppedFrames;
+                m_frameManager.release(msg.pFrame);
+                return;
+            }
+
+            xnOSGetHighResTimeStamp(&msg.queuedTimestamp);
+            ++m_queueStats.queuedFrames;
+            m_queueStats.queuedBytes += msg.pFrame->dataSize;
+            if (m_queueStats.queuedFrames > m_queueStats.maxQueuedFrames)
+            {
+                m_queueStats.maxQueuedFrames = m_queueStats.queuedFrames;
+            }
+        }
+        m_queue.Push(msg, priority);
+    }
+    m_queueEvent.Set();
+}
+
+void XN_CALLBACK_TYPE Recorder::compressFrame(void* pCookie)
+{
+    CompressionJob* pJob = reinterpret_cast<CompressionJob*>(pCookie);
+    pJob->compressedSize = pJob->bufferSize;
+    pJob->status = pJob->pCodec->Compress(reinterpret_cast<const XnUChar*>(pJob->pFrame->data),
+            pJob->pFrame->dataSize, pJob->pBuffer, &pJob->compressedSize);
+    pJob->doneEvent.Set();
+}
+
+void Recorder::dispatchRecord(const Message& msg)
+{
+    AttachedStreamInfo& info = m_streams[msg.pStream];
+
+    CompressionJob* pJob = NULL;
+    if (m_freeJobs.IsEmpty())
+    {
+        pJob = XN_NEW(CompressionJob);
+        pJob->doneEvent.Create(FALSE);
+    }
+    else
+    {
+        pJob = *m_freeJobs.Begin();
+        m_freeJobs.Remove(m_freeJobs.Begin());
+    }
+
+    pJob->pStream         = msg.pStream;
+    pJob->nodeId          = info.nodeId;
+    pJob->pFrame          = msg.pFrame;
+    pJob->queuedTimestamp = msg.queuedTimestamp;
+    pJob->frameId         = ++info.frameId;
+    pJob->timestamp       = 0;
+    if (pJob->frameId > 1)
+    {
+        pJob->timestamp = info.lastOutputTimestamp + (msg.pFrame->timestamp - info.lastInputTimestamp);
+    }
+    info.lastInputTimestamp  = msg.pFrame->timestamp;
+    info.lastOutputTimestamp = pJob->timestamp;
+
+    pJob->pCodec         = NULL;
+    pJob->pBuffer        = NULL;
+    pJob->bufferSize     = 0;
+    pJob->compressedSize = 0;
+    pJob->status         = XN_STATUS_OK;
+
+    if (NULL != info.pCodec)
+    {
+        // Codecs keep state while compressing, so every job gets its own instance.
+        if (info.freeCodecs.IsEmpty())
+        {
+            pJob->pCodec = createCodec(info);
+            if (NULL == pJob->pCodec)
+            {
+                // wait for the instances in use to come back
+                writePendingRecords(0);
+            }
+        }
+        if (NULL == pJob->pCodec)
+        {
+            pJob->pCodec = *info.freeCodecs.Begin();
+            info.freeCodecs.Remove(info.freeCodecs.Begin());
+        }
+
+        XnUInt32 requiredSize = msg.pFrame->dataSize * 2 + pJob->pCodec->GetOverheadSize();
+        if (requiredSize > info.bufferSize)
+        {
+            // all pooled buffers are too small now
+            for (xnl::List<XnUInt8*>::Iterator b = info.freeBuffers.Begin(); b != info.freeBuffers.End(); ++b)
+            {
+                XN_DELETE_ARR(*b);
+            }
+            info.freeBuffers.Clear();
+            info.bufferSize = requiredSize;
+        }
+        if (info.freeBuffers.IsEmpty())
+        {
+            pJob->pBuffer = XN_NEW_ARR(XnUInt8, info.bufferSize);
+        }
+        else
+        {
+            pJob->pBuffer = *info.freeBuffers.Begin();
+            info.freeBuffers.Remove(info.freeBuffers.Begin());
+        }
+        pJob->bufferSize = info.bufferSize;
+    }
+
+    m_pendingJobs.AddLast(pJob);
+
+    if (NULL == pJob->pCodec)
+    {
+        pJob->doneEvent.Set();
+    }
+    else if (XN_STATUS_OK != m_codecWorkers.Submit(compressFrame, pJob))
+    {
+        compressFrame(pJob);
+    }
+}
+
+void Recorder::writePendingRecords(XnUInt32 maxPendingJobs)
+{
+    while (m_pendingJobs.Size() > maxPendingJobs)
+    {
+        CompressionJob* pJob = *m_pendingJobs.Begin();
+        m_pendingJobs.Remove(m_pendingJobs.Begin());
+        pJob->doneEvent.Wait(XN_WAIT_INFINITE);
+
+        {
+            // Streams are removed only after all their frames have been written.
+            xnl::LockGuard<AttachedStreams> streamsGuard(m_streams);
+            AttachedStreamInfo& info = m_streams[pJob->pStream];
+
+            onRecord(*pJob);
+
+            if (NULL != pJob->pCodec)
+            {
+                info.freeCodecs.AddLast(pJob->pCodec);
+                if (pJob->bufferSize == info.bufferSize)
+                {
+                    info.freeBuffers.AddLast(pJob->pBuffer);
+                }
+                else
+                {
+                    XN_DELETE_ARR(pJob->pBuffer);
+                }
+            }
+        }
+
+        XnUInt64 now = 0;
+        xnOSGetHighResTimeStamp(&now);
+        XnUInt64 latency = now - pJob->queuedTimestamp;
+
+        {
+            xnl::LockGuard<MessageQueue> queueGuard(m_queue);
+            ++m_queueStats.recordedFrames;
+            m_queueStats.lastWriteLatency = latency;
+            m_totalWriteLatency += latency;
+            if (latency > m_queueStats.maxWriteLatency)
+            {
+                m_queueStats.maxWriteLatency = latency;
+            }
+        }
+
+        m_frameManager.release(pJob->pFrame);
+        m_freeJobs.AddLast(pJob);
+    }
+}
+
+XnBool Recorder::isQueueFull(XnSizeT frameSize)
+{
+    if (m_maxQueueFrames != 0 && (XnUInt32)m_queueStats.queuedFrames >= m_maxQueueFrames)
+    {
+        return TRUE;
+    }
+    // a single frame larger than the limit is still accepted into an empty queue
+    if (m_maxQueueBytes != 0 && m_queueStats.queuedFrames > 0 && m_queueStats.queuedBytes + frameSize > m_maxQueueBytes)
+    {
+        return TRUE;
+    }
+    return FALSE;
+}
+
+XnBool Recorder::makeRoomForFrame(XnSizeT frameSize)
+{
+    switch (m_queuePolicy)
+    {
+    case ONI_RECORDER_QUEUE_POLICY_DROP_NEWEST:
+        return !isQueueFull(frameSize);
+
+    case ONI_RECORDER_QUEUE_POLICY_DROP_OLDEST:
+        {
+            // frames are always sent with normal priority
+            MessageList& frames = m_queue.GetQueue(ms_priorityNormal);
+            MessageList::Iterator it = frames.Begin();
+            while (isQueueFull(frameSize) && it != frames.End())
+            {
+                MessageList::Iterator current = it++;
+                if (Message::MESSAGE_RECORD == current->type)
+                {
+                    --m_queueStats.queuedFrames;
+                    m_queueStats.queuedBytes -= current->pFrame->dataSize;
+                    ++m_queueStats.droppedFrames;
+                    m_frameManager.release(current->pFrame);
+                    frames.Remove(current);
+                }
+            }
+            return TRUE;
+        }
+
+    case ONI_RECORDER_QUEUE_POLICY_BLOCK:
+    default:
+        // producer already waited in waitForQueueSpace(). Several producers might
+        // have been released at once, so the limit may be slightly exceeded.
+        return TRUE;
+    }
+}
+
+void Recorder::applyFileSettings()
+{
+    XnUInt32 writeBufferSize = 0;
+    XnUInt64 syncInterval = 0;
+    {
+        xnl::LockGuard<MessageQueue> guard(m_queue);
+        writeBufferSize = m_writeBufferSize;
+        syncInterval = m_syncInterval;
+    }
+
+    // on failure, keep writing with the current buffer
+    m_file.setBufferSize(writeBufferSize);
+    m_file.setSyncInterval(syncInterval);
+}
+
+void Recorder::waitForQueueSpace(XnSizeT frameSize)
+{
+    for (;;)
+    {
+        {
+            xnl::LockGuard<MessageQueue> guard(m_queue);
+            if (!m_started || !isQueueFull(frameSize))
+            {
+                return;
+            }
+        }
+        m_queueSpaceEvent.Wait(RECORDER_QUEUE_SPACE_WAIT_TIMEOUT);
+    }
 }
 
 void Recorder::onInitialize()
 {
-    XnStatus status = xnOSOpenFile(
+    XnStatus status = m_file.open(
         /* file name  = */ m_fileName.Data(), 
-        /* open flags = */ XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE, 
-        /* out handle = */ &m_file);
+        /* open flags = */ XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE);
 
     if (XN_STATUS_OK == status)
     {
@@ -491,7 +956,7 @@ void Recorder::onInitialize()
             /* maxNodeId    = */ m_maxId,
         };
         m_fileHeader = fileHeader;
-        xnOSWriteFile(m_file, &m_fileHeader, sizeof(m_fileHeader));
+        m_file.write(&m_fileHeader, sizeof(m_fileHeader));
     }
 }
 
@@ -537,6 +1002,48 @@ void Recorder::onInitialize()
         } \
     }
 
+XnCodecBase* Recorder::createCodec(const AttachedStreamInfo& info)
+{
+    XnCodecBase* pCodec = NULL;
+    switch (info.codecId)
+    {
+    case ONI_CODEC_16Z_EMB_TABLES:
+        pCodec = XN_NEW(Xn16zEmbTablesCodec, info.maxDepth);
+        break;
+    case ONI_CODEC_JPEG:
+        pCodec = XN_NEW(XnJpegCodec, /* bRGB = */ TRUE, info.resolutionX, info.resolutionY);
+        break;
+    default:
+        pCodec = XN_NEW(XnUncompressedCodec);
+        break;
+    }
+
+    if (XN_STATUS_OK != pCodec->Init())
+    {
+        XN_DELETE(pCodec);
+        return NULL;
+    }
+    return pCodec;
+}
+
+void Recorder::freeCodecResources(AttachedStreamInfo& info)
+{
+    // pCodec is one of the free codecs
+    for (xnl::List<XnCodecBase*>::Iterator i = info.freeCodecs.Begin(); i != info.freeCodecs.End(); ++i)
+    {
+        XN_DELETE(*i);
+    }
+    info.freeCodecs.Clear();
+    info.pCodec = NULL;
+
+    for (xnl::List<XnUInt8*>::Iterator i = info.freeBuffers.Begin(); i != info.freeBuffers.End(); ++i)
+    {
+        XN_DELETE_ARR(*i);
+    }
+    info.freeBuffers.Clear();
+    info.bufferSize = 0;
+}
+
 XnUInt64 Recorder::getLastPropertyRecordPos(XnUInt32 nodeId, const char *propName, XnUInt64 newRecordPos)
 {
     XnUInt64 pos = 0;
@@ -555,11 +1062,7 @@ void Recorder::onTerminate()
 {
     // Truncate the file to it's last offset, so that undone records
     // will not be serialized.
-    XnUInt64 truncationOffset = XN_UINT64_C(0);
-    if (XN_STATUS_OK == xnOSTellFile64(m_file, &truncationOffset))
-    {
-        xnOSTruncateFile64(m_file, truncationOffset);
-    }
+    m_file.truncate();
 
     Memento undoPoint(this);
     EMIT(RECORD_END())
@@ -568,11 +1071,10 @@ void Recorder::onTerminate()
     // The file header needs being patched, because its maxNodeId field has become
     // irrelevant by now.
     m_fileHeader.maxNodeId = m_maxId;
-    xnOSSeekFile64(m_file, XN_OS_SEEK_SET, XN_UINT64_C(0));
-    xnOSWriteFile(m_file, &m_fileHeader, sizeof(m_fileHeader));
+    m_file.seek(XN_UINT64_C(0));
+    m_file.write(&m_fileHeader, sizeof(m_fileHeader));
 
-    xnOSCloseFile(&m_file);
-    m_file = XN_INVALID_FILE_HANDLE;
+    m_file.close();
 }
 
 typedef enum XnPixelFormat
@@ -664,9 +1166,6 @@ void Recorder::onAttach(XnUInt32 nodeId, VideoStream* pStream)
             pStream->getProperty(
                     ONI_STREAM_PROPERTY_MAX_VALUE, &maxDepth, &size);
 
-            m_streams[pStream].pCodec = XN_NEW(
-                    Xn16zEmbTablesCodec, static_cast<XnUInt16>(maxDepth));
-
             codecId = ONI_CODEC_16Z_EMB_TABLES;
         }
         break;
@@ -674,32 +1173,29 @@ void Recorder::onAttach(XnUInt32 nodeId, VideoStream* pStream)
         {
             if (m_streams[pStream].allowLossyCompression)
             {
-                m_streams[pStream].pCodec = XN_NEW(
-                        XnJpegCodec, 
-                        /* bRGB = */ TRUE, 
-                        curVideoMode.resolutionX,
-                        curVideoMode.resolutionY);
-
                 codecId = ONI_CODEC_JPEG;
             }
-            else
-            {
-                m_streams[pStream].pCodec = XN_NEW(XnUncompressedCodec);
-            }
         }
         break;
     default:
-        m_streams[pStream].pCodec = XN_NEW(XnUncompressedCodec);
         break;
     }
 
+    m_streams[pStream].codecId     = codecId;
+    m_streams[pStream].maxDepth    = static_cast<XnUInt16>(maxDepth);
+    m_streams[pStream].resolutionX = curVideoMode.resolutionX;
+    m_streams[pStream].resolutionY = curVideoMode.resolutionY;
+    m_streams[pStream].pCodec      = createCodec(m_streams[pStream]);
+
     // If anything went wrong - fall back to uncompressed format. 
-    if (XN_STATUS_OK != m_streams[pStream].pCodec->Init())
+    if (NULL == m_streams[pStream].pCodec)
     {
-        XN_DELETE(m_streams[pStream].pCodec);
-        m_streams[pStream].pCodec = NULL;
         codecId = ONI_CODEC_UNCOMPRESSED;
     }
+    else
+    {
+        m_streams[pStream].freeCodecs.AddLast(m_streams[pStream].pCodec);
+    }
     
     Memento undoPoint(this);
     // save the position of this record so we can override it upon detaching
@@ -989,8 +1485,10 @@ void Recorder::onStart(XnUInt32 nodeId)
     undoPoint.Release();
 }
 
-void Recorder::onRecord(XnUInt32 nodeId, XnCodecBase* pCodec, const OniFrame* pFrame, XnUInt32 frameId, XnUInt64 timestamp)
+void Recorder::onRecord(const CompressionJob& job)
 {
+    XnUInt32 nodeId = job.nodeId;
+    const OniFrame* pFrame = job.pFrame;
     if (0 == nodeId || NULL == pFrame)
     {
         return;
@@ -1001,25 +1499,18 @@ void Recorder::onRecord(XnUInt32 nodeId, XnCodecBase* pCodec, const OniFrame* pF
 
     Memento undoPoint(this);
 
-    if (NULL != pCodec)
+    if (NULL != job.pCodec)
     {
-        XnUInt32 bufferSize_bytes32 = pFrame->dataSize * 2 + pCodec->GetOverheadSize();
-        XnUInt8* buffer             = XN_NEW_ARR(XnUInt8, bufferSize_bytes32);
-
-        XnStatus status = pCodec->Compress(reinterpret_cast<const XnUChar*>(pFrame->data), 
-                pFrame->dataSize, buffer, &bufferSize_bytes32);
-                XnSizeT  bufferSize_bytes = bufferSize_bytes32;
-        if (XN_STATUS_OK == status)
+        if (XN_STATUS_OK == job.status)
         {
             EMIT(RECORD_NEW_DATA(
                     nodeId,
                     pInfo->lastNewDataRecordPosition,
-                    timestamp,
-                    frameId,
-                    buffer,
-                    bufferSize_bytes))
+                    job.timestamp,
+                    job.frameId,
+                    job.pBuffer,
+                    job.compressedSize))
         }
-        XN_DELETE_ARR(buffer);
     }
     else
     {
@@ -1038,7 +1529,7 @@ void Recorder::onRecord(XnUInt32 nodeId, XnCodecBase* pCodec, const OniFrame* pF
     
     // write to seek table
     DataIndexEntry dataIndexEntry;
-    dataIndexEntry.nTimestamp = timestamp;
+    dataIndexEntry.nTimestamp = job.timestamp;
     dataIndexEntry.nConfigurationID = m_configurationId;
     dataIndexEntry.nSeekPos = undoPoint.GetPosition();
 
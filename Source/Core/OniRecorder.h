@@ -25,6 +25,9 @@
 #include "XnLockable.h"
 #include "XnString.h"
 #include "XnPriorityQueue.h"
+#include "XnList.h"
+#include "XnOSCpp.h"
+#include "XnThreadPool.h"
 
 // These come from OniFile/Formats
 #include "Xn16zEmbTablesCodec.h"
@@ -34,6 +37,7 @@
 #include "OniCommon.h"
 #include "OniFrameManager.h"
 #include "OniDataRecords.h"
+#include "OniWriteBehindFile.h"
 #include "OniStream.h"
 #include "OniCTypes.h"
 
@@ -106,6 +110,21 @@ public:
             int         propertyId,
             const void* pData, 
             int         dataSize);
+
+    /**
+     * Sets a recorder property (ONI_RECORDER_PROPERTY_...).
+     */
+    OniStatus setProperty(int propertyId, const void* data, int dataSize);
+
+    /**
+     * Gets a recorder property (ONI_RECORDER_PROPERTY_...).
+     */
+    OniStatus getProperty(int propertyId, void* data, int* pDataSize);
+
+    /**
+     * Returns the name of the file being recorded to.
+     */
+    const XnChar* getFileName() const { return m_fileName.Data(); }
     
 private:
     XN_DISABLE_COPY_AND_ASSIGN(Recorder)
@@ -137,7 +156,7 @@ private:
         };
         XnUInt32    propertyId;
         XnSizeT     dataSize;
-        
+        XnUInt64    queuedTimestamp;    ///< When the message was queued (MESSAGE_RECORD only).
     };
 
     // Used for undo functionality.
@@ -147,10 +166,60 @@ private:
     // The main function of Recorder's thread.
     static XN_THREAD_PROC threadMain(XN_THREAD_PARAM pThreadParam);
 
-    // Obtains the next message from the queue of messages and executes an
-    // action associated with that message.
+    // Waits for messages to arrive, then obtains and executes every message
+    // currently in the queue (in priority order).
     void messagePump();
 
+    // Obtains the next message from the queue of messages and executes an
+    // action associated with that message. Returns FALSE if the queue is empty.
+    XnBool processNextMessage();
+
+    // A frame handed to m_codecWorkers for compression. Jobs are written to the
+    // file by the recorder thread, in the order they were dispatched.
+    struct CompressionJob
+    {
+        VideoStream*    pStream;
+        XnUInt32        nodeId;
+        OniFrame*       pFrame;
+        XnUInt32        frameId;
+        XnUInt64        timestamp;
+        XnUInt64        queuedTimestamp;
+        XnCodecBase*    pCodec;         //< NULL if the frame is written uncompressed.
+        XnUInt8*        pBuffer;
+        XnUInt32        bufferSize;
+        XnUInt32        compressedSize;
+        XnStatus        status;
+        xnl::OSEvent    doneEvent;      //< Set once the frame has been compressed.
+    };
+    typedef xnl::List<CompressionJob*> CompressionJobs;
+
+    // Compresses a frame on one of m_codecWorkers.
+    static void XN_CALLBACK_TYPE compressFrame(void* pCookie);
+
+    // Hands a MESSAGE_RECORD over to m_codecWorkers and queues it for writing.
+    // m_streams must be locked by the caller.
+    void dispatchRecord(const Message& msg);
+
+    // Writes dispatched frames to the file, oldest first, until no more than
+    // maxPendingJobs remain in flight.
+    void writePendingRecords(XnUInt32 maxPendingJobs);
+
+    // Returns TRUE if a frame of the given size exceeds the queue limits.
+    // m_queue must be locked by the caller.
+    XnBool isQueueFull(XnSizeT frameSize);
+
+    // Makes room in the queue for a new frame according to the queue policy.
+    // Returns FALSE if the new frame should be dropped.
+    // m_queue must be locked by the caller.
+    XnBool makeRoomForFrame(XnSizeT frameSize);
+
+    // Applies the write buffer settings to m_file.
+    void applyFileSettings();
+
+    // Blocks while the queue has no room for a frame of the given size (used by
+    // ONI_RECORDER_QUEUE_POLICY_BLOCK).
+    void waitForQueueSpace(XnSizeT frameSize);
+
     // Sends a message to the threadMain.
     void send(
             Message::Type type, 
@@ -166,7 +235,7 @@ private:
     void onAttach(XnUInt32 nodeId, VideoStream* pStream);
     void onDetach(XnUInt32 nodeId);
     void onStart (XnUInt32 nodeId);
-    void onRecord(XnUInt32 nodeId, XnCodecBase* pCodec, const OniFrame* pFrame, XnUInt32 frameId, XnUInt64 timestamp);
+    void onRecord(const CompressionJob& job);
     void onRecordProperty(
             XnUInt32    nodeId, 
             XnUInt32    propertyId,
@@ -198,6 +267,17 @@ private:
         XnUInt32       nodeType; 
         XnUInt32       codecId;
 
+        // needed for creating additional codec instances
+        XnUInt16       maxDepth;
+        int            resolutionX;
+        int            resolutionY;
+
+        // Codec instances and compression buffers that are not in use by any
+        // compression job (pCodec is one of the codecs). Recorder thread only.
+        xnl::List<XnCodecBase*> freeCodecs;
+        xnl::List<XnUInt8*>     freeBuffers;
+        XnUInt32                bufferSize;
+
         // needed for keeping track of undoRecordPos field
         XnUInt64       lastNewDataRecordPosition;
         xnl::Hash<const char *, XnUInt64> 
@@ -211,6 +291,12 @@ private:
     typedef xnl::Lockable< xnl::Hash<VideoStream*, AttachedStreamInfo> > AttachedStreams;
     AttachedStreams m_streams;
 
+    // Creates a new codec instance for the stream. Returns NULL on failure.
+    XnCodecBase* createCodec(const AttachedStreamInfo& info);
+
+    // Deletes the codecs and compression buffers of the stream.
+    void freeCodecResources(AttachedStreamInfo& info);
+
     // A helper function for the properties' undoRecordPos
     XnUInt64 getLastPropertyRecordPos(XnUInt32 nodeId, const char *propName, XnUInt64 newRecordPos);
 
@@ -224,7 +310,21 @@ private:
 
     // A message queue, used by threadMain and Send().
     typedef xnl::Lockable<xnl::PriorityQueue<Message, 3> > MessageQueue;
+    typedef xnl::Queue<Message> MessageList;    //< A single priority of MessageQueue.
     MessageQueue m_queue;
+    // Signalled by send() whenever a message is pushed into m_queue.
+    xnl::OSEvent m_queueEvent;
+    // Signalled by the recorder thread whenever a frame leaves m_queue.
+    xnl::OSEvent m_queueSpaceEvent;
+
+    // Queue limits, policy and statistics. Protected by m_queue's lock.
+    XnUInt32               m_maxQueueFrames;    //< 0 means unlimited.
+    XnUInt64               m_maxQueueBytes;     //< 0 means unlimited.
+    OniRecorderQueuePolicy m_queuePolicy;
+    OniRecorderQueueStats  m_queueStats;
+    XnUInt64               m_totalWriteLatency;
+    XnUInt32               m_writeBufferSize;   //< Applied to m_file by the recorder thread.
+    XnUInt64               m_syncInterval;      //< Applied to m_file by the recorder thread.
 	int m_propertyPriority;
 	static const int ms_priorityLow = 2;
 	static const int ms_priorityNormal = 1;
@@ -234,10 +334,17 @@ private:
     // serialize them to a file.
     RecordAssembler m_assembler;
 
+    // Compresses frames in parallel. Only the recorder thread dispatches jobs
+    // and writes their results, so the file is written in message order.
+    xnl::ThreadPool  m_codecWorkers;
+    CompressionJobs  m_pendingJobs;     //< Dispatched but not yet written.
+    CompressionJobs  m_freeJobs;        //< Written jobs, for reuse.
+    XnUInt32         m_maxPendingJobs;
+
     XN_THREAD_HANDLE m_thread;
     FileHeaderData   m_fileHeader;  //< Will be patched during termination.
     xnl::String      m_fileName;
-    XN_FILE_HANDLE   m_file;
+    WriteBehindFile  m_file;
     XnBool           m_running;     //< TRUE whenever the threadMain is running.
     XnBool           m_started;     //< TRUE whenever the recorder has started.
     XnBool           m_wasStarted;  //< TRUE if the recorder has been started once.
@@ -10,15 +10,23 @@ Sensor::Sensor(xnl::ErrorLogger& errorLogger, FrameManager& frameManager, const
 	m_frameManager(frameManager),
 	m_driverHandler(driverHandler),
 	m_streamHandle(NULL),
-	m_requiredFrameSize(0)
+	m_requiredFrameSize(0),
+	m_pFrameBufferSlab(NULL),
+	m_framePoolSize(0),
+	m_framePoolLargePages(FALSE),
+	m_framePoolHits(0),
+	m_framePoolMisses(0),
+	m_latencyTrackingStreams(0)
 {
 	resetFrameAllocator();
 
 	OniStreamServices::streamServices = this;
 	OniStreamServices::getDefaultRequiredFrameSize = getDefaultRequiredFrameSizeCallback;
 	OniStreamServices::acquireFrame = acquireFrameCallback;
+	OniStreamServices::acquireExternalFrame = acquireExternalFrameCallback;
 	OniStreamServices::addFrameRef = addFrameRefCallback;
 	OniStreamServices::releaseFrame = releaseFrameCallback;
+	OniStreamServices::setFrameStageTimestamp = setFrameStageTimestampCallback;
 }
 
 Sensor::~Sensor()
@@ -67,9 +75,67 @@ void Sensor::setRequiredFrameSize(int requiredFrameSize)
 	{
 		// release all previous frames. They can't be used anymore
 		releaseAllFrames();
+		m_requiredFrameSize = requiredFrameSize;
+		createFrameBufferSlab();
 	}
+}
+
+OniStatus Sensor::setFramePool(int bufferCount, OniBool largePages, int requiredFrameSize)
+{
+	xnl::AutoCSLocker lock(m_refCountCS);
+	if (m_startedStreamCount > 0)
+	{
+		m_errorLogger.Append("Cannot change frame buffer pool while stream is running");
+		return ONI_STATUS_OUT_OF_FLOW;
+	}
+
+	if (bufferCount < 0 || bufferCount > FrameBufferSlab::MAX_BUFFERS)
+	{
+		m_errorLogger.Append("Frame buffer pool size must be between 0 and %d", FrameBufferSlab::MAX_BUFFERS);
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	m_framePoolSize = bufferCount;
+	m_framePoolLargePages = largePages;
 
+	// allocate right away (for the current video mode), rather than on start
+	releaseAllFrames();
 	m_requiredFrameSize = requiredFrameSize;
+	createFrameBufferSlab();
+
+	if (m_framePoolSize > 0 && m_pFrameBufferSlab == NULL)
+	{
+		m_errorLogger.Append("Failed to allocate %d frame buffers of %d bytes", bufferCount, requiredFrameSize);
+		return ONI_STATUS_ERROR;
+	}
+
+	return ONI_STATUS_OK;
+}
+
+void Sensor::getFramePoolStats(OniFramePoolStats* pStats)
+{
+	xnl::AutoCSLocker lock(m_refCountCS);
+	xnOSMemSet(pStats, 0, sizeof(*pStats));
+	if (m_pFrameBufferSlab != NULL)
+	{
+		pStats->capacity = m_pFrameBufferSlab->getBufferCount();
+		pStats->buffersInUse = m_pFrameBufferSlab->getBuffersInUse();
+		pStats->maxBuffersInUse = m_pFrameBufferSlab->getMaxBuffersInUse();
+	}
+	pStats->hits = m_framePoolHits;
+	pStats->misses = m_framePoolMisses;
+}
+
+void Sensor::createFrameBufferSlab()
+{
+	XN_ASSERT(m_pFrameBufferSlab == NULL);
+	m_framePoolHits = 0;
+	m_framePoolMisses = 0;
+
+	if (m_framePoolSize > 0 && m_requiredFrameSize > 0)
+	{
+		m_pFrameBufferSlab = FrameBufferSlab::create(m_requiredFrameSize, m_framePoolSize, m_framePoolLargePages);
+	}
 }
 
 void Sensor::resetFrameAllocator()
@@ -87,7 +153,35 @@ OniFrame* Sensor::acquireFrame()
 		return NULL;
 	}
 
-	pResult->data = m_allocFrameBufferCallback(m_requiredFrameSize, m_frameBufferAllocatorCookie);
+	pResult->data = NULL;
+	pResult->freeBufferFunc = m_freeFrameBufferCallback;
+	pResult->freeBufferFuncCookie = m_frameBufferAllocatorCookie;
+
+	// preallocated buffers are only used with the default allocator
+	if (m_allocFrameBufferCallback == allocFrameBufferFromPoolCallback)
+	{
+		if (m_pFrameBufferSlab != NULL)
+		{
+			pResult->data = m_pFrameBufferSlab->acquireBuffer();
+		}
+
+		if (pResult->data != NULL)
+		{
+			xnOSAtomicIncrement(&m_framePoolHits);
+			pResult->freeBufferFunc = FrameBufferSlab::releaseBufferCallback;
+			pResult->freeBufferFuncCookie = m_pFrameBufferSlab;
+		}
+		else
+		{
+			xnOSAtomicIncrement(&m_framePoolMisses);
+		}
+	}
+
+	if (pResult->data == NULL)
+	{
+		pResult->data = m_allocFrameBufferCallback(m_requiredFrameSize, m_frameBufferAllocatorCookie);
+	}
+
 	if (pResult->data == NULL)
 	{
 		m_frameManager.release(pResult);
@@ -97,8 +191,33 @@ OniFrame* Sensor::acquireFrame()
 	pResult->dataSize = m_requiredFrameSize;
 	pResult->backToPoolFunc = frameBackToPoolCallback;
 	pResult->backToPoolFuncCookie = this;
-	pResult->freeBufferFunc = m_freeFrameBufferCallback;
-	pResult->freeBufferFuncCookie = m_frameBufferAllocatorCookie;
+
+	xnl::AutoCSLocker lock(m_framesCS);
+	m_currentStreamFrames.AddLast(pResult);
+
+	return pResult;
+}
+
+OniFrame* Sensor::acquireExternalFrame(void* data, int dataSize, OniFrameFreeBufferCallback freeBuffer, void* pCookie)
+{
+	// when the application supplied its own allocator, frames must be in its buffers (external ones may be read-only)
+	if (m_allocFrameBufferCallback != allocFrameBufferFromPoolCallback)
+	{
+		return NULL;
+	}
+
+	OniFrameInternal* pResult = m_frameManager.acquireFrame();
+	if (pResult == NULL)
+	{
+		return NULL;
+	}
+
+	pResult->data = data;
+	pResult->dataSize = dataSize;
+	pResult->backToPoolFunc = frameBackToPoolCallback;
+	pResult->backToPoolFuncCookie = this;
+	pResult->freeBufferFunc = freeBuffer;
+	pResult->freeBufferFuncCookie = pCookie;
 
 	xnl::AutoCSLocker lock(m_framesCS);
 	m_currentStreamFrames.AddLast(pResult);
@@ -173,6 +292,13 @@ void Sensor::releaseAllFrames()
 		xnOSFreeAligned(*it);
 	}
 	m_availableFrameBuffers.Clear();
+
+	// frames still using preallocated buffers keep the slab alive
+	if (m_pFrameBufferSlab != NULL)
+	{
+		m_pFrameBufferSlab->release();
+		m_pFrameBufferSlab = NULL;
+	}
 }
 
 void ONI_CALLBACK_TYPE Sensor::frameBackToPoolCallback(OniFrameInternal* pFrame, void* pCookie)
@@ -216,6 +342,10 @@ int Sensor::getDefaultRequiredFrameSize()
 void ONI_CALLBACK_TYPE Sensor::newFrameCallback(void* /*streamHandle*/, OniFrame* pFrame, void* pCookie)
 {
 	Sensor* pThis = (Sensor*)pCookie;
+	if (pThis->isLatencyTracked())
+	{
+		stampFrame(pFrame, ONI_FRAME_STAGE_NEW_FRAME);
+	}
 	pThis->m_newFrameEvent.Raise(pFrame);
 }
 
@@ -231,6 +361,12 @@ OniFrame* ONI_CALLBACK_TYPE Sensor::acquireFrameCallback(void* streamServices)
 	return pThis->acquireFrame();
 }
 
+OniFrame* ONI_CALLBACK_TYPE Sensor::acquireExternalFrameCallback(void* streamServices, void* data, int dataSize, OniFrameFreeBufferCallback freeBuffer, void* pCookie)
+{
+	Sensor* pThis = (Sensor*)streamServices;
+	return pThis->acquireExternalFrame(data, dataSize, freeBuffer, pCookie);
+}
+
 void ONI_CALLBACK_TYPE Sensor::addFrameRefCallback(void* streamServices, OniFrame* pFrame)
 {
 	Sensor* pThis = (Sensor*)streamServices;
@@ -243,4 +379,13 @@ void ONI_CALLBACK_TYPE Sensor::releaseFrameCallback(void* streamServices, OniFra
 	return pThis->m_frameManager.release(pFrame);
 }
 
+void ONI_CALLBACK_TYPE Sensor::setFrameStageTimestampCallback(void* streamServices, OniFrame* pFrame, OniFrameStage stage, uint64_t timestamp)
+{
+	Sensor* pThis = (Sensor*)streamServices;
+	if (pThis->isLatencyTracked() && pFrame != NULL && stage >= 0 && stage < ONI_FRAME_STAGE_COUNT)
+	{
+		((OniFrameInternal*)pFrame)->stageTimestamps[stage] = timestamp;
+	}
+}
+
 ONI_NAMESPACE_IMPLEMENTATION_END
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "OniCommon.h"
 #include "OniFrameManager.h"
 #include "OniDriverHandler.h"
+#include "OniFrameBufferSlab.h"
 #include <Driver/OniDriverTypes.h>
 #include <XnOSCpp.h>
 #include <XnList.h>
@@ -23,6 +24,17 @@ public:
 	OniStatus setFrameBufferAllocator(OniFrameAllocBufferCallback alloc, OniFrameFreeBufferCallback free, void* pCookie);
 	void setRequiredFrameSize(int requiredFrameSize);
 
+	// Frame buffers allocated up front, so streaming doesn't allocate. Only while the sensor is stopped.
+	OniStatus setFramePool(int bufferCount, OniBool largePages, int requiredFrameSize);
+	int getFramePoolSize() const { return m_framePoolSize; }
+	OniBool getFramePoolLargePages() const { return m_framePoolLargePages; }
+	void getFramePoolStats(OniFramePoolStats* pStats);
+
+	// Frames are stamped as they go through the pipeline while any stream of the sensor tracks latency.
+	void addLatencyTrackingStream() { xnOSAtomicIncrement(&m_latencyTrackingStreams); }
+	void removeLatencyTrackingStream() { xnOSAtomicDecrement(&m_latencyTrackingStreams); }
+	OniBool isLatencyTracked() const { return m_latencyTrackingStreams > 0; }
+
 	xnl::Event1Arg<OniFrame*>::Interface& newFrameEvent() { return m_newFrameEvent; }
 	void* streamHandle() const { return m_streamHandle; }
 
@@ -36,11 +48,14 @@ private:
 	// stream services implementation
 	int getDefaultRequiredFrameSize();
 	OniFrame* acquireFrame();
+	OniFrame* acquireExternalFrame(void* data, int dataSize, OniFrameFreeBufferCallback freeBuffer, void* pCookie);
 
 	static int ONI_CALLBACK_TYPE getDefaultRequiredFrameSizeCallback(void* streamServices);
 	static OniFrame* ONI_CALLBACK_TYPE acquireFrameCallback(void* streamServices);
+	static OniFrame* ONI_CALLBACK_TYPE acquireExternalFrameCallback(void* streamServices, void* data, int dataSize, OniFrameFreeBufferCallback freeBuffer, void* pCookie);
 	static void ONI_CALLBACK_TYPE releaseFrameCallback(void* streamServices, OniFrame* pFrame);
 	static void ONI_CALLBACK_TYPE addFrameRefCallback(void* streamServices, OniFrame* pFrame);
+	static void ONI_CALLBACK_TYPE setFrameStageTimestampCallback(void* streamServices, OniFrame* pFrame, OniFrameStage stage, uint64_t timestamp);
 
 	void resetFrameAllocator();
 
@@ -48,6 +63,7 @@ private:
 	void* allocFrameBufferFromPool(int size);
 	void releaseFrameBufferToPool(void* pBuffer);
 	void releaseAllFrames();
+	void createFrameBufferSlab();
 
 	static void* ONI_CALLBACK_TYPE allocFrameBufferFromPoolCallback(int size, void* pCookie);
 	static void ONI_CALLBACK_TYPE releaseFrameBufferToPoolCallback(void* pBuffer, void* pCookie);
@@ -71,6 +87,15 @@ private:
 	xnl::List<void*> m_availableFrameBuffers;
 	xnl::List<OniFrameInternal*> m_currentStreamFrames;
 
+	// preallocated buffers, tried before the list above
+	FrameBufferSlab* m_pFrameBufferSlab;
+	int m_framePoolSize;
+	OniBool m_framePoolLargePages;
+	volatile XnInt32 m_framePoolHits; // only modified through xnOSAtomic* functions
+	volatile XnInt32 m_framePoolMisses; // only modified through xnOSAtomic* functions
+
+	volatile XnInt32 m_latencyTrackingStreams; // only modified through xnOSAtomic* functions
+
 	// following members point to current allocation functions
 	OniFrameAllocBufferCallback m_allocFrameBufferCallback;
 	OniFrameFreeBufferCallback m_freeFrameBufferCallback;
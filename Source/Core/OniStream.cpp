@@ -23,15 +23,40 @@
 #include "OniProperties.h"
 #include "Driver/OniDriverTypes.h"
 #include "OniRecorder.h"
+#include "OniFramePublisher.h"
 #include "XnLockGuard.h"
 
 //#include <math.h>
 #include <cmath>
 
 #define STREAM_DESTROY_THREAD_TIMEOUT			2000
+// Rows mapped to color coordinates by one thread at a time.
+#define DEPTH_TO_COLOR_ROWS_PER_BAND			16
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
+void StreamWaiter::streamReady(VideoStream* pStream)
+{
+	m_cs.Lock();
+	m_readyStreams.AddLast(pStream);
+	m_cs.Unlock();
+
+	xnOSSetEvent(m_hEvent);
+}
+
+void StreamWaiter::takeReadyStreams(xnl::Array<VideoStream*>& readyStreams)
+{
+	// Sizes are reset rather than cleared, to keep the allocated memory.
+	readyStreams.SetSize(0);
+	m_cs.Lock();
+	for (XnUInt32 i = 0; i < m_readyStreams.GetSize(); ++i)
+	{
+		readyStreams.AddLast(m_readyStreams[i]);
+	}
+	m_readyStreams.SetSize(0);
+	m_cs.Unlock();
+}
+
 VideoStream::VideoStream(Sensor* pSensor, const OniSensorInfo* pSensorInfo, Device& device, const DriverHandler& libraryHandler, FrameManager& frameManager, xnl::ErrorLogger& errorLogger) :
 	m_errorLogger(errorLogger),
 	m_pSensorInfo(NULL),
@@ -41,8 +66,13 @@ VideoStream::VideoStream(Sensor* pSensor, const OniSensorInfo* pSensorInfo, Devi
 	m_frameManager(frameManager),
 	m_pSensor(pSensor),
 	m_hNewFrameEvent(NULL),
-	m_started(FALSE)
+	m_started(FALSE),
+	m_frameQueueSize(1),
+	m_frameQueuePolicy(ONI_FRAME_QUEUE_POLICY_DROP_OLDEST),
+	m_conversionThreadCount(1),
+	m_newFrameRaisedTime(0)
 {
+	xnOSMemSet(&m_frameQueueStats, 0, sizeof(m_frameQueueStats));
 	xnOSCreateEvent(&m_newFrameInternalEvent, false);
 	xnOSCreateEvent(&m_newFrameInternalEventForFrameHolder, false);
 	xnOSCreateThread(newFrameThread, this, &m_newFrameThread);
@@ -74,6 +104,11 @@ VideoStream::~VideoStream()
 
 	m_device.clearStream(this);
 
+	if (m_latencyTracker.isEnabled())
+	{
+		m_pSensor->removeLatencyTrackingStream();
+	}
+
     // Detach all recorders from this stream.
     xnl::LockGuard< Recorders > guard(m_recorders);
     while (m_recorders.Begin() != m_recorders.End())
@@ -82,6 +117,14 @@ VideoStream::~VideoStream()
         m_recorders.Begin()->Value()->detachStream(*this);
     }
 
+	// Detach all publishers from this stream.
+	xnl::LockGuard<Publishers> publishersGuard(m_publishers);
+	while (m_publishers.Begin() != m_publishers.End())
+	{
+		// NOTE: detachStream removes the publisher from m_publishers.
+		m_publishers.Begin()->Value()->detachStream(*this);
+	}
+
 	// Try to close the thread properly, and forcibly terminate it if failed/timedout.
 	m_running = false;
 	xnOSSetEvent(m_newFrameInternalEvent);
@@ -192,6 +235,24 @@ void VideoStream::unlockFrame()
 
 OniStatus VideoStream::setProperty(int propertyId, const void* data, int dataSize)
 {
+	// Frame queue belongs to this stream only, so it can be changed at any time.
+	switch (propertyId)
+	{
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_SIZE:
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_POLICY:
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_STATS:
+		return setFrameQueueProperty(propertyId, data, dataSize);
+	case ONI_STREAM_PROPERTY_FRAME_POOL_SIZE:
+	case ONI_STREAM_PROPERTY_FRAME_POOL_LARGE_PAGES:
+	case ONI_STREAM_PROPERTY_FRAME_POOL_STATS:
+		return setFramePoolProperty(propertyId, data, dataSize);
+	case ONI_STREAM_PROPERTY_COORDINATE_CONVERSION_THREADS:
+		return setCoordinateConversionProperty(propertyId, data, dataSize);
+	case ONI_STREAM_PROPERTY_LATENCY_TRACKING:
+	case ONI_STREAM_PROPERTY_LATENCY_STATS:
+		return setLatencyProperty(propertyId, data, dataSize);
+	}
+
 	xnl::AutoCSLocker lock(m_pSensor->m_refCountCS);
 	// if this stream is open, and not just by me (multiple depth streams for example), don't allow any changes
 	int myOpenRefCount = m_started ? 1 : 0;
@@ -217,6 +278,23 @@ OniStatus VideoStream::setProperty(int propertyId, const void* data, int dataSiz
 }
 OniStatus VideoStream::getProperty(int propertyId, void* data, int* pDataSize)
 {
+	switch (propertyId)
+	{
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_SIZE:
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_POLICY:
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_STATS:
+		return getFrameQueueProperty(propertyId, data, pDataSize);
+	case ONI_STREAM_PROPERTY_FRAME_POOL_SIZE:
+	case ONI_STREAM_PROPERTY_FRAME_POOL_LARGE_PAGES:
+	case ONI_STREAM_PROPERTY_FRAME_POOL_STATS:
+		return getFramePoolProperty(propertyId, data, pDataSize);
+	case ONI_STREAM_PROPERTY_COORDINATE_CONVERSION_THREADS:
+		return getCoordinateConversionProperty(propertyId, data, pDataSize);
+	case ONI_STREAM_PROPERTY_LATENCY_TRACKING:
+	case ONI_STREAM_PROPERTY_LATENCY_STATS:
+		return getLatencyProperty(propertyId, data, pDataSize);
+	}
+
 	OniStatus rc = m_driverHandler.streamGetProperty(m_pSensor->streamHandle(), propertyId, data, pDataSize);
 	if (rc != ONI_STATUS_OK)
 	{
@@ -226,8 +304,239 @@ OniStatus VideoStream::getProperty(int propertyId, void* data, int* pDataSize)
 }
 OniBool VideoStream::isPropertySupported(int propertyId)
 {
+	switch (propertyId)
+	{
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_SIZE:
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_POLICY:
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_STATS:
+	case ONI_STREAM_PROPERTY_FRAME_POOL_SIZE:
+	case ONI_STREAM_PROPERTY_FRAME_POOL_LARGE_PAGES:
+	case ONI_STREAM_PROPERTY_FRAME_POOL_STATS:
+	case ONI_STREAM_PROPERTY_COORDINATE_CONVERSION_THREADS:
+	case ONI_STREAM_PROPERTY_LATENCY_TRACKING:
+	case ONI_STREAM_PROPERTY_LATENCY_STATS:
+		return TRUE;
+	}
+
 	return m_driverHandler.streamIsPropertySupported(m_pSensor->streamHandle(), propertyId);
 }
+OniStatus VideoStream::setFrameQueueProperty(int propertyId, const void* data, int dataSize)
+{
+	switch (propertyId)
+	{
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_SIZE:
+		if (dataSize != sizeof(int) || *(const int*)data < 1)
+		{
+			m_errorLogger.Append("Frame queue size must be a positive int\n");
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		// Excess frames are dropped when the next frame arrives.
+		m_frameQueueSize = *(const int*)data;
+		return ONI_STATUS_OK;
+
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_POLICY:
+		if (dataSize != sizeof(OniFrameQueuePolicy))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		switch (*(const OniFrameQueuePolicy*)data)
+		{
+		case ONI_FRAME_QUEUE_POLICY_DROP_OLDEST:
+		case ONI_FRAME_QUEUE_POLICY_DROP_NEWEST:
+			m_frameQueuePolicy = *(const OniFrameQueuePolicy*)data;
+			return ONI_STATUS_OK;
+		default:
+			m_errorLogger.Append("Unknown frame queue policy %d\n", *(const int*)data);
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+	default:
+		m_errorLogger.Append("Stream setProperty(%d) failed: property is read only\n", propertyId);
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+}
+
+OniStatus VideoStream::getFrameQueueProperty(int propertyId, void* data, int* pDataSize)
+{
+	switch (propertyId)
+	{
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_SIZE:
+		if (*pDataSize != sizeof(int))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		*(int*)data = (int)m_frameQueueSize;
+		return ONI_STATUS_OK;
+
+	case ONI_STREAM_PROPERTY_FRAME_QUEUE_POLICY:
+		if (*pDataSize != sizeof(OniFrameQueuePolicy))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		*(OniFrameQueuePolicy*)data = m_frameQueuePolicy;
+		return ONI_STATUS_OK;
+
+	default:
+		if (*pDataSize != sizeof(OniFrameQueueStats))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		lockFrame();
+		*(OniFrameQueueStats*)data = m_frameQueueStats;
+		unlockFrame();
+		return ONI_STATUS_OK;
+	}
+}
+
+OniStatus VideoStream::setFramePoolProperty(int propertyId, const void* data, int dataSize)
+{
+	switch (propertyId)
+	{
+	case ONI_STREAM_PROPERTY_FRAME_POOL_SIZE:
+		if (dataSize != sizeof(int))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		return m_pSensor->setFramePool(*(const int*)data, m_pSensor->getFramePoolLargePages(), getRequiredFrameSize());
+
+	case ONI_STREAM_PROPERTY_FRAME_POOL_LARGE_PAGES:
+		if (dataSize != sizeof(OniBool))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		return m_pSensor->setFramePool(m_pSensor->getFramePoolSize(), *(const OniBool*)data, getRequiredFrameSize());
+
+	default:
+		m_errorLogger.Append("Stream setProperty(%d) failed: property is read only\n", propertyId);
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+}
+
+OniStatus VideoStream::getFramePoolProperty(int propertyId, void* data, int* pDataSize)
+{
+	switch (propertyId)
+	{
+	case ONI_STREAM_PROPERTY_FRAME_POOL_SIZE:
+		if (*pDataSize != sizeof(int))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		*(int*)data = m_pSensor->getFramePoolSize();
+		return ONI_STATUS_OK;
+
+	case ONI_STREAM_PROPERTY_FRAME_POOL_LARGE_PAGES:
+		if (*pDataSize != sizeof(OniBool))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		*(OniBool*)data = m_pSensor->getFramePoolLargePages();
+		return ONI_STATUS_OK;
+
+	default:
+		if (*pDataSize != sizeof(OniFramePoolStats))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		m_pSensor->getFramePoolStats((OniFramePoolStats*)data);
+		return ONI_STATUS_OK;
+	}
+}
+
+OniStatus VideoStream::setCoordinateConversionProperty(int /*propertyId*/, const void* data, int dataSize)
+{
+	if (dataSize != sizeof(int) || *(const int*)data < 0)
+	{
+		m_errorLogger.Append("Coordinate conversion thread count must be a non-negative int\n");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	int threadCount = *(const int*)data;
+	XnUInt32 nThreads = threadCount;
+	if (nThreads == 0 && xnOSGetProcessorCount(&nThreads) != XN_STATUS_OK)
+	{
+		nThreads = 1;
+	}
+
+	xnl::AutoCSLocker lock(m_conversionThreadsCS);
+	m_conversionThreadPool.Destroy();
+	m_conversionThreadCount = threadCount;
+
+	// The calling thread converts rows too.
+	if (nThreads > 1 && m_conversionThreadPool.Create(nThreads - 1) != XN_STATUS_OK)
+	{
+		m_conversionThreadCount = 1;
+		m_errorLogger.Append("Failed to create coordinate conversion threads\n");
+		return ONI_STATUS_ERROR;
+	}
+
+	return ONI_STATUS_OK;
+}
+
+OniStatus VideoStream::getCoordinateConversionProperty(int /*propertyId*/, void* data, int* pDataSize)
+{
+	if (*pDataSize != sizeof(int))
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	xnl::AutoCSLocker lock(m_conversionThreadsCS);
+	*(int*)data = m_conversionThreadCount;
+	return ONI_STATUS_OK;
+}
+
+OniStatus VideoStream::setLatencyProperty(int propertyId, const void* data, int dataSize)
+{
+	if (propertyId != ONI_STREAM_PROPERTY_LATENCY_TRACKING)
+	{
+		m_errorLogger.Append("Stream setProperty(%d) failed: property is read only\n", propertyId);
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	if (dataSize != sizeof(OniBool))
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	OniBool enabled = (*(const OniBool*)data) ? TRUE : FALSE;
+	if (enabled != m_latencyTracker.isEnabled())
+	{
+		m_latencyTracker.setEnabled(enabled);
+		if (enabled)
+		{
+			m_callbackDispatchCS.Lock();
+			m_callbackDispatch.reset();
+			m_callbackDispatchCS.Unlock();
+			m_pSensor->addLatencyTrackingStream();
+		}
+		else
+		{
+			m_pSensor->removeLatencyTrackingStream();
+		}
+	}
+
+	return ONI_STATUS_OK;
+}
+
+OniStatus VideoStream::getLatencyProperty(int propertyId, void* data, int* pDataSize)
+{
+	if (propertyId == ONI_STREAM_PROPERTY_LATENCY_TRACKING)
+	{
+		if (*pDataSize != sizeof(OniBool))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		*(OniBool*)data = m_latencyTracker.isEnabled();
+		return ONI_STATUS_OK;
+	}
+
+	if (*pDataSize != sizeof(OniFrameLatencyStats))
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+	m_latencyTracker.getStats((OniFrameLatencyStats*)data);
+	return ONI_STATUS_OK;
+}
+
 void VideoStream::notifyAllProperties()
 {
 	m_driverHandler.streamNotifyAllProperties(m_pSensor->streamHandle());
@@ -244,7 +553,12 @@ OniBool VideoStream::isCommandSupported(int commandId)
 
 OniStatus VideoStream::readFrame(OniFrame** pFrame)
 {
-	return m_pFrameHolder->readFrame(this, pFrame);
+	OniStatus rc = m_pFrameHolder->readFrame(this, pFrame);
+	if (rc == ONI_STATUS_OK && *pFrame != NULL && m_latencyTracker.isEnabled())
+	{
+		m_latencyTracker.frameRead(*pFrame);
+	}
+	return rc;
 }
 
 OniStatus VideoStream::registerNewFrameCallback(OniGeneralCallback handler, void* pCookie, XnCallbackHandle* pHandle)
@@ -270,15 +584,32 @@ const OniSensorInfo* VideoStream::getSensorInfo() const
 void VideoStream::newFrameThreadMainloop()
 {
 	XnStatus rc = XN_STATUS_OK;
-	// Wait on frame
+	// Wait on frame. The event is auto-reset, so frames arriving while listeners are
+	// still busy are coalesced into a single pending notification (listeners read the
+	// latest frame from the frame holder anyway). This bounds the delivery backlog to
+	// one, and the thread always blocks between notifications, so no sleep is needed
+	// to let other threads run.
 	while (m_running)
 	{
 		rc = xnOSWaitEvent(m_newFrameInternalEvent, XN_WAIT_INFINITE);
 		if ((rc == XN_STATUS_OK) && m_running)
 		{
+			XnInt32 raisedTime = m_newFrameRaisedTime;
+			while (raisedTime != 0 && xnOSAtomicCompareExchange(&m_newFrameRaisedTime, 0, raisedTime) != raisedTime)
+			{
+				raisedTime = m_newFrameRaisedTime;
+			}
+
 			m_newFrameEvent.Raise();
-			// HACK: To avoid starvation of other threads.
-			xnOSSleep(1);
+
+			if (raisedTime != 0)
+			{
+				XnUInt64 now;
+				xnOSGetHighResTimeStamp(&now);
+				m_callbackDispatchCS.Lock();
+				m_callbackDispatch.add((XnUInt32)now - (XnUInt32)raisedTime);
+				m_callbackDispatchCS.Unlock();
+			}
 		}
 	}
 }
@@ -297,6 +628,18 @@ OniStatus VideoStream::removeRecorder(Recorder& aRecorder)
     return ONI_STATUS_OK;
 }
 
+void VideoStream::addPublisher(FramePublisher& publisher)
+{
+	xnl::LockGuard<Publishers> guard(m_publishers);
+	m_publishers[&publisher] = &publisher;
+}
+
+void VideoStream::removePublisher(FramePublisher& publisher)
+{
+	xnl::LockGuard<Publishers> guard(m_publishers);
+	m_publishers.Remove(&publisher);
+}
+
 XN_THREAD_PROC VideoStream::newFrameThread(XN_THREAD_PARAM pThreadParam)
 {
 	oni::implementation::VideoStream* pStream = (oni::implementation::VideoStream*)pThreadParam;
@@ -336,15 +679,84 @@ void ONI_CALLBACK_TYPE VideoStream::stream_NewFrame(OniFrame* pFrame, void* pCoo
         }
     }
 
+	{
+		// Publishers copy the frame, so they don't hold on to it either.
+		xnl::LockGuard<Publishers> guard(pStream->m_publishers);
+		for (Publishers::Iterator i = pStream->m_publishers.Begin(); i != pStream->m_publishers.End(); ++i)
+		{
+			i->Key()->publish(*pStream, *pFrame);
+		}
+	}
+
     // Process the frame.
     pStream->m_pFrameHolder->processNewFrame(pStream, pFrame);
 }
 
 void VideoStream::raiseNewFrameEvent()
 {
+	// Coalesced notifications are measured from the first one. A time whose low bits are 0 is
+	// taken as 1, as 0 means that nothing is pending.
+	if (m_latencyTracker.isEnabled() && m_newFrameRaisedTime == 0)
+	{
+		XnUInt64 now;
+		xnOSGetHighResTimeStamp(&now);
+		XnInt32 raisedTime = ((XnUInt32)now == 0) ? 1 : (XnInt32)now;
+		xnOSAtomicCompareExchange(&m_newFrameRaisedTime, raisedTime, 0);
+	}
+
 	xnOSSetEvent(m_newFrameInternalEvent);
 	xnOSSetEvent(m_newFrameInternalEventForFrameHolder);
-	m_newFrameCallback(m_newFrameCookie);
+
+	xnl::AutoCSLocker lock(m_waitersCS);
+	for (xnl::List<StreamWaiter*>::Iterator iter = m_waiters.Begin(); iter != m_waiters.End(); ++iter)
+	{
+		(*iter)->streamReady(this);
+	}
+}
+
+void VideoStream::getMetrics(OniStreamMetrics* pMetrics)
+{
+	xnOSMemSet(pMetrics, 0, sizeof(*pMetrics));
+
+	xnOSStrCopy(pMetrics->deviceUri, m_device.getInfo()->uri, sizeof(pMetrics->deviceUri));
+	pMetrics->sensorType = m_pSensorInfo->sensorType;
+	pMetrics->started = m_started;
+	pMetrics->frameQueue = m_frameQueueStats;
+	m_pSensor->getFramePoolStats(&pMetrics->framePool);
+
+	int dataSize = sizeof(pMetrics->driver);
+	if (m_driverHandler.streamIsPropertySupported(m_pSensor->streamHandle(), ONI_STREAM_PROPERTY_DRIVER_STATS) &&
+		m_driverHandler.streamGetProperty(m_pSensor->streamHandle(), ONI_STREAM_PROPERTY_DRIVER_STATS, &pMetrics->driver, &dataSize) == ONI_STATUS_OK)
+	{
+		pMetrics->hasDriverStats = TRUE;
+	}
+	else
+	{
+		xnOSMemSet(&pMetrics->driver, 0, sizeof(pMetrics->driver));
+	}
+
+	m_callbackDispatchCS.Lock();
+	m_callbackDispatch.getStats(&pMetrics->callbackDispatch);
+	m_callbackDispatchCS.Unlock();
+
+	m_latencyTracker.getStats(&pMetrics->latency);
+}
+
+void VideoStream::addWaiter(StreamWaiter* pWaiter)
+{
+	xnl::AutoCSLocker lock(m_waitersCS);
+	m_waiters.AddLast(pWaiter);
+}
+
+void VideoStream::removeWaiter(StreamWaiter* pWaiter)
+{
+	xnl::AutoCSLocker lock(m_waitersCS);
+	m_waiters.Remove(pWaiter);
+}
+
+void VideoStream::raiseNewFrameEventForFrameHolder()
+{
+	xnOSSetEvent(m_newFrameInternalEventForFrameHolder);
 }
 
 XnStatus VideoStream::waitForNewFrameEvent()
@@ -470,6 +882,34 @@ OniStatus VideoStream::convertWorldToDepthCoordinates(float worldX, float worldY
 	return ONI_STATUS_OK;
 }
 
+OniStatus VideoStream::convertDepthFrameToWorld(const OniFrame* pDepthFrame, float* pWorld, int worldBufferSize)
+{
+	if (m_pSensorInfo->sensorType != ONI_SENSOR_DEPTH)
+	{
+		m_errorLogger.Append("convertDepthFrameToWorld: Stream is not from DEPTH\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	if (pDepthFrame == NULL || pWorld == NULL || pDepthFrame->sensorType != ONI_SENSOR_DEPTH)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	if (worldBufferSize < 0 || (XnUInt64)worldBufferSize < (XnUInt64)pDepthFrame->width * pDepthFrame->height * 3 * sizeof(float))
+	{
+		m_errorLogger.Append("convertDepthFrameToWorld: buffer must hold 3 floats per pixel\n");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	xnl::AutoCSLocker lock(m_conversionThreadsCS);
+	OniStatus rc = m_depthToWorldConverter.convertFrame(*pDepthFrame, pWorld, m_conversionThreadPool);
+	if (rc != ONI_STATUS_OK)
+	{
+		m_errorLogger.Append("convertDepthFrameToWorld: unsupported frame\n");
+	}
+	return rc;
+}
+
 void VideoStream::refreshWorldConversionCache()
 {
 	if (m_pSensorInfo->sensorType != ONI_SENSOR_DEPTH)
@@ -495,6 +935,8 @@ void VideoStream::refreshWorldConversionCache()
 	m_worldConvertCache.halfResY = m_worldConvertCache.resolutionY / 2;
 	m_worldConvertCache.coeffX = m_worldConvertCache.resolutionX / m_worldConvertCache.xzFactor;
 	m_worldConvertCache.coeffY = m_worldConvertCache.resolutionY / m_worldConvertCache.yzFactor;
+
+	m_depthToWorldConverter.setFieldOfView(m_worldConvertCache.xzFactor, m_worldConvertCache.yzFactor);
 }
 
 OniStatus VideoStream::convertDepthToColorCoordinates(VideoStream* colorStream, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY)
@@ -513,6 +955,123 @@ OniStatus VideoStream::convertDepthToColorCoordinates(VideoStream* colorStream,
 	return m_driverHandler.convertDepthPointToColor(m_pSensor->streamHandle(), colorStream->m_pSensor->streamHandle(), depthX, depthY, depthZ, pColorX, pColorY);
 }
 
+struct VideoStream::DepthToColorJob
+{
+	VideoStream* pThis;
+	VideoStream* pColorStream;
+	const OniFrame* pDepthFrame;
+	int* pColorXY;
+	volatile OniStatus status;
+};
+
+OniStatus VideoStream::convertDepthFrameToColorCoordinates(VideoStream* colorStream, const OniFrame* pDepthFrame, int* pColorXY, int colorBufferSize)
+{
+	if (m_pSensorInfo->sensorType != ONI_SENSOR_DEPTH || colorStream->m_pSensorInfo->sensorType != ONI_SENSOR_COLOR)
+	{
+		m_errorLogger.Append("convertDepthFrameToColorCoordinates: Streams are from the wrong sensors (should be DEPTH and COLOR)\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	if (&m_device != &colorStream->m_device)
+	{
+		m_errorLogger.Append("convertDepthFrameToColorCoordinates: Streams are not from the same device\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	if (pDepthFrame == NULL || pColorXY == NULL || pDepthFrame->sensorType != ONI_SENSOR_DEPTH ||
+		pDepthFrame->width < 0 || pDepthFrame->height < 0 || pDepthFrame->stride < pDepthFrame->width * (int)sizeof(OniDepthPixel))
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	if (colorBufferSize < 0 || (XnUInt64)colorBufferSize < (XnUInt64)pDepthFrame->width * pDepthFrame->height * 2 * sizeof(int))
+	{
+		m_errorLogger.Append("convertDepthFrameToColorCoordinates: buffer must hold 2 ints per pixel\n");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	DepthToColorJob job;
+	job.pThis = this;
+	job.pColorStream = colorStream;
+	job.pDepthFrame = pDepthFrame;
+	job.pColorXY = pColorXY;
+	job.status = ONI_STATUS_OK;
+
+	xnl::AutoCSLocker lock(m_conversionThreadsCS);
+
+	// Let the driver set up anything the bands share, before they run.
+	job.status = m_driverHandler.prepareDepthFrameToColor(m_pSensor->streamHandle(), colorStream->m_pSensor->streamHandle(), pDepthFrame);
+	if (job.status == ONI_STATUS_NOT_SUPPORTED)
+	{
+		job.status = ONI_STATUS_OK;
+	}
+	else if (job.status != ONI_STATUS_OK)
+	{
+		m_errorLogger.Append("convertDepthFrameToColorCoordinates: driver failed to prepare the conversion\n");
+		return job.status;
+	}
+
+	XnUInt32 nBands = (pDepthFrame->height + DEPTH_TO_COLOR_ROWS_PER_BAND - 1) / DEPTH_TO_COLOR_ROWS_PER_BAND;
+	if (m_conversionThreadPool.GetThreadCount() == 0 || nBands <= 1)
+	{
+		job.status = convertDepthRowsToColorCoordinates(colorStream, pDepthFrame, 0, pDepthFrame->height, pColorXY);
+	}
+	else
+	{
+		m_conversionThreadPool.ParallelFor(nBands, convertDepthToColorBand, &job);
+	}
+
+	if (job.status != ONI_STATUS_OK)
+	{
+		m_errorLogger.Append("convertDepthFrameToColorCoordinates: driver failed to map the frame\n");
+	}
+	return job.status;
+}
+
+void XN_CALLBACK_TYPE VideoStream::convertDepthToColorBand(XnUInt32 band, void* pCookie)
+{
+	DepthToColorJob* pJob = (DepthToColorJob*)pCookie;
+	int firstRow = band * DEPTH_TO_COLOR_ROWS_PER_BAND;
+	int rowCount = XN_MIN(DEPTH_TO_COLOR_ROWS_PER_BAND, pJob->pDepthFrame->height - firstRow);
+	int* pColorXY = pJob->pColorXY + (XnSizeT)firstRow * pJob->pDepthFrame->width * 2;
+
+	OniStatus rc = pJob->pThis->convertDepthRowsToColorCoordinates(pJob->pColorStream, pJob->pDepthFrame, firstRow, rowCount, pColorXY);
+	if (rc != ONI_STATUS_OK)
+	{
+		pJob->status = rc;
+	}
+}
+
+OniStatus VideoStream::convertDepthRowsToColorCoordinates(VideoStream* colorStream, const OniFrame* pDepthFrame, int firstRow, int rowCount, int* pColorXY)
+{
+	void* depthHandle = m_pSensor->streamHandle();
+	void* colorHandle = colorStream->m_pSensor->streamHandle();
+
+	OniStatus rc = m_driverHandler.convertDepthFrameRowsToColor(depthHandle, colorHandle, pDepthFrame, firstRow, rowCount, pColorXY);
+	if (rc != ONI_STATUS_NOT_SUPPORTED)
+	{
+		return rc;
+	}
+
+	// Driver can only map single pixels.
+	int originX = pDepthFrame->croppingEnabled ? pDepthFrame->cropOriginX : 0;
+	int originY = pDepthFrame->croppingEnabled ? pDepthFrame->cropOriginY : 0;
+	for (int y = firstRow; y < firstRow + rowCount; ++y)
+	{
+		const OniDepthPixel* pDepth = (const OniDepthPixel*)((const XnUInt8*)pDepthFrame->data + (XnSizeT)y * pDepthFrame->stride);
+		for (int x = 0; x < pDepthFrame->width; ++x, pColorXY += 2)
+		{
+			if (pDepth[x] == 0 ||
+				m_driverHandler.convertDepthPointToColor(depthHandle, colorHandle, originX + x, originY + y, pDepth[x], &pColorXY[0], &pColorXY[1]) != ONI_STATUS_OK)
+			{
+				pColorXY[0] = pColorXY[1] = -1;
+			}
+		}
+	}
+
+	return ONI_STATUS_OK;
+}
+
 int VideoStream::getRequiredFrameSize()
 {
 	return m_driverHandler.streamGetRequiredFrameSize(m_pSensor->streamHandle());
@@ -26,16 +26,47 @@
 #include "OniFrameHolder.h"
 #include "OniFrameManager.h"
 #include "OniSensor.h"
+#include "OniDepthToWorldConverter.h"
+#include "OniLatencyTracker.h"
 #include "XnEvent.h"
 #include "XnErrorLogger.h"
 #include "XnHash.h"
 #include "XnLockable.h"
+#include "XnList.h"
+#include "XnArray.h"
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 class Device;
 class FrameHolder;
 class Recorder;
+class FramePublisher;
+class VideoStream;
+
+// Collects the streams that received a frame while a thread waits on them.
+// The waiter registers with each waited stream, and a stream that gets a new
+// frame adds itself to the waiter's ready set and wakes the waiting thread, so
+// the thread only needs to look at the streams that actually changed.
+class StreamWaiter
+{
+public:
+	StreamWaiter(XN_EVENT_HANDLE hEvent) : m_hEvent(hEvent) {}
+
+	XN_EVENT_HANDLE getEvent() const { return m_hEvent; }
+
+	// Called by a stream that has a new frame.
+	void streamReady(VideoStream* pStream);
+
+	// Move the streams that became ready since the last call to readyStreams.
+	void takeReadyStreams(xnl::Array<VideoStream*>& readyStreams);
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(StreamWaiter)
+
+	XN_EVENT_HANDLE m_hEvent;
+	xnl::CriticalSection m_cs;
+	xnl::Array<VideoStream*> m_readyStreams;
+};
 
 class VideoStream
 {
@@ -43,9 +74,9 @@ public:
 	VideoStream(Sensor* pSensor, const OniSensorInfo* pSensorInfo, Device& device, const DriverHandler& driverHandler, FrameManager& frameManager, xnl::ErrorLogger& errorLogger);
 	virtual ~VideoStream();
 
-	typedef void (XN_CALLBACK_TYPE* NewFrameFuncPtr)(void* pCookie);
-
-	void setNewFrameCallback(NewFrameFuncPtr callback, void* pCookie) { m_newFrameCallback = callback; m_newFrameCookie = pCookie; }
+	// Waiters are notified each time a new frame is available for reading.
+	void addWaiter(StreamWaiter* pWaiter);
+	void removeWaiter(StreamWaiter* pWaiter);
 
 	OniStatus start();
 	void stop();
@@ -77,11 +108,30 @@ public:
 	FrameHolder* getFrameHolder();
 
 	void raiseNewFrameEvent();
+	void raiseNewFrameEventForFrameHolder();
 	XnStatus waitForNewFrameEvent();
 
+	// Frame queue configuration and counters. Counters are updated by the frame holder, under its lock.
+	XnUInt32 getFrameQueueSize() const { return m_frameQueueSize; }
+	OniFrameQueuePolicy getFrameQueuePolicy() const { return m_frameQueuePolicy; }
+	OniFrameQueueStats& getFrameQueueStats() { return m_frameQueueStats; }
+
+	// Called by the frame holder right before a frame can be read.
+	void framePublished(OniFrame* pFrame)
+	{
+		if (m_latencyTracker.isEnabled())
+		{
+			stampFrame(pFrame, ONI_FRAME_STAGE_PUBLISHED);
+		}
+	}
+
     OniStatus addRecorder(Recorder& aRecorder);
     OniStatus removeRecorder(Recorder& aRecorder);
 
+	// Publishers get every frame of a started stream, see FramePublisher.
+	void addPublisher(FramePublisher& publisher);
+	void removePublisher(FramePublisher& publisher);
+
 	OniStatus setFrameBufferAllocator(OniFrameAllocBufferCallback alloc, OniFrameFreeBufferCallback free, void* pCookie);
 
 	OniStatus convertDepthToWorldCoordinates(float depthX, float depthY, float depthZ, float* pWorldX, float* pWorldY, float* pWorldZ);
@@ -107,10 +157,17 @@ public:
 	);
 	
 	OniStatus convertWorldToDepthCoordinates(float worldX, float worldY, float worldZ, float* pDepthX, float* pDepthY, float* pDepthZ);
+	// Converts every pixel of a depth frame of this stream. worldBufferSize is in bytes.
+	OniStatus convertDepthFrameToWorld(const OniFrame* pDepthFrame, float* pWorld, int worldBufferSize);
 	OniStatus convertDepthToColorCoordinates(VideoStream* colorStream, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY);
+	// Maps every pixel of a depth frame of this stream. colorBufferSize is in bytes.
+	OniStatus convertDepthFrameToColorCoordinates(VideoStream* colorStream, const OniFrame* pDepthFrame, int* pColorXY, int colorBufferSize);
 
 	int getRequiredFrameSize();
 
+	// Fills the counters of this stream, see oniGetMetrics.
+	void getMetrics(OniStreamMetrics* pMetrics);
+
 protected:
 	XN_EVENT_HANDLE m_newFrameInternalEvent;
 	XN_EVENT_HANDLE m_newFrameInternalEventForFrameHolder;
@@ -136,8 +193,8 @@ private:
 
 	void refreshWorldConversionCache();
 
-	NewFrameFuncPtr m_newFrameCallback;
-	void* m_newFrameCookie;
+	xnl::CriticalSection m_waitersCS;
+	xnl::List<StreamWaiter*> m_waiters;
 
 	Device& m_device;
 	const DriverHandler& m_driverHandler;
@@ -148,11 +205,32 @@ private:
 
 	OniBool m_started;
 
+	OniStatus setFrameQueueProperty(int propertyId, const void* data, int dataSize);
+	OniStatus getFrameQueueProperty(int propertyId, void* data, int* pDataSize);
+	OniStatus setFramePoolProperty(int propertyId, const void* data, int dataSize);
+	OniStatus getFramePoolProperty(int propertyId, void* data, int* pDataSize);
+	OniStatus setCoordinateConversionProperty(int propertyId, const void* data, int dataSize);
+	OniStatus getCoordinateConversionProperty(int propertyId, void* data, int* pDataSize);
+	OniStatus setLatencyProperty(int propertyId, const void* data, int dataSize);
+	OniStatus getLatencyProperty(int propertyId, void* data, int* pDataSize);
+
+	struct DepthToColorJob;
+	static void XN_CALLBACK_TYPE convertDepthToColorBand(XnUInt32 band, void* pCookie);
+	OniStatus convertDepthRowsToColorCoordinates(VideoStream* colorStream, const OniFrame* pDepthFrame, int firstRow, int rowCount, int* pColorXY);
+
+	// Kept here rather than in the frame holder, as holders are replaced when frame sync changes.
+	XnUInt32 m_frameQueueSize;
+	OniFrameQueuePolicy m_frameQueuePolicy;
+	OniFrameQueueStats m_frameQueueStats;
+
     // XnLib does not provide a set container. I decided to use this odd
     // Recorder* -> Recorder* map to mimic a set.
     typedef xnl::Lockable<xnl::Hash<Recorder*, Recorder*> > Recorders;
     Recorders m_recorders;
 
+	typedef xnl::Lockable<xnl::Hash<FramePublisher*, FramePublisher*> > Publishers;
+	Publishers m_publishers;
+
 	struct WorldConversionCache
 	{
 		float xzFactor;
@@ -164,6 +242,23 @@ private:
 		int halfResX;
 		int halfResY;
 	} m_worldConvertCache;
+
+	DepthToWorldConverter m_depthToWorldConverter;
+
+	// Helps the calling thread with whole frame conversions. Guarded by
+	// m_conversionThreadsCS, which is held for the whole conversion.
+	xnl::CriticalSection m_conversionThreadsCS;
+	xnl::ThreadPool m_conversionThreadPool;
+	int m_conversionThreadCount;
+
+	FrameLatencyTracker m_latencyTracker;
+
+	// Time from raiseNewFrameEvent() until the new frame callbacks returned, measured while latency
+	// tracking is on. m_newFrameRaisedTime holds the low 32 bits of the time (in microseconds) the
+	// pending notification was raised at, and is 0 while none is pending or measured.
+	volatile XnInt32 m_newFrameRaisedTime; // only modified through xnOSAtomic* functions
+	xnl::CriticalSection m_callbackDispatchCS; // guards m_callbackDispatch
+	LatencyHistogram m_callbackDispatch;
 };
 
 ONI_NAMESPACE_IMPLEMENTATION_END
@@ -24,13 +24,17 @@
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 StreamFrameHolder::StreamFrameHolder(FrameManager& frameManager, VideoStream* pStream) : 
-	FrameHolder(frameManager), m_pStream(pStream), m_pLastFrame(NULL)
+	FrameHolder(frameManager), m_pStream(pStream)
 {
 }
 
 StreamFrameHolder::~StreamFrameHolder()
 {
-	clear();
+	// The stream might already be gone, so don't touch its counters.
+	for (xnl::List<OniFrame*>::Iterator iter = m_frames.Begin(); iter != m_frames.End(); ++iter)
+	{
+		m_frameManager.release(*iter);
+	}
 }
 
 OniStatus StreamFrameHolder::readFrame(VideoStream* pStream, OniFrame** pFrame)
@@ -51,10 +55,21 @@ OniStatus StreamFrameHolder::readFrame(VideoStream* pStream, OniFrame** pFrame)
 	// If frame already exists, wait() will return immidiately.
 	m_pStream->waitForNewFrameEvent();
 
-	// Return the last frame and set it to NULL.
+	// Return the oldest frame and remove it from the queue.
 	lock();
-	*pFrame = m_pLastFrame;
-	m_pLastFrame = NULL;
+	*pFrame = NULL;
+	if (!m_frames.IsEmpty())
+	{
+		*pFrame = *m_frames.Begin();
+		m_frames.Remove(m_frames.Begin());
+		m_pStream->getFrameQueueStats().queuedFrames = m_frames.Size();
+
+		// More frames are waiting, so next read shouldn't block.
+		if (!m_frames.IsEmpty())
+		{
+			m_pStream->raiseNewFrameEventForFrameHolder();
+		}
+	}
 	unlock();
 
 	return ONI_STATUS_OK;
@@ -74,14 +89,39 @@ OniStatus StreamFrameHolder::processNewFrame(VideoStream* pStream, OniFrame* pFr
 		return ONI_STATUS_OK;
 	}
 
-	// Release the last stored frame and store received frame.
+	// Make room for the received frame (or drop it) and store it.
 	lock();
-	if (m_pLastFrame != NULL)
+	OniFrameQueueStats& stats = m_pStream->getFrameQueueStats();
+	XnUInt32 queueSize = m_pStream->getFrameQueueSize();
+	++stats.receivedFrames;
+
+	// Queue size might have been reduced since last frame.
+	while (m_frames.Size() > queueSize)
+	{
+		dropOldestFrame();
+	}
+
+	if (m_frames.Size() == queueSize)
+	{
+		if (queueSize > 1 && m_pStream->getFrameQueuePolicy() == ONI_FRAME_QUEUE_POLICY_DROP_NEWEST)
+		{
+			++stats.droppedFrames;
+			stats.queuedFrames = m_frames.Size();
+			unlock();
+			return ONI_STATUS_OK;
+		}
+
+		dropOldestFrame();
+	}
+
+	m_frameManager.addRef(pFrame);
+	m_pStream->framePublished(pFrame);
+	m_frames.AddLast(pFrame);
+	stats.queuedFrames = m_frames.Size();
+	if (stats.queuedFrames > stats.maxQueuedFrames)
 	{
-		m_frameManager.release(m_pLastFrame);
+		stats.maxQueuedFrames = stats.queuedFrames;
 	}
-	m_pLastFrame = pFrame;
-	m_frameManager.addRef(m_pLastFrame);
 	unlock();
 
 	// Raise the new frame event.
@@ -104,22 +144,30 @@ OniFrame* StreamFrameHolder::peekFrame(VideoStream* pStream)
 		return NULL;
 	}
 
-	return m_pLastFrame;
+	return m_frames.IsEmpty() ? NULL : *m_frames.Begin();
 }
 
 // Clear all the frame in the holder.
 void StreamFrameHolder::clear()
 {
-	// Release the last stored frame.
+	// Release all the stored frames.
 	lock();
-	if (m_pLastFrame != NULL)
+	for (xnl::List<OniFrame*>::Iterator iter = m_frames.Begin(); iter != m_frames.End(); ++iter)
 	{
-		m_frameManager.release(m_pLastFrame);
+		m_frameManager.release(*iter);
 	}
-	m_pLastFrame = NULL;
+	m_frames.Clear();
+	m_pStream->getFrameQueueStats().queuedFrames = 0;
 	unlock();
 }
 
+void StreamFrameHolder::dropOldestFrame()
+{
+	m_frameManager.release(*m_frames.Begin());
+	m_frames.Remove(m_frames.Begin());
+	++m_pStream->getFrameQueueStats().droppedFrames;
+}
+
 // Return list of streams which are members of the stream group.
 void StreamFrameHolder::getStreams(VideoStream** ppStreams, int* pNumStreams)
 {
@@ -23,11 +23,16 @@
 
 #include "OniCommon.h"
 #include "OniFrameHolder.h"
+#include "XnList.h"
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 class VideoStream;
 
+// Holds the unread frames of a single stream. By default only the latest frame
+// is kept. When the stream's frame queue size is larger, frames are queued
+// (by reference) and read in order, dropping frames according to the stream's
+// frame queue policy once the queue is full.
 class StreamFrameHolder : public FrameHolder
 {
 public:
@@ -61,9 +66,12 @@ public:
 
 private:
 
+	// Release the oldest queued frame. Must be called under lock.
+	void dropOldestFrame();
+
 	VideoStream* m_pStream;
 
-	OniFrame* m_pLastFrame;
+	xnl::List<OniFrame*> m_frames;
 };
 
 ONI_NAMESPACE_IMPLEMENTATION_END
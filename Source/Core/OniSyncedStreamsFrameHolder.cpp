@@ -144,6 +144,10 @@ OniStatus SyncedStreamsFrameHolder::readFrame(VideoStream* pStream, OniFrame** p
 			// Replace synced frame with last frame.
 			m_FrameSyncedStreams[i].pSyncedFrame = m_FrameSyncedStreams[i].pLastFrame;
 			m_FrameSyncedStreams[i].pLastFrame = NULL;
+			if (m_FrameSyncedStreams[i].pSyncedFrame != NULL)
+			{
+				m_FrameSyncedStreams[i].pStream->framePublished(m_FrameSyncedStreams[i].pSyncedFrame);
+			}
 		}
 
 		// Send the raise event to all streams.
@@ -228,6 +232,10 @@ OniStatus SyncedStreamsFrameHolder::processNewFrame(VideoStream* pStream, OniFra
 			// Replace synced frame with last frame.
 			m_FrameSyncedStreams[i].pSyncedFrame = m_FrameSyncedStreams[i].pLastFrame;
 			m_FrameSyncedStreams[i].pLastFrame = NULL;
+			if (m_FrameSyncedStreams[i].pSyncedFrame != NULL)
+			{
+				m_FrameSyncedStreams[i].pStream->framePublished(m_FrameSyncedStreams[i].pSyncedFrame);
+			}
 		}
 
 		// Send the raise event to all streams.
@@ -0,0 +1,371 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniTimestampSyncedStreamsFrameHolder.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+// Constructor.
+TimestampSyncedStreamsFrameHolder::TimestampSyncedStreamsFrameHolder(FrameManager& frameManager, VideoStream** ppStreams, int numStreams, const OniFrameSyncConfig& config) :
+	FrameHolder(frameManager), m_config(config), m_streams(numStreams), m_numReaders(0)
+{
+	lock();
+
+	for (int i = 0; i < numStreams; ++i)
+	{
+		TimestampSyncedStream* pSyncedStream = XN_NEW(TimestampSyncedStream);
+		pSyncedStream->pStream = ppStreams[i];
+		pSyncedStream->enabled = ppStreams[i]->isStarted();
+		pSyncedStream->pSyncedFrame = NULL;
+		m_streams.AddLast(pSyncedStream);
+	}
+
+	unlock();
+}
+
+// Destructor.
+TimestampSyncedStreamsFrameHolder::~TimestampSyncedStreamsFrameHolder()
+{
+	setEnabled(FALSE);
+
+	// Readers blocked on one of our streams must leave before we go away.
+	lock();
+	while (m_numReaders != 0)
+	{
+		wakeReaders();
+		unlock();
+		xnOSSleep(1);
+		lock();
+	}
+	unlock();
+
+	clear();
+
+	for (XnUInt32 i = 0; i < m_streams.GetSize(); ++i)
+	{
+		XN_DELETE(m_streams[i]);
+	}
+}
+
+// Get the next frame belonging to a stream.
+OniStatus TimestampSyncedStreamsFrameHolder::readFrame(VideoStream* pStream, OniFrame** pFrame)
+{
+	*pFrame = NULL;
+
+	TimestampSyncedStream* pSyncedStream = findStream(pStream);
+	if (pSyncedStream == NULL)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	lock();
+	++m_numReaders;
+
+	// Wait for the next matched set. Disabling the stream or the holder wakes us up.
+	while (m_enabled && pSyncedStream->enabled && pSyncedStream->pSyncedFrame == NULL)
+	{
+		unlock();
+		pStream->waitForNewFrameEvent();
+		lock();
+	}
+
+	OniStatus rc = ONI_STATUS_ERROR;
+	if (m_enabled && pSyncedStream->enabled)
+	{
+		*pFrame = pSyncedStream->pSyncedFrame;
+		pSyncedStream->pSyncedFrame = NULL;
+		rc = ONI_STATUS_OK;
+	}
+
+	--m_numReaders;
+	unlock();
+
+	return rc;
+}
+
+// Process a newly received frame.
+OniStatus TimestampSyncedStreamsFrameHolder::processNewFrame(VideoStream* pStream, OniFrame* pFrame)
+{
+	// Make sure frame holder is enabled.
+	if (!m_enabled)
+	{
+		return ONI_STATUS_OK;
+	}
+
+	TimestampSyncedStream* pSyncedStream = findStream(pStream);
+	if (pSyncedStream == NULL)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	lock();
+
+	if (pSyncedStream->enabled)
+	{
+		m_frameManager.addRef(pFrame);
+		pSyncedStream->pendingFrames.AddLast(pFrame);
+
+		// Keep the buffer bounded.
+		while (pSyncedStream->pendingFrames.Size() > (XnUInt32)m_config.maxBufferedFrames)
+		{
+			dropFrame(pSyncedStream);
+		}
+
+		matchFrames();
+	}
+
+	unlock();
+
+	return ONI_STATUS_OK;
+}
+
+// Peek at next frame.
+OniFrame* TimestampSyncedStreamsFrameHolder::peekFrame(VideoStream* pStream)
+{
+	// Make sure frame holder is enabled.
+	if (!m_enabled)
+	{
+		return NULL;
+	}
+
+	TimestampSyncedStream* pSyncedStream = findStream(pStream);
+	if (pSyncedStream == NULL)
+	{
+		return NULL;
+	}
+
+	lock();
+	OniFrame* pRetVal = pSyncedStream->pSyncedFrame;
+	unlock();
+
+	return pRetVal;
+}
+
+// Clear all the frame in the holder.
+void TimestampSyncedStreamsFrameHolder::clear()
+{
+	lock();
+
+	for (XnUInt32 i = 0; i < m_streams.GetSize(); ++i)
+	{
+		releaseFrames(m_streams[i]);
+	}
+
+	unlock();
+}
+
+// Set whether stream is enabled.
+void TimestampSyncedStreamsFrameHolder::setStreamEnabled(VideoStream* pStream, OniBool enabled)
+{
+	TimestampSyncedStream* pSyncedStream = findStream(pStream);
+	if (pSyncedStream == NULL)
+	{
+		return;
+	}
+
+	lock();
+
+	pSyncedStream->enabled = enabled;
+	if (!enabled)
+	{
+		releaseFrames(pSyncedStream);
+
+		// The others might have been waiting for this stream only.
+		matchFrames();
+
+		// A reader of this stream will never get a set anymore.
+		pSyncedStream->pStream->raiseNewFrameEventForFrameHolder();
+	}
+
+	unlock();
+}
+
+// Set whether frame holder is enabled.
+void TimestampSyncedStreamsFrameHolder::setEnabled(OniBool enabled)
+{
+	lock();
+
+	m_enabled = enabled;
+	if (!enabled)
+	{
+		wakeReaders();
+	}
+
+	unlock();
+}
+
+// Return list of streams which are members of the stream group.
+void TimestampSyncedStreamsFrameHolder::getStreams(VideoStream** ppStreams, int* pNumStreams)
+{
+	int numStreams = m_streams.GetSize();
+	*pNumStreams = (*pNumStreams > numStreams) ? numStreams : *pNumStreams;
+	for (int i = 0; i < *pNumStreams; ++i)
+	{
+		ppStreams[i] = m_streams[i]->pStream;
+	}
+}
+
+// Return number of streams which are members of the stream group.
+int TimestampSyncedStreamsFrameHolder::getNumStreams()
+{
+	return m_streams.GetSize();
+}
+
+TimestampSyncedStreamsFrameHolder::TimestampSyncedStream* TimestampSyncedStreamsFrameHolder::findStream(VideoStream* pStream)
+{
+	for (XnUInt32 i = 0; i < m_streams.GetSize(); ++i)
+	{
+		if (m_streams[i]->pStream == pStream)
+		{
+			return m_streams[i];
+		}
+	}
+
+	return NULL;
+}
+
+void TimestampSyncedStreamsFrameHolder::matchFrames()
+{
+	XnUInt32 numStreams = m_streams.GetSize();
+
+	for (;;)
+	{
+		// Look at the oldest pending frame of each stream.
+		XnUInt32 numEnabled = 0;
+		XnUInt32 numWithFrames = 0;
+		OniBool bufferFull = FALSE;
+		XnUInt64 oldestTimestamp = XN_MAX_UINT64;
+		XnUInt64 latestTimestamp = 0;
+		for (XnUInt32 i = 0; i < numStreams; ++i)
+		{
+			TimestampSyncedStream* pSyncedStream = m_streams[i];
+			if (!pSyncedStream->enabled)
+			{
+				continue;
+			}
+
+			++numEnabled;
+			if (pSyncedStream->pendingFrames.IsEmpty())
+			{
+				continue;
+			}
+
+			++numWithFrames;
+			XnUInt64 timestamp = (*pSyncedStream->pendingFrames.Begin())->timestamp;
+			oldestTimestamp = XN_MIN(oldestTimestamp, timestamp);
+			latestTimestamp = XN_MAX(latestTimestamp, timestamp);
+			if (pSyncedStream->pendingFrames.Size() >= (XnUInt32)m_config.maxBufferedFrames)
+			{
+				bufferFull = TRUE;
+			}
+		}
+
+		if (numWithFrames == 0)
+		{
+			return;
+		}
+
+		XnUInt64 windowEnd;
+		if (numWithFrames < numEnabled)
+		{
+			// Some stream has no frame yet. Unless it is given up on, wait for it.
+			if (m_config.policy != ONI_FRAME_SYNC_POLICY_SKIP_STRAGGLERS || !bufferFull)
+			{
+				return;
+			}
+
+			// Deliver whatever matches the oldest frame, without the stragglers.
+			windowEnd = oldestTimestamp + m_config.tolerance;
+		}
+		else if (latestTimestamp - oldestTimestamp > m_config.tolerance)
+		{
+			// Frames too old to match the latest one will never be part of a set.
+			for (XnUInt32 i = 0; i < numStreams; ++i)
+			{
+				TimestampSyncedStream* pSyncedStream = m_streams[i];
+				while (pSyncedStream->enabled && !pSyncedStream->pendingFrames.IsEmpty() &&
+					(*pSyncedStream->pendingFrames.Begin())->timestamp + m_config.tolerance < latestTimestamp)
+				{
+					dropFrame(pSyncedStream);
+				}
+			}
+			continue;
+		}
+		else
+		{
+			windowEnd = latestTimestamp;
+		}
+
+		// 'Latch' the matched frames and let their streams know.
+		for (XnUInt32 i = 0; i < numStreams; ++i)
+		{
+			TimestampSyncedStream* pSyncedStream = m_streams[i];
+			if (pSyncedStream->enabled && !pSyncedStream->pendingFrames.IsEmpty() &&
+				(*pSyncedStream->pendingFrames.Begin())->timestamp <= windowEnd)
+			{
+				latchFrame(pSyncedStream);
+				pSyncedStream->pStream->raiseNewFrameEvent();
+			}
+		}
+	}
+}
+
+void TimestampSyncedStreamsFrameHolder::latchFrame(TimestampSyncedStream* pSyncedStream)
+{
+	// A set which was not read yet is replaced.
+	if (pSyncedStream->pSyncedFrame != NULL)
+	{
+		m_frameManager.release(pSyncedStream->pSyncedFrame);
+	}
+
+	pSyncedStream->pSyncedFrame = *pSyncedStream->pendingFrames.Begin();
+	pSyncedStream->pendingFrames.Remove(pSyncedStream->pendingFrames.Begin());
+	pSyncedStream->pStream->framePublished(pSyncedStream->pSyncedFrame);
+}
+
+void TimestampSyncedStreamsFrameHolder::dropFrame(TimestampSyncedStream* pSyncedStream)
+{
+	m_frameManager.release(*pSyncedStream->pendingFrames.Begin());
+	pSyncedStream->pendingFrames.Remove(pSyncedStream->pendingFrames.Begin());
+}
+
+void TimestampSyncedStreamsFrameHolder::wakeReaders()
+{
+	for (XnUInt32 i = 0; i < m_streams.GetSize(); ++i)
+	{
+		m_streams[i]->pStream->raiseNewFrameEventForFrameHolder();
+	}
+}
+
+void TimestampSyncedStreamsFrameHolder::releaseFrames(TimestampSyncedStream* pSyncedStream)
+{
+	while (!pSyncedStream->pendingFrames.IsEmpty())
+	{
+		dropFrame(pSyncedStream);
+	}
+
+	if (pSyncedStream->pSyncedFrame != NULL)
+	{
+		m_frameManager.release(pSyncedStream->pSyncedFrame);
+		pSyncedStream->pSyncedFrame = NULL;
+	}
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
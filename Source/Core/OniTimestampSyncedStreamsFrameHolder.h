@@ -0,0 +1,114 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_IMPL_TIMESTAMP_SYNCED_STREAMS_FRAME_HOLDER_H_
+#define _ONI_IMPL_TIMESTAMP_SYNCED_STREAMS_FRAME_HOLDER_H_
+
+#include "OniCommon.h"
+#include "OniFrameHolder.h"
+#include "OniStream.h"
+#include "XnArray.h"
+#include "XnList.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+// Synchronizes streams by matching frames whose timestamps are within a
+// tolerance of each other. Unlike SyncedStreamsFrameHolder, which needs the
+// driver to give synced frames the same frame index, this works for streams
+// of different devices and drivers.
+class TimestampSyncedStreamsFrameHolder : public FrameHolder
+{
+public:
+
+	// Constructor.
+	TimestampSyncedStreamsFrameHolder(FrameManager& frameManager, VideoStream** ppStreams, int numStreams, const OniFrameSyncConfig& config);
+
+	// Destructor.
+	virtual ~TimestampSyncedStreamsFrameHolder();
+
+	// Get the next frame belonging to a stream.
+	virtual OniStatus readFrame(VideoStream* pStream, OniFrame** pFrame);
+
+	// Process a newly received frame.
+	virtual OniStatus processNewFrame(VideoStream* pStream, OniFrame* pFrame);
+
+	// Peek at next frame.
+	virtual OniFrame* peekFrame(VideoStream* pStream);
+
+	// Clear all the frame in the holder.
+	virtual void clear();
+
+	// Set whether stream is enabled.
+	virtual void setStreamEnabled(VideoStream* pStream, OniBool enabled);
+
+	// Set whether frame holder is enabled.
+	virtual void setEnabled(OniBool enabled);
+
+	// Return list of streams which are members of the stream group.
+	virtual void getStreams(VideoStream** ppStreams, int* pNumStreams);
+
+	// Return number of streams which are members of the stream group.
+	virtual int getNumStreams();
+
+private:
+
+	typedef struct
+	{
+		// Pointer to stream.
+		VideoStream* pStream;
+
+		// Flag indicating stream is enabled.
+		OniBool enabled;
+
+		// Received frames which were not matched yet, oldest first.
+		xnl::List<OniFrame*> pendingFrames;
+
+		// Frame of the last matched set, until it is read.
+		OniFrame* pSyncedFrame;
+
+	} TimestampSyncedStream;
+
+	TimestampSyncedStream* findStream(VideoStream* pStream);
+
+	// Deliver all the frame sets that can be matched. Must be called under lock.
+	void matchFrames();
+
+	// Move the oldest pending frame of a stream to be its synced frame.
+	void latchFrame(TimestampSyncedStream* pSyncedStream);
+
+	// Release the oldest pending frame of a stream.
+	void dropFrame(TimestampSyncedStream* pSyncedStream);
+
+	// Release all the frames of a stream.
+	void releaseFrames(TimestampSyncedStream* pSyncedStream);
+
+	// Wake up the readers blocked in readFrame(), so they can see they should give up.
+	void wakeReaders();
+
+	OniFrameSyncConfig m_config;
+	xnl::Array<TimestampSyncedStream*> m_streams;
+
+	// Number of threads inside readFrame(). Changed under lock.
+	int m_numReaders;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // _ONI_IMPL_TIMESTAMP_SYNCED_STREAMS_FRAME_HOLDER_H_
@@ -0,0 +1,214 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniWriteBehindFile.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+// Buffers are page aligned, so the OS can hand them to the disk directly.
+#define WRITE_BEHIND_FILE_BUFFER_ALIGNMENT 4096
+
+WriteBehindFile::WriteBehindFile()
+        : m_file(XN_INVALID_FILE_HANDLE),
+          m_pBuffer(NULL),
+          m_bufferSize(0),
+          m_bufferOffset(0),
+          m_bufferUsed(0),
+          m_position(0),
+          m_filePosition(0),
+          m_syncInterval(0),
+          m_bytesSinceSync(0)
+{
+}
+
+WriteBehindFile::~WriteBehindFile()
+{
+    close();
+    xnOSFreeAligned(m_pBuffer);
+}
+
+XnStatus WriteBehindFile::open(const XnChar* fileName, XnUInt32 flags)
+{
+    XnStatus nRetVal = close();
+    XN_IS_STATUS_OK(nRetVal);
+
+    nRetVal = xnOSOpenFile(fileName, flags, &m_file);
+    XN_IS_STATUS_OK(nRetVal);
+
+    m_bufferOffset = 0;
+    m_bufferUsed = 0;
+    m_position = 0;
+    m_filePosition = 0;
+    m_bytesSinceSync = 0;
+
+    return (XN_STATUS_OK);
+}
+
+XnStatus WriteBehindFile::close()
+{
+    if (!isOpen())
+    {
+        return (XN_STATUS_OK);
+    }
+
+    XnStatus nRetVal = flush();
+    xnOSCloseFile(&m_file);
+    m_file = XN_INVALID_FILE_HANDLE;
+
+    return (nRetVal);
+}
+
+XnStatus WriteBehindFile::setBufferSize(XnUInt32 bufferSize)
+{
+    if (bufferSize == m_bufferSize)
+    {
+        return (XN_STATUS_OK);
+    }
+
+    XnStatus nRetVal = flush();
+    XN_IS_STATUS_OK(nRetVal);
+
+    XnUInt8* pBuffer = NULL;
+    if (bufferSize != 0)
+    {
+        pBuffer = (XnUInt8*)xnOSMallocAligned(bufferSize, WRITE_BEHIND_FILE_BUFFER_ALIGNMENT);
+        XN_VALIDATE_ALLOC_PTR(pBuffer);
+    }
+
+    xnOSFreeAligned(m_pBuffer);
+    m_pBuffer = pBuffer;
+    m_bufferSize = bufferSize;
+
+    return (XN_STATUS_OK);
+}
+
+XnStatus WriteBehindFile::write(const void* pData, XnUInt32 dataSize)
+{
+    XnStatus nRetVal = XN_STATUS_OK;
+
+    if (!isOpen())
+    {
+        return (XN_STATUS_OS_INVALID_FILE);
+    }
+
+    if (dataSize > m_bufferSize)
+    {
+        // not worth buffering. Flush first, as the buffer may overlap the data.
+        nRetVal = flush();
+        XN_IS_STATUS_OK(nRetVal);
+
+        nRetVal = writeToFile(m_position, pData, dataSize);
+        XN_IS_STATUS_OK(nRetVal);
+
+        m_position += dataSize;
+        return (XN_STATUS_OK);
+    }
+
+    // the buffer can only be extended at its end
+    if (m_bufferUsed != 0 && (m_position < m_bufferOffset || m_position > m_bufferOffset + m_bufferUsed))
+    {
+        nRetVal = flush();
+        XN_IS_STATUS_OK(nRetVal);
+    }
+
+    if (m_bufferUsed != 0 && m_position + dataSize > m_bufferOffset + m_bufferSize)
+    {
+        nRetVal = flush();
+        XN_IS_STATUS_OK(nRetVal);
+    }
+
+    if (m_bufferUsed == 0)
+    {
+        m_bufferOffset = m_position;
+    }
+
+    XnUInt32 nStart = (XnUInt32)(m_position - m_bufferOffset);
+    xnOSMemCopy(m_pBuffer + nStart, pData, dataSize);
+    m_bufferUsed = XN_MAX(m_bufferUsed, nStart + dataSize);
+    m_position += dataSize;
+
+    return (XN_STATUS_OK);
+}
+
+XnStatus WriteBehindFile::truncate()
+{
+    // buffered data past the current position is dropped
+    if (m_bufferUsed != 0 && m_position < m_bufferOffset + m_bufferUsed)
+    {
+        m_bufferUsed = (m_position > m_bufferOffset) ? (XnUInt32)(m_position - m_bufferOffset) : 0;
+    }
+
+    XnStatus nRetVal = flush();
+    XN_IS_STATUS_OK(nRetVal);
+
+    nRetVal = xnOSTruncateFile64(m_file, m_position);
+    m_filePosition = XN_MAX_UINT64;
+
+    return (nRetVal);
+}
+
+XnStatus WriteBehindFile::flush()
+{
+    if (m_bufferUsed == 0)
+    {
+        return (XN_STATUS_OK);
+    }
+
+    XnStatus nRetVal = writeToFile(m_bufferOffset, m_pBuffer, m_bufferUsed);
+    m_bufferUsed = 0;
+
+    return (nRetVal);
+}
+
+XnStatus WriteBehindFile::writeToFile(XnUInt64 offset, const void* pData, XnUInt32 dataSize)
+{
+    XnStatus nRetVal = XN_STATUS_OK;
+
+    if (offset != m_filePosition)
+    {
+        nRetVal = xnOSSeekFile64(m_file, XN_OS_SEEK_SET, offset);
+        if (nRetVal != XN_STATUS_OK)
+        {
+            m_filePosition = XN_MAX_UINT64;
+            return (nRetVal);
+        }
+        m_filePosition = offset;
+    }
+
+    nRetVal = xnOSWriteFile(m_file, pData, dataSize);
+    if (nRetVal != XN_STATUS_OK)
+    {
+        m_filePosition = XN_MAX_UINT64;
+        return (nRetVal);
+    }
+    m_filePosition += dataSize;
+
+    m_bytesSinceSync += dataSize;
+    if (m_syncInterval != 0 && m_bytesSinceSync >= m_syncInterval)
+    {
+        m_bytesSinceSync = 0;
+        nRetVal = xnOSFlushFile(m_file);
+        XN_IS_STATUS_OK(nRetVal);
+    }
+
+    return (XN_STATUS_OK);
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
@@ -0,0 +1,103 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_IMPL_WRITE_BEHIND_FILE_H_
+#define _ONI_IMPL_WRITE_BEHIND_FILE_H_ 1
+
+#include "XnOS.h"
+
+#include "OniCommon.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+/**
+ * A file that is written through a large memory buffer.
+ *
+ * Sequential writes are collected in the buffer and handed to the OS in big
+ * chunks. The file position is tracked in memory, so telling and seeking cost
+ * nothing; seeking back into the buffered range (e.g. to undo a record) does
+ * not even touch the file. The OS file pointer is only moved when data has to
+ * be written somewhere else (e.g. when patching a header).
+ */
+class WriteBehindFile
+{
+public:
+    WriteBehindFile();
+
+    /// Flushes and closes the file.
+    ~WriteBehindFile();
+
+    /// Opens the file for writing, starting at its beginning.
+    XnStatus open(const XnChar* fileName, XnUInt32 flags);
+
+    /// Flushes and closes the file.
+    XnStatus close();
+
+    XnBool isOpen() const { return m_file != XN_INVALID_FILE_HANDLE; }
+
+    /// Flushes the buffer and replaces it with one of the given size. 0 disables buffering.
+    XnStatus setBufferSize(XnUInt32 bufferSize);
+
+    XnUInt32 getBufferSize() const { return m_bufferSize; }
+
+    /// Makes the OS flush the file to disk every syncInterval written bytes. 0 never does.
+    void setSyncInterval(XnUInt64 syncInterval) { m_syncInterval = syncInterval; }
+
+    XnUInt64 getSyncInterval() const { return m_syncInterval; }
+
+    /// Writes data at the current position.
+    XnStatus write(const void* pData, XnUInt32 dataSize);
+
+    /// Moves the current position.
+    void seek(XnUInt64 position) { m_position = position; }
+
+    /// Returns the current position.
+    XnUInt64 tell() const { return m_position; }
+
+    /// Truncates the file at the current position.
+    XnStatus truncate();
+
+    /// Hands all buffered data to the OS.
+    XnStatus flush();
+
+private:
+    WriteBehindFile(const WriteBehindFile&);
+    WriteBehindFile& operator=(const WriteBehindFile&);
+
+    XnStatus writeToFile(XnUInt64 offset, const void* pData, XnUInt32 dataSize);
+
+    XN_FILE_HANDLE m_file;
+
+    // The buffer holds a single range of the file, starting at m_bufferOffset.
+    XnUInt8*       m_pBuffer;
+    XnUInt32       m_bufferSize;
+    XnUInt64       m_bufferOffset;
+    XnUInt32       m_bufferUsed;
+
+    XnUInt64       m_position;      //< The position of the next write.
+    XnUInt64       m_filePosition;  //< The OS file pointer, XN_MAX_UINT64 if unknown.
+
+    XnUInt64       m_syncInterval;
+    XnUInt64       m_bytesSinceSync;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // _ONI_IMPL_WRITE_BEHIND_FILE_H_
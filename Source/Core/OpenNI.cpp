@@ -102,6 +102,18 @@ ONI_C_API const char* oniGetExtendedError()
 	return g_Context.getExtendedError();
 }
 
+ONI_C_API OniStatus oniCreateFrameSync(OniStreamHandle* pStreams, int numStreams, const OniFrameSyncConfig* pConfig, OniFrameSyncHandle* pFrameSync)
+{
+	g_Context.clearErrorLogger();
+	return g_Context.createFrameSync(pStreams, numStreams, pConfig, pFrameSync);
+}
+
+ONI_C_API void oniDestroyFrameSync(OniFrameSyncHandle frameSync)
+{
+	g_Context.clearErrorLogger();
+	g_Context.disableFrameSync(frameSync);
+}
+
 ONI_C_API OniVersion oniGetVersion()
 {
 	g_Context.clearErrorLogger();
@@ -424,12 +436,92 @@ ONI_C_API void oniRecorderStop(OniRecorderHandle recorder)
     recorder->pRecorder->stop();
 }
 
+ONI_C_API OniStatus oniRecorderSetProperty(OniRecorderHandle recorder, int propertyId, const void* data, int dataSize)
+{
+	g_Context.clearErrorLogger();
+    // Validate parameters.
+    if (NULL == recorder || NULL == recorder->pRecorder)
+    {
+        return ONI_STATUS_BAD_PARAMETER;
+    }
+    return recorder->pRecorder->setProperty(propertyId, data, dataSize);
+}
+
+ONI_C_API OniStatus oniRecorderGetProperty(OniRecorderHandle recorder, int propertyId, void* data, int* pDataSize)
+{
+	g_Context.clearErrorLogger();
+    // Validate parameters.
+    if (NULL == recorder || NULL == recorder->pRecorder)
+    {
+        return ONI_STATUS_BAD_PARAMETER;
+    }
+    return recorder->pRecorder->getProperty(propertyId, data, pDataSize);
+}
+
 ONI_C_API OniStatus oniRecorderDestroy(OniRecorderHandle* pRecorder)
 {
 	g_Context.clearErrorLogger();
     return g_Context.recorderClose(pRecorder);
 }
 
+// Frame publisher
+//////////////////////////////////////////////////////////////////////////
+
+ONI_C_API OniStatus oniCreateFramePublisher(const char* name, OniFramePublisherHandle* pPublisher)
+{
+	g_Context.clearErrorLogger();
+	return g_Context.framePublisherOpen(name, pPublisher);
+}
+
+ONI_C_API OniStatus oniFramePublisherAttachStream(OniFramePublisherHandle publisher, OniStreamHandle stream, int numSlots)
+{
+	g_Context.clearErrorLogger();
+	if (NULL == publisher || NULL == publisher->pPublisher ||
+		NULL == stream || NULL == stream->pStream)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+	return publisher->pPublisher->attachStream(*stream->pStream, numSlots);
+}
+
+ONI_C_API OniStatus oniFramePublisherStart(OniFramePublisherHandle publisher)
+{
+	g_Context.clearErrorLogger();
+	if (NULL == publisher || NULL == publisher->pPublisher)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+	return publisher->pPublisher->start();
+}
+
+ONI_C_API OniStatus oniFramePublisherDestroy(OniFramePublisherHandle* pPublisher)
+{
+	g_Context.clearErrorLogger();
+	return g_Context.framePublisherClose(pPublisher);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Metrics
+//////////////////////////////////////////////////////////////////////////
+
+ONI_C_API OniStatus oniGetMetrics(OniMetrics* pMetrics)
+{
+	g_Context.clearErrorLogger();
+	return g_Context.getMetrics(pMetrics);
+}
+
+ONI_C_API void oniReleaseMetrics(OniMetrics* pMetrics)
+{
+	g_Context.clearErrorLogger();
+	g_Context.releaseMetrics(pMetrics);
+}
+
+ONI_C_API OniStatus oniSetMetricsDump(const char* fileName, int intervalMs)
+{
+	g_Context.clearErrorLogger();
+	return g_Context.setMetricsDump(fileName, intervalMs);
+}
+
 ONI_C_API void oniWriteLogEntry(const char* mask, int severity, const char* message)
 {
 	xnLogWrite(mask, (XnLogSeverity)severity, "External", 0, message);
@@ -502,6 +594,12 @@ ONI_C_API OniStatus oniCoordinateConverterDepthToWorld(OniStreamHandle depthStre
 	return depthStream->pStream->convertDepthToWorldCoordinates(depthX, depthY, depthZ, pWorldX, pWorldY, pWorldZ);
 }
 
+ONI_C_API OniStatus oniCoordinateConverterDepthFrameToWorld(OniStreamHandle depthStream, const OniFrame* pDepthFrame, float* pWorld, int worldBufferSize)
+{
+	g_Context.clearErrorLogger();
+	return depthStream->pStream->convertDepthFrameToWorld(pDepthFrame, pWorld, worldBufferSize);
+}
+
 ONI_C_API OniStatus oniCoordinateConverterWorldToDepth(OniStreamHandle depthStream, float worldX, float worldY, float worldZ, float* pDepthX, float* pDepthY, float* pDepthZ)
 {
 	g_Context.clearErrorLogger();
@@ -532,4 +630,10 @@ ONI_C_API OniStatus oniCoordinateConverterDepthToColor(OniStreamHandle depthStre
 	return depthStream->pStream->convertDepthToColorCoordinates(colorStream->pStream, depthX, depthY, depthZ, pColorX, pColorY);
 }
 
+ONI_C_API OniStatus oniCoordinateConverterDepthFrameToColor(OniStreamHandle depthStream, OniStreamHandle colorStream, const OniFrame* pDepthFrame, int* pColorXY, int colorBufferSize)
+{
+	g_Context.clearErrorLogger();
+	return depthStream->pStream->convertDepthFrameToColorCoordinates(colorStream->pStream, pDepthFrame, pColorXY, colorBufferSize);
+}
+
 XN_API_EXPORT_INIT()
\ No newline at end of file
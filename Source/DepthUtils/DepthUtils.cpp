@@ -46,6 +46,14 @@ XN_C_API XnStatus DepthUtilsTranslateDepthMap(DepthUtilsHandle handle, unsigned
 	}
 	return handle->pDepthUtils->Apply(depth);
 }
+XN_C_API XnStatus DepthUtilsTranslateDepthRect(DepthUtilsHandle handle, const unsigned short* depth, unsigned int stride, unsigned int x, unsigned int y, unsigned int width, unsigned int height, int* pXY)
+{
+	if (handle == NULL || handle->pDepthUtils == NULL)
+	{
+		return XN_STATUS_BAD_PARAM;
+	}
+	return handle->pDepthUtils->TranslateDepthRect(depth, stride, x, y, width, height, pXY);
+}
 
 XN_C_API XnStatus DepthUtilsSetDepthConfiguration(DepthUtilsHandle handle, int xres, int yres, OniPixelFormat format, int isMirrored)
 {
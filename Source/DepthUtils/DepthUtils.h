@@ -89,6 +89,7 @@ extern "C"
 
 	int DepthUtilsTranslatePixel(DepthUtilsHandle handle, unsigned int x, unsigned int y, unsigned short z, unsigned int* pX, unsigned int* pY);
 	int DepthUtilsTranslateDepthMap(DepthUtilsHandle handle, unsigned short* depthMap);
+	int DepthUtilsTranslateDepthRect(DepthUtilsHandle handle, const unsigned short* depth, unsigned int stride, unsigned int x, unsigned int y, unsigned int width, unsigned int height, int* pXY);
 
 	int DepthUtilsSetDepthConfiguration(DepthUtilsHandle handle, int xres, int yres, OniPixelFormat format, int isMirrored);
 	int DepthUtilsSetColorResolution(DepthUtilsHandle handle, int xres, int yres);
@@ -22,8 +22,12 @@ static void incrementalFitting50(XnInt64 dPrev, XnInt64 ddPrev, XnInt64 dddPrev,
 
 
 DepthUtilsImpl::DepthUtilsImpl() : m_pDepthToShiftTable_QQVGA(NULL), m_pDepthToShiftTable_QVGA(NULL), m_pDepthToShiftTable_VGA(NULL),
-									m_pRegistrationTable_QQVGA(NULL), m_pRegistrationTable_QVGA(NULL), m_pRegistrationTable_VGA(NULL), m_bD2SAlloc(false), m_bInitialized(FALSE)
+									m_pRegistrationTable_QQVGA(NULL), m_pRegistrationTable_QVGA(NULL), m_pRegistrationTable_VGA(NULL), m_bD2SAlloc(false), m_bInitialized(FALSE),
+									m_isMirrored(false), m_pImageXBySum(NULL), m_nImageXBySumSize(0), m_pImageYByRegY(NULL), m_nImageYByRegYSize(0), m_bImageTablesValid(false),
+									m_pApplyInput(NULL), m_nApplyPixels(0)
 {
+	m_depthResolution.x = m_depthResolution.y = 0;
+	m_colorResolution.x = m_colorResolution.y = 0;
 }
 DepthUtilsImpl::~DepthUtilsImpl()
 {
@@ -71,6 +75,9 @@ XnStatus DepthUtilsImpl::Free()
 {
 	m_bInitialized = FALSE;
 
+	FreeImageTables();
+	FreeApplyBuffers();
+
 	if (m_pRegistrationTable_QQVGA != NULL)
 	{
 		xnOSFreeAligned(m_pRegistrationTable_QQVGA);
@@ -112,79 +119,94 @@ XnStatus DepthUtilsImpl::Free()
 	return (XN_STATUS_OK);
 }
 
-XnStatus DepthUtilsImpl::Apply(unsigned short* pOutput)
+// Writes a registered pixel through the z-buffer, along with its left/upper neighbors
+static inline void WriteRegisteredPixel(unsigned short* pOutput, XnUInt32 nDepthXRes, XnUInt32 nArrPos, XnBool bHasLeft, XnBool bHasUp, unsigned short nValue)
 {
-	unsigned short* pTempBuffer;
-	pTempBuffer = (unsigned short*)xnOSCallocAligned(m_depthResolution.x*m_depthResolution.y, sizeof(unsigned short), XN_DEFAULT_MEM_ALIGN);
+	unsigned short nOutValue = pOutput[nArrPos];
 
-	unsigned short* pInput = pTempBuffer;
-	memcpy(pInput, pOutput, m_depthResolution.x*m_depthResolution.y*2);
+	if ((nOutValue == 0) || (nOutValue > nValue))
+	{
+		if (bHasLeft && bHasUp)
+		{
+			pOutput[nArrPos-nDepthXRes] = nValue;
+			pOutput[nArrPos-nDepthXRes-1] = nValue;
+			pOutput[nArrPos-1] = nValue;
+		}
+		else if (bHasUp)
+		{
+			pOutput[nArrPos-nDepthXRes] = nValue;
+		}
+		else if (bHasLeft)
+		{
+			pOutput[nArrPos-1] = nValue;
+		}
 
+		pOutput[nArrPos] = nValue;
+	}
+}
+
+XnStatus DepthUtilsImpl::Apply(unsigned short* pOutput)
+{
+	xnl::AutoCSLocker lock(m_applyCS);
 
-	XnInt16* pRegTable = (XnInt16*)m_pRegTable;
-	XnInt16* pRGBRegDepthToShiftTable = (XnInt16*)m_pDepth2ShiftTable; 
-	unsigned short nValue = 0;
-	unsigned short nOutValue = 0;
-	XnUInt32 nNewX = 0;
-	XnUInt32 nNewY = 0;
-	XnUInt32 nArrPos = 0;
 	XnUInt32 nDepthXRes = m_depthResolution.x;
 	XnUInt32 nDepthYRes = m_depthResolution.y;
 
-	memset(pOutput, 0, nDepthXRes*nDepthYRes*sizeof(unsigned short));
+	if (m_nApplyPixels == 0 || m_nApplyPixels != nDepthXRes * nDepthYRes)
+	{
+		return XN_STATUS_ALLOC_FAILED;
+	}
 
-	XnBool bMirror = m_isMirrored;
+	// registration is done in place, so keep a copy of the input
+	xnOSMemCopy(m_pApplyInput, pOutput, m_nApplyPixels*sizeof(unsigned short));
 
-	XnUInt32 nLinesShift = m_pPadInfo->nCroppingLines - m_pPadInfo->nStartLines;
+	xnOSMemSet(pOutput, 0, m_nApplyPixels*sizeof(unsigned short));
+
+	if (m_isMirrored)
+	{
+		Register<true>(pOutput);
+	}
+	else
+	{
+		Register<false>(pOutput);
+	}
+
+	return XN_STATUS_OK;
+}
+
+template <bool bMirror>
+void DepthUtilsImpl::Register(unsigned short* pOutput)
+{
+	const XnInt16* pRGBRegDepthToShiftTable = (const XnInt16*)m_pDepth2ShiftTable;
+	const XnUInt32 nDepthXRes = m_depthResolution.x;
+	const XnUInt32 nDepthYRes = m_depthResolution.y;
+	const XnUInt32 nXScale = m_blob.params1080.rgbRegXValScale;
+	const XnUInt32 nLinesShift = m_pPadInfo->nCroppingLines - m_pPadInfo->nStartLines;
 
 	for (XnUInt32 y = 0; y < nDepthYRes; ++y)
 	{
-		pRegTable = (XnInt16*)&m_pRegTable[ bMirror ? ((y+1) * nDepthXRes - 1) * 2 : y * nDepthXRes * 2 ];
-		for (XnUInt32 x = 0; x < nDepthXRes; ++x)
+		const XnInt16* pRegTable = (const XnInt16*)&m_pRegTable[bMirror ? ((y+1) * nDepthXRes - 1) * 2 : y * nDepthXRes * 2];
+		const unsigned short* pInput = m_pApplyInput + y * nDepthXRes;
+
+		for (XnUInt32 x = 0; x < nDepthXRes; ++x, pRegTable += bMirror ? -2 : 2)
 		{
-			nValue = *pInput;
+			unsigned short nValue = pInput[x];
 
 			if (nValue != 0)
 			{
-				nNewX = (XnUInt32)(*pRegTable + pRGBRegDepthToShiftTable[nValue]) / m_blob.params1080.rgbRegXValScale;
-				nNewY = *(pRegTable+1);
+				XnUInt32 nNewX = (XnUInt32)(pRegTable[0] + pRGBRegDepthToShiftTable[nValue]) / nXScale;
+				XnUInt32 nNewY = (XnUInt16)pRegTable[1];
 
 				if (nNewX < nDepthXRes && nNewY > nLinesShift)
 				{
 					nNewY -= nLinesShift;
-					nArrPos = bMirror ? (nNewY+1)*nDepthXRes - nNewX - 1 : (nNewY*nDepthXRes) + nNewX;
-
-					nOutValue = pOutput[nArrPos];
-
-					if ((nOutValue == 0) || (nOutValue > nValue))
-					{
-						if ( nNewX > 0 && nNewY > 0 )
-						{
-							pOutput[nArrPos-nDepthXRes] = nValue;
-							pOutput[nArrPos-nDepthXRes-1] = nValue;
-							pOutput[nArrPos-1] = nValue;
-						}
-						else if( nNewY > 0 )
-						{
-							pOutput[nArrPos-nDepthXRes] = nValue;
-						}
-						else if( nNewX > 0 )
-						{
-							pOutput[nArrPos-1] = nValue;
-						}
-
-						pOutput[nArrPos] = nValue;
-					}
+					XnUInt32 nArrPos = bMirror ? (nNewY+1)*nDepthXRes - nNewX - 1 : (nNewY*nDepthXRes) + nNewX;
+
+					WriteRegisteredPixel(pOutput, nDepthXRes, nArrPos, nNewX > 0, nNewY > 0, nValue);
 				}
 			}
-
-			pInput++;
-			bMirror ? pRegTable-=2 : pRegTable+=2;
 		}
 	}
-	xnOSFreeAligned(pTempBuffer);
-
-	return XN_STATUS_OK;
 }
 
 XnStatus DepthUtilsImpl::SetDepthConfiguration(int xres, int yres, OniPixelFormat /*format*/, bool isMirrored)
@@ -219,14 +241,25 @@ XnStatus DepthUtilsImpl::SetDepthConfiguration(int xres, int yres, OniPixelForma
 	m_depthResolution.x = xres;
 	m_depthResolution.y = yres;
 
+	AllocateApplyBuffers();
+	BuildImageTables();
+
 	return XN_STATUS_OK;
 }
 
 XnStatus DepthUtilsImpl::SetColorResolution(int xres, int yres)
 {
+	// called before every translation, so only rebuild on change
+	if (m_colorResolution.x == xres && m_colorResolution.y == yres)
+	{
+		return XN_STATUS_OK;
+	}
+
 	m_colorResolution.x = xres;
 	m_colorResolution.y = yres;
 
+	BuildImageTables();
+
 	return XN_STATUS_OK;
 }
 
@@ -243,8 +276,6 @@ XnStatus DepthUtilsImpl::TranslateSinglePixel(XnUInt32 x, XnUInt32 y, unsigned s
 	XnUInt32 nNewX = 0;
 	XnUInt32 nNewY = 0;
 
-	XnUInt32 nLinesShift = m_pPadInfo->nCroppingLines - m_pPadInfo->nStartLines;
-
 	if (z == 0)
 	{
 		return XN_STATUS_BAD_PARAM;
@@ -252,17 +283,40 @@ XnStatus DepthUtilsImpl::TranslateSinglePixel(XnUInt32 x, XnUInt32 y, unsigned s
 
 	nNewX = (XnUInt32)(*pRegTable + pRGBRegDepthToShiftTable[z]) / m_blob.params1080.rgbRegXValScale;
 	nNewY = *(pRegTable+1);
-	if (nNewX >= nDepthXRes || nNewY < nLinesShift)
+	if (nNewX >= nDepthXRes)
 	{
 		return XN_STATUS_BAD_PARAM;
 	}
 
-	imageX = bMirror ? (nDepthXRes - nNewX - 1) : nNewX;
-	imageY = nNewY - nLinesShift;
+	if (!DepthXToImageX(nNewX, imageX) || !DepthYToImageY(nNewY, imageY))
+	{
+		return XN_STATUS_BAD_PARAM;
+	}
+
+	return XN_STATUS_OK;
+}
 
-	/////////////////////////////////////
+XnBool DepthUtilsImpl::DepthXToImageX(XnUInt32 nNewX, XnUInt32& imageX)
+{
+	imageX = m_isMirrored ? (m_depthResolution.x - nNewX - 1) : nNewX;
 
+	// inflate to full res
 	XnDouble fullXRes = m_colorResolution.x;
+	imageX = (XnUInt32)(fullXRes / m_depthResolution.x * imageX);
+
+	return TRUE;
+}
+
+XnBool DepthUtilsImpl::DepthYToImageY(XnUInt32 nNewY, XnUInt32& imageY)
+{
+	XnUInt32 nLinesShift = m_pPadInfo->nCroppingLines - m_pPadInfo->nStartLines;
+	if (nNewY < nLinesShift)
+	{
+		return FALSE;
+	}
+
+	imageY = nNewY - nLinesShift;
+
 	XnDouble fullYRes;
 	XnBool bCrop = FALSE;
 
@@ -278,7 +332,6 @@ XnStatus DepthUtilsImpl::TranslateSinglePixel(XnUInt32 x, XnUInt32 y, unsigned s
 	}
 
 	// inflate to full res
-	imageX = (XnUInt32)(fullXRes / m_depthResolution.x * imageX);
 	imageY = (XnUInt32)(fullYRes / m_depthResolution.y * imageY);
 
 	if (bCrop)
@@ -287,7 +340,148 @@ XnStatus DepthUtilsImpl::TranslateSinglePixel(XnUInt32 x, XnUInt32 y, unsigned s
 		imageY -= (XnUInt32)(fullYRes - m_colorResolution.y)/2;
 		if (imageY > (XnUInt32)m_colorResolution.y)
 		{
-			return XN_STATUS_BAD_PARAM;
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+void DepthUtilsImpl::BuildImageTables()
+{
+	m_bImageTablesValid = false;
+
+	if (!m_bInitialized || m_depthResolution.x == 0 || m_colorResolution.x <= 0 || m_colorResolution.y <= 0)
+	{
+		return;
+	}
+
+	// every X the registration table can lead to, before the division by the scale
+	XnUInt32 nXScale = m_blob.params1080.rgbRegXValScale;
+	XnUInt32 nSumSize = m_depthResolution.x * nXScale;
+	// the registration table keeps Y in [1, yres]
+	XnUInt32 nRegYSize = m_depthResolution.y + 1;
+
+	if (nSumSize != m_nImageXBySumSize || nRegYSize != m_nImageYByRegYSize)
+	{
+		FreeImageTables();
+		m_pImageXBySum = (XnInt16*)xnOSMallocAligned(nSumSize * sizeof(XnInt16), XN_DEFAULT_MEM_ALIGN);
+		m_pImageYByRegY = (XnInt16*)xnOSMallocAligned(nRegYSize * sizeof(XnInt16), XN_DEFAULT_MEM_ALIGN);
+		if (m_pImageXBySum == NULL || m_pImageYByRegY == NULL)
+		{
+			FreeImageTables();
+			return;
+		}
+		m_nImageXBySumSize = nSumSize;
+		m_nImageYByRegYSize = nRegYSize;
+	}
+
+	XnUInt32 imageX;
+	for (XnUInt32 nSum = 0; nSum < nSumSize; ++nSum)
+	{
+		m_pImageXBySum[nSum] = DepthXToImageX(nSum / nXScale, imageX) ? (XnInt16)imageX : -1;
+	}
+
+	XnUInt32 imageY;
+	for (XnUInt32 nRegY = 0; nRegY < nRegYSize; ++nRegY)
+	{
+		m_pImageYByRegY[nRegY] = DepthYToImageY(nRegY, imageY) ? (XnInt16)imageY : -1;
+	}
+
+	m_bImageTablesValid = true;
+}
+
+void DepthUtilsImpl::FreeImageTables()
+{
+	m_bImageTablesValid = false;
+
+	if (m_pImageXBySum != NULL)
+	{
+		xnOSFreeAligned(m_pImageXBySum);
+		m_pImageXBySum = NULL;
+	}
+	if (m_pImageYByRegY != NULL)
+	{
+		xnOSFreeAligned(m_pImageYByRegY);
+		m_pImageYByRegY = NULL;
+	}
+	m_nImageXBySumSize = 0;
+	m_nImageYByRegYSize = 0;
+}
+
+void DepthUtilsImpl::AllocateApplyBuffers()
+{
+	xnl::AutoCSLocker lock(m_applyCS);
+
+	XnUInt32 nPixels = m_depthResolution.x * m_depthResolution.y;
+	if (nPixels == m_nApplyPixels)
+	{
+		return;
+	}
+
+	FreeApplyBuffers();
+
+	m_pApplyInput = (unsigned short*)xnOSMallocAligned(nPixels * sizeof(unsigned short), XN_DEFAULT_MEM_ALIGN);
+	if (m_pApplyInput == NULL)
+	{
+		return;
+	}
+
+	m_nApplyPixels = nPixels;
+}
+
+void DepthUtilsImpl::FreeApplyBuffers()
+{
+	if (m_pApplyInput != NULL)
+	{
+		xnOSFreeAligned(m_pApplyInput);
+		m_pApplyInput = NULL;
+	}
+	m_nApplyPixels = 0;
+}
+
+XnStatus DepthUtilsImpl::TranslateDepthRect(const unsigned short* pDepth, XnUInt32 nStride, XnUInt32 x, XnUInt32 y, XnUInt32 width, XnUInt32 height, int* pImageXY)
+{
+	XnUInt32 nDepthXRes = m_depthResolution.x;
+	XnUInt32 nDepthYRes = m_depthResolution.y;
+
+	if (!m_bImageTablesValid || x + width > nDepthXRes || y + height > nDepthYRes || nStride < width * sizeof(unsigned short))
+	{
+		return XN_STATUS_BAD_PARAM;
+	}
+
+	// Same as TranslateSinglePixel(), with the division, bound checks, mirroring and scaling to the
+	// image resolution folded into the image tables.
+	const XnInt16* pRGBRegDepthToShiftTable = (const XnInt16*)m_pDepth2ShiftTable;
+	const XnInt16* pImageXBySum = m_pImageXBySum;
+	const XnInt16* pImageYByRegY = m_pImageYByRegY;
+	const XnUInt32 nSumSize = m_nImageXBySumSize;
+	const XnUInt32 nRegYSize = m_nImageYByRegYSize;
+	const XnBool bMirror = m_isMirrored;
+	const XnInt32 nRegStep = bMirror ? -2 : 2;
+
+	for (XnUInt32 nRow = 0; nRow < height; ++nRow)
+	{
+		const unsigned short* pDepthRow = (const unsigned short*)((const XnUInt8*)pDepth + nRow * nStride);
+		XnUInt32 nDepthY = y + nRow;
+		const XnInt16* pRegTable = (const XnInt16*)&m_pRegTable[bMirror ? ((nDepthY+1)*nDepthXRes - x - 1) * 2 : (nDepthY*nDepthXRes + x) * 2];
+
+		for (XnUInt32 nCol = 0; nCol < width; ++nCol, pRegTable += nRegStep, pImageXY += 2)
+		{
+			unsigned short z = pDepthRow[nCol];
+			XnUInt32 nSum = (XnUInt32)(pRegTable[0] + pRGBRegDepthToShiftTable[z]);
+			XnUInt32 nRegY = (XnUInt16)pRegTable[1];
+
+			XnInt32 imageY = (nRegY < nRegYSize) ? pImageYByRegY[nRegY] : -1;
+			if (z == 0 || nSum >= nSumSize || imageY < 0)
+			{
+				pImageXY[0] = pImageXY[1] = -1;
+			}
+			else
+			{
+				pImageXY[0] = pImageXBySum[nSum];
+				pImageXY[1] = imageY;
+			}
 		}
 	}
 
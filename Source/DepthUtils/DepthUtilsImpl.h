@@ -2,6 +2,7 @@
 #define _DEPTH_UTILS_IMPL_H_
 
 #include <XnLib.h>
+#include <XnOSCpp.h>
 #include "DepthUtils.h"
 
 #define MAX_Z 65535
@@ -22,7 +23,21 @@ public:
 	XnStatus SetColorResolution(int xres, int yres);
 
 	XnStatus TranslateSinglePixel(XnUInt32 x, XnUInt32 y, unsigned short z, XnUInt32& imageX, XnUInt32& imageY);
+
+	// Translates width x height pixels starting at (x, y). Writes an (x, y) pair per pixel, or (-1, -1) where
+	// TranslateSinglePixel() fails. Safe to call concurrently as long as the configuration doesn't change.
+	XnStatus TranslateDepthRect(const unsigned short* pDepth, XnUInt32 nStride, XnUInt32 x, XnUInt32 y, XnUInt32 width, XnUInt32 height, int* pImageXY);
 private:
+	XnBool DepthXToImageX(XnUInt32 nNewX, XnUInt32& imageX);
+	XnBool DepthYToImageY(XnUInt32 nNewY, XnUInt32& imageY);
+	void BuildImageTables();
+	void FreeImageTables();
+	void AllocateApplyBuffers();
+	void FreeApplyBuffers();
+
+	// Registers the copy of the input into pOutput, which must be zeroed
+	template <bool bMirror> void Register(unsigned short* pOutput);
+
 	void BuildDepthToShiftTable(XnUInt16* pRGBRegDepthToShiftTable, int xres);
 	XnStatus BuildRegistrationTable(XnUInt16* pRegTable, RegistrationInfo* pRegInfo, XnUInt16** pDepthToShiftTable, int xres, int yres);
 
@@ -71,6 +86,22 @@ private:
 		int x, y;
 	} m_depthResolution, m_colorResolution;
 
+	// For TranslateDepthRect(), built whenever the configuration changes. m_pImageXBySum is indexed by the
+	// registration X plus the shift of the depth (before dividing by rgbRegXValScale), m_pImageYByRegY by the
+	// registration Y. Both hold -1 where the pixel has no image coordinate.
+	XnInt16* m_pImageXBySum;
+	XnUInt32 m_nImageXBySumSize;
+	XnInt16* m_pImageYByRegY;
+	XnUInt32 m_nImageYByRegYSize;
+	bool m_bImageTablesValid;
+
+	// For Apply(), a copy of the input, kept across frames and reallocated only when the depth resolution changes
+	unsigned short* m_pApplyInput;
+	XnUInt32 m_nApplyPixels;
+
+	// Apply() uses the buffer above, which may be replaced from another thread.
+	xnl::CriticalSection m_applyCS;
+
 };
 
 
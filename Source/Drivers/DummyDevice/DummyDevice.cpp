@@ -30,6 +30,8 @@
 class OzStream : public oni::driver::StreamBase
 {
 public:
+	OzStream() : m_running(false), m_threadHandle(NULL) {}
+
 	~OzStream()
 	{
 		stop();
@@ -37,6 +39,7 @@ public:
 
 	OniStatus start()
 	{
+		m_running = true;
 		xnOSCreateThread(threadFunc, this, &m_threadHandle);
 
 		return ONI_STATUS_OK;
@@ -45,6 +48,12 @@ public:
 	void stop()
 	{
 		m_running = false;
+
+		// the thread still uses this stream and its services until it exits
+		if (m_threadHandle != NULL)
+		{
+			xnOSWaitAndTerminateThread(&m_threadHandle, XN_WAIT_INFINITE);
+		}
 	}
 
 	virtual OniStatus SetVideoMode(OniVideoMode*) = 0;
@@ -86,7 +95,6 @@ protected:
 	static XN_THREAD_PROC threadFunc(XN_THREAD_PARAM pThreadParam)
 	{
 		OzStream* pStream = (OzStream*)pThreadParam;
-		pStream->m_running = true;
 		pStream->Mainloop();
 
 		XN_THREAD_PROC_RETURN(XN_STATUS_OK);
@@ -95,7 +103,7 @@ protected:
 
 	int singleRes(int x, int y) {return y*OZ_RESOLUTION_X+x;}
 
-	bool m_running;
+	volatile bool m_running;
 
 	XN_THREAD_HANDLE m_threadHandle;
 };
@@ -31,6 +31,7 @@
 #include "Formats/XnCodec.h"
 #include "PlayerCodecFactory.h"
 #include "PS1080.h"
+#include <XnLog.h>
 
 namespace oni_file {
 
@@ -42,6 +43,7 @@ namespace driver = oni::driver;
 #define XN_PLAYBACK_SPEED_SANITY_SLEEP				2000
 #define XN_PLAYBACK_SPEED_FASTEST					0.0
 #define XN_PLAYBACK_SPEED_MANUAL					(-1.0)
+#define DECODED_FRAME_MAX_SIZE						(256 * 1024 * 1024)
 
 #ifndef ARRAYSIZE
 #define ARRAYSIZE(a)								(sizeof(a)/sizeof((a)[0]))
@@ -91,9 +93,10 @@ static PS1080Property PS1080PropertyList[] =
 };
 
 PlayerDevice::PlayerDevice(const xnl::String& filePath) : 
-	m_filePath(filePath), m_fileHandle(0), m_threadHandle(NULL), m_running(FALSE), m_isSeeking(FALSE),
+	m_filePath(filePath), m_fileHandle(0), m_pFileMapping(NULL), m_threadHandle(NULL), m_running(FALSE), m_isSeeking(FALSE),
 	m_dPlaybackSpeed(1.0), m_nStartTimestamp(0), m_nStartTime(0), m_bHasTimeReference(FALSE), 
-	m_bRepeat(TRUE), m_player(filePath.Data()), m_driverEOFCallback(NULL), m_driverCookie(NULL)
+	m_bRepeat(TRUE), m_player(filePath.Data()), m_driverEOFCallback(NULL), m_driverCookie(NULL),
+	m_maxPendingJobs(0)
 {
 	// Create the events.
 	m_readyForDataInternalEvent.Create(FALSE);
@@ -118,6 +121,7 @@ OniStatus PlayerDevice::Initialize()
 		OnNodeGeneralPropChanged,
 		OnNodeStateReady,
 		OnNodeNewData,
+		OnNodeNewCompressedData,
 	};
 	static XnPlayerInputStreamInterface inputInterface = 
 	{
@@ -128,6 +132,7 @@ OniStatus PlayerDevice::Initialize()
 		FileClose,
 		FileSeek64,
 		FileTell64,
+		FileGetData,
 	};
 	static PlayerNode::CodecFactory codecFactory = 
 	{
@@ -171,6 +176,10 @@ OniStatus PlayerDevice::Initialize()
 		return ONI_STATUS_ERROR;
 	}
 
+	// Create the decode workers. The player thread reads ahead up to two frames per worker.
+	m_decodeWorkers.Create();
+	m_maxPendingJobs = XN_MAX(1, 2 * m_decodeWorkers.GetThreadCount());
+
 	// Create thread for running the player.
 	XnStatus status = xnOSCreateThread(ThreadProc, this, &m_threadHandle);
 	if (status != XN_STATUS_OK)
@@ -197,6 +206,19 @@ void PlayerDevice::close()
 		xnOSCloseThread(&m_threadHandle);
 	}
 
+	// Destroy the decode-ahead pipeline.
+	m_decodeWorkers.Destroy();
+	DiscardPendingFrames();
+	while (!m_freeJobs.IsEmpty())
+	{
+		DecodeJob* pJob = *m_freeJobs.Begin();
+		m_freeJobs.Remove(m_freeJobs.Begin());
+		xnOSFreeAligned(pJob->pBuffer);
+		xnOSFreeAligned(pJob->pDecoded);
+		XN_DELETE(pJob);
+	}
+	DestroyDecoderCodecs();
+
 	// Destroy the player.
 	m_player.Destroy();
 
@@ -437,14 +459,26 @@ OniStatus PlayerDevice::invoke(int commandId, void* data, int dataSize)
 		Seek* pSeek = (Seek*)data;
 		m_seek.frameId = pSeek->frameId;
 		m_seek.pStream = pSeek->pStream;
-		m_isSeeking = TRUE;
+		m_seek.bByTimestamp = FALSE;
+		return seek();
+	}
+	else if (commandId == ONI_DEVICE_COMMAND_SEEK_TIMESTAMP)
+	{
+		if (m_player.IsEOF())
+		{
+			return ONI_STATUS_ERROR;
+		}
 
-		// Set the ready for data and manual trigger events, to make sure player thread wakes up.
-		m_readyForDataInternalEvent.Set();
-		m_manualTriggerInternalEvent.Set();
+		if (dataSize != sizeof(XnUInt64))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
 
-		// Wait for seek to complete.
-		m_SeekCompleteInternalEvent.Wait(XN_WAIT_INFINITE);
+		// Seek all sources to the given time.
+		m_seek.timestamp = *(XnUInt64*)data;
+		m_seek.pStream = NULL;
+		m_seek.bByTimestamp = TRUE;
+		return seek();
 	}
 	else
 	{
@@ -456,7 +490,23 @@ OniStatus PlayerDevice::invoke(int commandId, void* data, int dataSize)
 
 OniBool PlayerDevice::isCommandSupported(int commandId)
 {
-	return commandId == ONI_DEVICE_COMMAND_SEEK;
+	return commandId == ONI_DEVICE_COMMAND_SEEK ||
+			commandId == ONI_DEVICE_COMMAND_SEEK_TIMESTAMP;
+}
+
+OniStatus PlayerDevice::seek()
+{
+	m_seek.status = XN_STATUS_OK;
+	m_isSeeking = TRUE;
+
+	// Set the ready for data and manual trigger events, to make sure player thread wakes up.
+	m_readyForDataInternalEvent.Set();
+	m_manualTriggerInternalEvent.Set();
+
+	// Wait for seek to complete.
+	m_SeekCompleteInternalEvent.Wait(XN_WAIT_INFINITE);
+
+	return (m_seek.status == XN_STATUS_OK) ? ONI_STATUS_OK : ONI_STATUS_ERROR;
 }
 
 PlayerSource* PlayerDevice::FindSource(const XnChar* strNodeName)
@@ -553,19 +603,43 @@ void PlayerDevice::MainLoop()
 			double playbackSpeed = m_dPlaybackSpeed;
 			m_dPlaybackSpeed = XN_PLAYBACK_SPEED_FASTEST;
 
-			// Seek the frame ID for first source (seek to (frame ID-1) so next read frame is frameId).
-			PlayerSource* pSource = m_seek.pStream->GetSource();
-			XnStatus xnrc = m_player.SeekToFrame(pSource->GetNodeName(), m_seek.frameId, XN_PLAYER_SEEK_SET);
-			if (xnrc != XN_STATUS_OK)
+			// Frames read ahead of the seek point are not needed anymore.
+			DiscardPendingFrames();
+
+			XnStatus xnrc = XN_STATUS_OK;
+			if (m_seek.bByTimestamp)
 			{
-				// Failure to seek.
-				m_isSeeking = FALSE;
-				continue;
+				xnrc = m_player.SeekToTimeStamp((XnInt64)m_seek.timestamp, XN_PLAYER_SEEK_SET);
+			}
+			else
+			{
+				// Seek the frame ID for first source (seek to (frame ID-1) so next read frame is frameId).
+				PlayerSource* pSource = m_seek.pStream->GetSource();
+				xnrc = m_player.SeekToFrame(pSource->GetNodeName(), m_seek.frameId, XN_PLAYER_SEEK_SET);
+			}
+
+			// Deliver the frames at the seek point before reporting completion.
+			if (xnrc == XN_STATUS_OK)
+			{
+				DeliverPendingFrames(0);
+			}
+			else
+			{
+				DiscardPendingFrames();
 			}
 
 			// Return playback speed to normal.
 			m_dPlaybackSpeed = playbackSpeed;
 
+			if (xnrc != XN_STATUS_OK)
+			{
+				// Failure to seek. Let the caller know.
+				m_seek.status = xnrc;
+				m_isSeeking = FALSE;
+				m_SeekCompleteInternalEvent.Set();
+				continue;
+			}
+
 			// Reset the wait events.
 			m_readyForDataInternalEvent.Reset();
 			m_manualTriggerInternalEvent.Reset();
@@ -573,18 +647,21 @@ void PlayerDevice::MainLoop()
 			// Reset the time reference.
 			m_bHasTimeReference = FALSE;
 
-			// Raise the seek complete event.
-			m_SeekCompleteInternalEvent.Set();
-
-			// Mark the seeking flag as false.
+			// Mark the seeking flag as false before raising the seek complete event, as the next
+			// seek may already be set once the event is raised.
 			m_isSeeking = FALSE;
+			m_SeekCompleteInternalEvent.Set();
 		}
 		else
 		{
-			// Read the next frame (delay between frames must be dealt with in the OnNodeNewData callback).
+			// Read the next frame, and deliver the oldest ones once enough frames are being decoded
+			// (delay between frames is dealt with when delivering).
 			m_player.ReadNext();
+			DeliverPendingFrames(m_maxPendingJobs);
 		}
 	}
+
+	DiscardPendingFrames();
 }
 
 XN_THREAD_PROC PlayerDevice::ThreadProc(XN_THREAD_PARAM pThreadParam)
@@ -687,6 +764,9 @@ XnStatus XN_CALLBACK_TYPE PlayerDevice::OnNodeIntPropChanged(void* pCookie, cons
 	XnStatus nRetVal = XN_STATUS_OK;
 	OniStatus rc;
 
+	// Frames read ahead were recorded before this change, so they go out with the old value.
+	pThis->DeliverPendingFrames(0);
+
 	// Find the source.
 	pThis->Lock();
 	PlayerSource* pSource = pThis->FindSource(strNodeName);
@@ -795,6 +875,9 @@ XnStatus XN_CALLBACK_TYPE PlayerDevice::OnNodeRealPropChanged(void* pCookie, con
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
 	XnStatus nRetVal = XN_STATUS_OK;
 
+	// Frames read ahead were recorded before this change, so they go out with the old value.
+	pThis->DeliverPendingFrames(0);
+
 	// Find the source.
 	pThis->Lock();
 	PlayerSource* pSource = pThis->FindSource(strNodeName);
@@ -812,6 +895,9 @@ XnStatus XN_CALLBACK_TYPE PlayerDevice::OnNodeStringPropChanged(void* pCookie, c
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
 	XnStatus nRetVal = XN_STATUS_OK;
 
+	// Frames read ahead were recorded before this change, so they go out with the old value.
+	pThis->DeliverPendingFrames(0);
+
 	// Find the source.
 	pThis->Lock();
 	PlayerSource* pSource = pThis->FindSource(strNodeName);
@@ -830,6 +916,9 @@ XnStatus XN_CALLBACK_TYPE PlayerDevice::OnNodeGeneralPropChanged(void* pCookie,
 	XnStatus nRetVal = XN_STATUS_OK;
 	OniStatus rc;
 
+	// Frames read ahead were recorded before this change, so they go out with the old value.
+	pThis->DeliverPendingFrames(0);
+
 	// Find the source.
 	pThis->Lock();
 	PlayerSource* pSource = pThis->FindSource(strNodeName);
@@ -973,70 +1062,302 @@ XnStatus XN_CALLBACK_TYPE PlayerDevice::OnNodeNewData(void* pCookie, const XnCha
 	PlayerSource* pSource = pThis->FindSource(strNodeName);
 	if (pSource != NULL)
 	{
-		// Make sure streams are ready to receive the frame.
-		OniBool ready = FALSE;
-		OniBool hasStreams = TRUE;
-		while (hasStreams && !ready && pThis->m_running)
+		pThis->QueueFrame(pSource, nTimeStamp, nFrame, XN_CODEC_UNCOMPRESSED, pData, nSize);
+	}
+
+	return XN_STATUS_OK;
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerDevice::OnNodeNewCompressedData(void* pCookie, const XnChar* strNodeName, XnUInt64 nTimeStamp, XnUInt32 nFrame, XnCodecID compression, const void* pData, XnUInt32 nSize)
+{
+	PlayerDevice* pThis = (PlayerDevice*)pCookie;
+
+	// Find the relevant source.
+	PlayerSource* pSource = pThis->FindSource(strNodeName);
+	if (pSource != NULL)
+	{
+		pThis->QueueFrame(pSource, nTimeStamp, nFrame, compression, pData, nSize);
+	}
+
+	return XN_STATUS_OK;
+}
+
+void PlayerDevice::DeliverFrame(PlayerSource* pSource, XnUInt64 nTimeStamp, XnUInt32 nFrame, void* pData, XnUInt32 nSize, PlayerFileMapping* pMapping)
+{
+	// Make sure streams are ready to receive the frame.
+	OniBool ready = FALSE;
+	OniBool hasStreams = TRUE;
+	while (hasStreams && !ready && m_running)
+	{
+		// Check if any stream is ready to receive the frames.
+		// NOTE: all the streams have a local 'last frame' buffer, so worst case other streams on source will buffer the frame.
+		Lock();
+		hasStreams = FALSE;
+		for (StreamList::Iterator iter = m_streams.Begin(); iter != m_streams.End(); iter++)
 		{
-			// Check if any stream is ready to receive the frames.
-			// NOTE: all the streams have a local 'last frame' buffer, so worst case other streams on source will buffer the frame.
-			pThis->Lock();
-			hasStreams = FALSE;
-			for (StreamList::Iterator iter = pThis->m_streams.Begin(); iter != pThis->m_streams.End(); iter++)
+			PlayerStream* pStream = *iter;
+			if (pStream->GetSource() == pSource)
 			{
-				PlayerStream* pStream = *iter;
-				if (pStream->GetSource() == pSource)
-				{
-					hasStreams = TRUE;
-					ready = TRUE;
-					break;
-				}
+				hasStreams = TRUE;
+				ready = TRUE;
+				break;
 			}
-			pThis->Unlock();
+		}
+		Unlock();
 
-			// If no ready device found, wait for ready for data event.
-			if (hasStreams)
+		// If no ready device found, wait for ready for data event.
+		if (hasStreams)
+		{
+			if (ready)
 			{
-				if (ready)
+				// Check if waiting for manual trigger (playback speed is zero).
+				if (m_dPlaybackSpeed == XN_PLAYBACK_SPEED_MANUAL)
 				{
-					// Check if waiting for manual trigger (playback speed is zero).
-					if (pThis->m_dPlaybackSpeed == XN_PLAYBACK_SPEED_MANUAL)
+					// Wait for manual trigger.
+					XnStatus rc = m_manualTriggerInternalEvent.Wait(DEVICE_MANUAL_TRIGGER_STANITY_SLEEP);
+					if (rc == XN_STATUS_OK)
 					{
-						// Wait for manual trigger.
-						XnStatus rc = pThis->m_manualTriggerInternalEvent.Wait(DEVICE_MANUAL_TRIGGER_STANITY_SLEEP);
-						if (rc == XN_STATUS_OK)
-						{
-							pThis->m_manualTriggerInternalEvent.Reset();
-						}
-						else
-						{
-							ready = FALSE;
-						}
+						m_manualTriggerInternalEvent.Reset();
+					}
+					else
+					{
+						ready = FALSE;
 					}
-				}
-				else 
-				{
-					// Wait for streams to become ready.
-					pThis->m_readyForDataInternalEvent.Wait(DEVICE_READY_FOR_DATA_EVENT_SANITY_SLEEP);
 				}
 			}
+			else 
+			{
+				// Wait for streams to become ready.
+				m_readyForDataInternalEvent.Wait(DEVICE_READY_FOR_DATA_EVENT_SANITY_SLEEP);
+			}
 		}
+	}
 
-		// Sleep until next timestamp has expired.
-		pThis->SleepToTimestamp(nTimeStamp);
+	// Sleep until next timestamp has expired.
+	SleepToTimestamp(nTimeStamp);
 
-		// Continue processing in the source.
-		void* data = const_cast<void*>(pData);
-		pSource->ProcessNewData(nTimeStamp, nFrame, data, nSize);
+	// Continue processing in the source.
+	pSource->ProcessNewData(nTimeStamp, nFrame, pData, nSize, pMapping);
+}
+
+void PlayerDevice::QueueFrame(PlayerSource* pSource, XnUInt64 nTimeStamp, XnUInt32 nFrame, XnCodecID compression, const void* pData, XnUInt32 nSize)
+{
+	DecodeJob* pJob = NULL;
+	if (m_freeJobs.IsEmpty())
+	{
+		pJob = XN_NEW(DecodeJob);
+		pJob->pBuffer = NULL;
+		pJob->nBufferSize = 0;
+		pJob->pDecoded = NULL;
+		pJob->nDecodedBufferSize = 0;
+		pJob->doneEvent.Create(FALSE);
+	}
+	else
+	{
+		pJob = *m_freeJobs.Begin();
+		m_freeJobs.Remove(m_freeJobs.Begin());
 	}
 
-	return XN_STATUS_OK;
+	pJob->pSource = pSource;
+	pJob->nTimeStamp = nTimeStamp;
+	pJob->nFrame = nFrame;
+	pJob->pCodec = NULL;
+	pJob->nSize = nSize;
+	pJob->pMapping = NULL;
+	pJob->nDecodedSize = 0;
+	pJob->status = XN_STATUS_OK;
+
+	if (compression != XN_CODEC_UNCOMPRESSED)
+	{
+		pJob->pCodec = AcquireDecoderCodec(pSource, compression);
+
+		// Decode into a buffer of the source frame size (DecodeFrame grows it if it is too small).
+		XnUInt32 nDecodedSize = (XnUInt32)pSource->GetRequiredFrameSize();
+		if (nDecodedSize == 0)
+		{
+			OniVideoMode videoMode;
+			int dataSize = sizeof(videoMode);
+			if (pSource->GetProperty(ONI_STREAM_PROPERTY_VIDEO_MODE, &videoMode, &dataSize) == ONI_STATUS_OK)
+			{
+				nDecodedSize = videoMode.resolutionX * videoMode.resolutionY * 3;
+			}
+		}
+
+		if (pJob->pCodec == NULL || nDecodedSize == 0)
+		{
+			xnLogWarning("Player", "Can't decode frame %u of %s, dropping it", nFrame, pSource->GetNodeName());
+			ReleaseDecodeJob(pJob);
+			return;
+		}
+
+		if (nDecodedSize > pJob->nDecodedBufferSize)
+		{
+			xnOSFreeAligned(pJob->pDecoded);
+			pJob->pDecoded = (XnUInt8*)xnOSMallocAligned(nDecodedSize, XN_DEFAULT_MEM_ALIGN);
+			pJob->nDecodedBufferSize = (pJob->pDecoded == NULL) ? 0 : nDecodedSize;
+		}
+	}
+
+	// Data in the file mapping stays valid, anything else is overwritten by the next read.
+	if (m_pFileMapping != NULL && m_pFileMapping->Contains(pData, nSize))
+	{
+		m_pFileMapping->AddRef();
+		pJob->pMapping = m_pFileMapping;
+		pJob->pData = (const XnUInt8*)pData;
+	}
+	else
+	{
+		if (nSize > pJob->nBufferSize)
+		{
+			xnOSFreeAligned(pJob->pBuffer);
+			pJob->pBuffer = (XnUInt8*)xnOSMallocAligned(nSize, XN_DEFAULT_MEM_ALIGN);
+			pJob->nBufferSize = (pJob->pBuffer == NULL) ? 0 : nSize;
+		}
+		if (pJob->pBuffer != NULL)
+		{
+			xnOSMemCopy(pJob->pBuffer, pData, nSize);
+		}
+		pJob->pData = pJob->pBuffer;
+	}
+
+	if (pJob->pData == NULL || (pJob->pCodec != NULL && pJob->pDecoded == NULL))
+	{
+		xnLogWarning("Player", "Failed to allocate buffers for frame %u of %s, dropping it", nFrame, pSource->GetNodeName());
+		ReleaseDecodeJob(pJob);
+		return;
+	}
+
+	m_pendingJobs.AddLast(pJob);
+
+	if (pJob->pCodec == NULL)
+	{
+		pJob->doneEvent.Set();
+	}
+	else if (m_decodeWorkers.Submit(DecodeFrame, pJob) != XN_STATUS_OK)
+	{
+		DecodeFrame(pJob);
+	}
+}
+
+void XN_CALLBACK_TYPE PlayerDevice::DecodeFrame(void* pCookie)
+{
+	DecodeJob* pJob = (DecodeJob*)pCookie;
+	for (;;)
+	{
+		pJob->nDecodedSize = pJob->nDecodedBufferSize;
+		pJob->status = pJob->pCodec->Decompress(pJob->pData, pJob->nSize, pJob->pDecoded, &pJob->nDecodedSize);
+		if (pJob->status != XN_STATUS_OUTPUT_BUFFER_OVERFLOW || pJob->nDecodedBufferSize >= DECODED_FRAME_MAX_SIZE)
+		{
+			break;
+		}
+
+		// The frame is larger than the source's frame size. Grow the buffer and try again.
+		XnUInt32 nNewSize = pJob->nDecodedBufferSize * 2;
+		xnOSFreeAligned(pJob->pDecoded);
+		pJob->pDecoded = (XnUInt8*)xnOSMallocAligned(nNewSize, XN_DEFAULT_MEM_ALIGN);
+		pJob->nDecodedBufferSize = (pJob->pDecoded == NULL) ? 0 : nNewSize;
+		if (pJob->pDecoded == NULL)
+		{
+			pJob->status = XN_STATUS_ALLOC_FAILED;
+			break;
+		}
+	}
+	pJob->doneEvent.Set();
+}
+
+void PlayerDevice::DeliverPendingFrames(XnUInt32 nMaxPending)
+{
+	while (m_pendingJobs.Size() > nMaxPending)
+	{
+		DecodeJob* pJob = *m_pendingJobs.Begin();
+		m_pendingJobs.Remove(m_pendingJobs.Begin());
+		pJob->doneEvent.Wait(XN_WAIT_INFINITE);
+
+		if (pJob->status != XN_STATUS_OK)
+		{
+			xnLogWarning("Player", "Failed to decode frame %u of %s: %s", pJob->nFrame, pJob->pSource->GetNodeName(), xnGetStatusString(pJob->status));
+		}
+		else if (pJob->pCodec != NULL)
+		{
+			DeliverFrame(pJob->pSource, pJob->nTimeStamp, pJob->nFrame, pJob->pDecoded, pJob->nDecodedSize, NULL);
+		}
+		else
+		{
+			DeliverFrame(pJob->pSource, pJob->nTimeStamp, pJob->nFrame, const_cast<XnUInt8*>(pJob->pData), pJob->nSize, pJob->pMapping);
+		}
+
+		ReleaseDecodeJob(pJob);
+	}
+}
+
+void PlayerDevice::DiscardPendingFrames()
+{
+	while (!m_pendingJobs.IsEmpty())
+	{
+		DecodeJob* pJob = *m_pendingJobs.Begin();
+		m_pendingJobs.Remove(m_pendingJobs.Begin());
+		pJob->doneEvent.Wait(XN_WAIT_INFINITE);
+		ReleaseDecodeJob(pJob);
+	}
+}
+
+void PlayerDevice::ReleaseDecodeJob(DecodeJob* pJob)
+{
+	if (pJob->pCodec != NULL)
+	{
+		DecoderCodec codec;
+		codec.pSource = pJob->pSource;
+		codec.pCodec = pJob->pCodec;
+		m_freeCodecs.AddLast(codec);
+		pJob->pCodec = NULL;
+	}
+
+	if (pJob->pMapping != NULL)
+	{
+		pJob->pMapping->Release();
+		pJob->pMapping = NULL;
+	}
+
+	m_freeJobs.AddLast(pJob);
+}
+
+XnCodec* PlayerDevice::AcquireDecoderCodec(PlayerSource* pSource, XnCodecID compression)
+{
+	for (DecoderCodecs::Iterator iter = m_freeCodecs.Begin(); iter != m_freeCodecs.End(); ++iter)
+	{
+		if (iter->pSource == pSource && iter->pCodec->GetCodecID() == compression)
+		{
+			XnCodec* pCodec = iter->pCodec;
+			m_freeCodecs.Remove(iter);
+			return pCodec;
+		}
+	}
+
+	XnCodec* pCodec = NULL;
+	if (PlayerCodecFactory::Create(compression, pSource, &pCodec) != XN_STATUS_OK)
+	{
+		return NULL;
+	}
+	return pCodec;
+}
+
+void PlayerDevice::DestroyDecoderCodecs()
+{
+	for (DecoderCodecs::Iterator iter = m_freeCodecs.Begin(); iter != m_freeCodecs.End(); ++iter)
+	{
+		PlayerCodecFactory::Destroy(iter->pCodec);
+	}
+	m_freeCodecs.Clear();
 }
 
 void XN_CALLBACK_TYPE PlayerDevice::OnEndOfFileReached(void* pCookie)
 {
 	// Reset time reference for all streams.
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
+
+	// Frames from before the end must be delivered before the time reference is reset.
+	pThis->DeliverPendingFrames(0);
+
 	pThis->Lock();
 	pThis->m_bHasTimeReference = FALSE;
 	pThis->Unlock();
@@ -1073,7 +1394,21 @@ XnStatus PlayerDevice::AddPrivateProperty(PlayerSource* pSource, const XnChar* s
 XnStatus XN_CALLBACK_TYPE PlayerDevice::FileOpen(void* pCookie)
 {
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
-	return xnOSOpenFile(pThis->m_filePath.Data(), XN_OS_FILE_READ, &pThis->m_fileHandle);
+	XnStatus rc = xnOSOpenFile(pThis->m_filePath.Data(), XN_OS_FILE_READ, &pThis->m_fileHandle);
+	if (rc != XN_STATUS_OK)
+	{
+		return rc;
+	}
+
+	// Map the file as well, so payloads can be used without copying them. Reading the file still
+	// works if this fails.
+	pThis->m_pFileMapping = PlayerFileMapping::Create(pThis->m_filePath.Data());
+	if (pThis->m_pFileMapping == NULL)
+	{
+		xnLogVerbose("Player", "Could not map %s, playing it without memory mapping", pThis->m_filePath.Data());
+	}
+
+	return XN_STATUS_OK;
 }
 
 XnStatus XN_CALLBACK_TYPE PlayerDevice::FileRead(void* pCookie, void* pBuffer, XnUInt32 nSize, XnUInt32* pnBytesRead)
@@ -1100,6 +1435,13 @@ void XN_CALLBACK_TYPE PlayerDevice::FileClose(void* pCookie)
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
 	xnOSCloseFile(&pThis->m_fileHandle);
 	pThis->m_fileHandle = 0;
+
+	// Frames still pointing into the mapping keep it alive.
+	if (pThis->m_pFileMapping != NULL)
+	{
+		pThis->m_pFileMapping->Release();
+		pThis->m_pFileMapping = NULL;
+	}
 }
 
 XnStatus XN_CALLBACK_TYPE PlayerDevice::FileSeek64(void* pCookie, XnOSSeekType seekType, const XnInt64 nOffset)
@@ -1120,6 +1462,16 @@ XnUInt64 XN_CALLBACK_TYPE PlayerDevice::FileTell64(void* pCookie)
 	return 0xffffffff;
 }
 
+const void* XN_CALLBACK_TYPE PlayerDevice::FileGetData(void* pCookie, XnUInt64 nOffset, XnUInt32 nSize)
+{
+	PlayerDevice* pThis = (PlayerDevice*)pCookie;
+	if (pThis->m_pFileMapping == NULL)
+	{
+		return NULL;
+	}
+	return pThis->m_pFileMapping->GetData(nOffset, nSize);
+}
+
 XnStatus XN_CALLBACK_TYPE PlayerDevice::CodecCreate(void* pCookie, const char* strNodeName, XnCodecID nCodecID, XnCodec** ppCodec)
 {
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
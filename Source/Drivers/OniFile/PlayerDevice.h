@@ -29,9 +29,11 @@
 #include "XnString.h"
 #include "XnList.h"
 #include "XnOSCpp.h"
+#include "XnThreadPool.h"
 #include "PlayerNode.h"
 #include "PlayerProperties.h"
 #include "PlayerStream.h"
+#include "PlayerFileMapping.h"
 
 namespace oni_file {
 
@@ -95,15 +97,72 @@ protected:
 private:
 	void close();
 
+	// Hands m_seek to the player thread and waits for it to complete.
+	OniStatus seek();
+
 	typedef struct 
 	{
 		int frameId;
 		PlayerStream* pStream;
 	} Seek;
 
+	// A pending seek, as handed from invoke() to the player thread.
+	typedef struct
+	{
+		int frameId;
+		PlayerStream* pStream;
+		XnBool bByTimestamp;	// Seek to timestamp instead of frameId.
+		XnUInt64 timestamp;
+		XnStatus status;		// Set by the player thread.
+	} SeekRequest;
+
+	// A frame on its way from the file to the streams. The player thread reads ahead while the
+	// decode workers decompress, and frames are delivered in the order they were read.
+	struct DecodeJob
+	{
+		PlayerSource* pSource;
+		XnUInt64 nTimeStamp;
+		XnUInt32 nFrame;
+		XnCodec* pCodec;					// NULL if the data is delivered as is.
+		const XnUInt8* pData;				// The data as read from the file.
+		XnUInt32 nSize;
+		PlayerFileMapping* pMapping;		// Referenced while pData points into the file mapping.
+		XnUInt8* pBuffer;					// Copy of data that is not in the file mapping.
+		XnUInt32 nBufferSize;
+		XnUInt8* pDecoded;
+		XnUInt32 nDecodedBufferSize;
+		XnUInt32 nDecodedSize;
+		XnStatus status;
+		xnl::OSEvent doneEvent;
+	};
+	typedef xnl::List<DecodeJob*> DecodeJobs;
+
+	// A codec instance that is not used by any job. Codecs keep state while decoding, so every job
+	// gets its own instance.
+	typedef struct
+	{
+		PlayerSource* pSource;
+		XnCodec* pCodec;
+	} DecoderCodec;
+	typedef xnl::List<DecoderCodec> DecoderCodecs;
+
 	void MainLoop();
 	static XN_THREAD_PROC ThreadProc(XN_THREAD_PARAM pThreadParam);
 
+	// Queues a frame for delivery, handing compressed data to the decode workers.
+	void QueueFrame(PlayerSource* pSource, XnUInt64 nTimeStamp, XnUInt32 nFrame, XnCodecID compression, const void* pData, XnUInt32 nSize);
+	// Delivers queued frames in order until no more than nMaxPending are left.
+	void DeliverPendingFrames(XnUInt32 nMaxPending);
+	// Drops all queued frames (after a seek, or when shutting down).
+	void DiscardPendingFrames();
+	void ReleaseDecodeJob(DecodeJob* pJob);
+	XnCodec* AcquireDecoderCodec(PlayerSource* pSource, XnCodecID compression);
+	void DestroyDecoderCodecs();
+	static void XN_CALLBACK_TYPE DecodeFrame(void* pCookie);
+
+	// Waits for the streams and the frame time, then hands the frame to the source.
+	void DeliverFrame(PlayerSource* pSource, XnUInt64 nTimeStamp, XnUInt32 nFrame, void* pData, XnUInt32 nSize, PlayerFileMapping* pMapping);
+
 	static void     ONI_CALLBACK_TYPE ReadyForDataCallback(const PlayerStream::ReadyForDataEventArgs& newDataEventArgs, void* pCookie);
 	static void     ONI_CALLBACK_TYPE StreamDestroyCallback(const PlayerStream::DestroyEventArgs& destroyEventArgs, void* pCookie);
 
@@ -115,6 +174,7 @@ private:
 	static XnStatus XN_CALLBACK_TYPE OnNodeGeneralPropChanged(void* pCookie, const XnChar* strNodeName, const XnChar* strPropName, XnUInt32 nBufferSize, const void* pBuffer);
 	static XnStatus XN_CALLBACK_TYPE OnNodeStateReady(void* pCookie, const XnChar* strNodeName);
 	static XnStatus XN_CALLBACK_TYPE OnNodeNewData(void* pCookie, const XnChar* strNodeName, XnUInt64 nTimeStamp, XnUInt32 nFrame, const void* pData, XnUInt32 nSize);
+	static XnStatus XN_CALLBACK_TYPE OnNodeNewCompressedData(void* pCookie, const XnChar* strNodeName, XnUInt64 nTimeStamp, XnUInt32 nFrame, XnCodecID compression, const void* pData, XnUInt32 nSize);
 	static void		XN_CALLBACK_TYPE OnEndOfFileReached(void* pCookie);
 	XnStatus AddPrivateProperty(PlayerSource* pSource, const XnChar* strPropName, XnUInt32 nBufferSize, const void* pBuffer);
 
@@ -125,6 +185,7 @@ private:
 	static void     XN_CALLBACK_TYPE FileClose(void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE FileSeek64(void* pCookie, XnOSSeekType seekType, const XnInt64 nOffset);
 	static XnUInt64 XN_CALLBACK_TYPE FileTell64(void* pCookie);
+	static const void* XN_CALLBACK_TYPE FileGetData(void* pCookie, XnUInt64 nOffset, XnUInt32 nSize);
 
 	static XnStatus XN_CALLBACK_TYPE CodecCreate(void* pCookie, const char* strNodeName, XnCodecID nCodecId, XnCodec** ppCodec);
 	static void     XN_CALLBACK_TYPE CodecDestroy(void* pCookie, XnCodec* pCodec);
@@ -138,6 +199,9 @@ private:
 	// Handle to the opened file.
 	XN_FILE_HANDLE m_fileHandle;
 
+	// Memory mapping of the opened file (NULL if the file could not be mapped).
+	PlayerFileMapping* m_pFileMapping;
+
 	// Thread handle.
 	XN_THREAD_HANDLE m_threadHandle;
 
@@ -145,7 +209,7 @@ private:
 	OniBool m_running;
 
 	// Seek frame.
-	Seek m_seek;
+	SeekRequest m_seek;
 	OniBool m_isSeeking;
 
 	// Speed of playback.
@@ -188,6 +252,13 @@ private:
 
 	// Critical section.
 	xnl::CriticalSection m_cs;
+
+	// Decode-ahead pipeline. Only used by the player thread (and by close() once it exited).
+	xnl::ThreadPool m_decodeWorkers;
+	DecodeJobs m_pendingJobs;
+	DecodeJobs m_freeJobs;
+	DecoderCodecs m_freeCodecs;
+	XnUInt32 m_maxPendingJobs;
 };
 
 } // namespace oni_files_player
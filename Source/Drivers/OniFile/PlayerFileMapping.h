@@ -0,0 +1,112 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Contains the declaration of PlayerFileMapping class that maps a whole *.ONI
+/// file into memory, so frames can point directly into it.
+
+#ifndef __PLAYER_FILE_MAPPING_H__
+#define __PLAYER_FILE_MAPPING_H__
+
+#include "OniCTypes.h"
+#include "XnOS.h"
+
+namespace oni_file {
+
+/// A reference counted memory mapping of a played file. The device holds one
+/// reference, and each frame pointing into the mapping holds another one, so
+/// the mapping outlives the device as long as the application keeps frames.
+/// The mapping is read-only: frames pointing into it are shared with every
+/// later replay of the same data.
+class PlayerFileMapping
+{
+public:
+	/// Maps the file. Returns NULL if the file can't be mapped.
+	static PlayerFileMapping* Create(const XnChar* strFileName)
+	{
+		void* pData = NULL;
+		XnUInt64 nSize = 0;
+		if (xnOSMapFile(strFileName, &pData, &nSize) != XN_STATUS_OK)
+		{
+			return NULL;
+		}
+
+		PlayerFileMapping* pMapping = XN_NEW(PlayerFileMapping, pData, nSize);
+		if (pMapping == NULL)
+		{
+			xnOSUnmapFile(pData, nSize);
+		}
+		return pMapping;
+	}
+
+	void AddRef()
+	{
+		xnOSAtomicIncrement(&m_refCount);
+	}
+
+	void Release()
+	{
+		if (xnOSAtomicDecrement(&m_refCount) == 0)
+		{
+			XN_DELETE(this);
+		}
+	}
+
+	/// Returns a pointer to nSize bytes at nOffset, or NULL if they are not mapped.
+	const void* GetData(XnUInt64 nOffset, XnUInt32 nSize) const
+	{
+		if (nOffset > m_nSize || nSize > m_nSize - nOffset)
+		{
+			return NULL;
+		}
+		return (const XnUInt8*)m_pData + nOffset;
+	}
+
+	/// Checks if a buffer lies inside the mapping.
+	XnBool Contains(const void* pData, XnUInt32 nSize) const
+	{
+		const XnUInt8* pStart = (const XnUInt8*)m_pData;
+		const XnUInt8* pBuffer = (const XnUInt8*)pData;
+		return (pBuffer >= pStart && pBuffer <= pStart + m_nSize && nSize <= (XnUInt64)(pStart + m_nSize - pBuffer));
+	}
+
+	/// Frame buffer free callback for frames pointing into the mapping. pCookie is the mapping.
+	static void ONI_CALLBACK_TYPE ReleaseFrameBufferCallback(void* /*pData*/, void* pCookie)
+	{
+		((PlayerFileMapping*)pCookie)->Release();
+	}
+
+private:
+	PlayerFileMapping(void* pData, XnUInt64 nSize) : m_pData(pData), m_nSize(nSize), m_refCount(1) {}
+	~PlayerFileMapping()
+	{
+		xnOSUnmapFile(m_pData, m_nSize);
+	}
+
+	XN_DISABLE_COPY_AND_ASSIGN(PlayerFileMapping);
+
+	void* m_pData;
+	XnUInt64 m_nSize;
+	volatile XnInt32 m_refCount; // only modified through xnOSAtomic* functions
+};
+
+} // namespace oni_file
+
+#endif // __PLAYER_FILE_MAPPING_H__
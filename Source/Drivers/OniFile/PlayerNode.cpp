@@ -64,11 +64,12 @@ typedef struct XnRealWorldTranslationData
 // Code
 //---------------------------------------------------------------------------
 
-//DATA_MAX_SIZE is set to support a resolution of 1600x1200 with 24 bits per pixel
-const XnUInt64 PlayerNode::DATA_MAX_SIZE = 1600 * 1200 * 3; 
-const XnUInt64 PlayerNode::RECORD_MAX_SIZE = 
-	NewDataRecordHeader::MAX_SIZE +
-	PlayerNode::DATA_MAX_SIZE; //Maximum data size
+//The record buffer grows to fit the largest record read (when payloads can't be used in place)
+const XnUInt32 PlayerNode::RECORD_BUFFER_INITIAL_SIZE = 64 * 1024;
+//Used for nodes that recorded no frame size, supports a resolution of 1600x1200 with 24 bits per pixel
+const XnUInt32 PlayerNode::DEFAULT_FRAME_SIZE = 1600 * 1200 * 3;
+//Limit for growing the uncompressed data buffer when a codec reports it is too small
+const XnUInt32 PlayerNode::UNCOMPRESSED_DATA_MAX_SIZE = 256 * 1024 * 1024;
 
 const XnVersion PlayerNode::OLDEST_SUPPORTED_FILE_FORMAT_VERSION = {1, 0, 0, 4};
 const XnVersion PlayerNode::FIRST_FILESIZE64BIT_FILE_FORMAT_VERSION = {1, 0, 1, 0};
@@ -77,7 +78,9 @@ PlayerNode::PlayerNode(const XnChar* strName) :
 	m_bOpen(FALSE),
 	m_bIs32bitFileFormat(FALSE),
 	m_pRecordBuffer(NULL),
+	m_nRecordBufferSize(0),
 	m_pUncompressedData(NULL),
+	m_nUncompressedDataSize(0),
 	m_pStreamCookie(NULL),
 	m_pInputStream(NULL),
 	m_pNotificationsCookie(NULL),
@@ -103,10 +106,10 @@ PlayerNode::~PlayerNode()
 
 XnStatus PlayerNode::Init()
 {
-	m_pRecordBuffer = XN_NEW_ARR(XnUInt8, RECORD_MAX_SIZE);
+	//The uncompressed data buffer is allocated once the frame sizes are known
+	m_pRecordBuffer = XN_NEW_ARR(XnUInt8, RECORD_BUFFER_INITIAL_SIZE);
 	XN_VALIDATE_ALLOC_PTR(m_pRecordBuffer);
-	m_pUncompressedData = XN_NEW_ARR(XnUInt8, DATA_MAX_SIZE);
-	XN_VALIDATE_ALLOC_PTR(m_pUncompressedData);
+	m_nRecordBufferSize = RECORD_BUFFER_INITIAL_SIZE;
 	return XN_STATUS_OK;
 }
 
@@ -134,8 +137,10 @@ XnStatus PlayerNode::Destroy()
 
 	XN_DELETE_ARR(m_pRecordBuffer);
 	m_pRecordBuffer = NULL;
+	m_nRecordBufferSize = 0;
 	XN_DELETE_ARR(m_pUncompressedData);
 	m_pUncompressedData = NULL;
+	m_nUncompressedDataSize = 0;
 
 	return XN_STATUS_OK;
 }
@@ -173,22 +178,20 @@ XnStatus PlayerNode::SetRepeat(XnBool bRepeat)
 	return XN_STATUS_OK;
 }
 
-XnStatus PlayerNode::SeekToTimeStamp(XnInt64 /*nTimeOffset*/, XnPlayerSeekOrigin /*origin*/)
+XnStatus PlayerNode::SeekToTimeStamp(XnInt64 nTimeOffset, XnPlayerSeekOrigin origin)
 {
-	/*
 	switch (origin)
 	{
 		case XN_PLAYER_SEEK_SET:
-			return SeekToTimeStampAbsolute((XnUInt64)nTimeOffset);
+			return SeekToTimeStampAbsolute((XnUInt64)XN_MAX(0, nTimeOffset));
 		case XN_PLAYER_SEEK_CUR:
 			return SeekToTimeStampRelative(nTimeOffset);
 		case XN_PLAYER_SEEK_END:
-			return SeekToTimeStampAbsolute(m_nGlobalMaxTimeStamp);
+			return SeekToTimeStampAbsolute((XnUInt64)XN_MAX(0, (XnInt64)m_nGlobalMaxTimeStamp + nTimeOffset));
 		default:
 			XN_ASSERT(FALSE);
 			XN_LOG_ERROR_RETURN(XN_STATUS_BAD_PARAM, XN_MASK_OPEN_NI, "Invalid seek origin: %u", origin);
-	}*/
-	return XN_STATUS_NOT_IMPLEMENTED;
+	}
 }
 
 XnStatus PlayerNode::SeekToFrame(const XnChar* strNodeName, XnInt32 nFrameOffset, XnPlayerSeekOrigin origin)
@@ -238,7 +241,7 @@ XnStatus PlayerNode::UndoRecord(PlayerNode::RecordUndoInfo& undoInfo, XnUInt64 n
 	XnStatus nRetVal = XN_STATUS_OK;
 	XnUInt64 nOriginalPos = TellStream();
 	bUndone = FALSE;
-	Record record(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+	Record record(m_pRecordBuffer, m_nRecordBufferSize, m_bIs32bitFileFormat);
 	while ((undoInfo.nRecordPos > nDestPos) && (undoInfo.nUndoRecordPos != 0))
 	{
 		nRetVal = SeekStream(XN_OS_SEEK_SET, undoInfo.nUndoRecordPos);
@@ -272,32 +275,39 @@ DataIndexEntry* PlayerNode::FindTimestampInDataIndex(XnUInt32 nNodeID, XnUInt64
 	XN_ASSERT((nNodeID != INVALID_NODE_ID) && (nNodeID < m_nMaxNodes));
 	PlayerNodeInfo* pPlayerNodeInfo = &m_pNodeInfoMap[nNodeID];
 	
-	// perform binary search. We're looking for the highest timestamp BEFORE searched timestamp
-	int first = 1;
-	int last = pPlayerNodeInfo->nFrames;
-	int mid;
-	XnUInt64 nMidTimestamp;
+	if (pPlayerNodeInfo->pDataIndex == NULL)
+	{
+		return NULL;
+	}
+
+	// perform binary search. We're looking for the last frame with a timestamp not after the searched timestamp
+	// (entry 0 is an empty entry, frames start with 1)
+	XnUInt32 first = 1;
+	XnUInt32 last = pPlayerNodeInfo->nFrames;
+	XnUInt32 found = 0;
 
 	while (first <= last)
 	{
-		mid = (first + last) / 2;
-		nMidTimestamp = pPlayerNodeInfo->pDataIndex[mid].nTimestamp;
+		XnUInt32 mid = first + (last - first) / 2;
 
-		if (nMidTimestamp > nTimestamp)
-		{
-			last = mid - 1;
-		}
-		else if (nMidTimestamp < nTimestamp)
+		if (pPlayerNodeInfo->pDataIndex[mid].nTimestamp <= nTimestamp)
 		{
+			found = mid;
 			first = mid + 1;
 		}
-		else // equals
+		else
 		{
-			break;
+			last = mid - 1;
 		}
 	}
 
-	return &pPlayerNodeInfo->pDataIndex[first-1];
+	// no frame was recorded by then
+	if (found == 0)
+	{
+		return NULL;
+	}
+
+	return &pPlayerNodeInfo->pDataIndex[found];
 }
 
 DataIndexEntry** PlayerNode::GetSeekLocationsFromDataIndex(XnUInt32 nNodeID, XnUInt32 nDestFrame)
@@ -326,6 +336,12 @@ DataIndexEntry** PlayerNode::GetSeekLocationsFromDataIndex(XnUInt32 nNodeID, XnU
 	{
 		if (m_pNodeInfoMap[i].bIsGenerator && i != nNodeID)
 		{
+			if (m_pNodeInfoMap[i].pDataIndex == NULL)
+			{
+				xnLogVerbose(XN_MASK_OPEN_NI, "Seeking from %u to %u: Slow seek being used (other nodes don't have seek tables)", pPlayerNodeInfo->nCurFrame, nDestFrame);
+				return NULL;
+			}
+
 			m_aSeekTempArray[i] = FindTimestampInDataIndex(i, pDestFrame->nTimestamp);
 			if (m_aSeekTempArray[i] != NULL && m_aSeekTempArray[i]->nConfigurationID != pCurrentFrame->nConfigurationID)
 			{
@@ -401,7 +417,7 @@ XnStatus PlayerNode::SeekToFrameAbsolute(XnUInt32 nNodeID, XnUInt32 nDestFrame)
 			//Seek backwards
 			XnUInt64 nDestRecordPos = pPlayerNodeInfo->newDataUndoInfo.nRecordPos;
 			XnUInt64 nUndoRecordPos = pPlayerNodeInfo->newDataUndoInfo.nUndoRecordPos;
-			NewDataRecordHeader record(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+			NewDataRecordHeader record(m_pRecordBuffer, m_nRecordBufferSize, m_bIs32bitFileFormat);
 			
 			/*Scan back through the frames' undo positions until we get to a frame number that is smaller or equal
 			  to nDestFrame. We put the position of the frame we find in nDestRecordPos. */
@@ -540,8 +556,15 @@ XnStatus PlayerNode::ProcessEachNodeLastData(XnUInt32 nIDToProcessLast)
 			{
 				/*This means we had to undo this node's data, but found no data frame before our main node's
 			      data frame. In this case we push a 0 frame.*/
-				memset(m_pRecordBuffer, 0, RECORD_MAX_SIZE);
-				nRetVal = m_pNodeNotifications->OnNodeNewData(m_pNotificationsCookie, pni.strName, 0, 0, m_pRecordBuffer, RECORD_MAX_SIZE);
+				XnUInt32 nFrameSize = pni.GetFrameSize();
+				if (nFrameSize == 0)
+				{
+					nFrameSize = DEFAULT_FRAME_SIZE;
+				}
+				nRetVal = ReserveRecordBuffer(nFrameSize);
+				XN_IS_STATUS_OK(nRetVal);
+				memset(m_pRecordBuffer, 0, nFrameSize);
+				nRetVal = m_pNodeNotifications->OnNodeNewData(m_pNotificationsCookie, pni.strName, 0, 0, m_pRecordBuffer, nFrameSize);
 				XN_IS_STATUS_OK(nRetVal);
 			}
 			else
@@ -656,7 +679,7 @@ XnStatus PlayerNode::ReadNext()
 XnStatus PlayerNode::ProcessRecord(XnBool bProcessPayload)
 {
 	//Read a record and handle it
-	Record record(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+	Record record(m_pRecordBuffer, m_nRecordBufferSize, m_bIs32bitFileFormat);
 	XnStatus nRetVal = ReadRecord(record);
 	XN_IS_STATUS_OK(nRetVal);
 	nRetVal = HandleRecord(record, bProcessPayload);
@@ -755,6 +778,16 @@ XnStatus PlayerNode::Read(void *pData, XnUInt32 nSize, XnUInt32 &nBytesRead)
 	return m_pInputStream->Read(m_pStreamCookie, pData, nSize, &nBytesRead);
 } 
 
+const void* PlayerNode::GetStreamData(XnUInt32 nSize)
+{
+	if (!m_bOpen || m_pInputStream == NULL || m_pInputStream->GetData == NULL)
+	{
+		return NULL;
+	}
+
+	return m_pInputStream->GetData(m_pStreamCookie, TellStream(), nSize);
+}
+
 XnStatus PlayerNode::ReadRecordHeader(Record &record)
 {
 	XnUInt32 nBytesRead = 0;
@@ -776,9 +809,12 @@ XnStatus PlayerNode::ReadRecordHeader(Record &record)
 
 XnStatus PlayerNode::ReadRecordFields(Record &record)
 {
+	XnStatus nRetVal = ReserveRecordBuffer(record, record.GetSize());
+	XN_IS_STATUS_OK(nRetVal);
+
 	XnUInt32 nBytesToRead = record.GetSize() - record.HEADER_SIZE;
 	XnUInt32 nBytesRead = 0;
-	XnStatus nRetVal = Read(record.GetData() + record.HEADER_SIZE, nBytesToRead, nBytesRead);
+	nRetVal = Read(record.GetData() + record.HEADER_SIZE, nBytesToRead, nBytesRead);
 	XN_IS_STATUS_OK(nRetVal);
 	if (nBytesRead < nBytesToRead)
 	{
@@ -787,6 +823,46 @@ XnStatus PlayerNode::ReadRecordFields(Record &record)
 	return XN_STATUS_OK;
 }
 
+XnStatus PlayerNode::ReserveRecordBuffer(Record& record, XnUInt32 nSize)
+{
+	XnStatus nRetVal = ReserveRecordBuffer(nSize);
+	XN_IS_STATUS_OK(nRetVal);
+
+	record.SetData(m_pRecordBuffer, m_nRecordBufferSize);
+	return XN_STATUS_OK;
+}
+
+XnStatus PlayerNode::ReserveRecordBuffer(XnUInt32 nSize)
+{
+	if (nSize > m_nRecordBufferSize)
+	{
+		//Grow by at least half, so slowly growing frames don't reallocate every time
+		XnUInt32 nNewSize = XN_MAX(nSize, m_nRecordBufferSize + m_nRecordBufferSize / 2);
+		XnUInt8* pNewBuffer = XN_NEW_ARR(XnUInt8, nNewSize);
+		XN_VALIDATE_ALLOC_PTR(pNewBuffer);
+		xnOSMemCopy(pNewBuffer, m_pRecordBuffer, m_nRecordBufferSize);
+		XN_DELETE_ARR(m_pRecordBuffer);
+		m_pRecordBuffer = pNewBuffer;
+		m_nRecordBufferSize = nNewSize;
+	}
+
+	return XN_STATUS_OK;
+}
+
+XnStatus PlayerNode::ReserveUncompressedData(XnUInt32 nSize)
+{
+	if (nSize > m_nUncompressedDataSize)
+	{
+		XN_DELETE_ARR(m_pUncompressedData);
+		m_nUncompressedDataSize = 0;
+		m_pUncompressedData = XN_NEW_ARR(XnUInt8, nSize);
+		XN_VALIDATE_ALLOC_PTR(m_pUncompressedData);
+		m_nUncompressedDataSize = nSize;
+	}
+
+	return XN_STATUS_OK;
+}
+
 XnStatus PlayerNode::ReadRecord(Record &record)
 {
 	XnStatus nRetVal = ReadRecordHeader(record);
@@ -942,6 +1018,7 @@ XnStatus PlayerNode::HandleNodeAddedImpl(XnUInt32 nNodeID, XnProductionNodeType
 	pPlayerNodeInfo->bValid = TRUE;
 
 	//Loop until this node's state is ready.
+	//NOTE: this reuses (and may reallocate) the record buffer, so strName must not be used from here on
 	//TODO: Check for eof
 	while (!pPlayerNodeInfo->bStateReady)
 	{
@@ -989,7 +1066,7 @@ XnStatus PlayerNode::HandleNodeAdded_1_0_0_4_Record(NodeAdded_1_0_0_4_Record rec
 		nRetVal = SeekToRecordByType(nNodeID, RECORD_NODE_DATA_BEGIN);
 		if (nRetVal == XN_STATUS_OK)
 		{
-			NodeDataBeginRecord dataBeginRecord(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+			NodeDataBeginRecord dataBeginRecord(m_pRecordBuffer, m_nRecordBufferSize, m_bIs32bitFileFormat);
 			nRetVal = ReadRecord(dataBeginRecord);
 			XN_IS_STATUS_OK(nRetVal);
 
@@ -999,11 +1076,11 @@ XnStatus PlayerNode::HandleNodeAdded_1_0_0_4_Record(NodeAdded_1_0_0_4_Record rec
 			nNumFrames = dataBeginRecord.GetNumFrames();
 			nMaxTimestamp = dataBeginRecord.GetMaxTimeStamp();
 
-			// also find data record for min timestamp
-			nRetVal = SeekToRecordByType(record.GetNodeID(), RECORD_NEW_DATA);
+			// also find data record for min timestamp (record's buffer may have been reallocated by now)
+			nRetVal = SeekToRecordByType(nNodeID, RECORD_NEW_DATA);
 			if (nRetVal == XN_STATUS_OK)
 			{
-				NewDataRecordHeader newDataRecord(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+				NewDataRecordHeader newDataRecord(m_pRecordBuffer, m_nRecordBufferSize, m_bIs32bitFileFormat);
 				nRetVal = ReadRecord(newDataRecord);
 				XN_IS_STATUS_OK(nRetVal);
 
@@ -1065,7 +1142,7 @@ XnStatus PlayerNode::HandleNodeAddedRecord(NodeAddedRecord record)
 		nRetVal = SeekStream(XN_OS_SEEK_SET, record.GetSeekTablePosition());
 		XN_IS_STATUS_OK(nRetVal);
 
-		DataIndexRecordHeader seekTableHeader(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+		DataIndexRecordHeader seekTableHeader(m_pRecordBuffer, m_nRecordBufferSize, m_bIs32bitFileFormat);
 		nRetVal = ReadRecord(seekTableHeader);
 		XN_IS_STATUS_OK(nRetVal);
 
@@ -1084,7 +1161,7 @@ XnStatus PlayerNode::SeekToRecordByType(XnUInt32 nNodeID, RecordType type)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 	
-	Record record(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+	Record record(m_pRecordBuffer, m_nRecordBufferSize, m_bIs32bitFileFormat);
 
 	XnUInt64 nStartPos = TellStream();
 
@@ -1143,10 +1220,11 @@ XnStatus PlayerNode::HandleGeneralPropRecord(GeneralPropRecord record)
 		return XN_STATUS_CORRUPT_FILE;
 	}
 
-	// Save map output mode (resolution) - for real world translation (BC)
+	// Save map output mode (resolution) - for real world translation (BC), and for sizing frames
 	if (strcmp(record.GetPropName(), XN_PROP_MAP_OUTPUT_MODE) == 0)
 	{
 		xnOSMemCopy(&m_lastOutputMode, record.GetPropData(), sizeof(XnMapOutputMode));
+		xnOSMemCopy(&pPlayerNodeInfo->outputMode, record.GetPropData(), sizeof(XnMapOutputMode));
 	}
 	// Fix backwards compatibility issues
 	if (strcmp(record.GetPropName(), XN_PROP_REAL_WORLD_TRANSLATION_DATA) == 0)
@@ -1209,6 +1287,16 @@ XnStatus PlayerNode::HandleIntPropRecord(IntPropRecord record)
 	const XnChar* strPropName = record.GetPropName();
 	XnUInt64 nValue = record.GetValue();
 
+	// Keep what's needed to size the node's uncompressed frames
+	if (strcmp(strPropName, XN_PROP_ONI_REQUIRED_FRAME_SIZE) == 0 || strcmp(strPropName, "RequiredDataSize") == 0)
+	{
+		pPlayerNodeInfo->nRequiredFrameSize = (XnUInt32)nValue;
+	}
+	else if (strcmp(strPropName, XN_PROP_BYTES_PER_PIXEL) == 0)
+	{
+		pPlayerNodeInfo->nBytesPerPixel = (XnUInt32)nValue;
+	}
+
 	// old files workaround: some old files recorded nodes as not generating though having frames.
 	// make them generating.
 	if (strcmp(strPropName, XN_PROP_IS_GENERATING) == 0 &&
@@ -1397,13 +1485,6 @@ XnStatus PlayerNode::HandleNewDataRecord(NewDataRecordHeader record, XnBool bRea
 		return XN_STATUS_CORRUPT_FILE;
 	}
 
-	XnUInt32 nRecordTotalSize = record.GetSize() + record.GetPayloadSize();
-	if (nRecordTotalSize > RECORD_MAX_SIZE)
-	{
-		XN_ASSERT(FALSE);
-		XN_LOG_ERROR_RETURN(XN_STATUS_INTERNAL_BUFFER_TOO_SMALL, XN_MASK_OPEN_NI, "Record size %u is larger than player internal buffer", nRecordTotalSize);
-	}
-	
 	pPlayerNodeInfo->nLastDataPos = TellStream() - record.GetSize();
 	pPlayerNodeInfo->newDataUndoInfo.nRecordPos =  pPlayerNodeInfo->nLastDataPos;
 	pPlayerNodeInfo->newDataUndoInfo.nUndoRecordPos = record.GetUndoRecordPos();
@@ -1425,17 +1506,30 @@ XnStatus PlayerNode::HandleNewDataRecord(NewDataRecordHeader record, XnBool bRea
 
 	if (bReadPayload)
 	{
-		//Now read the actual data
-		XnUInt32 nBytesRead = 0;
-		nRetVal = Read(record.GetPayload(), record.GetPayloadSize(), nBytesRead);
-		XN_IS_STATUS_OK(nRetVal);
-		if (nBytesRead < record.GetPayloadSize())
+		//If the stream gives direct access to the data, use it in place instead of copying it
+		const XnUInt8* pCompressedData = (const XnUInt8*)GetStreamData(record.GetPayloadSize());
+		if (pCompressedData != NULL)
 		{
-			XN_ASSERT(FALSE);
-			XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Not enough bytes read");
+			nRetVal = SkipRecordPayload(record);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+		else
+		{
+			//Now read the actual data
+			nRetVal = ReserveRecordBuffer(record, record.GetSize() + record.GetPayloadSize());
+			XN_IS_STATUS_OK(nRetVal);
+			XnUInt32 nBytesRead = 0;
+			nRetVal = Read(record.GetPayload(), record.GetPayloadSize(), nBytesRead);
+			XN_IS_STATUS_OK(nRetVal);
+			if (nBytesRead < record.GetPayloadSize())
+			{
+				XN_ASSERT(FALSE);
+				XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Not enough bytes read");
+			}
+
+			pCompressedData = record.GetPayload(); //The new (compressed) data is right at the end of the header
 		}
 
-		const XnUInt8* pCompressedData = record.GetPayload(); //The new (compressed) data is right at the end of the header
 		XnUInt32 nCompressedDataSize = record.GetPayloadSize();
 		const XnUInt8* pUncompressedData = NULL;
 		XnUInt32 nUncompressedDataSize = 0;
@@ -1446,12 +1540,34 @@ XnStatus PlayerNode::HandleNewDataRecord(NewDataRecordHeader record, XnBool bRea
 			pUncompressedData = pCompressedData;
 			nUncompressedDataSize = nCompressedDataSize;
 		}
+		else if (m_pNodeNotifications->OnNodeNewCompressedData != NULL)
+		{
+			//Let the notifications object decode the data
+			nRetVal = m_pNodeNotifications->OnNodeNewCompressedData(m_pNotificationsCookie, pPlayerNodeInfo->strName, 
+																	record.GetTimeStamp(), record.GetFrameNumber(), 
+																	compression, pCompressedData, nCompressedDataSize);
+			XN_IS_STATUS_OK_ASSERT(nRetVal);
+			return XN_STATUS_OK;
+		}
 		else
 		{
-			//Decode data with codec
-			nUncompressedDataSize = DATA_MAX_SIZE;
-			nRetVal = pPlayerNodeInfo->pCodec->Decompress(pCompressedData, nCompressedDataSize, 
-														  m_pUncompressedData, &nUncompressedDataSize);
+			//Decode data with codec, into a buffer sized for the node's frames
+			XnUInt32 nFrameSize = pPlayerNodeInfo->GetFrameSize();
+			nRetVal = ReserveUncompressedData((nFrameSize != 0) ? nFrameSize : DEFAULT_FRAME_SIZE);
+			XN_IS_STATUS_OK(nRetVal);
+			for (;;)
+			{
+				nUncompressedDataSize = m_nUncompressedDataSize;
+				nRetVal = pPlayerNodeInfo->pCodec->Decompress(pCompressedData, nCompressedDataSize, 
+															  m_pUncompressedData, &nUncompressedDataSize);
+				if (nRetVal != XN_STATUS_OUTPUT_BUFFER_OVERFLOW || m_nUncompressedDataSize >= UNCOMPRESSED_DATA_MAX_SIZE)
+				{
+					break;
+				}
+				//Frame is larger than recorded, try again with a bigger buffer
+				nRetVal = ReserveUncompressedData(m_nUncompressedDataSize * 2);
+				XN_IS_STATUS_OK(nRetVal);
+			}
 			XN_IS_STATUS_OK_ASSERT(nRetVal);
 			pUncompressedData = m_pUncompressedData;
 		}
@@ -1484,13 +1600,6 @@ XnStatus PlayerNode::HandleDataIndexRecord(DataIndexRecordHeader record, XnBool
 	PlayerNodeInfo* pPlayerNodeInfo = GetPlayerNodeInfo(record.GetNodeID());
 	XN_VALIDATE_PTR(pPlayerNodeInfo, XN_STATUS_CORRUPT_FILE);
 
-	XnUInt32 nRecordTotalSize = record.GetSize() + record.GetPayloadSize();
-	if (nRecordTotalSize > RECORD_MAX_SIZE)
-	{
-		XN_ASSERT(FALSE);
-		XN_LOG_ERROR_RETURN(XN_STATUS_INTERNAL_BUFFER_TOO_SMALL, XN_MASK_OPEN_NI, "Record size %u is larger than player internal buffer", nRecordTotalSize);
-	}
-
 	if (bReadPayload)
 	{
 		// make sure node exists
@@ -1616,10 +1725,64 @@ XnStatus PlayerNode::ProcessUntilFirstData()
 	return XN_STATUS_OK;
 }
 
+XnStatus PlayerNode::SeekToTimeStampFromDataIndex(XnUInt64 nDestTimeStamp, XnBool& bSeeked)
+{
+	bSeeked = FALSE;
+
+	// Find the node that recorded a frame closest to (but not after) the destination time. All other
+	// nodes are then moved to their last frame before that one.
+	XnUInt32 nNodeID = INVALID_NODE_ID;
+	XnUInt32 nDestFrame = 0;
+	XnUInt64 nFrameTimeStamp = 0;
+	for (XnUInt32 i = 0; i < m_nMaxNodes; ++i)
+	{
+		if (!m_pNodeInfoMap[i].bIsGenerator)
+		{
+			continue;
+		}
+
+		if (m_pNodeInfoMap[i].pDataIndex == NULL)
+		{
+			// can't use the seek tables
+			return XN_STATUS_OK;
+		}
+
+		DataIndexEntry* pEntry = FindTimestampInDataIndex(i, nDestTimeStamp);
+		if (pEntry != NULL && (nNodeID == INVALID_NODE_ID || pEntry->nTimestamp > nFrameTimeStamp))
+		{
+			nNodeID = i;
+			nDestFrame = (XnUInt32)(pEntry - m_pNodeInfoMap[i].pDataIndex);
+			nFrameTimeStamp = pEntry->nTimestamp;
+		}
+	}
+
+	if (nNodeID == INVALID_NODE_ID)
+	{
+		// no frame was recorded by then
+		return XN_STATUS_OK;
+	}
+
+	XnStatus nRetVal = SeekToFrameAbsolute(nNodeID, nDestFrame);
+	XN_IS_STATUS_OK(nRetVal);
+
+	bSeeked = TRUE;
+	return XN_STATUS_OK;
+}
+
 XnStatus PlayerNode::SeekToTimeStampAbsolute(XnUInt64 nDestTimeStamp)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 	XnUInt64 nRecordTimeStamp = 0LL;
+
+	// Seek tables let us find each node's frame in O(log n), instead of scanning the file.
+	XnBool bSeeked = FALSE;
+	nRetVal = SeekToTimeStampFromDataIndex(nDestTimeStamp, bSeeked);
+	XN_IS_STATUS_OK(nRetVal);
+	if (bSeeked)
+	{
+		return XN_STATUS_OK;
+	}
+
 	XnUInt64 nStartPos = TellStream(); //We'll revert to this in case nDestTimeStamp is beyond end of stream
 	XN_IS_STATUS_OK(nRetVal);
 
@@ -1637,12 +1800,14 @@ XnStatus PlayerNode::SeekToTimeStampAbsolute(XnUInt64 nDestTimeStamp)
 		nDestTimeStamp = m_nGlobalMaxTimeStamp;
 	}
 
-	Record record(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+	Record record(m_pRecordBuffer, m_nRecordBufferSize, m_bIs32bitFileFormat);
 	XnBool bEnd = FALSE;
 	XnUInt32 nBytesRead = 0;
 
 	while ((nRecordTimeStamp < nDestTimeStamp) && !bEnd)
 	{
+		// handling the previous record may have grown (reallocated) the record buffer
+		record.SetData(m_pRecordBuffer, m_nRecordBufferSize);
 		nRetVal = ReadRecordHeader(record);
 		XN_IS_STATUS_OK(nRetVal);
 		switch (record.GetType())
@@ -1698,9 +1863,9 @@ XnStatus PlayerNode::SeekToTimeStampAbsolute(XnUInt64 nDestTimeStamp)
 			case RECORD_NODE_STATE_READY:
 			{
 				//Read rest of record and handle it normally
-				nRetVal = Read(m_pRecordBuffer + record.HEADER_SIZE, record.GetSize() - record.HEADER_SIZE, nBytesRead);
+				nRetVal = ReadRecordFields(record);
 				XN_IS_STATUS_OK(nRetVal);
-				Record record0(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+				Record record0(m_pRecordBuffer, m_nRecordBufferSize, m_bIs32bitFileFormat);
 				nRetVal = HandleRecord(record0, TRUE);
 				XN_IS_STATUS_OK(nRetVal);
 				break;
@@ -1725,8 +1890,7 @@ XnStatus PlayerNode::SeekToTimeStampAbsolute(XnUInt64 nDestTimeStamp)
 
 XnStatus PlayerNode::SeekToTimeStampRelative(XnInt64 nOffset)
 {
-	//TODO: Implement more efficiently
-	return SeekToTimeStampAbsolute(m_nTimeStamp + nOffset);
+	return SeekToTimeStampAbsolute((XnUInt64)XN_MAX(0, (XnInt64)m_nTimeStamp + nOffset));
 }
 
 XnUInt32 PlayerNode::GetPlayerNodeIDByName(const XnChar* strNodeName)
@@ -1801,6 +1965,18 @@ void PlayerNode::PlayerNodeInfo::Reset()
 	bValid = FALSE;
 	xnOSFree(pDataIndex);
 	pDataIndex = NULL;
+	nRequiredFrameSize = 0;
+	xnOSMemSet(&outputMode, 0, sizeof(outputMode));
+	nBytesPerPixel = 0;
+}
+
+XnUInt32 PlayerNode::PlayerNodeInfo::GetFrameSize() const
+{
+	if (nRequiredFrameSize != 0)
+	{
+		return nRequiredFrameSize;
+	}
+	return outputMode.nXRes * outputMode.nYRes * nBytesPerPixel;
 }
 
 }
@@ -104,11 +104,18 @@ private:
 		RecordUndoInfoMap recordUndoInfoMap;
 		RecordUndoInfo newDataUndoInfo;
 		DataIndexEntry* pDataIndex;
+		XnUInt32 nRequiredFrameSize; //As recorded, 0 if unknown
+		XnMapOutputMode outputMode;
+		XnUInt32 nBytesPerPixel;
+
+		//Returns the size of an uncompressed frame, or 0 if it is not known.
+		XnUInt32 GetFrameSize() const;
 	};
 
 	XnStatus ProcessRecord(XnBool bProcessPayload);
 	XnStatus SeekToTimeStampAbsolute(XnUInt64 nDestTimeStamp);
 	XnStatus SeekToTimeStampRelative(XnInt64 nOffset);
+	XnStatus SeekToTimeStampFromDataIndex(XnUInt64 nDestTimeStamp, XnBool& bSeeked);
 	XnStatus UndoRecord(PlayerNode::RecordUndoInfo& undoInfo, XnUInt64 nDestPos, XnBool& nUndone);
 	XnStatus SeekToFrameAbsolute(XnUInt32 nNodeID, XnUInt32 nFrameNumber);
 	XnStatus ProcessEachNodeLastData(XnUInt32 nIDToProcessLast);
@@ -116,8 +123,16 @@ private:
 	static XnInt32 CompareVersions(const XnVersion* pV0, const XnVersion* pV1);
 	XnStatus OpenStream();
 	XnStatus Read(void* pData, XnUInt32 nSize, XnUInt32& nBytesRead);
+	//Returns nSize bytes at the current position without reading them, or NULL if the stream doesn't support it.
+	const void* GetStreamData(XnUInt32 nSize);
 	XnStatus ReadRecordHeader(Record& record);
 	XnStatus ReadRecordFields(Record& record);
+	//Makes the record buffer hold at least nSize bytes, keeping its contents.
+	XnStatus ReserveRecordBuffer(XnUInt32 nSize);
+	//Same, and points record to the record buffer.
+	XnStatus ReserveRecordBuffer(Record& record, XnUInt32 nSize);
+	//Makes the uncompressed data buffer hold at least nSize bytes. Its contents are not kept.
+	XnStatus ReserveUncompressedData(XnUInt32 nSize);
 	//ReadRecord reads just the fields of the record, not the payload.
 	XnStatus ReadRecord(Record& record);
 	XnStatus SeekStream(XnOSSeekType seekType, XnInt64 nOffset);
@@ -156,8 +171,9 @@ private:
 	XnStatus HandleNodeAdded_1_0_0_5_Record(NodeAdded_1_0_0_5_Record record);
 	XnStatus HandleNodeAdded_1_0_0_4_Record(NodeAdded_1_0_0_4_Record record);
 
-	static const XnUInt64 DATA_MAX_SIZE;
-	static const XnUInt64 RECORD_MAX_SIZE;
+	static const XnUInt32 RECORD_BUFFER_INITIAL_SIZE;
+	static const XnUInt32 DEFAULT_FRAME_SIZE;
+	static const XnUInt32 UNCOMPRESSED_DATA_MAX_SIZE;
 	static const XnVersion OLDEST_SUPPORTED_FILE_FORMAT_VERSION;
 	static const XnVersion FIRST_FILESIZE64BIT_FILE_FORMAT_VERSION;
 
@@ -166,7 +182,9 @@ private:
 	XnBool m_bOpen;
 	XnBool m_bIs32bitFileFormat;
 	XnUInt8* m_pRecordBuffer;
-	XnUInt8* m_pUncompressedData;
+	XnUInt32 m_nRecordBufferSize;
+	XnUInt8* m_pUncompressedData; //Shared by all nodes
+	XnUInt32 m_nUncompressedDataSize;
 	void* m_pStreamCookie;
 	XnPlayerInputStreamInterface* m_pInputStream;
 	void* m_pNotificationsCookie;
@@ -29,6 +29,7 @@
 #include "OniCProperties.h"
 #include "XnEvent.h"
 #include "XnString.h"
+#include "PlayerFileMapping.h"
 
 enum
 {
@@ -50,6 +51,7 @@ public:
 		XnUInt32 nFrameId;
 		void* pData;
 		XnUInt32 nSize;
+		PlayerFileMapping* pMapping; // set if pData points into the file mapping
 	} NewDataEventArgs;
 	typedef xnl::Event<NewDataEventArgs> NewDataEvent;
 	typedef void (ONI_CALLBACK_TYPE* NewDataCallback)(const NewDataEventArgs& newDataEventArgs, void* pCookie);
@@ -75,7 +77,7 @@ public:
 	virtual OniStatus SetProperty(int propertyId, const void* data, int dataSize);
 
 	// Process new data.
-	void ProcessNewData(XnUInt64 nTimeStamp, XnUInt32 nFrameId, void* pData, XnUInt32 nSize);
+	void ProcessNewData(XnUInt64 nTimeStamp, XnUInt32 nFrameId, void* pData, XnUInt32 nSize, PlayerFileMapping* pMapping = NULL);
 
 	// Register for new data event.
 	OniStatus RegisterNewDataEvent(NewDataCallback callback, void* pCookie, OniCallbackHandle& handle);
@@ -169,23 +169,45 @@ void ONI_CALLBACK_TYPE PlayerStream::OnNewDataCallback(const PlayerSource::NewDa
 		return;
 	}
 
-	// Set the cropping property.
+	// Set the cropping property (devices that don't support cropping don't record it).
 	OniCropping cropping;
 	cropping.enabled = FALSE;
 	int dataSize = sizeof(cropping);
 	rc = pStream->m_pSource->GetProperty(ONI_STREAM_PROPERTY_CROPPING, &cropping, &dataSize);
 	if (rc != ONI_STATUS_OK)
 	{
-		XN_ASSERT(FALSE);
-		return;
+		cropping.enabled = FALSE;
 	}
 
 	pStream->m_cs.Lock();
 
-	// Allocate new frame and fill it.
-	OniFrame* pFrame = pStream->getServices().acquireFrame();
+	// If the data lies in the file mapping, let the frame point to it directly (the frame keeps the
+	// mapping alive). Otherwise, allocate a new frame and copy the data.
+	OniFrame* pFrame = NULL;
+	OniBool copyData = TRUE;
+	PlayerFileMapping* pMapping = newDataEventArgs.pMapping;
+	if (pMapping != NULL && (int)newDataEventArgs.nSize <= pStream->m_requiredFrameSize)
+	{
+		pMapping->AddRef();
+		pFrame = pStream->getServices().acquireExternalFrame(newDataEventArgs.pData, newDataEventArgs.nSize, PlayerFileMapping::ReleaseFrameBufferCallback, pMapping);
+		if (pFrame == NULL)
+		{
+			pMapping->Release();
+		}
+		else
+		{
+			copyData = FALSE;
+		}
+	}
+
 	if (pFrame == NULL)
 	{
+		pFrame = pStream->getServices().acquireFrame();
+	}
+
+	if (pFrame == NULL)
+	{
+		pStream->m_cs.Unlock();
 		return;
 	}
 
@@ -225,7 +247,10 @@ void ONI_CALLBACK_TYPE PlayerStream::OnNewDataCallback(const PlayerSource::NewDa
 		XN_ASSERT(FALSE);
 		pFrame->dataSize = pStream->m_requiredFrameSize;
 	}
-	memcpy(pFrame->data, newDataEventArgs.pData, pFrame->dataSize);
+	if (copyData)
+	{
+		memcpy(pFrame->data, newDataEventArgs.pData, pFrame->dataSize);
+	}
 
 	pStream->m_cs.Unlock();
 
@@ -263,6 +263,18 @@ typedef struct XnPlayerInputStreamInterface
 	 */
 	XnUInt64 (XN_CALLBACK_TYPE* Tell64)(void* pCookie);
 
+	/**
+	 * Optional. Gets direct access to stream data without copying it. The returned memory must stay valid
+	 * until the stream is closed.
+	 *
+	 * @param	pCookie		[in]	A cookie that was received with this interface.
+	 * @param	nOffset		[in]	Position of the data in the stream.
+	 * @param	nSize		[in]	Number of bytes needed.
+	 *
+	 * @returns A pointer to the data, or NULL if the data can't be accessed directly.
+	 */
+	const void* (XN_CALLBACK_TYPE* GetData)(void* pCookie, XnUInt64 nOffset, XnUInt32 nSize);
+
 } XnPlayerInputStreamInterface;
 
 /** 
@@ -360,6 +372,23 @@ typedef struct XnNodeNotifications
 		(void* pCookie, const XnChar* strNodeName,
 		XnUInt64 nTimeStamp, XnUInt32 nFrame, const void* pData, XnUInt32 nSize);
 
+	/**
+	 * Optional. Notifies the object about new compressed data, leaving the decompression to it. If not set,
+	 * the player decompresses the data and calls @ref OnNodeNewData instead. The data is only valid during
+	 * this call.
+	 *
+	 * @param	pCookie		[in]	A cookie that was received with this interface.
+	 * @param	strNodeName	[in]	The name of the node.
+	 * @param	nTimeStamp	[in]	The timestamp of the data.
+	 * @param	nFrame		[in]	The frame ID of the data.
+	 * @param	compression	[in]	The codec the data was compressed with.
+	 * @param	pData		[in]	The compressed data.
+	 * @param	nSize		[in]	The size of the compressed data.
+	 */
+	XnStatus (XN_CALLBACK_TYPE* OnNodeNewCompressedData)
+		(void* pCookie, const XnChar* strNodeName,
+		XnUInt64 nTimeStamp, XnUInt32 nFrame, XnCodecID compression, const void* pData, XnUInt32 nSize);
+
 } XnNodeNotifications;
 
 #endif //__XN_PLAYER_TYPES_H__
@@ -0,0 +1,205 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Contains the definition of ShmDevice class.
+
+#include "ShmDevice.h"
+#include "XnLog.h"
+
+#define XN_MASK_SHM "OniShm"
+
+#define XN_SHM_THREAD_EXIT_TIMEOUT 3000
+
+namespace oni_shm {
+
+namespace driver = oni::driver;
+
+ShmDevice::ShmDevice(ShmMapping* pMapping) :
+	m_pMapping(pMapping),
+	m_numSensors(0),
+	m_hEvent(NULL),
+	m_hThread(NULL),
+	m_running(FALSE)
+{
+	m_pMapping->AddRef();
+	xnOSMemSet(m_sensors, 0, sizeof(m_sensors));
+}
+
+ShmDevice::~ShmDevice()
+{
+	if (m_hThread != NULL)
+	{
+		m_running = FALSE;
+		xnOSSetEvent(m_hEvent);
+		if (xnOSWaitForThreadExit(m_hThread, XN_SHM_THREAD_EXIT_TIMEOUT) != XN_STATUS_OK)
+		{
+			xnOSTerminateThread(&m_hThread);
+		}
+		else
+		{
+			xnOSCloseThread(&m_hThread);
+		}
+	}
+
+	if (m_hEvent != NULL)
+	{
+		xnOSCloseEvent(&m_hEvent);
+	}
+
+	// Frames still held by the application keep our consumer entry until they are released.
+	m_pMapping->Release();
+}
+
+OniStatus ShmDevice::Initialize(const XnChar* strName)
+{
+	ShmRingHeader* pHeader = m_pMapping->GetHeader();
+
+	// Streams the publisher detached before it started have no slots.
+	for (XnUInt32 i = 0; i < pHeader->numStreams; ++i)
+	{
+		const ShmStreamInfo& info = pHeader->streams[i];
+		if (info.numSlots == 0)
+		{
+			continue;
+		}
+
+		m_videoModes[m_numSensors] = info.videoMode;
+		m_sensors[m_numSensors].sensorType = info.sensorType;
+		m_sensors[m_numSensors].numSupportedVideoModes = 1;
+		m_sensors[m_numSensors].pSupportedVideoModes = &m_videoModes[m_numSensors];
+		m_sensorStreams[m_numSensors] = i;
+		++m_numSensors;
+	}
+
+	// Register as a consumer, so the publisher wakes us up on new frames.
+	XnInt32 nConsumer = m_pMapping->RegisterConsumer();
+	if (nConsumer < 0)
+	{
+		xnLogWarning(XN_MASK_SHM, "'%s' already has %d consumers", strName, XN_SHM_RING_MAX_CONSUMERS);
+		return ONI_STATUS_ERROR;
+	}
+
+	XnChar strEventName[XN_FILE_MAX_PATH];
+	XnUInt32 nCharsWritten = 0;
+	xnOSStrFormat(strEventName, sizeof(strEventName), &nCharsWritten, XN_SHM_RING_EVENT_NAME_FORMAT, strName, nConsumer);
+	XnStatus nRetVal = xnOSOpenNamedEvent(&m_hEvent, strEventName);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogWarning(XN_MASK_SHM, "Failed to open event '%s': %s", strEventName, xnGetStatusString(nRetVal));
+		return ONI_STATUS_ERROR;
+	}
+
+	m_running = TRUE;
+	nRetVal = xnOSCreateThread(ThreadProc, this, &m_hThread);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		m_running = FALSE;
+		return ONI_STATUS_ERROR;
+	}
+
+	return ONI_STATUS_OK;
+}
+
+OniStatus ShmDevice::getSensorInfoList(OniSensorInfo** pSensors, int* numSensors)
+{
+	*pSensors = m_sensors;
+	*numSensors = m_numSensors;
+	return ONI_STATUS_OK;
+}
+
+driver::StreamBase* ShmDevice::createStream(OniSensorType sensorType)
+{
+	for (int i = 0; i < m_numSensors; ++i)
+	{
+		if (m_sensors[i].sensorType == sensorType)
+		{
+			ShmStream* pStream = XN_NEW(ShmStream, m_pMapping, m_sensorStreams[i]);
+			if (pStream != NULL)
+			{
+				xnl::AutoCSLocker lock(m_cs);
+				m_streams[m_sensorStreams[i]].AddLast(pStream);
+			}
+			return pStream;
+		}
+	}
+
+	return NULL;
+}
+
+void ShmDevice::destroyStream(driver::StreamBase* pStream)
+{
+	ShmStream* pShmStream = (ShmStream*)pStream;
+	{
+		xnl::AutoCSLocker lock(m_cs);
+		for (XnUInt32 i = 0; i < XN_SHM_RING_MAX_STREAMS; ++i)
+		{
+			m_streams[i].Remove(pShmStream);
+		}
+	}
+
+	XN_DELETE(pShmStream);
+}
+
+XN_THREAD_PROC ShmDevice::ThreadProc(XN_THREAD_PARAM pThreadParam)
+{
+	ShmDevice* pThis = (ShmDevice*)pThreadParam;
+	pThis->MainLoop();
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+void ShmDevice::MainLoop()
+{
+	while (m_running)
+	{
+		// A timeout is not an error: a stopped publisher may never set the event again.
+		// Waking up anyway also keeps our heartbeat going.
+		xnOSWaitEvent(m_hEvent, XN_SHM_CONSUMER_HEARTBEAT_INTERVAL);
+		if (!m_running)
+		{
+			break;
+		}
+
+		if (!m_pMapping->Heartbeat())
+		{
+			xnLogWarning(XN_MASK_SHM, "Publisher dropped us for not responding, no more frames will arrive");
+			break;
+		}
+
+		{
+			xnl::AutoCSLocker lock(m_cs);
+			for (XnUInt32 i = 0; i < XN_SHM_RING_MAX_STREAMS; ++i)
+			{
+				for (xnl::List<ShmStream*>::Iterator iter = m_streams[i].Begin(); iter != m_streams[i].End(); ++iter)
+				{
+					(*iter)->DeliverFrames();
+				}
+			}
+		}
+
+		if (!m_pMapping->IsPublisherAlive())
+		{
+			xnLogWarning(XN_MASK_SHM, "Publisher is gone, no more frames will arrive");
+			break;
+		}
+	}
+}
+
+} // namespace oni_shm
@@ -0,0 +1,72 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Contains the declaration of ShmDevice class that implements a device whose
+/// streams are published by another process.
+
+#ifndef __SHM_DEVICE_H__
+#define __SHM_DEVICE_H__
+
+#include "Driver/OniDriverAPI.h"
+#include "XnOSCpp.h"
+#include "XnList.h"
+#include "ShmStream.h"
+
+namespace oni_shm {
+
+/// A device exposing the streams of a frame ring. Registers as one of the
+/// ring's consumers, and runs a thread that hands new frames to the streams.
+class ShmDevice : public oni::driver::DeviceBase
+{
+public:
+	ShmDevice(ShmMapping* pMapping);
+	virtual ~ShmDevice();
+
+	OniStatus Initialize(const XnChar* strName);
+
+	virtual OniStatus getSensorInfoList(OniSensorInfo** pSensors, int* numSensors);
+
+	virtual oni::driver::StreamBase* createStream(OniSensorType sensorType);
+	virtual void destroyStream(oni::driver::StreamBase* pStream);
+
+private:
+	static XN_THREAD_PROC ThreadProc(XN_THREAD_PARAM pThreadParam);
+	void MainLoop();
+
+	ShmMapping* m_pMapping;
+
+	OniSensorInfo m_sensors[XN_SHM_RING_MAX_STREAMS];
+	OniVideoMode m_videoModes[XN_SHM_RING_MAX_STREAMS];
+	XnUInt32 m_sensorStreams[XN_SHM_RING_MAX_STREAMS];
+	int m_numSensors;
+
+	// Streams created on each stream of the ring.
+	xnl::CriticalSection m_cs;
+	xnl::List<ShmStream*> m_streams[XN_SHM_RING_MAX_STREAMS];
+
+	XN_EVENT_HANDLE m_hEvent;
+	XN_THREAD_HANDLE m_hThread;
+	volatile XnBool m_running;
+};
+
+} // namespace oni_shm
+
+#endif // __SHM_DEVICE_H__
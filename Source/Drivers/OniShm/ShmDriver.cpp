@@ -0,0 +1,135 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Contains the definition of ShmDriver class.
+
+#include "ShmDriver.h"
+#include "ShmDevice.h"
+
+namespace oni_shm {
+
+namespace driver = oni::driver;
+
+namespace {
+
+const XnChar kVendorString[] = "OpenNI";
+const XnChar kDeviceName[] = "Shared Memory";
+
+// Returns the ring name of a shm:// URI, or NULL if the URI is not one.
+const XnChar* GetRingName(const char* strUri)
+{
+	if (strUri == NULL)
+	{
+		return NULL;
+	}
+
+	XnUInt32 nPrefixLength = xnOSStrLen(XN_SHM_URI_PREFIX);
+	if (xnOSMemCmp(strUri, XN_SHM_URI_PREFIX, nPrefixLength) != 0 || strUri[nPrefixLength] == '\0')
+	{
+		return NULL;
+	}
+	return strUri + nPrefixLength;
+}
+
+} // namespace
+
+ShmDriver::ShmDriver(OniDriverServices* pDriverServices) : driver::DriverBase(pDriverServices)
+{
+}
+
+driver::DeviceBase* ShmDriver::deviceOpen(const char* strUri, const char* /*mode*/)
+{
+	const XnChar* strName = GetRingName(strUri);
+	if (strName == NULL)
+	{
+		return NULL;
+	}
+
+	ShmMapping* pMapping = ShmMapping::Open(strName);
+	if (pMapping == NULL)
+	{
+		return NULL;
+	}
+
+	// The device takes its own reference.
+	ShmDevice* pDevice = XN_NEW(ShmDevice, pMapping);
+	pMapping->Release();
+	if (pDevice == NULL)
+	{
+		return NULL;
+	}
+
+	if (pDevice->Initialize(strName) != ONI_STATUS_OK)
+	{
+		XN_DELETE(pDevice);
+		return NULL;
+	}
+
+	return pDevice;
+}
+
+void ShmDriver::deviceClose(driver::DeviceBase* pDevice)
+{
+	XN_DELETE(pDevice);
+}
+
+void ShmDriver::shutdown()
+{
+	for (xnl::List<OniDeviceInfo*>::Iterator iter = m_deviceInfos.Begin(); iter != m_deviceInfos.End(); ++iter)
+	{
+		XN_DELETE(*iter);
+	}
+	m_deviceInfos.Clear();
+}
+
+OniStatus ShmDriver::tryDevice(const char* strUri)
+{
+	const XnChar* strName = GetRingName(strUri);
+	if (strName == NULL)
+	{
+		return DriverBase::tryDevice(strUri);
+	}
+
+	ShmMapping* pMapping = ShmMapping::Open(strName);
+	if (pMapping == NULL)
+	{
+		return DriverBase::tryDevice(strUri);
+	}
+	pMapping->Release();
+
+	OniDeviceInfo* pInfo = XN_NEW(OniDeviceInfo);
+	if (pInfo == NULL)
+	{
+		return ONI_STATUS_ERROR;
+	}
+	xnOSMemSet(pInfo, 0, sizeof(*pInfo));
+	xnOSStrCopy(pInfo->uri,    strUri,        ONI_MAX_STR);
+	xnOSStrCopy(pInfo->vendor, kVendorString, ONI_MAX_STR);
+	xnOSStrCopy(pInfo->name,   kDeviceName,   ONI_MAX_STR);
+	m_deviceInfos.AddLast(pInfo);
+
+	deviceConnected(pInfo);
+	return ONI_STATUS_OK;
+}
+
+} // namespace oni_shm
+
+ONI_EXPORT_DRIVER(oni_shm::ShmDriver)
@@ -0,0 +1,54 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Contains the declaration of ShmDriver class that implements an OpenNI driver
+/// exposing the frames published by other processes as devices.
+
+#ifndef __SHM_DRIVER_H__
+#define __SHM_DRIVER_H__
+
+#include "Driver/OniDriverAPI.h"
+#include "XnList.h"
+
+namespace oni_shm {
+
+/// Opens shm://<name> URIs. Each one is the frame ring of a frame publisher
+/// running in another process on the same machine.
+class ShmDriver : public oni::driver::DriverBase
+{
+public:
+	ShmDriver(OniDriverServices* pDriverServices);
+
+	virtual oni::driver::DeviceBase* deviceOpen(const char* strUri, const char* mode);
+	virtual void deviceClose(oni::driver::DeviceBase* pDevice);
+
+	virtual void shutdown();
+
+	/// Reports the device as connected if the URI names a running publisher.
+	virtual OniStatus tryDevice(const char* strUri);
+
+private:
+	xnl::List<OniDeviceInfo*> m_deviceInfos;
+};
+
+} // namespace oni_shm
+
+#endif // __SHM_DRIVER_H__
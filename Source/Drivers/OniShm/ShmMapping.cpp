@@ -0,0 +1,231 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Contains the definition of ShmMapping class.
+
+#include "ShmMapping.h"
+#include "XnLog.h"
+
+#define XN_MASK_SHM "OniShm"
+
+namespace oni_shm {
+
+ShmMapping* ShmMapping::Open(const XnChar* strName)
+{
+	XnChar strMemoryName[XN_FILE_MAX_PATH];
+	XnUInt32 nCharsWritten = 0;
+	XnStatus nRetVal = xnOSStrFormat(strMemoryName, sizeof(strMemoryName), &nCharsWritten, XN_SHM_RING_MEMORY_NAME_FORMAT, strName);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		return NULL;
+	}
+
+	XN_SHARED_MEMORY_HANDLE hSharedMemory = NULL;
+	nRetVal = xnOSOpenSharedMemory(strMemoryName, XN_OS_FILE_READ | XN_OS_FILE_WRITE, &hSharedMemory);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		return NULL;
+	}
+
+	ShmRingHeader* pHeader = NULL;
+	xnOSSharedMemoryGetAddress(hSharedMemory, (void**)&pHeader);
+	if (pHeader == NULL || pHeader->magic != XN_SHM_RING_MAGIC || pHeader->version != XN_SHM_RING_VERSION ||
+		pHeader->numStreams > XN_SHM_RING_MAX_STREAMS || !pHeader->publisherAlive)
+	{
+		xnLogWarning(XN_MASK_SHM, "'%s' is not a frame ring of a running publisher", strMemoryName);
+		xnOSCloseSharedMemory(hSharedMemory);
+		return NULL;
+	}
+
+	// Slot data is handed to the application from a mapping it can't write to.
+	XN_SHARED_MEMORY_HANDLE hReadOnlyMemory = NULL;
+	nRetVal = xnOSOpenSharedMemory(strMemoryName, XN_OS_FILE_READ, &hReadOnlyMemory);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnOSCloseSharedMemory(hSharedMemory);
+		return NULL;
+	}
+
+	const XnUInt8* pReadOnly = NULL;
+	xnOSSharedMemoryGetAddress(hReadOnlyMemory, (void**)&pReadOnly);
+
+	ShmMapping* pMapping = XN_NEW(ShmMapping, hSharedMemory, pHeader, hReadOnlyMemory, pReadOnly);
+	if (pMapping == NULL)
+	{
+		xnOSCloseSharedMemory(hReadOnlyMemory);
+		xnOSCloseSharedMemory(hSharedMemory);
+	}
+	return pMapping;
+}
+
+ShmMapping::~ShmMapping()
+{
+	if (m_nConsumer >= 0)
+	{
+		xnOSAtomicCompareExchange(&m_pHeader->consumers[m_nConsumer], 0, 1);
+	}
+
+	xnOSCloseSharedMemory(m_hReadOnlyMemory);
+	xnOSCloseSharedMemory(m_hSharedMemory);
+}
+
+const void* ShmMapping::GetSlotData(XnUInt32 nStream, XnUInt32 nSlot)
+{
+	return m_pReadOnly + ((XnUInt8*)ShmGetSlotData(m_pHeader, nStream, nSlot) - (XnUInt8*)m_pHeader);
+}
+
+void ShmMapping::AddRef()
+{
+	xnOSAtomicIncrement(&m_refCount);
+}
+
+void ShmMapping::Release()
+{
+	if (xnOSAtomicDecrement(&m_refCount) == 0)
+	{
+		XN_DELETE(this);
+	}
+}
+
+XnInt32 ShmMapping::RegisterConsumer()
+{
+	for (XnUInt32 i = 0; i < XN_SHM_RING_MAX_CONSUMERS; ++i)
+	{
+		// Bump the heartbeat first, so the publisher never sees the new consumer
+		// with the heartbeat of the previous one.
+		xnOSAtomicIncrement(&m_pHeader->consumerHeartbeats[i]);
+		if (xnOSAtomicCompareExchange(&m_pHeader->consumers[i], 1, 0) == 0)
+		{
+			m_nConsumer = i;
+			break;
+		}
+	}
+
+	return m_nConsumer;
+}
+
+XnBool ShmMapping::Heartbeat()
+{
+	xnOSAtomicIncrement(&m_pHeader->consumerHeartbeats[m_nConsumer]);
+	return m_pHeader->consumers[m_nConsumer] != 0;
+}
+
+XnInt32 ShmMapping::AcquireNextSlot(XnUInt32 nStream, XnUInt32 nLastSequence)
+{
+	ShmSlot* pSlots = ShmGetSlots(m_pHeader, nStream);
+	XnUInt32 numSlots = m_pHeader->streams[nStream].numSlots;
+
+	for (;;)
+	{
+		// Find the oldest newer frame.
+		XnInt32 nNext = -1;
+		XnUInt32 nNextSequence = 0;
+		for (XnUInt32 i = 0; i < numSlots; ++i)
+		{
+			XnUInt32 nSequence = pSlots[i].sequence;
+			if (pSlots[i].state >= 0 && nSequence != 0 && (XnInt32)(nSequence - nLastSequence) > 0 &&
+				(nNext < 0 || (XnInt32)(nSequence - nNextSequence) < 0))
+			{
+				nNext = i;
+				nNextSequence = nSequence;
+			}
+		}
+
+		if (nNext < 0)
+		{
+			return -1;
+		}
+
+		// Hold it, unless the publisher took it meanwhile.
+		volatile XnInt32* pState = &pSlots[nNext].state;
+		XnInt32 nState = *pState;
+		if (nState < 0 || xnOSAtomicCompareExchange(pState, nState + 1, nState) != nState)
+		{
+			continue;
+		}
+		xnOSAtomicIncrement(&pSlots[nNext].holders[m_nConsumer]);
+
+		// The publisher may have rewritten the slot between the scan and the exchange.
+		if (pSlots[nNext].sequence != nNextSequence)
+		{
+			ReleaseSlot(nStream, nNext);
+			continue;
+		}
+
+		return nNext;
+	}
+}
+
+XnUInt32 ShmMapping::GetLatestSequence(XnUInt32 nStream)
+{
+	ShmSlot* pSlots = ShmGetSlots(m_pHeader, nStream);
+	XnUInt32 nLatest = 0;
+	for (XnUInt32 i = 0; i < m_pHeader->streams[nStream].numSlots; ++i)
+	{
+		XnUInt32 nSequence = pSlots[i].sequence;
+		if (nSequence != 0 && (nLatest == 0 || (XnInt32)(nSequence - nLatest) > 0))
+		{
+			nLatest = nSequence;
+		}
+	}
+	return nLatest;
+}
+
+void ShmMapping::ReleaseSlot(XnUInt32 nStream, XnUInt32 nSlot)
+{
+	ShmSlot& slot = ShmGetSlots(m_pHeader, nStream)[nSlot];
+
+	// If the publisher took our holds back, the slot is not ours to release anymore.
+	volatile XnInt32* pHolds = &slot.holders[m_nConsumer];
+	XnInt32 nHolds;
+	do
+	{
+		nHolds = *pHolds;
+		if (nHolds <= 0)
+		{
+			return;
+		}
+	} while (xnOSAtomicCompareExchange(pHolds, nHolds - 1, nHolds) != nHolds);
+
+	xnOSAtomicDecrement(&slot.state);
+}
+
+void ONI_CALLBACK_TYPE ShmMapping::ReleaseFrameBufferCallback(void* pData, void* pCookie)
+{
+	ShmMapping* pThis = (ShmMapping*)pCookie;
+	ShmRingHeader* pHeader = pThis->m_pHeader;
+	const XnUInt8* pBuffer = (const XnUInt8*)pData;
+
+	for (XnUInt32 nStream = 0; nStream < pHeader->numStreams; ++nStream)
+	{
+		const ShmStreamInfo& info = pHeader->streams[nStream];
+		const XnUInt8* pStart = (const XnUInt8*)pThis->GetSlotData(nStream, 0);
+		if (info.numSlots > 0 && pBuffer >= pStart && pBuffer < pStart + (XnSizeT)info.numSlots * info.slotDataSize)
+		{
+			pThis->ReleaseSlot(nStream, (XnUInt32)((pBuffer - pStart) / info.slotDataSize));
+			break;
+		}
+	}
+
+	pThis->Release();
+}
+
+} // namespace oni_shm
@@ -0,0 +1,94 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Contains the declaration of ShmMapping class that maps a frame ring created
+/// by a frame publisher in another process.
+
+#ifndef __SHM_MAPPING_H__
+#define __SHM_MAPPING_H__
+
+#include "Driver/OniShmFrameRing.h"
+#include "XnOS.h"
+
+namespace oni_shm {
+
+/// A reference counted mapping of a frame ring. The device holds one reference,
+/// and each frame pointing into the ring holds another one, along with its slot.
+/// The mapping is registered as one of the ring's consumers until it is freed,
+/// so slots held by frames that outlive the device are still counted as ours.
+/// Frames point into a second, read-only mapping of the ring, so a consumer
+/// can't change a slot other consumers are reading.
+class ShmMapping
+{
+public:
+	/// Maps the ring published under strName. Returns NULL if there is no such
+	/// ring, or if it was created by an incompatible publisher.
+	static ShmMapping* Open(const XnChar* strName);
+
+	void AddRef();
+	void Release();
+
+	ShmRingHeader* GetHeader() { return m_pHeader; }
+
+	/// Returns the data of a slot, as seen through the read-only mapping.
+	const void* GetSlotData(XnUInt32 nStream, XnUInt32 nSlot);
+
+	XnBool IsPublisherAlive() const { return m_pHeader->publisherAlive != 0; }
+
+	/// Takes a free consumer entry of the ring. Returns its index, or -1 if all are taken.
+	XnInt32 RegisterConsumer();
+	XnInt32 GetConsumer() const { return m_nConsumer; }
+
+	/// Lets the publisher know we are alive. Returns FALSE if the publisher
+	/// already gave up on us and released our entry and slots.
+	XnBool Heartbeat();
+
+	/// Holds the oldest frame of the stream that is newer than nLastSequence.
+	/// Returns the slot index, or -1 if there is no such frame.
+	XnInt32 AcquireNextSlot(XnUInt32 nStream, XnUInt32 nLastSequence);
+
+	/// Returns the highest sequence number currently in the stream's slots.
+	XnUInt32 GetLatestSequence(XnUInt32 nStream);
+
+	void ReleaseSlot(XnUInt32 nStream, XnUInt32 nSlot);
+
+	/// Frame buffer free callback for frames pointing into a slot. pCookie is
+	/// the mapping. Releases the slot and the frame's reference to the mapping.
+	static void ONI_CALLBACK_TYPE ReleaseFrameBufferCallback(void* pData, void* pCookie);
+
+private:
+	ShmMapping(XN_SHARED_MEMORY_HANDLE hSharedMemory, ShmRingHeader* pHeader, XN_SHARED_MEMORY_HANDLE hReadOnlyMemory, const XnUInt8* pReadOnly) :
+		m_hSharedMemory(hSharedMemory), m_pHeader(pHeader), m_hReadOnlyMemory(hReadOnlyMemory), m_pReadOnly(pReadOnly), m_nConsumer(-1), m_refCount(1) {}
+	~ShmMapping();
+
+	XN_DISABLE_COPY_AND_ASSIGN(ShmMapping);
+
+	XN_SHARED_MEMORY_HANDLE m_hSharedMemory;
+	ShmRingHeader* m_pHeader;
+	XN_SHARED_MEMORY_HANDLE m_hReadOnlyMemory;
+	const XnUInt8* m_pReadOnly;
+	XnInt32 m_nConsumer;
+	volatile XnInt32 m_refCount; // only modified through xnOSAtomic* functions
+};
+
+} // namespace oni_shm
+
+#endif // __SHM_MAPPING_H__
@@ -0,0 +1,201 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Contains the definition of ShmStream class.
+
+#include "ShmStream.h"
+
+namespace oni_shm {
+
+ShmStream::ShmStream(ShmMapping* pMapping, XnUInt32 nStream) :
+	m_pMapping(pMapping),
+	m_nStream(nStream),
+	m_info(pMapping->GetHeader()->streams[nStream]),
+	m_isStarted(FALSE),
+	m_lastSequence(0)
+{
+	m_pMapping->AddRef();
+}
+
+ShmStream::~ShmStream()
+{
+	stop();
+	m_pMapping->Release();
+}
+
+OniStatus ShmStream::start()
+{
+	xnl::AutoCSLocker lock(m_cs);
+
+	// Frames published before the stream started are not delivered.
+	m_lastSequence = m_pMapping->GetLatestSequence(m_nStream);
+	m_isStarted = TRUE;
+	return ONI_STATUS_OK;
+}
+
+void ShmStream::stop()
+{
+	xnl::AutoCSLocker lock(m_cs);
+	m_isStarted = FALSE;
+}
+
+int ShmStream::getRequiredFrameSize()
+{
+	return m_info.slotDataSize;
+}
+
+OniStatus ShmStream::getProperty(int propertyId, void* pData, int* pDataSize)
+{
+	switch (propertyId)
+	{
+	case ONI_STREAM_PROPERTY_VIDEO_MODE:
+		if (*pDataSize != sizeof(OniVideoMode))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		*(OniVideoMode*)pData = m_info.videoMode;
+		return ONI_STATUS_OK;
+
+	case ONI_STREAM_PROPERTY_HORIZONTAL_FOV:
+	case ONI_STREAM_PROPERTY_VERTICAL_FOV:
+		if (*pDataSize != sizeof(float))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		*(float*)pData = (propertyId == ONI_STREAM_PROPERTY_HORIZONTAL_FOV) ? m_info.horizontalFov : m_info.verticalFov;
+		return ONI_STATUS_OK;
+
+	case ONI_STREAM_PROPERTY_MIN_VALUE:
+	case ONI_STREAM_PROPERTY_MAX_VALUE:
+		if (*pDataSize != sizeof(int))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		*(int*)pData = (propertyId == ONI_STREAM_PROPERTY_MIN_VALUE) ? m_info.minPixelValue : m_info.maxPixelValue;
+		return ONI_STATUS_OK;
+
+	case ONI_STREAM_PROPERTY_CROPPING:
+		if (*pDataSize != sizeof(OniCropping))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+		xnOSMemSet(pData, 0, sizeof(OniCropping));
+		return ONI_STATUS_OK;
+
+	default:
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+}
+
+OniStatus ShmStream::setProperty(int propertyId, const void* pData, int dataSize)
+{
+	// The publisher owns the device, so only the published mode can be "set".
+	if (propertyId == ONI_STREAM_PROPERTY_VIDEO_MODE && dataSize == sizeof(OniVideoMode))
+	{
+		const OniVideoMode* pMode = (const OniVideoMode*)pData;
+		if (pMode->pixelFormat == m_info.videoMode.pixelFormat &&
+			pMode->resolutionX == m_info.videoMode.resolutionX &&
+			pMode->resolutionY == m_info.videoMode.resolutionY &&
+			pMode->fps == m_info.videoMode.fps)
+		{
+			return ONI_STATUS_OK;
+		}
+	}
+
+	return ONI_STATUS_NOT_SUPPORTED;
+}
+
+OniBool ShmStream::isPropertySupported(int propertyId)
+{
+	return (propertyId == ONI_STREAM_PROPERTY_VIDEO_MODE ||
+		propertyId == ONI_STREAM_PROPERTY_HORIZONTAL_FOV ||
+		propertyId == ONI_STREAM_PROPERTY_VERTICAL_FOV ||
+		propertyId == ONI_STREAM_PROPERTY_MIN_VALUE ||
+		propertyId == ONI_STREAM_PROPERTY_MAX_VALUE ||
+		propertyId == ONI_STREAM_PROPERTY_CROPPING);
+}
+
+void ShmStream::DeliverFrames()
+{
+	xnl::AutoCSLocker lock(m_cs);
+	if (!m_isStarted)
+	{
+		return;
+	}
+
+	XnInt32 nSlot;
+	while ((nSlot = m_pMapping->AcquireNextSlot(m_nStream, m_lastSequence)) >= 0)
+	{
+		DeliverSlot(nSlot);
+	}
+}
+
+void ShmStream::DeliverSlot(XnUInt32 nSlot)
+{
+	// The publisher may rewrite the slot as soon as we release it, so work on a copy
+	// of its metadata.
+	ShmSlot slot = ShmGetSlots(m_pMapping->GetHeader(), m_nStream)[nSlot];
+	void* pData = const_cast<void*>(m_pMapping->GetSlotData(m_nStream, nSlot));
+	m_lastSequence = slot.sequence;
+
+	// Let the frame point into the slot (read-only, as other consumers may be
+	// reading it too). The frame holds the slot and the mapping until it is released. If the application allocates its own frame
+	// buffers, copy the data and free the slot right away.
+	m_pMapping->AddRef();
+	OniFrame* pFrame = getServices().acquireExternalFrame(pData, slot.dataSize, ShmMapping::ReleaseFrameBufferCallback, m_pMapping);
+	if (pFrame == NULL)
+	{
+		m_pMapping->Release();
+
+		pFrame = getServices().acquireFrame();
+		if (pFrame != NULL && pFrame->dataSize >= (int)slot.dataSize)
+		{
+			xnOSMemCopy(pFrame->data, pData, slot.dataSize);
+			pFrame->dataSize = slot.dataSize;
+		}
+		else if (pFrame != NULL)
+		{
+			getServices().releaseFrame(pFrame);
+			pFrame = NULL;
+		}
+		m_pMapping->ReleaseSlot(m_nStream, nSlot);
+	}
+
+	if (pFrame == NULL)
+	{
+		return;
+	}
+
+	pFrame->frameIndex = slot.frameIndex;
+	pFrame->timestamp = slot.timestamp;
+	pFrame->videoMode = slot.videoMode;
+	pFrame->width = slot.width;
+	pFrame->height = slot.height;
+	pFrame->stride = slot.stride;
+	pFrame->croppingEnabled = slot.croppingEnabled;
+	pFrame->cropOriginX = slot.cropOriginX;
+	pFrame->cropOriginY = slot.cropOriginY;
+
+	raiseNewFrame(pFrame);
+	getServices().releaseFrame(pFrame);
+}
+
+} // namespace oni_shm
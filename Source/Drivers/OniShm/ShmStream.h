@@ -0,0 +1,68 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+/// @file
+/// Contains the declaration of ShmStream class that implements a stream whose
+/// frames are read from a frame ring in shared memory.
+
+#ifndef __SHM_STREAM_H__
+#define __SHM_STREAM_H__
+
+#include "Driver/OniDriverAPI.h"
+#include "XnOSCpp.h"
+#include "ShmMapping.h"
+
+namespace oni_shm {
+
+/// A stream of a published ring. The device's reader thread hands it new
+/// frames, which point directly into the ring's slots.
+class ShmStream : public oni::driver::StreamBase
+{
+public:
+	ShmStream(ShmMapping* pMapping, XnUInt32 nStream);
+	virtual ~ShmStream();
+
+	virtual OniStatus start();
+	virtual void stop();
+
+	virtual int getRequiredFrameSize();
+
+	virtual OniStatus getProperty(int propertyId, void* pData, int* pDataSize);
+	virtual OniStatus setProperty(int propertyId, const void* pData, int dataSize);
+	virtual OniBool isPropertySupported(int propertyId);
+
+	/// Raises all frames published since the last call. Called by the device's reader thread.
+	void DeliverFrames();
+
+private:
+	void DeliverSlot(XnUInt32 nSlot);
+
+	ShmMapping* m_pMapping;
+	XnUInt32 m_nStream;
+	const ShmStreamInfo& m_info;
+
+	xnl::CriticalSection m_cs;
+	XnBool m_isStarted;
+	XnUInt32 m_lastSequence;
+};
+
+} // namespace oni_shm
+
+#endif // __SHM_STREAM_H__
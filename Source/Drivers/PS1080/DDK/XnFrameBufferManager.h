@@ -61,6 +61,12 @@ public:
 		return m_pWorkingBuffer;
 	}
 
+	/* Stamps the write frame with the host time it reached a stage (see ONI_STREAM_PROPERTY_LATENCY_TRACKING). */
+	inline void SetWriteFrameStageTimestamp(OniFrameStage stage, XnUInt64 nTimestamp)
+	{
+		m_pServices->setFrameStageTimestamp(m_pWorkingBuffer, stage, nTimestamp);
+	}
+
 	void MarkWriteBufferAsStable(XnUInt32* pnFrameID);
 
 	inline XnUInt32 GetLastFrameID() const { return m_nStableFrameID; }
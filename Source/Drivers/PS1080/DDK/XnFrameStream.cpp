@@ -30,9 +30,12 @@ XnFrameStream::XnFrameStream(const XnChar* csType, const XnChar* csName) :
 	XnDeviceStream(csType, csName),
 	m_nLastReadFrame(0),
 	m_IsFrameStream(XN_STREAM_PROPERTY_IS_FRAME_BASED, "IsFrameBased", TRUE),
-	m_FPS(XN_STREAM_PROPERTY_FPS, "FPS", 0)
+	m_FPS(XN_STREAM_PROPERTY_FPS, "FPS", 0),
+	m_DriverStats(ONI_STREAM_PROPERTY_DRIVER_STATS, "DriverStats")
 {
+	xnOSMemSet(&m_driverStats, 0, sizeof(m_driverStats));
 	m_FPS.UpdateSetCallback(SetFPSCallback, this);
+	m_DriverStats.UpdateGetCallback(GetDriverStatsCallback, this);
 }
 
 XnStatus XnFrameStream::Init()
@@ -49,7 +52,7 @@ XnStatus XnFrameStream::Init()
 	// register for new data events
 	m_bufferManager.SetNewFrameCallback(OnTripleBufferNewData, this);
 
-	XN_VALIDATE_ADD_PROPERTIES(this, &m_IsFrameStream, &m_FPS );
+	XN_VALIDATE_ADD_PROPERTIES(this, &m_IsFrameStream, &m_FPS, &m_DriverStats);
 
 	return (XN_STATUS_OK);
 }
@@ -89,6 +92,18 @@ XnStatus XN_CALLBACK_TYPE XnFrameStream::SetFPSCallback(XnActualIntProperty* /*p
 	return pThis->SetFPS((XnUInt32)nValue);
 }
 
+XnStatus XN_CALLBACK_TYPE XnFrameStream::GetDriverStatsCallback(const XnGeneralProperty* /*pSender*/, const OniGeneralBuffer& gbValue, void* pCookie)
+{
+	XnFrameStream* pThis = (XnFrameStream*)pCookie;
+	if (gbValue.dataSize != sizeof(OniStreamDriverStats))
+	{
+		return XN_STATUS_DEVICE_PROPERTY_SIZE_DONT_MATCH;
+	}
+
+	*(OniStreamDriverStats*)gbValue.data = pThis->m_driverStats;
+	return XN_STATUS_OK;
+}
+
 void XN_CALLBACK_TYPE XnFrameStream::OnTripleBufferNewData(OniFrame* pFrame, void* pCookie)
 {
 	XnFrameStream* pThis = (XnFrameStream*)pCookie;
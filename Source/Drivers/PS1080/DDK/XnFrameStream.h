@@ -26,6 +26,7 @@
 //---------------------------------------------------------------------------
 #include "XnDeviceStream.h"
 #include "XnFrameBufferManager.h"
+#include "XnGeneralProperty.h"
 #include "Driver/OniDriverTypes.h"
 
 //---------------------------------------------------------------------------
@@ -44,6 +45,12 @@ public:
 	//---------------------------------------------------------------------------
 	inline XnUInt32 GetFPS() const { return (XnUInt32)m_FPS.GetValue(); }
 
+	//---------------------------------------------------------------------------
+	// Counters (reported by ONI_STREAM_PROPERTY_DRIVER_STATS)
+	//---------------------------------------------------------------------------
+	inline void FrameCorrupted() { ++m_driverStats.corruptedFrames; }
+	inline void TransferErrorOccurred() { ++m_driverStats.transferErrors; }
+
 	//---------------------------------------------------------------------------
 	// Overridden Methods
 	//---------------------------------------------------------------------------
@@ -78,6 +85,7 @@ private:
 
 	static XnStatus XN_CALLBACK_TYPE SetFPSCallback(XnActualIntProperty* pSenser, XnUInt64 nValue, void* pCookie);
 	static void XN_CALLBACK_TYPE OnTripleBufferNewData(OniFrame* pFrame, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE GetDriverStatsCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
 
 	//---------------------------------------------------------------------------
 	// Members
@@ -88,6 +96,9 @@ private:
 
 	XnActualIntProperty m_IsFrameStream;
 	XnActualIntProperty m_FPS;
+	XnGeneralProperty m_DriverStats;
+
+	OniStreamDriverStats m_driverStats;
 };
 
 #endif //__XN_FRAME_STREAM_H__
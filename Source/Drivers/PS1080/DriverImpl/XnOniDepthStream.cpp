@@ -182,3 +182,50 @@ OniStatus XnOniDepthStream::convertDepthToColorCoordinates(StreamBase* colorStre
 	return ONI_STATUS_OK;
 }
 
+OniStatus XnOniDepthStream::prepareDepthFrameToColorCoordinates(StreamBase* colorStream, const OniFrame* /*pDepthFrame*/)
+{
+	// take video mode from the color stream
+	XnOniMapStream* pColorStream = (XnOniMapStream*)colorStream;
+
+	OniVideoMode videoMode;
+	XnStatus retVal = pColorStream->GetVideoMode(&videoMode);
+	if (retVal != XN_STATUS_OK)
+	{
+		XN_ASSERT(FALSE);
+		return ONI_STATUS_ERROR;
+	}
+
+	retVal = ((XnSensorDepthStream*)m_pDeviceStream)->PrepareImageCoordinatesOfDepthRect(videoMode.resolutionX, videoMode.resolutionY);
+	if (retVal == XN_STATUS_DEVICE_UNSUPPORTED_PARAMETER)
+	{
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+	else if (retVal != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+
+	return ONI_STATUS_OK;
+}
+
+OniStatus XnOniDepthStream::convertDepthFrameToColorCoordinates(StreamBase* /*colorStream*/, const OniFrame* pDepthFrame, int firstRow, int rowCount, int* pColorXY)
+{
+	// registration tables are for the full frame
+	XnUInt32 nOriginX = pDepthFrame->croppingEnabled ? pDepthFrame->cropOriginX : 0;
+	XnUInt32 nOriginY = pDepthFrame->croppingEnabled ? pDepthFrame->cropOriginY : 0;
+	const OniDepthPixel* pDepth = (const OniDepthPixel*)((const XnUInt8*)pDepthFrame->data + firstRow * pDepthFrame->stride);
+
+	XnStatus retVal = ((XnSensorDepthStream*)m_pDeviceStream)->GetImageCoordinatesOfDepthRect(pDepth, pDepthFrame->stride,
+		nOriginX, nOriginY + firstRow, pDepthFrame->width, rowCount, pColorXY);
+	if (retVal == XN_STATUS_DEVICE_UNSUPPORTED_PARAMETER)
+	{
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+	else if (retVal != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+
+	return ONI_STATUS_OK;
+}
+
@@ -39,6 +39,8 @@ public:
 	virtual OniBool isPropertySupported(int propertyId);
 	virtual void notifyAllProperties();
 	virtual OniStatus convertDepthToColorCoordinates(StreamBase* colorStream, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY);
+	virtual OniStatus prepareDepthFrameToColorCoordinates(StreamBase* colorStream, const OniFrame* pDepthFrame);
+	virtual OniStatus convertDepthFrameToColorCoordinates(StreamBase* colorStream, const OniFrame* pDepthFrame, int firstRow, int rowCount, int* pColorXY);
 };
 
 #endif // __XN_ONI_DEPTH_STREAM_H__
\ No newline at end of file
@@ -26,77 +26,207 @@
 #include "XnFormats.h"
 #include <XnOS.h>
 #include <XnLog.h>
+#include <XnSIMD.h>
+#ifdef XN_NEON
+#include <arm_neon.h>
+#endif
 
 //---------------------------------------------------------------------------
-// Defines
+// Global Variables
 //---------------------------------------------------------------------------
-#define XN_MIRROR_MAX_LINE_SIZE	1920*3
+// Byte order of 16 bytes of pixels after mirroring them
+static const XnUInt8 g_anMirrorOneByteShuffle[16] = { 15,14,13,12, 11,10,9,8, 7,6,5,4, 3,2,1,0 };
+static const XnUInt8 g_anMirrorTwoByteShuffle[16] = { 14,15, 12,13, 10,11, 8,9, 6,7, 4,5, 2,3, 0,1 };
+// Y1 and Y2 also trade places inside each YUV422 (u, y1, v, y2) or YUYV (y1, u, y2, v) element
+static const XnUInt8 g_anMirrorYUV422Shuffle[16] = { 12,15,14,13, 8,11,10,9, 4,7,6,5, 0,3,2,1 };
+static const XnUInt8 g_anMirrorYUYVShuffle[16] = { 14,13,12,15, 10,9,8,11, 6,5,4,7, 2,1,0,3 };
 
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
-XnStatus XnMirrorOneBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+// The vector code mirrors a line in place, by swapping blocks from both of its ends until less than
+// two blocks are left. The functions return the number of bytes done at each end, and the caller
+// swaps the pixels left in the middle one at a time.
+#if defined(XN_SSE)
+// Mirrors with 16-byte blocks, of pixels whose bytes are reordered by anShuffle
+XN_SSSE3_FUNCTION static XnUInt32 XnMirrorLineEndsSSSE3(XnUInt8* pLine, XnUInt32 nLineBytes, const XnUInt8* anShuffle)
 {
-	// Local function variables
-	XnUInt8* pSrc = pBuffer;
-	XnUInt8 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt8* pSrcEnd = pSrc + nBufferSize;
-	XnUInt8* pDest = NULL;
-	XnUInt8* pDestVal = &pLineBuffer[0] + nLineSize - 1;
-	XnUInt8* pDestEnd = &pLineBuffer[0] - 1;
-
-	if (nLineSize > XN_MIRROR_MAX_LINE_SIZE)
+	const __m128i shuffle = _mm_loadu_si128((const __m128i*)anShuffle);
+
+	XnUInt8* pLeft = pLine;
+	XnUInt8* pRight = pLine + nLineBytes;
+	while (pRight - pLeft >= 32)
+	{
+		pRight -= 16;
+		__m128i left = _mm_loadu_si128((const __m128i*)pLeft);
+		__m128i right = _mm_loadu_si128((const __m128i*)pRight);
+		_mm_storeu_si128((__m128i*)pLeft, _mm_shuffle_epi8(right, shuffle));
+		_mm_storeu_si128((__m128i*)pRight, _mm_shuffle_epi8(left, shuffle));
+		pLeft += 16;
+	}
+
+	return (XnUInt32)(pLeft - pLine);
+}
+
+// Mirrors 16 three-byte pixels (3 vectors)
+XN_SSSE3_FUNCTION static inline void XnMirrorThreeByteBlockSSSE3(__m128i in0, __m128i in1, __m128i in2, XnUInt8* pOut)
+{
+	const __m128i out0From2 = _mm_setr_epi8(13,14,15, 10,11,12, 7,8,9, 4,5,6, 1,2,3, -1);
+	const __m128i out0From1 = _mm_setr_epi8(-1,-1,-1, -1,-1,-1, -1,-1,-1, -1,-1,-1, -1,-1,-1, 14);
+	const __m128i out1From0 = _mm_setr_epi8(-1,-1, -1,-1,-1, -1,-1,-1, -1,-1,-1, -1,-1,-1, 15,-1);
+	const __m128i out1From1 = _mm_setr_epi8(15,-1, 11,12,13, 8,9,10, 5,6,7, 2,3,4, -1,0);
+	const __m128i out1From2 = _mm_setr_epi8(-1,0, -1,-1,-1, -1,-1,-1, -1,-1,-1, -1,-1,-1, -1,-1);
+	const __m128i out2From0 = _mm_setr_epi8(-1, 12,13,14, 9,10,11, 6,7,8, 3,4,5, 0,1,2);
+	const __m128i out2From1 = _mm_setr_epi8(1, -1,-1,-1, -1,-1,-1, -1,-1,-1, -1,-1,-1, -1,-1,-1);
+
+	_mm_storeu_si128((__m128i*)pOut, _mm_or_si128(_mm_shuffle_epi8(in2, out0From2), _mm_shuffle_epi8(in1, out0From1)));
+	_mm_storeu_si128((__m128i*)(pOut + 16), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in0, out1From0), _mm_shuffle_epi8(in1, out1From1)), _mm_shuffle_epi8(in2, out1From2)));
+	_mm_storeu_si128((__m128i*)(pOut + 32), _mm_or_si128(_mm_shuffle_epi8(in0, out2From0), _mm_shuffle_epi8(in1, out2From1)));
+}
+
+// Mirrors with 48-byte blocks of three-byte pixels
+XN_SSSE3_FUNCTION static XnUInt32 XnMirrorThreeByteLineEndsSSSE3(XnUInt8* pLine, XnUInt32 nLineBytes)
+{
+	XnUInt8* pLeft = pLine;
+	XnUInt8* pRight = pLine + nLineBytes;
+	while (pRight - pLeft >= 96)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		pRight -= 48;
+		__m128i left0 = _mm_loadu_si128((const __m128i*)pLeft);
+		__m128i left1 = _mm_loadu_si128((const __m128i*)(pLeft + 16));
+		__m128i left2 = _mm_loadu_si128((const __m128i*)(pLeft + 32));
+		__m128i right0 = _mm_loadu_si128((const __m128i*)pRight);
+		__m128i right1 = _mm_loadu_si128((const __m128i*)(pRight + 16));
+		__m128i right2 = _mm_loadu_si128((const __m128i*)(pRight + 32));
+		XnMirrorThreeByteBlockSSSE3(right0, right1, right2, pLeft);
+		XnMirrorThreeByteBlockSSSE3(left0, left1, left2, pRight);
+		pLeft += 48;
 	}
 
-	while (pSrc < pSrcEnd)
+	return (XnUInt32)(pLeft - pLine);
+}
+#elif defined(XN_NEON)
+// Same as the SSSE3 version, with table lookups
+static XnUInt32 XnMirrorLineEndsNEON(XnUInt8* pLine, XnUInt32 nLineBytes, const XnUInt8* anShuffle)
+{
+	const uint8x8_t shuffleLow = vld1_u8(anShuffle);
+	const uint8x8_t shuffleHigh = vld1_u8(anShuffle + 8);
+
+	XnUInt8* pLeft = pLine;
+	XnUInt8* pRight = pLine + nLineBytes;
+	uint8x8x2_t left;
+	uint8x8x2_t right;
+	while (pRight - pLeft >= 32)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nLineSize);
+		pRight -= 16;
+		left.val[0] = vld1_u8(pLeft);
+		left.val[1] = vld1_u8(pLeft + 8);
+		right.val[0] = vld1_u8(pRight);
+		right.val[1] = vld1_u8(pRight + 8);
+		vst1_u8(pLeft, vtbl2_u8(right, shuffleLow));
+		vst1_u8(pLeft + 8, vtbl2_u8(right, shuffleHigh));
+		vst1_u8(pRight, vtbl2_u8(left, shuffleLow));
+		vst1_u8(pRight + 8, vtbl2_u8(left, shuffleHigh));
+		pLeft += 16;
+	}
 
-		pDest = pDestVal;
-		while (pDest != pDestEnd)
-		{
-			*pSrc = *pDest;
+	return (XnUInt32)(pLeft - pLine);
+}
 
-			pSrc++;
-			pDest--;
-		}
+// Reverses the 16 bytes of each plane of 16 three-byte pixels
+static inline uint8x16x3_t XnMirrorPlanesNEON(uint8x16x3_t planes)
+{
+	for (XnUInt32 i = 0; i < 3; ++i)
+	{
+		uint8x16_t reversed = vrev64q_u8(planes.val[i]);
+		planes.val[i] = vcombine_u8(vget_high_u8(reversed), vget_low_u8(reversed));
 	}
+	return planes;
+}
 
-	// All is good...
-	return (XN_STATUS_OK);
+static XnUInt32 XnMirrorThreeByteLineEndsNEON(XnUInt8* pLine, XnUInt32 nLineBytes)
+{
+	XnUInt8* pLeft = pLine;
+	XnUInt8* pRight = pLine + nLineBytes;
+	while (pRight - pLeft >= 96)
+	{
+		pRight -= 48;
+		uint8x16x3_t left = vld3q_u8(pLeft);
+		uint8x16x3_t right = vld3q_u8(pRight);
+		vst3q_u8(pLeft, XnMirrorPlanesNEON(right));
+		vst3q_u8(pRight, XnMirrorPlanesNEON(left));
+		pLeft += 48;
+	}
+
+	return (XnUInt32)(pLeft - pLine);
 }
+#endif
 
-XnStatus XnMirrorTwoBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+// Returns the number of bytes the vector code mirrored at each end of the line
+static XnUInt32 XnMirrorLineEnds(XnUInt8* pLine, XnUInt32 nLineBytes, const XnUInt8* anShuffle, XnBool bVector)
 {
-	// Local function variables
-	XnUInt16* pSrc = (XnUInt16*)pBuffer;
-	XnUInt16 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt16* pSrcEnd = pSrc + nBufferSize / sizeof(XnUInt16);
-	XnUInt16* pDest = NULL;
-	XnUInt16* pDestVal = &pLineBuffer[0] + nLineSize - 1;
-	XnUInt16* pDestEnd = &pLineBuffer[0] - 1;
-	XnUInt16 nMemCpyLineSize = (XnUInt16)(nLineSize * sizeof(XnUInt16));
-	XnUInt16 nValue;
-
-	if (nLineSize > XN_MIRROR_MAX_LINE_SIZE)
+	if (!bVector)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		return 0;
 	}
+#if defined(XN_SSE)
+	return XnMirrorLineEndsSSSE3(pLine, nLineBytes, anShuffle);
+#elif defined(XN_NEON)
+	return XnMirrorLineEndsNEON(pLine, nLineBytes, anShuffle);
+#else
+	XN_REFERENCE_VARIABLE(pLine);
+	XN_REFERENCE_VARIABLE(nLineBytes);
+	XN_REFERENCE_VARIABLE(anShuffle);
+	return 0;
+#endif
+}
 
-	while (pSrc < pSrcEnd)
+static XnUInt32 XnMirrorThreeByteLineEnds(XnUInt8* pLine, XnUInt32 nLineBytes, XnBool bVector)
+{
+	if (!bVector)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
+		return 0;
+	}
+#if defined(XN_SSE)
+	return XnMirrorThreeByteLineEndsSSSE3(pLine, nLineBytes);
+#elif defined(XN_NEON)
+	return XnMirrorThreeByteLineEndsNEON(pLine, nLineBytes);
+#else
+	XN_REFERENCE_VARIABLE(pLine);
+	XN_REFERENCE_VARIABLE(nLineBytes);
+	return 0;
+#endif
+}
 
-		pDest = pDestVal;
-		while (pDest != pDestEnd)
-		{
-			nValue = pDest[0];
-			pSrc[0] = nValue;
+static XnBool XnMirrorCanUseVectors()
+{
+#if defined(XN_SSE)
+	return (xnOSGetCPUFeatures() & XN_CPU_FEATURE_SSSE3) != 0;
+#elif defined(XN_NEON)
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+XnStatus XnMirrorOneBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+{
+	// Local function variables
+	XnUInt8* pLine = pBuffer;
+	XnUInt8* pBufferEnd = pBuffer + nBufferSize;
+	XnBool bVector = XnMirrorCanUseVectors();
 
-			pDest--;
-			pSrc++;
+	for (; pLine + nLineSize <= pBufferEnd; pLine += nLineSize)
+	{
+		XnUInt32 nDone = XnMirrorLineEnds(pLine, nLineSize, g_anMirrorOneByteShuffle, bVector);
+
+		XnUInt8* pLeft = pLine + nDone;
+		XnUInt8* pRight = pLine + nLineSize - nDone - 1;
+		for (; pLeft < pRight; ++pLeft, --pRight)
+		{
+			XnUInt8 nValue = *pLeft;
+			*pLeft = *pRight;
+			*pRight = nValue;
 		}
 	}
 
@@ -104,35 +234,25 @@ XnStatus XnMirrorTwoBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32
 	return (XN_STATUS_OK);
 }
 
-XnStatus XnMirrorThreeBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+XnStatus XnMirrorTwoBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
 {
 	// Local function variables
-	XnUInt8* pSrc = pBuffer;
-	XnUInt8 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt8* pSrcEnd = pSrc + nBufferSize;
-	XnUInt8* pDest = NULL;
-	XnUInt8* pDestVal = &pLineBuffer[0] + nLineSize * 3 - 1;
-	XnUInt8* pDestEnd = &pLineBuffer[0] - 1;
-	XnUInt16 nMemCpyLineSize = (XnUInt16)(nLineSize * 3);
-
-	if (nMemCpyLineSize > XN_MIRROR_MAX_LINE_SIZE)
-	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
-	}
+	XnUInt32 nLineBytes = nLineSize * sizeof(XnUInt16);
+	XnUInt8* pLine = pBuffer;
+	XnUInt8* pBufferEnd = pBuffer + nBufferSize;
+	XnBool bVector = XnMirrorCanUseVectors();
 
-	while (pSrc < pSrcEnd)
+	for (; pLine + nLineBytes <= pBufferEnd; pLine += nLineBytes)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
+		XnUInt32 nDone = XnMirrorLineEnds(pLine, nLineBytes, g_anMirrorTwoByteShuffle, bVector);
 
-		pDest = pDestVal;
-		while (pDest != pDestEnd)
+		XnUInt16* pLeft = (XnUInt16*)(pLine + nDone);
+		XnUInt16* pRight = (XnUInt16*)(pLine + nLineBytes - nDone) - 1;
+		for (; pLeft < pRight; ++pLeft, --pRight)
 		{
-			*pSrc = *(pDest-2);
-			*(pSrc+1) = *(pDest-1);
-			*(pSrc+2) = *pDest;
-
-			pSrc+=3;
-			pDest-=3;
+			XnUInt16 nValue = *pLeft;
+			*pLeft = *pRight;
+			*pRight = nValue;
 		}
 	}
 
@@ -140,36 +260,26 @@ XnStatus XnMirrorThreeBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt3
 	return (XN_STATUS_OK);
 }
 
-XnStatus XnMirrorYUV422Pixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+XnStatus XnMirrorThreeBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
 {
 	// Local function variables
-	XnUInt8* pSrc = pBuffer;
-	XnUInt8 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt8* pSrcEnd = (XnUInt8*)pSrc + nBufferSize;
-	XnUInt8* pDest = NULL;
-	XnUInt8* pDestVal = &pLineBuffer[(nLineSize/2-1)*sizeof(XnUInt32)]; // last element
-	XnUInt8* pDestEnd = &pLineBuffer[0]; // first element
-	XnUInt32 nMemCpyLineSize = nLineSize/2*sizeof(XnUInt32);
-
-	if (nMemCpyLineSize > XN_MIRROR_MAX_LINE_SIZE)
-	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
-	}
+	XnUInt32 nLineBytes = nLineSize * 3;
+	XnUInt8* pLine = pBuffer;
+	XnUInt8* pBufferEnd = pBuffer + nBufferSize;
+	XnBool bVector = XnMirrorCanUseVectors();
+	XnUInt8 nValue;
 
-	while (pSrc < pSrcEnd)
+	for (; pLine + nLineBytes <= pBufferEnd; pLine += nLineBytes)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
-		pDest = pDestVal;
+		XnUInt32 nDone = XnMirrorThreeByteLineEnds(pLine, nLineBytes, bVector);
 
-		while (pDest >= pDestEnd)
+		XnUInt8* pLeft = pLine + nDone;
+		XnUInt8* pRight = pLine + nLineBytes - nDone - 3;
+		for (; pLeft < pRight; pLeft += 3, pRight -= 3)
 		{
-			pSrc[0] = pDest[0]; // u
-			pSrc[1] = pDest[3]; // y1 <-> y2
-			pSrc[2] = pDest[2]; // v
-			pSrc[3] = pDest[1]; // y2 <-> y1
-
-			pSrc += 4;
-			pDest -= 4;
+			nValue = pLeft[0]; pLeft[0] = pRight[0]; pRight[0] = nValue;
+			nValue = pLeft[1]; pLeft[1] = pRight[1]; pRight[1] = nValue;
+			nValue = pLeft[2]; pLeft[2] = pRight[2]; pRight[2] = nValue;
 		}
 	}
 
@@ -177,38 +287,51 @@ XnStatus XnMirrorYUV422Pixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 n
 	return (XN_STATUS_OK);
 }
 
-XnStatus XnMirrorYUYVPixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+// Mirrors a line of elements of two pixels, whose Y values are at nY1 and nY2 and chroma at nU and nV
+static void XnMirrorYUVElementPixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize, const XnUInt8* anShuffle,
+									 XnUInt32 nY1, XnUInt32 nU, XnUInt32 nY2, XnUInt32 nV)
 {
 	// Local function variables
-	XnUInt8* pSrc = pBuffer;
-	XnUInt8 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt8* pSrcEnd = (XnUInt8*)pSrc + nBufferSize;
-	XnUInt8* pDest = NULL;
-	XnUInt8* pDestVal = &pLineBuffer[(nLineSize/2-1)*sizeof(XnUInt32)]; // last element
-	XnUInt8* pDestEnd = &pLineBuffer[0]; // first element
-	XnUInt32 nMemCpyLineSize = nLineSize/2*sizeof(XnUInt32);
-
-	if (nMemCpyLineSize > XN_MIRROR_MAX_LINE_SIZE)
-	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
-	}
+	XnUInt32 nLineBytes = nLineSize/2*sizeof(XnUInt32);
+	XnUInt8* pLine = pBuffer;
+	XnUInt8* pBufferEnd = pBuffer + nBufferSize;
+	XnBool bVector = XnMirrorCanUseVectors();
+	XnUInt8 nValue;
 
-	while (pSrc < pSrcEnd)
+	for (; pLine + nLineBytes <= pBufferEnd; pLine += nLineBytes)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
-		pDest = pDestVal;
+		XnUInt32 nDone = XnMirrorLineEnds(pLine, nLineBytes, anShuffle, bVector);
 
-		while (pDest >= pDestEnd)
+		XnUInt8* pLeft = pLine + nDone;
+		XnUInt8* pRight = pLine + nLineBytes - nDone - 4;
+		for (; pLeft < pRight; pLeft += 4, pRight -= 4)
 		{
-			pSrc[0] = pDest[2]; // y1 <-> y2
-			pSrc[1] = pDest[3]; // u
-			pSrc[2] = pDest[0]; // y2 <-> y1
-			pSrc[3] = pDest[1]; // v
+			nValue = pLeft[nU]; pLeft[nU] = pRight[nU]; pRight[nU] = nValue;
+			nValue = pLeft[nV]; pLeft[nV] = pRight[nV]; pRight[nV] = nValue;
+			nValue = pLeft[nY1]; pLeft[nY1] = pRight[nY2]; pRight[nY2] = nValue; // y1 <-> y2
+			nValue = pLeft[nY2]; pLeft[nY2] = pRight[nY1]; pRight[nY1] = nValue; // y2 <-> y1
+		}
 
-			pSrc += 4;
-			pDest -= 4;
+		// the middle element only swaps its own y1 and y2
+		if (pLeft == pRight)
+		{
+			nValue = pLeft[nY1]; pLeft[nY1] = pLeft[nY2]; pLeft[nY2] = nValue;
 		}
 	}
+}
+
+XnStatus XnMirrorYUV422Pixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+{
+	XnMirrorYUVElementPixels(pBuffer, nBufferSize, nLineSize, g_anMirrorYUV422Shuffle, 1, 0, 3, 2);
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnMirrorYUYVPixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+{
+	// each element (y1, u, y2, v) is written back as (y2, u, y1, v), so the chroma stays in place
+	XnMirrorYUVElementPixels(pBuffer, nBufferSize, nLineSize, g_anMirrorYUYVShuffle, 0, 1, 2, 3);
 
 	// All is good...
 	return (XN_STATUS_OK);
@@ -24,20 +24,120 @@
 
 // Includes
 #include "Bayer.h"
+#include <XnSIMD.h>
 
 #define AVG(a,b) (((int)(a) + (int)(b)) >> 1)
 #define AVG3(a,b,c) (((int)(a) + (int)(b) + (int)(c)) / 3)
 #define AVG4(a,b,c,d) (((int)(a) + (int)(b) + (int)(c) + (int)(d)) >> 2)
 #define WAVG4(a,b,c,d,x,y)  (unsigned char)( ( ((int)(a) + (int)(b)) * (int)(x) + ((int)(c) + (int)(d)) * (int)(y) ) / ( 2 * ((int)(x) + (int(y))) ) )
 
-typedef enum
+// Row pairs debayered by one thread at a time
+#define XN_BAYER_ROW_PAIRS_PER_STRIPE 16
+
+#ifdef XN_SSE
+// Stores 16 pixels of R, G and B planes as RGB888
+XN_SSSE3_FUNCTION static inline void StoreRGB16(unsigned char* rgb_buffer, __m128i r, __m128i g, __m128i b)
+{
+	const __m128i r0 = _mm_setr_epi8(0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1,-1, 5);
+	const __m128i g0 = _mm_setr_epi8(-1,0,-1, -1,1,-1, -1,2,-1, -1,3,-1, -1,4,-1, -1);
+	const __m128i b0 = _mm_setr_epi8(-1,-1,0, -1,-1,1, -1,-1,2, -1,-1,3, -1,-1,4, -1);
+	const __m128i r1 = _mm_setr_epi8(-1,-1,6, -1,-1,7, -1,-1,8, -1,-1,9, -1,-1,10, -1);
+	const __m128i g1 = _mm_setr_epi8(5,-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1, 10);
+	const __m128i b1 = _mm_setr_epi8(-1,5,-1, -1,6,-1, -1,7,-1, -1,8,-1, -1,9,-1, -1);
+	const __m128i r2 = _mm_setr_epi8(-1,11,-1, -1,12,-1, -1,13,-1, -1,14,-1, -1,15,-1, -1);
+	const __m128i g2 = _mm_setr_epi8(-1,-1,11, -1,-1,12, -1,-1,13, -1,-1,14, -1,-1,15, -1);
+	const __m128i b2 = _mm_setr_epi8(10,-1,-1, 11,-1,-1, 12,-1,-1, 13,-1,-1, 14,-1,-1, 15);
+
+	_mm_storeu_si128((__m128i*)rgb_buffer, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r0), _mm_shuffle_epi8(g, g0)), _mm_shuffle_epi8(b, b0)));
+	_mm_storeu_si128((__m128i*)(rgb_buffer + 16), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r1), _mm_shuffle_epi8(g, g1)), _mm_shuffle_epi8(b, b1)));
+	_mm_storeu_si128((__m128i*)(rgb_buffer + 32), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r2), _mm_shuffle_epi8(g, g2)), _mm_shuffle_epi8(b, b2)));
+}
+
+// Interleaves the values of even pixels (low bytes) and odd pixels (high bytes)
+static inline __m128i Interleave(__m128i even, __m128i odd)
 {
-	Bilinear = 0,
-	EdgeAware,
-	EdgeAwareWeighted
-} DebayeringMethod;
+	return _mm_or_si128(even, _mm_slli_epi16(odd, 8));
+}
+
+// Green at a red or blue pixel. The edge aware method takes the direction with the smaller
+// gradient, and both when they are equal. Results are exactly those of AVG/AVG4.
+template <XnBool bEdgeAware>
+XN_SSSE3_FUNCTION static inline __m128i InterpolateGreen(__m128i h0, __m128i h1, __m128i v0, __m128i v1)
+{
+	__m128i avg4 = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(h0, h1), _mm_add_epi16(v0, v1)), 2);
+	if (!bEdgeAware)
+	{
+		return avg4;
+	}
+
+	__m128i dh = _mm_abs_epi16(_mm_sub_epi16(h0, h1));
+	__m128i dv = _mm_abs_epi16(_mm_sub_epi16(v0, v1));
+	__m128i useV = _mm_cmpgt_epi16(dh, dv);
+	__m128i useH = _mm_cmpgt_epi16(dv, dh);
+	__m128i avgH = _mm_srli_epi16(_mm_add_epi16(h0, h1), 1);
+	__m128i avgV = _mm_srli_epi16(_mm_add_epi16(v0, v1), 1);
+
+	return _mm_or_si128(_mm_or_si128(_mm_and_si128(useV, avgV), _mm_and_si128(useH, avgH)), _mm_andnot_si128(_mm_or_si128(useV, useH), avg4));
+}
+
+// Same as the inner loop of the main processing of the bilinear and edge aware methods, for
+// nPixels (a multiple of 16) pixels of a GRGR line and the BGBG line below it. Reads 2 pixels
+// before and 18 pixels after bayer_pixel on each line.
+template <XnBool bEdgeAware>
+XN_SSSE3_FUNCTION static void DebayerLinePairSSSE3(const XnUInt8* bayer_pixel, unsigned char* rgb_buffer, int bayer_line_step, unsigned rgb_line_step, unsigned nPixels)
+{
+	const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+
+	for (unsigned xIdx = 0; xIdx < nPixels; xIdx += 16, bayer_pixel += 16, rgb_buffer += 48)
+	{
+		// lines -1 (BGBG), 0 (GRGR), 1 (BGBG) and 2 (GRGR), at offsets -2, 0 and +2. Even pixels
+		// of a load are its low bytes, odd pixels its high bytes.
+		__m128i up = _mm_loadu_si128((const __m128i*)(bayer_pixel - bayer_line_step));
+		__m128i upNext = _mm_loadu_si128((const __m128i*)(bayer_pixel - bayer_line_step + 2));
+		__m128i line0Prev = _mm_loadu_si128((const __m128i*)(bayer_pixel - 2));
+		__m128i line0 = _mm_loadu_si128((const __m128i*)bayer_pixel);
+		__m128i line0Next = _mm_loadu_si128((const __m128i*)(bayer_pixel + 2));
+		__m128i line1Prev = _mm_loadu_si128((const __m128i*)(bayer_pixel + bayer_line_step - 2));
+		__m128i line1 = _mm_loadu_si128((const __m128i*)(bayer_pixel + bayer_line_step));
+		__m128i line1Next = _mm_loadu_si128((const __m128i*)(bayer_pixel + bayer_line_step + 2));
+		__m128i downPrev = _mm_loadu_si128((const __m128i*)(bayer_pixel + 2 * bayer_line_step - 2));
+		__m128i down = _mm_loadu_si128((const __m128i*)(bayer_pixel + 2 * bayer_line_step));
+
+		__m128i upG = _mm_srli_epi16(up, 8);
+		__m128i upB = _mm_and_si128(up, lowBytes);
+		__m128i upNextB = _mm_and_si128(upNext, lowBytes);
+		__m128i line0PrevR = _mm_srli_epi16(line0Prev, 8);
+		__m128i line0G = _mm_and_si128(line0, lowBytes);
+		__m128i line0R = _mm_srli_epi16(line0, 8);
+		__m128i line0NextG = _mm_and_si128(line0Next, lowBytes);
+		__m128i line1PrevG = _mm_srli_epi16(line1Prev, 8);
+		__m128i line1B = _mm_and_si128(line1, lowBytes);
+		__m128i line1G = _mm_srli_epi16(line1, 8);
+		__m128i line1NextB = _mm_and_si128(line1Next, lowBytes);
+		__m128i downPrevR = _mm_srli_epi16(downPrev, 8);
+		__m128i downG = _mm_and_si128(down, lowBytes);
+		__m128i downR = _mm_srli_epi16(down, 8);
+
+		// GRGR line
+		__m128i r = Interleave(_mm_srli_epi16(_mm_add_epi16(line0PrevR, line0R), 1), line0R);
+		__m128i g = Interleave(line0G, InterpolateGreen<bEdgeAware>(line0G, line0NextG, upG, line1G));
+		__m128i b = Interleave(_mm_srli_epi16(_mm_add_epi16(upB, line1B), 1),
+			_mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(upB, upNextB), _mm_add_epi16(line1B, line1NextB)), 2));
+		StoreRGB16(rgb_buffer, r, g, b);
 
-void fillRGB(unsigned width, unsigned height, const XnUInt8* bayer_pixel, unsigned char* rgb_buffer, DebayeringMethod debayering_method, XnUInt32 nDownSampleStep)
+		// BGBG line
+		r = Interleave(_mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(line0R, downR), _mm_add_epi16(line0PrevR, downPrevR)), 2),
+			_mm_srli_epi16(_mm_add_epi16(line0R, downR), 1));
+		g = Interleave(InterpolateGreen<bEdgeAware>(line1PrevG, line1G, line0G, downG), line1G);
+		b = Interleave(line1B, _mm_srli_epi16(_mm_add_epi16(line1B, line1NextB), 1));
+		StoreRGB16(rgb_buffer + rgb_line_step, r, g, b);
+	}
+}
+#endif
+
+// Debayers the row pairs [nFirstPair, nEndPair) of the image. Each row pair is written by exactly
+// one call, so disjoint ranges may be debayered concurrently.
+static void fillRGB(unsigned width, unsigned height, const XnUInt8* bayer_pixel, unsigned char* rgb_buffer, XnDebayeringMethod debayering_method, XnUInt32 nDownSampleStep, unsigned nFirstPair, unsigned nEndPair)
 {
 	unsigned rgb_line_step = width * 3;
 //---------------------------------------------------------------------------
@@ -51,126 +151,145 @@ void fillRGB(unsigned width, unsigned height, const XnUInt8* bayer_pixel, unsign
 		
 		int bayer_line_step = width;
 		int bayer_line_step2 = width << 1;
+
+		// the first and last row pairs are handled separately from the main processing
+		unsigned nPairs = height / 2;
+		unsigned nMiddleFirst = XN_MAX(nFirstPair, 1) * 2;
+		unsigned nMiddleEnd = XN_MIN(nEndPair, nPairs - 1) * 2;
+
+		bayer_pixel += nFirstPair * bayer_line_step2;
+		rgb_buffer += nFirstPair * 2 * rgb_line_step;
+
+		// pixels [2, 2 + nVectorPixels) of each main processing line pair are done 16 at a time
+		unsigned nVectorPixels = (width > 4) ? ((width - 4) / 16) * 16 : 0;
+#ifdef XN_SSE
+		XnBool bUseSSSE3 = (xnOSGetCPUFeatures() & XN_CPU_FEATURE_SSSE3) != 0;
+#else
+		XN_REFERENCE_VARIABLE(nVectorPixels);
+#endif
 		
-		if (debayering_method == Bilinear)
+		if (debayering_method == XN_DEBAYERING_BILINEAR)
 		{
-			// first two pixel values for first two lines
-			// Bayer         0 1 2
-			//         0     G r g
-			// line_step     b g b
-			// line_step2    g r g
-			
-			rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
-			rgb_buffer[1] = bayer_pixel[0]; // green pixel
-			rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
-			
-			// Bayer         0 1 2
-			//         0     g R g
-			// line_step     b g b
-			// line_step2    g r g
-			//rgb_pixel[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-			rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-			
-			// BGBG line
-			// Bayer         0 1 2
-			//         0     g r g
-			// line_step     B g b
-			// line_step2    g r g
-			rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-			rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
-			//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-			
-			// pixel (1, 1)  0 1 2
-			//         0     g r g
-			// line_step     b G b
-			// line_step2    g r g
-			//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
-			
-			rgb_buffer += 6;
-			bayer_pixel += 2;
-			// rest of the first two lines
-			
-			for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+			if (nFirstPair == 0)
 			{
+				// first two pixel values for first two lines
+				// Bayer         0 1 2
+				//         0     G r g
+				// line_step     b g b
+				// line_step2    g r g
+				
+				rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
+				rgb_buffer[1] = bayer_pixel[0]; // green pixel
+				rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
+				
+				// Bayer         0 1 2
+				//         0     g R g
+				// line_step     b g b
+				// line_step2    g r g
+				//rgb_pixel[3] = bayer_pixel[1];
+				rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+				rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				
+				// BGBG line
+				// Bayer         0 1 2
+				//         0     g r g
+				// line_step     B g b
+				// line_step2    g r g
+				rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+				rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
+				//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+				
+				// pixel (1, 1)  0 1 2
+				//         0     g r g
+				// line_step     b G b
+				// line_step2    g r g
+				//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+				//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+				
+				rgb_buffer += 6;
+				bayer_pixel += 2;
+				// rest of the first two lines
+				
+				for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+				{
+					// GRGR line
+					// Bayer        -1 0 1 2
+					//           0   r G r g
+					//   line_step   g b g b
+					// line_step2    r g r g
+					rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+					rgb_buffer[1] = bayer_pixel[0];
+					rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
+					
+					// Bayer        -1 0 1 2
+					//          0    r g R g
+					//  line_step    g b g b
+					// line_step2    r g r g
+					rgb_buffer[3] = bayer_pixel[1];
+					rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+					rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+					
+					// BGBG line
+					// Bayer         -1 0 1 2
+					//         0      r g r g
+					// line_step      g B g b
+					// line_step2     r g r g
+					rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+					rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+					rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+					
+					// Bayer         -1 0 1 2
+					//         0      r g r g
+					// line_step      g b G b
+					// line_step2     r g r g
+					rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+					rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+					//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+				}
+
+				// last two pixel values for first two lines
 				// GRGR line
-				// Bayer        -1 0 1 2
-				//           0   r G r g
-				//   line_step   g b g b
-				// line_step2    r g r g
+				// Bayer        -1 0 1
+				//           0   r G r
+				//   line_step   g b g
+				// line_step2    r g r
 				rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
 				rgb_buffer[1] = bayer_pixel[0];
-				rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
+				rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
 				
-				// Bayer        -1 0 1 2
-				//          0    r g R g
-				//  line_step    g b g b
-				// line_step2    r g r g
+				// Bayer        -1 0 1
+				//          0    r g R
+				//  line_step    g b g
+				// line_step2    r g r
 				rgb_buffer[3] = bayer_pixel[1];
-				rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-				rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+				//rgb_pixel[5] = bayer_pixel[line_step];
 				
 				// BGBG line
-				// Bayer         -1 0 1 2
-				//         0      r g r g
-				// line_step      g B g b
-				// line_step2     r g r g
+				// Bayer        -1 0 1
+				//          0    r g r
+				//  line_step    g B g
+				// line_step2    r g r
 				rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
 				rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-				rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+				//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
 				
-				// Bayer         -1 0 1 2
-				//         0      r g r g
-				// line_step      g b G b
-				// line_step2     r g r g
+				// Bayer         -1 0 1
+				//         0      r g r
+				// line_step      g b G
+				// line_step2     r g r
 				rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
 				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-				//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+				//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+				
+				bayer_pixel += bayer_line_step + 2;
+				rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
 			}
-
-			// last two pixel values for first two lines
-			// GRGR line
-			// Bayer        -1 0 1
-			//           0   r G r
-			//   line_step   g b g
-			// line_step2    r g r
-			rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-			rgb_buffer[1] = bayer_pixel[0];
-			rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
-			
-			// Bayer        -1 0 1
-			//          0    r g R
-			//  line_step    g b g
-			// line_step2    r g r
-			rgb_buffer[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-			//rgb_pixel[5] = bayer_pixel[line_step];
-			
-			// BGBG line
-			// Bayer        -1 0 1
-			//          0    r g r
-			//  line_step    g B g
-			// line_step2    r g r
-			rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-			rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-			//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-			
-			// Bayer         -1 0 1
-			//         0      r g r
-			// line_step      g b G
-			// line_step2     r g r
-			rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-			
-			bayer_pixel += bayer_line_step + 2;
-			rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
 			
 			// main processing
 			
-			for (yIdx = 2; yIdx < height - 2; yIdx += 2)
+			for (yIdx = nMiddleFirst; yIdx < nMiddleEnd; yIdx += 2)
 			{
 				// first two pixel values
 				// Bayer         0 1 2
@@ -212,7 +331,17 @@ void fillRGB(unsigned width, unsigned height, const XnUInt8* bayer_pixel, unsign
 				rgb_buffer += 6;
 				bayer_pixel += 2;
 				// continue with rest of the line
-				for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+				xIdx = 2;
+#ifdef XN_SSE
+				if (bUseSSSE3)
+				{
+					DebayerLinePairSSSE3<FALSE>(bayer_pixel, rgb_buffer, bayer_line_step, rgb_line_step, nVectorPixels);
+					xIdx += nVectorPixels;
+					rgb_buffer += nVectorPixels * 3;
+					bayer_pixel += nVectorPixels;
+				}
+#endif
+				for (; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
 				{
 					// GRGR line
 					// Bayer        -1 0 1 2
@@ -293,220 +422,226 @@ void fillRGB(unsigned width, unsigned height, const XnUInt8* bayer_pixel, unsign
 				rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
 			}
 			
-			//last two lines
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     G r g
-			// line_step     b g b
-			
-			rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
-			rgb_buffer[1] = bayer_pixel[0]; // green pixel
-			rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
-			
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     g R g
-			// line_step     b g b
-			//rgb_pixel[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
-			rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
-			
-			// BGBG line
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     g r g
-			// line_step     B g b
-			//rgb_pixel[rgb_line_step    ] = bayer_pixel[1];
-			rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-			rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-			
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     g r g
-			// line_step     b G b
-			//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-			
-			rgb_buffer += 6;
-			bayer_pixel += 2;
-			// rest of the last two lines
-			for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+			if (nEndPair == nPairs)
 			{
-				rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-				rgb_buffer[1] = bayer_pixel[0];
-				rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-
-				rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
+				//last two lines
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     G r g
+				// line_step     b g b
+				
+				rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
+				rgb_buffer[1] = bayer_pixel[0]; // green pixel
+				rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
+				
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     g R g
+				// line_step     b g b
+				//rgb_pixel[3] = bayer_pixel[1];
 				rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
-				rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[-bayer_line_step + 2]);
+				rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
+				
+				// BGBG line
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     g r g
+				// line_step     B g b
+				//rgb_pixel[rgb_line_step    ] = bayer_pixel[1];
+				rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+				rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+				
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     g r g
+				// line_step     b G b
+				//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+				rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				
+				rgb_buffer += 6;
+				bayer_pixel += 2;
+				// rest of the last two lines
+				for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+				{
+					rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+					rgb_buffer[1] = bayer_pixel[0];
+					rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
+
+					rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
+					rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
+					rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[-bayer_line_step + 2]);
 
-				rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[-1], bayer_pixel[1]);
+					rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[-1], bayer_pixel[1]);
+					rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+					rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+					
+					// Bayer       -1 0 1 2
+					//        -1    g b g b
+					//         0    r g r g
+					// line_step    g b G b
+					//rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
+					rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+					rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				}
+				
+				// last two pixel values for first two lines
+				// GRGR line
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r G r
+				// line_step    g b g
+				rgb_buffer[rgb_line_step ] = rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+				rgb_buffer[1] = bayer_pixel[0];
+				rgb_buffer[5] = rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
+				
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r g R
+				// line_step    g b g
+				rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
+				rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[-bayer_line_step + 1]);
+				//rgb_pixel[5] = AVG( bayer_pixel[line_step], bayer_pixel[-line_step] );
+				
+				// BGBG line
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r g r
+				// line_step    g B g
+				//rgb_pixel[rgb_line_step    ] = AVG2( bayer_pixel[-1], bayer_pixel[1] );
 				rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-				rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+				rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
 				
-				// Bayer       -1 0 1 2
-				//        -1    g b g b
-				//         0    r g r g
-				// line_step    g b G b
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r g r
+				// line_step    g b G
 				//rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
 				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-				rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
 			}
-			
-			// last two pixel values for first two lines
-			// GRGR line
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r G r
-			// line_step    g b g
-			rgb_buffer[rgb_line_step ] = rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-			rgb_buffer[1] = bayer_pixel[0];
-			rgb_buffer[5] = rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-			
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r g R
-			// line_step    g b g
-			rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[-bayer_line_step + 1]);
-			//rgb_pixel[5] = AVG( bayer_pixel[line_step], bayer_pixel[-line_step] );
-			
-			// BGBG line
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r g r
-			// line_step    g B g
-			//rgb_pixel[rgb_line_step    ] = AVG2( bayer_pixel[-1], bayer_pixel[1] );
-			rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-			rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-			
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r g r
-			// line_step    g b G
-			//rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
 		}
-		else if (debayering_method == EdgeAware)
+		else if (debayering_method == XN_DEBAYERING_EDGE_AWARE)
 		{
 			int dh, dv;
 			
-			// first two pixel values for first two lines
-			// Bayer         0 1 2
-			//         0     G r g
-			// line_step     b g b
-			// line_step2    g r g
-			
-			rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
-			rgb_buffer[1] = bayer_pixel[0]; // green pixel
-			rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
-			
-			// Bayer         0 1 2
-			//         0     g R g
-			// line_step     b g b
-			// line_step2    g r g
-			//rgb_pixel[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-			rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-			
-			// BGBG line
-			// Bayer         0 1 2
-			//         0     g r g
-			// line_step     B g b
-			// line_step2    g r g
-			rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-			rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
-			//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-			
-			// pixel (1, 1)  0 1 2
-			//         0     g r g
-			// line_step     b G b
-			// line_step2    g r g
-			//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
-			
-			rgb_buffer += 6;
-			bayer_pixel += 2;
-			// rest of the first two lines
-			for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+			if (nFirstPair == 0)
 			{
+				// first two pixel values for first two lines
+				// Bayer         0 1 2
+				//         0     G r g
+				// line_step     b g b
+				// line_step2    g r g
+				
+				rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
+				rgb_buffer[1] = bayer_pixel[0]; // green pixel
+				rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
+				
+				// Bayer         0 1 2
+				//         0     g R g
+				// line_step     b g b
+				// line_step2    g r g
+				//rgb_pixel[3] = bayer_pixel[1];
+				rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+				rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				
+				// BGBG line
+				// Bayer         0 1 2
+				//         0     g r g
+				// line_step     B g b
+				// line_step2    g r g
+				rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+				rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
+				//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+				
+				// pixel (1, 1)  0 1 2
+				//         0     g r g
+				// line_step     b G b
+				// line_step2    g r g
+				//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+				//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+				
+				rgb_buffer += 6;
+				bayer_pixel += 2;
+				// rest of the first two lines
+				for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+				{
+					// GRGR line
+					// Bayer        -1 0 1 2
+					//           0   r G r g
+					//   line_step   g b g b
+					// line_step2    r g r g
+					rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+					rgb_buffer[1] = bayer_pixel[0];
+					rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
+					
+					// Bayer        -1 0 1 2
+					//          0    r g R g
+					//  line_step    g b g b
+					// line_step2    r g r g
+					rgb_buffer[3] = bayer_pixel[1];
+					rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+					rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+					
+					// BGBG line
+					// Bayer         -1 0 1 2
+					//         0      r g r g
+					// line_step      g B g b
+					// line_step2     r g r g
+					rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+					rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+					rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+					
+					// Bayer         -1 0 1 2
+					//         0      r g r g
+					// line_step      g b G b
+					// line_step2     r g r g
+					rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+					rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+					//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+				}
+				
+				// last two pixel values for first two lines
 				// GRGR line
-				// Bayer        -1 0 1 2
-				//           0   r G r g
-				//   line_step   g b g b
-				// line_step2    r g r g
+				// Bayer        -1 0 1
+				//           0   r G r
+				//   line_step   g b g
+				// line_step2    r g r
 				rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
 				rgb_buffer[1] = bayer_pixel[0];
-				rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
+				rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
 				
-				// Bayer        -1 0 1 2
-				//          0    r g R g
-				//  line_step    g b g b
-				// line_step2    r g r g
+				// Bayer        -1 0 1
+				//          0    r g R
+				//  line_step    g b g
+				// line_step2    r g r
 				rgb_buffer[3] = bayer_pixel[1];
-				rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-				rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+				//rgb_pixel[5] = bayer_pixel[line_step];
 				
 				// BGBG line
-				// Bayer         -1 0 1 2
-				//         0      r g r g
-				// line_step      g B g b
-				// line_step2     r g r g
+				// Bayer        -1 0 1
+				//          0    r g r
+				//  line_step    g B g
+				// line_step2    r g r
 				rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
 				rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-				rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+				//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
 				
-				// Bayer         -1 0 1 2
-				//         0      r g r g
-				// line_step      g b G b
-				// line_step2     r g r g
+				// Bayer         -1 0 1
+				//         0      r g r
+				// line_step      g b G
+				// line_step2     r g r
 				rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
 				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-				//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+				//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+				
+				bayer_pixel += bayer_line_step + 2;
+				rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
 			}
-			
-			// last two pixel values for first two lines
-			// GRGR line
-			// Bayer        -1 0 1
-			//           0   r G r
-			//   line_step   g b g
-			// line_step2    r g r
-			rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-			rgb_buffer[1] = bayer_pixel[0];
-			rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
-			
-			// Bayer        -1 0 1
-			//          0    r g R
-			//  line_step    g b g
-			// line_step2    r g r
-			rgb_buffer[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-			//rgb_pixel[5] = bayer_pixel[line_step];
-			
-			// BGBG line
-			// Bayer        -1 0 1
-			//          0    r g r
-			//  line_step    g B g
-			// line_step2    r g r
-			rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-			rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-			//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-			
-			// Bayer         -1 0 1
-			//         0      r g r
-			// line_step      g b G
-			// line_step2     r g r
-			rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-			
-			bayer_pixel += bayer_line_step + 2;
-			rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
 			// main processing
-			for (yIdx = 2; yIdx < height - 2; yIdx += 2)
+			for (yIdx = nMiddleFirst; yIdx < nMiddleEnd; yIdx += 2)
 			{
 				// first two pixel values
 				// Bayer         0 1 2
@@ -548,7 +683,17 @@ void fillRGB(unsigned width, unsigned height, const XnUInt8* bayer_pixel, unsign
 				rgb_buffer += 6;
 				bayer_pixel += 2;
 				// continue with rest of the line
-				for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+				xIdx = 2;
+#ifdef XN_SSE
+				if (bUseSSSE3)
+				{
+					DebayerLinePairSSSE3<TRUE>(bayer_pixel, rgb_buffer, bayer_line_step, rgb_line_step, nVectorPixels);
+					xIdx += nVectorPixels;
+					rgb_buffer += nVectorPixels * 3;
+					bayer_pixel += nVectorPixels;
+				}
+#endif
+				for (; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
 				{
 					// GRGR line
 					// Bayer        -1 0 1 2
@@ -648,235 +793,241 @@ void fillRGB(unsigned width, unsigned height, const XnUInt8* bayer_pixel, unsign
 				rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
 			}
 			
-			//last two lines
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     G r g
-			// line_step     b g b
-			
-			rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
-			rgb_buffer[1] = bayer_pixel[0]; // green pixel
-			rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
-			
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     g R g
-			// line_step     b g b
-			//rgb_pixel[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
-			rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
-			
-			// BGBG line
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     g r g
-			// line_step     B g b
-			//rgb_pixel[rgb_line_step    ] = bayer_pixel[1];
-			rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-			rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-			
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     g r g
-			// line_step     b G b
-			//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-			
-			rgb_buffer += 6;
-			bayer_pixel += 2;
-			// rest of the last two lines
-			for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+			if (nEndPair == nPairs)
 			{
+				//last two lines
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     G r g
+				// line_step     b g b
+				
+				rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
+				rgb_buffer[1] = bayer_pixel[0]; // green pixel
+				rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
+				
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     g R g
+				// line_step     b g b
+				//rgb_pixel[3] = bayer_pixel[1];
+				rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
+				rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
+				
+				// BGBG line
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     g r g
+				// line_step     B g b
+				//rgb_pixel[rgb_line_step    ] = bayer_pixel[1];
+				rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+				rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+				
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     g r g
+				// line_step     b G b
+				//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+				rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				
+				rgb_buffer += 6;
+				bayer_pixel += 2;
+				// rest of the last two lines
+				for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+				{
+					// GRGR line
+					// Bayer       -1 0 1 2
+					//        -1    g b g b
+					//         0    r G r g
+					// line_step    g b g b
+					rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+					rgb_buffer[1] = bayer_pixel[0];
+					rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
+					
+					// Bayer       -1 0 1 2
+					//        -1    g b g b
+					//         0    r g R g
+					// line_step    g b g b
+					rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
+					rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
+					rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[-bayer_line_step + 2]);
+					
+					// BGBG line
+					// Bayer       -1 0 1 2
+					//        -1    g b g b
+					//         0    r g r g
+					// line_step    g B g b
+					rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[-1], bayer_pixel[1]);
+					rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+					rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+					
+					
+					// Bayer       -1 0 1 2
+					//        -1    g b g b
+					//         0    r g r g
+					// line_step    g b G b
+					//rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
+					rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+					rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				}
+				
+				// last two pixel values for first two lines
 				// GRGR line
-				// Bayer       -1 0 1 2
-				//        -1    g b g b
-				//         0    r G r g
-				// line_step    g b g b
-				rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r G r
+				// line_step    g b g
+				rgb_buffer[rgb_line_step ] = rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
 				rgb_buffer[1] = bayer_pixel[0];
-				rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
+				rgb_buffer[5] = rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
 				
-				// Bayer       -1 0 1 2
-				//        -1    g b g b
-				//         0    r g R g
-				// line_step    g b g b
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r g R
+				// line_step    g b g
 				rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
-				rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
-				rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[-bayer_line_step + 2]);
+				rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[-bayer_line_step + 1]);
+				//rgb_pixel[5] = AVG( bayer_pixel[line_step], bayer_pixel[-line_step] );
 				
 				// BGBG line
-				// Bayer       -1 0 1 2
-				//        -1    g b g b
-				//         0    r g r g
-				// line_step    g B g b
-				rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[-1], bayer_pixel[1]);
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r g r
+				// line_step    g B g
+				//rgb_pixel[rgb_line_step    ] = AVG2( bayer_pixel[-1], bayer_pixel[1] );
 				rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-				rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-				
+				rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
 				
-				// Bayer       -1 0 1 2
-				//        -1    g b g b
-				//         0    r g r g
-				// line_step    g b G b
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r g r
+				// line_step    g b G
 				//rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
 				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-				rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
 			}
-			
-			// last two pixel values for first two lines
-			// GRGR line
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r G r
-			// line_step    g b g
-			rgb_buffer[rgb_line_step ] = rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-			rgb_buffer[1] = bayer_pixel[0];
-			rgb_buffer[5] = rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-			
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r g R
-			// line_step    g b g
-			rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[-bayer_line_step + 1]);
-			//rgb_pixel[5] = AVG( bayer_pixel[line_step], bayer_pixel[-line_step] );
-			
-			// BGBG line
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r g r
-			// line_step    g B g
-			//rgb_pixel[rgb_line_step    ] = AVG2( bayer_pixel[-1], bayer_pixel[1] );
-			rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-			rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-			
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r g r
-			// line_step    g b G
-			//rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
 		}
-		else if (debayering_method == EdgeAwareWeighted)
+		else if (debayering_method == XN_DEBAYERING_EDGE_AWARE_WEIGHTED)
 		{
 			int dh, dv;
 			
-			// first two pixel values for first two lines
-			// Bayer         0 1 2
-			//         0     G r g
-			// line_step     b g b
-			// line_step2    g r g
-			
-			rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
-			rgb_buffer[1] = bayer_pixel[0]; // green pixel
-			rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
-			
-			// Bayer         0 1 2
-			//         0     g R g
-			// line_step     b g b
-			// line_step2    g r g
-			//rgb_pixel[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-			rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-			
-			// BGBG line
-			// Bayer         0 1 2
-			//         0     g r g
-			// line_step     B g b
-			// line_step2    g r g
-			rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-			rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
-			//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-			
-			// pixel (1, 1)  0 1 2
-			//         0     g r g
-			// line_step     b G b
-			// line_step2    g r g
-			//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
-			
-			rgb_buffer += 6;
-			bayer_pixel += 2;
-			// rest of the first two lines
-			for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+			if (nFirstPair == 0)
 			{
+				// first two pixel values for first two lines
+				// Bayer         0 1 2
+				//         0     G r g
+				// line_step     b g b
+				// line_step2    g r g
+				
+				rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
+				rgb_buffer[1] = bayer_pixel[0]; // green pixel
+				rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
+				
+				// Bayer         0 1 2
+				//         0     g R g
+				// line_step     b g b
+				// line_step2    g r g
+				//rgb_pixel[3] = bayer_pixel[1];
+				rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+				rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				
+				// BGBG line
+				// Bayer         0 1 2
+				//         0     g r g
+				// line_step     B g b
+				// line_step2    g r g
+				rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+				rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
+				//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+				
+				// pixel (1, 1)  0 1 2
+				//         0     g r g
+				// line_step     b G b
+				// line_step2    g r g
+				//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+				//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+				
+				rgb_buffer += 6;
+				bayer_pixel += 2;
+				// rest of the first two lines
+				for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+				{
+					// GRGR line
+					// Bayer        -1 0 1 2
+					//           0   r G r g
+					//   line_step   g b g b
+					// line_step2    r g r g
+					rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+					rgb_buffer[1] = bayer_pixel[0];
+					rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
+					
+					// Bayer        -1 0 1 2
+					//          0    r g R g
+					//  line_step    g b g b
+					// line_step2    r g r g
+					rgb_buffer[3] = bayer_pixel[1];
+					rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+					rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+					
+					// BGBG line
+					// Bayer         -1 0 1 2
+					//         0      r g r g
+					// line_step      g B g b
+					// line_step2     r g r g
+					rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+					rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+					rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+					
+					// Bayer         -1 0 1 2
+					//         0      r g r g
+					// line_step      g b G b
+					// line_step2     r g r g
+					rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+					rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+					//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+				}
+				
+				// last two pixel values for first two lines
 				// GRGR line
-				// Bayer        -1 0 1 2
-				//           0   r G r g
-				//   line_step   g b g b
-				// line_step2    r g r g
+				// Bayer        -1 0 1
+				//           0   r G r
+				//   line_step   g b g
+				// line_step2    r g r
 				rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
 				rgb_buffer[1] = bayer_pixel[0];
-				rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
+				rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
 				
-				// Bayer        -1 0 1 2
-				//          0    r g R g
-				//  line_step    g b g b
-				// line_step2    r g r g
+				// Bayer        -1 0 1
+				//          0    r g R
+				//  line_step    g b g
+				// line_step2    r g r
 				rgb_buffer[3] = bayer_pixel[1];
-				rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-				rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+				//rgb_pixel[5] = bayer_pixel[line_step];
 				
 				// BGBG line
-				// Bayer         -1 0 1 2
-				//         0      r g r g
-				// line_step      g B g b
-				// line_step2     r g r g
+				// Bayer        -1 0 1
+				//          0    r g r
+				//  line_step    g B g
+				// line_step2    r g r
 				rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
 				rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-				rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+				//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
 				
-				// Bayer         -1 0 1 2
-				//         0      r g r g
-				// line_step      g b G b
-				// line_step2     r g r g
+				// Bayer         -1 0 1
+				//         0      r g r
+				// line_step      g b G
+				// line_step2     r g r
 				rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
 				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-				//rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+				//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+				
+				bayer_pixel += bayer_line_step + 2;
+				rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
 			}
-			
-			// last two pixel values for first two lines
-			// GRGR line
-			// Bayer        -1 0 1
-			//           0   r G r
-			//   line_step   g b g
-			// line_step2    r g r
-			rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-			rgb_buffer[1] = bayer_pixel[0];
-			rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
-			
-			// Bayer        -1 0 1
-			//          0    r g R
-			//  line_step    g b g
-			// line_step2    r g r
-			rgb_buffer[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-			//rgb_pixel[5] = bayer_pixel[line_step];
-			
-			// BGBG line
-			// Bayer        -1 0 1
-			//          0    r g r
-			//  line_step    g B g
-			// line_step2    r g r
-			rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-			rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-			//rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-			
-			// Bayer         -1 0 1
-			//         0      r g r
-			// line_step      g b G
-			// line_step2     r g r
-			rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-			
-			bayer_pixel += bayer_line_step + 2;
-			rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
 			// main processing
-			for (yIdx = 2; yIdx < height - 2; yIdx += 2)
+			for (yIdx = nMiddleFirst; yIdx < nMiddleEnd; yIdx += 2)
 			{
 				// first two pixel values
 				// Bayer         0 1 2
@@ -1013,116 +1164,119 @@ void fillRGB(unsigned width, unsigned height, const XnUInt8* bayer_pixel, unsign
 				rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
 			}
 			
-			//last two lines
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     G r g
-			// line_step     b g b
-			
-			rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
-			rgb_buffer[1] = bayer_pixel[0]; // green pixel
-			rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
-			
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     g R g
-			// line_step     b g b
-			//rgb_pixel[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
-			rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
-			
-			// BGBG line
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     g r g
-			// line_step     B g b
-			//rgb_pixel[rgb_line_step    ] = bayer_pixel[1];
-			rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-			rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-			
-			// Bayer         0 1 2
-			//        -1     b g b
-			//         0     g r g
-			// line_step     b G b
-			//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-			
-			rgb_buffer += 6;
-			bayer_pixel += 2;
-			// rest of the last two lines
-			for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+			if (nEndPair == nPairs)
 			{
+				//last two lines
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     G r g
+				// line_step     b g b
+				
+				rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
+				rgb_buffer[1] = bayer_pixel[0]; // green pixel
+				rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
+				
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     g R g
+				// line_step     b g b
+				//rgb_pixel[3] = bayer_pixel[1];
+				rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
+				rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
+				
+				// BGBG line
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     g r g
+				// line_step     B g b
+				//rgb_pixel[rgb_line_step    ] = bayer_pixel[1];
+				rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+				rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+				
+				// Bayer         0 1 2
+				//        -1     b g b
+				//         0     g r g
+				// line_step     b G b
+				//rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+				rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				
+				rgb_buffer += 6;
+				bayer_pixel += 2;
+				// rest of the last two lines
+				for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+				{
+					// GRGR line
+					// Bayer       -1 0 1 2
+					//        -1    g b g b
+					//         0    r G r g
+					// line_step    g b g b
+					rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+					rgb_buffer[1] = bayer_pixel[0];
+					rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
+					
+					// Bayer       -1 0 1 2
+					//        -1    g b g b
+					//         0    r g R g
+					// line_step    g b g b
+					rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
+					rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
+					rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[-bayer_line_step + 2]);
+					
+					// BGBG line
+					// Bayer       -1 0 1 2
+					//        -1    g b g b
+					//         0    r g r g
+					// line_step    g B g b
+					rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[-1], bayer_pixel[1]);
+					rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+					rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+					
+					
+					// Bayer       -1 0 1 2
+					//        -1    g b g b
+					//         0    r g r g
+					// line_step    g b G b
+					//rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
+					rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+					rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				}
+				
+				// last two pixel values for first two lines
 				// GRGR line
-				// Bayer       -1 0 1 2
-				//        -1    g b g b
-				//         0    r G r g
-				// line_step    g b g b
-				rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r G r
+				// line_step    g b g
+				rgb_buffer[rgb_line_step ] = rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
 				rgb_buffer[1] = bayer_pixel[0];
-				rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
+				rgb_buffer[5] = rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
 				
-				// Bayer       -1 0 1 2
-				//        -1    g b g b
-				//         0    r g R g
-				// line_step    g b g b
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r g R
+				// line_step    g b g
 				rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
-				rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
-				rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[-bayer_line_step + 2]);
+				rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[-bayer_line_step + 1]);
+				//rgb_pixel[5] = AVG( bayer_pixel[line_step], bayer_pixel[-line_step] );
 				
 				// BGBG line
-				// Bayer       -1 0 1 2
-				//        -1    g b g b
-				//         0    r g r g
-				// line_step    g B g b
-				rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[-1], bayer_pixel[1]);
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r g r
+				// line_step    g B g
+				//rgb_pixel[rgb_line_step    ] = AVG2( bayer_pixel[-1], bayer_pixel[1] );
 				rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-				rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-				
+				rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
 				
-				// Bayer       -1 0 1 2
-				//        -1    g b g b
-				//         0    r g r g
-				// line_step    g b G b
+				// Bayer       -1 0 1
+				//        -1    g b g
+				//         0    r g r
+				// line_step    g b G
 				//rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
 				rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-				rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+				//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
 			}
-			
-			// last two pixel values for first two lines
-			// GRGR line
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r G r
-			// line_step    g b g
-			rgb_buffer[rgb_line_step ] = rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-			rgb_buffer[1] = bayer_pixel[0];
-			rgb_buffer[5] = rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-			
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r g R
-			// line_step    g b g
-			rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
-			rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[-bayer_line_step + 1]);
-			//rgb_pixel[5] = AVG( bayer_pixel[line_step], bayer_pixel[-line_step] );
-			
-			// BGBG line
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r g r
-			// line_step    g B g
-			//rgb_pixel[rgb_line_step    ] = AVG2( bayer_pixel[-1], bayer_pixel[1] );
-			rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-			rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-			
-			// Bayer       -1 0 1
-			//        -1    g b g
-			//         0    r g r
-			// line_step    g b G
-			//rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
-			rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-			//rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
 		}
 		//else
 		//	THROW_OPENNI_EXCEPTION ("Unknwon debayering method: %d", (int)debayering_method);
@@ -1149,9 +1303,37 @@ void fillRGB(unsigned width, unsigned height, const XnUInt8* bayer_pixel, unsign
 	}
 }
 
-void Bayer2RGB888(const XnUInt8* pBayerImage, XnUInt8* pRGBImage, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nDownSampleStep)
-{	
-	fillRGB(nXRes, nYRes, pBayerImage, pRGBImage, DebayeringMethod(1), nDownSampleStep); // DebayeringMethod(0) == bilinear, (1) == edge aware, (2) == edge aware weighted
+typedef struct XnBayerStripesContext
+{
+	const XnUInt8* pBayerImage;
+	XnUInt8* pRGBImage;
+	XnUInt32 nXRes;
+	XnUInt32 nYRes;
+	XnDebayeringMethod method;
+} XnBayerStripesContext;
+
+static void XN_CALLBACK_TYPE DebayerStripe(XnUInt32 nStripe, void* pCookie)
+{
+	XnBayerStripesContext* pContext = (XnBayerStripesContext*)pCookie;
+	XnUInt32 nPairs = pContext->nYRes / 2;
+	XnUInt32 nFirstPair = nStripe * XN_BAYER_ROW_PAIRS_PER_STRIPE;
+	XnUInt32 nEndPair = XN_MIN(nFirstPair + XN_BAYER_ROW_PAIRS_PER_STRIPE, nPairs);
+	fillRGB(pContext->nXRes, pContext->nYRes, pContext->pBayerImage, pContext->pRGBImage, pContext->method, 1, nFirstPair, nEndPair);
+}
+
+void Bayer2RGB888(const XnUInt8* pBayerImage, XnUInt8* pRGBImage, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nDownSampleStep, XnDebayeringMethod method, xnl::ThreadPool* pThreadPool)
+{
+	XnUInt32 nPairs = nYRes / 2;
+	XnUInt32 nStripes = (nPairs + XN_BAYER_ROW_PAIRS_PER_STRIPE - 1) / XN_BAYER_ROW_PAIRS_PER_STRIPE;
+
+	if (nDownSampleStep != 1 || pThreadPool == NULL || pThreadPool->GetThreadCount() == 0 || nStripes < 2)
+	{
+		fillRGB(nXRes, nYRes, pBayerImage, pRGBImage, method, nDownSampleStep, 0, nPairs);
+		return;
+	}
+
+	XnBayerStripesContext context = { pBayerImage, pRGBImage, nXRes, nYRes, method };
+	pThreadPool->ParallelFor(nStripes, DebayerStripe, &context);
 }
 
 
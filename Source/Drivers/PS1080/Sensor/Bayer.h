@@ -25,6 +25,7 @@
 // Includes
 //---------------------------------------------------------------------------
 #include "XnDeviceSensor.h"
+#include <XnThreadPool.h>
 
 //---------------------------------------------------------------------------
 // Defines
@@ -37,6 +38,10 @@
 //---------------------------------------------------------------------------
 // Functions Declaration
 //---------------------------------------------------------------------------
-void Bayer2RGB888(const XnUInt8* pBayerImage, XnUInt8* pRGBImage, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nDownSampleStep);
+/**
+* Debayers a GRBG image into RGB888. When a thread pool is given, horizontal stripes of the image are
+* debayered in parallel on it (together with the calling thread).
+*/
+void Bayer2RGB888(const XnUInt8* pBayerImage, XnUInt8* pRGBImage, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nDownSampleStep, XnDebayeringMethod method = XN_DEBAYERING_EDGE_AWARE, xnl::ThreadPool* pThreadPool = NULL);
 
 #endif //_XN_BAYER_H_
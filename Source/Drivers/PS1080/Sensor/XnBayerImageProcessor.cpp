@@ -144,7 +144,7 @@ void XnBayerImageProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* p
 		break;
 	case ONI_PIXEL_FORMAT_RGB888:
 		{
-			Bayer2RGB888(m_UncompressedBayerBuffer.GetData(), GetWriteBuffer()->GetUnsafeWritePointer(), GetActualXRes(), GetActualYRes(), 1);
+			GetStream()->Debayer(m_UncompressedBayerBuffer.GetData(), GetWriteBuffer()->GetUnsafeWritePointer(), GetActualXRes(), GetActualYRes());
 			GetWriteBuffer()->UnsafeUpdateSize(GetActualXRes()*GetActualYRes()*3);
 			m_UncompressedBayerBuffer.Reset();
 		}
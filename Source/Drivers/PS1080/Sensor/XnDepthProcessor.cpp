@@ -37,6 +37,9 @@ XnDepthProcessor::XnDepthProcessor(XnSensorDepthStream* pStream, XnSensorStreamH
 	XnFrameStreamProcessor(pStream, pHelper, pBufferManager, XN_SENSOR_PROTOCOL_RESPONSE_DEPTH_START, XN_SENSOR_PROTOCOL_RESPONSE_DEPTH_END),
 	m_nPaddingPixelsOnEnd(0),
 	m_applyRegistrationOnEnd(FALSE),
+	m_nMirrorOnWriteAlignment(0),
+	m_bMirrorOnWrite(FALSE),
+	m_nLineSize(0),
 	m_nExpectedFrameSize(0),
 	m_bShiftToDepthAllocated(FALSE),
 	m_pShiftToDepthTable(pStream->GetShiftToDepthTable())
@@ -98,17 +101,44 @@ void XnDepthProcessor::OnStartOfFrame(const XnSensorProtocolResponseHeader* pHea
 		GetStream()->m_DepthRegistration.GetValue() == TRUE && 
 		GetStream()->m_FirmwareRegistration.GetValue() == FALSE);
 
+	XnUInt32 nPaddingPixelsOnStart = 0;
 	if (m_pDevicePrivateData->FWInfo.nFWVer >= XN_SENSOR_FW_VER_5_1 && pHeader->nTimeStamp != 0)
 	{
 		// PATCH: starting with v5.1, the timestamp field of the SOF packet, is the number of pixels
 		// that should be prepended to the frame.
-		XnUInt32 nPaddingPixelsOnStart = pHeader->nTimeStamp >> 16;
+		nPaddingPixelsOnStart = pHeader->nTimeStamp >> 16;
 		m_nPaddingPixelsOnEnd = pHeader->nTimeStamp & 0x0000FFFF;
+	}
+
+	// When the mirror is done in software, do it while the pixels are written rather than in another
+	// pass once the frame is complete. Each write must fit in a row, and registration expects the
+	// frame as it was sent.
+	m_nLineSize = GetLineSize();
+	m_bMirrorOnWrite = (
+		m_nMirrorOnWriteAlignment != 0 &&
+		m_nLineSize != 0 &&
+		GetStream()->IsMirrored() &&
+		GetStream()->m_FirmwareMirror.GetValue() == FALSE &&
+		!m_applyRegistrationOnEnd &&
+		m_nLineSize % m_nMirrorOnWriteAlignment == 0 &&
+		nPaddingPixelsOnStart % m_nMirrorOnWriteAlignment == 0);
 
+	if (nPaddingPixelsOnStart != 0)
+	{
 		PadPixels(nPaddingPixelsOnStart);
 	}
 }
 
+XnUInt32 XnDepthProcessor::GetLineSize()
+{
+	if (GetStream()->m_FirmwareCropMode.GetValue() != XN_FIRMWARE_CROPPING_MODE_DISABLED)
+	{
+		return (XnUInt32)GetStream()->m_FirmwareCropSizeX.GetValue();
+	}
+
+	return GetStream()->GetXRes();
+}
+
 XnUInt32 XnDepthProcessor::CalculateExpectedSize()
 {
 	XnUInt32 nExpectedDepthBufferSize = GetStream()->GetXRes() * GetStream()->GetYRes();
@@ -173,6 +203,9 @@ void XnDepthProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeade
 
 	pFrame->stride = pFrame->width * GetStream()->GetBytesPerPixel();
 
+	// let the stream know it should not mirror this frame again
+	GetStream()->m_bMirroredOnWrite = m_bMirrorOnWrite;
+
 	// call base
 	XnFrameStreamProcessor::OnEndOfFrame(pHeader);
 }
@@ -187,14 +220,44 @@ void XnDepthProcessor::PadPixels(XnUInt32 nPixels)
 		return;
 	}
 
-	OniDepthPixel* pDepth = (OniDepthPixel*)GetWriteBuffer()->GetUnsafeWritePointer();
+	while (nPixels > 0)
+	{
+		XnUInt32 nRunPixels = nPixels;
+		XnInt32 nStep;
+		OniDepthPixel* pDepth = GetDepthWritePointer(&nRunPixels, &nStep);
+
+		// place the no-depth value
+		for (XnUInt32 i = 0; i < nRunPixels; ++i, pDepth += nStep)
+		{
+			*pDepth = m_noDepthValue;
+		}
+		pWriteBuffer->UnsafeUpdateSize(nRunPixels * sizeof(OniDepthPixel));
+		nPixels -= nRunPixels;
+	}
+}
+
+OniDepthPixel* XnDepthProcessor::GetDepthWritePointer(XnUInt32* pnPixels, XnInt32* pnStep)
+{
+	XnBuffer* pWriteBuffer = GetWriteBuffer();
+	OniDepthPixel* pDepth = (OniDepthPixel*)pWriteBuffer->GetUnsafeWritePointer();
+
+	if (m_bMirrorOnWrite)
+	{
+		XnUInt32 nColumn = (pWriteBuffer->GetSize() / sizeof(OniDepthPixel)) % m_nLineSize;
+		XnUInt32 nPixelsLeftInRow = m_nLineSize - nColumn;
+
+		// a frame with more data than expected might not have room for the whole row. It is
+		// corrupted anyway, so it is just written as is.
+		if (nPixelsLeftInRow * sizeof(OniDepthPixel) <= pWriteBuffer->GetFreeSpaceInBuffer())
+		{
+			*pnPixels = XN_MIN(*pnPixels, nPixelsLeftInRow);
+			*pnStep = -1;
+			return pDepth + nPixelsLeftInRow - 1 - nColumn;
+		}
+	}
 
-	// place the no-depth value
-	for (XnUInt32 i = 0; i < nPixels; ++i, ++pDepth)
-    {
-		*pDepth = m_noDepthValue;
-    }
-	pWriteBuffer->UnsafeUpdateSize(nPixels * sizeof(OniDepthPixel));
+	*pnStep = 1;
+	return pDepth;
 }
 
 void XnDepthProcessor::OnFrameReady(XnUInt32 nFrameID, XnUInt64 nFrameTS)
@@ -72,17 +72,42 @@ protected:
 		return m_pShiftToDepthTable[nShift];
 	}
 
+	inline const OniDepthPixel* GetShiftToDepthTable() const
+	{
+		return m_pShiftToDepthTable;
+	}
+
 	inline XnUInt32 GetExpectedSize()
 	{
 		return m_nExpectedFrameSize;
 	}
 
+	/*
+	* Lets the processor mirror the frame while writing it, instead of having the stream mirror it
+	* once it is complete. nPixelsPerWrite is the number of pixels the processor always writes at once.
+	*/
+	inline void EnableMirrorOnWrite(XnUInt32 nPixelsPerWrite)
+	{
+		m_nMirrorOnWriteAlignment = nPixelsPerWrite;
+	}
+
+	/*
+	* Returns where to write the next pixels of the frame. When the frame is mirrored while written,
+	* pixels go backwards (*pnStep is -1) and only up to the end of the current row, so *pnPixels
+	* is cut to what is left of it. UnsafeUpdateSize() should be called once they were written.
+	*/
+	OniDepthPixel* GetDepthWritePointer(XnUInt32* pnPixels, XnInt32* pnStep);
+
 private:
 	void PadPixels(XnUInt32 nPixels);
 	XnUInt32 CalculateExpectedSize();
+	XnUInt32 GetLineSize();
 
 	XnUInt32 m_nPaddingPixelsOnEnd;
 	XnBool m_applyRegistrationOnEnd;
+	XnUInt32 m_nMirrorOnWriteAlignment;
+	XnBool m_bMirrorOnWrite;
+	XnUInt32 m_nLineSize;
 	XnUInt32 m_nExpectedFrameSize;
 	XnBool m_bShiftToDepthAllocated;
 	OniDepthPixel* m_pShiftToDepthTable;
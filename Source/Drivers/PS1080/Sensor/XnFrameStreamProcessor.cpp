@@ -38,7 +38,9 @@ XnFrameStreamProcessor::XnFrameStreamProcessor(XnFrameStream* pStream, XnSensorS
 	m_bFrameCorrupted(FALSE),
 	m_bAllowDoubleSOF(FALSE),
 	m_nLastSOFPacketID(0),
-	m_nFirstPacketTimestamp(0)
+	m_nFirstPacketTimestamp(0),
+	m_nStartOfFrameHostTime(0),
+	m_nEndOfFrameHostTime(0)
 {
 	sprintf(m_csInDumpMask, "%sIn", pStream->GetType());
 	sprintf(m_csInternalDumpMask, "Internal%s", pStream->GetType());
@@ -75,6 +77,8 @@ void XnFrameStreamProcessor::ProcessPacketChunk(const XnSensorProtocolResponseHe
 	// if last data from EOF packet
 	if (pHeader->nType == m_nTypeEOF && (nDataOffset + nDataSize) == pHeader->nBufSize)
 	{
+		// taken before inheriting classes process the frame
+		xnOSGetHighResTimeStamp(&m_nEndOfFrameHostTime);
 		OnEndOfFrame(pHeader);
 	}
 
@@ -83,6 +87,7 @@ void XnFrameStreamProcessor::ProcessPacketChunk(const XnSensorProtocolResponseHe
 
 void XnFrameStreamProcessor::OnPacketLost()
 {
+	GetStream()->TransferErrorOccurred();
 	FrameIsCorrupted();
 }
 
@@ -90,6 +95,7 @@ void XnFrameStreamProcessor::OnStartOfFrame(const XnSensorProtocolResponseHeader
 {
 	m_bFrameCorrupted = FALSE;
 	m_pTripleBuffer->GetWriteBuffer()->Reset();
+	xnOSGetHighResTimeStamp(&m_nStartOfFrameHostTime);
 	if (m_pDevicePrivateData->pSensor->ShouldUseHostTimestamps())
 	{
 		m_nFirstPacketTimestamp = GetHostTimestamp();
@@ -121,6 +127,10 @@ void XnFrameStreamProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader*
 
 		OniFrame* pFrame = m_pTripleBuffer->GetWriteFrame();
 		pFrame->timestamp = nTimestamp;
+
+		// for latency tracking
+		m_pTripleBuffer->SetWriteFrameStageTimestamp(ONI_FRAME_STAGE_FIRST_PACKET, m_nStartOfFrameHostTime);
+		m_pTripleBuffer->SetWriteFrameStageTimestamp(ONI_FRAME_STAGE_END_OF_FRAME, m_nEndOfFrameHostTime);
 		
 		XnUInt32 nFrameID;
 		m_pTripleBuffer->MarkWriteBufferAsStable(&nFrameID);
@@ -152,6 +162,7 @@ void XnFrameStreamProcessor::FrameIsCorrupted()
 	{
 		xnLogWarning(XN_MASK_SENSOR_PROTOCOL, "%s frame is corrupt!", m_csName);
 		m_bFrameCorrupted = TRUE;
+		GetStream()->FrameCorrupted();
 	}
 }
 
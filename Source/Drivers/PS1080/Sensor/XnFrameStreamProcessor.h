@@ -178,6 +178,9 @@ private:
 	XnBool m_bAllowDoubleSOF;
 	XnUInt16 m_nLastSOFPacketID;
 	XnUInt64 m_nFirstPacketTimestamp;
+	/* Host times of the first and last packets of current frame, for latency tracking. */
+	XnUInt64 m_nStartOfFrameHostTime;
+	XnUInt64 m_nEndOfFrameHostTime;
 };
 
 #endif //__XN_FRAME_STREAM_PROCESSOR_H__
@@ -57,6 +57,8 @@ protected:
 private:
 	/* A buffer used for storing some left-over bytes for the next packet. */
 	XnBuffer m_ContinuousBuffer;
+	/* TRUE if the CPU can run the vector unpacker. */
+	XnBool m_bVectorize;
 };
 
 #endif //__XN_PACKED_12_DEPTH_PROCESSOR_H__
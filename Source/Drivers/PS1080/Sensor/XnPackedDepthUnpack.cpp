@@ -0,0 +1,448 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "XnPackedDepthUnpack.h"
+#include "XnDeviceSensor.h"
+#include <XnSIMD.h>
+#ifdef XN_NEON
+#include <arm_neon.h>
+#endif
+
+//---------------------------------------------------------------------------
+// Macros
+//---------------------------------------------------------------------------
+/* Returns a set of <count> bits. For example XN_ON_BITS(4) returns 0xF */
+#define XN_ON_BITS(count)				((1 << count)-1)
+
+/* Creates a mask of <count> bits in offset <offset> */
+#define XN_CREATE_MASK(count, offset)	(XN_ON_BITS(count) << offset)
+
+/* Takes the <count> bits in offset <offset> from <source>.
+*  For example: 
+*  If we want 3 bits located in offset 2 from 0xF4:
+*  11110100
+*     ---
+*  we get 101, which is 0x5.
+*  and so, XN_TAKE_BITS(0xF4,3,2) == 0x5.
+*/
+#define XN_TAKE_BITS(source, count, offset)		((source & XN_CREATE_MASK(count, offset)) >> offset)
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+#ifdef XN_SSE
+// Unpacks pairs of input elements (16 shifts from 22 bytes) and looks them up in the
+// shift-to-depth table. Each shift is taken from the 16-bit big-endian word starting at
+// its first byte, shifted left by its bit offset in that byte. The two shifts which span
+// three bytes get their last bits from the byte after that word. Output pixels are nStep apart.
+XN_SSSE3_FUNCTION static void Unpack11to16SSSE3(const XnUInt8* pcInput, XnUInt32 nElementPairs, const OniDepthPixel* pShiftToDepth, XnUInt16* pnOutput, XnInt32 nStep)
+{
+	// Word of each shift, as {low byte, high byte}, relative to the loaded 16 bytes
+	const __m128i wordShuffle = _mm_setr_epi8(1,0, 2,1, 3,2, 5,4, 6,5, 7,6, 9,8, 10,9);
+	// The third byte of shifts 2 and 5
+	const __m128i spillShuffle = _mm_setr_epi8(-1,-1, -1,-1, 4,-1, -1,-1, -1,-1, 8,-1, -1,-1, -1,-1);
+	// 2^(bit offset)
+	const __m128i offsetMul = _mm_setr_epi16(1, 8, 64, 2, 16, 128, 4, 32);
+	// 2^(16 - (13 - bit offset)), so that mulhi shifts the spill byte right into place
+	const __m128i spillMul = _mm_setr_epi16(0, 0, 1 << 9, 0, 0, 1 << 10, 0, 0);
+
+	XnUInt16 shift[16];
+
+	for (XnUInt32 nPair = 0; nPair < nElementPairs; ++nPair)
+	{
+		// the second element starts at byte 11, which is byte 5 of a load at byte 6
+		__m128i in0 = _mm_loadu_si128((const __m128i*)pcInput);
+		__m128i in1 = _mm_srli_si128(_mm_loadu_si128((const __m128i*)(pcInput + 6)), 5);
+
+		__m128i words0 = _mm_mullo_epi16(_mm_shuffle_epi8(in0, wordShuffle), offsetMul);
+		__m128i words1 = _mm_mullo_epi16(_mm_shuffle_epi8(in1, wordShuffle), offsetMul);
+		__m128i spill0 = _mm_mulhi_epu16(_mm_shuffle_epi8(in0, spillShuffle), spillMul);
+		__m128i spill1 = _mm_mulhi_epu16(_mm_shuffle_epi8(in1, spillShuffle), spillMul);
+
+		_mm_storeu_si128((__m128i*)shift, _mm_or_si128(_mm_srli_epi16(words0, 5), spill0));
+		_mm_storeu_si128((__m128i*)(shift + 8), _mm_or_si128(_mm_srli_epi16(words1, 5), spill1));
+
+		for (XnUInt32 i = 0; i < 16; ++i, pnOutput += nStep)
+		{
+			*pnOutput = pShiftToDepth[shift[i]];
+		}
+
+		pcInput += 2 * XN_PACKED_11_INPUT_ELEMENT_SIZE;
+	}
+}
+#endif
+
+#ifdef XN_NEON
+// Same as the SSSE3 unpacker, but with NEON table lookups and variable shifts.
+static void Unpack11to16NEON(const XnUInt8* pcInput, XnUInt32 nElementPairs, const OniDepthPixel* pShiftToDepth, XnUInt16* pnOutput, XnInt32 nStep)
+{
+	// Word of each shift, as {low byte, high byte}, for each element of the pair. The second
+	// element starts at byte 11, which is byte 5 of a load at byte 6. 0xFF reads as 0.
+	static const XnUInt8 wordIndex[2][16] = {
+		{ 1,0, 2,1, 3,2, 5,4, 6,5, 7,6, 9,8, 10,9 },
+		{ 6,5, 7,6, 8,7, 10,9, 11,10, 12,11, 14,13, 15,14 } };
+	// The third byte of shifts 2 and 5
+	static const XnUInt8 spillIndex[2][16] = {
+		{ 0xFF,0xFF, 0xFF,0xFF, 4,0xFF, 0xFF,0xFF, 0xFF,0xFF, 8,0xFF, 0xFF,0xFF, 0xFF,0xFF },
+		{ 0xFF,0xFF, 0xFF,0xFF, 9,0xFF, 0xFF,0xFF, 0xFF,0xFF, 13,0xFF, 0xFF,0xFF, 0xFF,0xFF } };
+	// Bit offset of each shift (left), and the right shift of the spill byte
+	static const XnInt16 offsetShift[8] = { 0, 3, 6, 1, 4, 7, 2, 5 };
+	static const XnInt16 spillShift[8] = { 0, 0, -7, 0, 0, -6, 0, 0 };
+
+	const int16x8_t offsetQ = vld1q_s16(offsetShift);
+	const int16x8_t spillShiftQ = vld1q_s16(spillShift);
+	uint8x8_t wordIndexD[2][2];
+	uint8x8_t spillIndexD[2][2];
+	for (XnUInt32 i = 0; i < 2; ++i)
+	{
+		wordIndexD[i][0] = vld1_u8(wordIndex[i]);
+		wordIndexD[i][1] = vld1_u8(wordIndex[i] + 8);
+		spillIndexD[i][0] = vld1_u8(spillIndex[i]);
+		spillIndexD[i][1] = vld1_u8(spillIndex[i] + 8);
+	}
+
+	XnUInt16 shift[16];
+	uint8x8x2_t in;
+
+	for (XnUInt32 nPair = 0; nPair < nElementPairs; ++nPair)
+	{
+		for (XnUInt32 i = 0; i < 2; ++i)
+		{
+			in.val[0] = vld1_u8(pcInput + 6 * i);
+			in.val[1] = vld1_u8(pcInput + 6 * i + 8);
+
+			uint16x8_t words = vreinterpretq_u16_u8(vcombine_u8(vtbl2_u8(in, wordIndexD[i][0]), vtbl2_u8(in, wordIndexD[i][1])));
+			uint16x8_t spill = vreinterpretq_u16_u8(vcombine_u8(vtbl2_u8(in, spillIndexD[i][0]), vtbl2_u8(in, spillIndexD[i][1])));
+
+			words = vshrq_n_u16(vshlq_u16(words, offsetQ), 5);
+			vst1q_u16(shift + 8 * i, vorrq_u16(words, vshlq_u16(spill, spillShiftQ)));
+		}
+
+		for (XnUInt32 i = 0; i < 16; ++i, pnOutput += nStep)
+		{
+			*pnOutput = pShiftToDepth[shift[i]];
+		}
+
+		pcInput += 2 * XN_PACKED_11_INPUT_ELEMENT_SIZE;
+	}
+}
+#endif
+
+#ifdef XN_SSE
+// Unpacks input elements (16 shifts from 24 bytes) and looks them up in the shift-to-depth
+// table. Each shift is the top 12 bits of the 16-bit big-endian word starting at its first
+// byte, after shifting out the 4 bits of the previous shift from odd shifts. Output pixels are
+// nStep apart.
+XN_SSSE3_FUNCTION static void Unpack12to16SSSE3(const XnUInt8* pcInput, XnUInt32 nElements, const OniDepthPixel* pShiftToDepth, XnUInt16* pnOutput, XnInt32 nStep)
+{
+	// Word of each shift, as {low byte, high byte}, relative to the loaded 16 bytes
+	const __m128i wordShuffle0 = _mm_setr_epi8(1,0, 2,1, 4,3, 5,4, 7,6, 8,7, 10,9, 11,10);
+	// the second half starts at byte 12, which is byte 4 of a load at byte 8
+	const __m128i wordShuffle1 = _mm_setr_epi8(5,4, 6,5, 8,7, 9,8, 11,10, 12,11, 14,13, 15,14);
+	const __m128i offsetMul = _mm_setr_epi16(1, 16, 1, 16, 1, 16, 1, 16);
+	const __m128i maxShift = _mm_set1_epi16(XN_DEVICE_SENSOR_MAX_SHIFT_VALUE - 1);
+
+	XnUInt16 shift[16];
+
+	for (XnUInt32 nElem = 0; nElem < nElements; ++nElem)
+	{
+		__m128i in0 = _mm_loadu_si128((const __m128i*)pcInput);
+		__m128i in1 = _mm_loadu_si128((const __m128i*)(pcInput + 8));
+
+		__m128i shift0 = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(in0, wordShuffle0), offsetMul), 4);
+		__m128i shift1 = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(in1, wordShuffle1), offsetMul), 4);
+
+		// shifts out of the table are reported as 0
+		_mm_storeu_si128((__m128i*)shift, _mm_and_si128(shift0, _mm_cmplt_epi16(shift0, maxShift)));
+		_mm_storeu_si128((__m128i*)(shift + 8), _mm_and_si128(shift1, _mm_cmplt_epi16(shift1, maxShift)));
+
+		for (XnUInt32 i = 0; i < 16; ++i, pnOutput += nStep)
+		{
+			*pnOutput = pShiftToDepth[shift[i]];
+		}
+
+		pcInput += XN_PACKED_12_INPUT_ELEMENT_SIZE;
+	}
+}
+#endif
+
+#ifdef XN_NEON
+// Unpacks input elements (16 shifts from 24 bytes) by splitting them into the 3 bytes of each
+// pair of shifts, and looks them up in the shift-to-depth table. Output pixels are nStep apart.
+static void Unpack12to16NEON(const XnUInt8* pcInput, XnUInt32 nElements, const OniDepthPixel* pShiftToDepth, XnUInt16* pnOutput, XnInt32 nStep)
+{
+	XnUInt16 shift[16];
+	XnUInt16 depth[16];
+	uint8x8x3_t inD3;
+	uint8x8_t rshft4D, lshft4D;
+	uint16x8_t rshft4Q, lshft4Q;
+	uint16x8_t depthQ;
+	uint16x8x2_t shiftQ2;
+
+	for (XnUInt32 nElem = 0; nElem < nElements; ++nElem)
+	{
+		// input:	0,  1,2    (X8)
+		//			-,---,-
+		// bits:	8,4,4,8    (X8)
+		//			---,---
+		// output:	  0,  1    (X8)
+
+		// Split 24 bytes into 3 vectors (64 bit each)
+		inD3 = vld3_u8(pcInput);
+
+		// rshft4D0 contains 4 MSB of second vector (placed at offset 0)
+		rshft4D = vshr_n_u8(inD3.val[1], 4);
+		// lshft4D0 contains 4 LSB of second vector (placed at offset 4)
+		lshft4D = vshl_n_u8(inD3.val[1], 4);
+
+		// Expand 64 bit vectors to 128 bit (8 values of 16 bits)
+		shiftQ2.val[0] = vmovl_u8(inD3.val[0]);
+		shiftQ2.val[1] = vmovl_u8(inD3.val[2]);
+		rshft4Q = vmovl_u8(rshft4D);
+		lshft4Q = vmovl_u8(lshft4D);
+
+		// Even indexed shift = 8 bits from first vector + 4 MSB bits of second vector
+		shiftQ2.val[0] = vshlq_n_u16(shiftQ2.val[0], 4);
+		shiftQ2.val[0] = vorrq_u16(shiftQ2.val[0], rshft4Q);
+		
+		// Odd indexed shift = 4 LSB bits of second vector + 8 bits from third vector
+		lshft4Q = vshlq_n_u16(lshft4Q, 4);
+		shiftQ2.val[1] = vorrq_u16(shiftQ2.val[1], lshft4Q);
+		
+		// Interleave shift values to a single vector
+		vst2q_u16(shift, shiftQ2);
+
+		shift[0] = (((shift[0]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[0]) : 0);
+		shift[1] = (((shift[1]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[1]) : 0);
+		shift[2] = (((shift[2]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[2]) : 0);
+		shift[3] = (((shift[3]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[3]) : 0);
+		shift[4] = (((shift[4]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[4]) : 0);
+		shift[5] = (((shift[5]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[5]) : 0);
+		shift[6] = (((shift[6]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[6]) : 0);
+		shift[7] = (((shift[7]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[7]) : 0);
+		shift[8] = (((shift[8]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[8]) : 0);
+		shift[9] = (((shift[9]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[9]) : 0);
+		shift[10] = (((shift[10]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[10]) : 0);
+		shift[11] = (((shift[11]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[11]) : 0);
+		shift[12] = (((shift[12]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[12]) : 0);
+		shift[13] = (((shift[13]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[13]) : 0);
+		shift[14] = (((shift[14]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[14]) : 0);
+		shift[15] = (((shift[15]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[15]) : 0);
+
+		depth[0] = pShiftToDepth[shift[0]];
+		depth[1] = pShiftToDepth[shift[1]];
+
+		depth[2] = pShiftToDepth[shift[2]];
+		depth[3] = pShiftToDepth[shift[3]];
+
+		depth[4] = pShiftToDepth[shift[4]];
+		depth[5] = pShiftToDepth[shift[5]];
+
+		depth[6] = pShiftToDepth[shift[6]];
+		depth[7] = pShiftToDepth[shift[7]];
+
+		// Load
+		depthQ = vld1q_u16(depth);
+		//Store (reversed, when mirroring)
+		if (nStep == 1)
+		{
+			vst1q_u16(pnOutput, depthQ);
+		}
+		else
+		{
+			vst1q_u16(pnOutput - 7, vcombine_u16(vrev64_u16(vget_high_u16(depthQ)), vrev64_u16(vget_low_u16(depthQ))));
+		}
+
+		depth[8] = pShiftToDepth[shift[8]];
+		depth[9] = pShiftToDepth[shift[9]];
+
+		depth[10] = pShiftToDepth[shift[10]];
+		depth[11] = pShiftToDepth[shift[11]];
+
+		depth[12] = pShiftToDepth[shift[12]];
+		depth[13] = pShiftToDepth[shift[13]];
+
+		depth[14] = pShiftToDepth[shift[14]];
+		depth[15] = pShiftToDepth[shift[15]];
+
+		// Load
+		depthQ = vld1q_u16(depth + 8);
+		// Store (reversed, when mirroring)
+		if (nStep == 1)
+		{
+			vst1q_u16(pnOutput + 8, depthQ);
+		}
+		else
+		{
+			vst1q_u16(pnOutput - 15, vcombine_u16(vrev64_u16(vget_high_u16(depthQ)), vrev64_u16(vget_low_u16(depthQ))));
+		}
+
+		pcInput += XN_PACKED_12_INPUT_ELEMENT_SIZE;
+		pnOutput += 16 * nStep;
+	}
+}
+#endif
+
+XnBool XnPackedDepthCanVectorize()
+{
+#if defined(XN_NEON)
+	return TRUE;
+#elif defined(XN_SSE)
+	return ((xnOSGetCPUFeatures() & XN_CPU_FEATURE_SSSE3) != 0);
+#else
+	return FALSE;
+#endif
+}
+
+void XnUnpackPacked11Depth(const XnUInt8* pcInput, XnUInt32 nElements, const OniDepthPixel* pShiftToDepth, OniDepthPixel* pnOutput, XnInt32 nStep, XnBool bVectorize)
+{
+	// The vector unpackers take pairs of elements, so they never read past the input.
+	XnUInt32 nElem = 0;
+	if (bVectorize)
+	{
+		XnUInt32 nPairs = nElements / 2;
+#if defined(XN_NEON)
+		Unpack11to16NEON(pcInput, nPairs, pShiftToDepth, pnOutput, nStep);
+#elif defined(XN_SSE)
+		Unpack11to16SSSE3(pcInput, nPairs, pShiftToDepth, pnOutput, nStep);
+#else
+		nPairs = 0;
+#endif
+		nElem = nPairs * 2;
+		pcInput += nPairs * 2 * XN_PACKED_11_INPUT_ELEMENT_SIZE;
+		pnOutput += (XnInt32)nPairs * 16 * nStep;
+	}
+
+	XnUInt16 a0,a1,a2,a3,a4,a5,a6,a7;
+
+	// Convert the 11bit packed data into 16bit shorts
+	for (; nElem < nElements; ++nElem)
+	{
+		// input:	0,  1,  2,3,  4,  5,  6,7,  8,  9,10
+		//			-,---,---,-,---,---,---,-,---,---,-
+		// bits:	8,3,5,6,2,8,1,7,4,4,7,1,8,2,6,5,3,8
+		//			---,---,-----,---,---,-----,---,---
+		// output:	  0,  1,    2,  3,  4,    5,  6,  7
+
+		a0 = (XN_TAKE_BITS(pcInput[0],8,0) << 3) | XN_TAKE_BITS(pcInput[1],3,5);
+		a1 = (XN_TAKE_BITS(pcInput[1],5,0) << 6) | XN_TAKE_BITS(pcInput[2],6,2);
+		a2 = (XN_TAKE_BITS(pcInput[2],2,0) << 9) | (XN_TAKE_BITS(pcInput[3],8,0) << 1) | XN_TAKE_BITS(pcInput[4],1,7);
+		a3 = (XN_TAKE_BITS(pcInput[4],7,0) << 4) | XN_TAKE_BITS(pcInput[5],4,4);
+		a4 = (XN_TAKE_BITS(pcInput[5],4,0) << 7) | XN_TAKE_BITS(pcInput[6],7,1);
+		a5 = (XN_TAKE_BITS(pcInput[6],1,0) << 10) | (XN_TAKE_BITS(pcInput[7],8,0) << 2) | XN_TAKE_BITS(pcInput[8],2,6);
+		a6 = (XN_TAKE_BITS(pcInput[8],6,0) << 5) | XN_TAKE_BITS(pcInput[9],5,3);
+		a7 = (XN_TAKE_BITS(pcInput[9],3,0) << 8) | XN_TAKE_BITS(pcInput[10],8,0);
+
+		pnOutput[0] = pShiftToDepth[a0];
+		pnOutput[nStep] = pShiftToDepth[a1];
+		pnOutput[2 * nStep] = pShiftToDepth[a2];
+		pnOutput[3 * nStep] = pShiftToDepth[a3];
+		pnOutput[4 * nStep] = pShiftToDepth[a4];
+		pnOutput[5 * nStep] = pShiftToDepth[a5];
+		pnOutput[6 * nStep] = pShiftToDepth[a6];
+		pnOutput[7 * nStep] = pShiftToDepth[a7];
+
+		pcInput += XN_PACKED_11_INPUT_ELEMENT_SIZE;
+		pnOutput += 8 * nStep;
+	}
+}
+
+void XnUnpackPacked12Depth(const XnUInt8* pcInput, XnUInt32 nElements, const OniDepthPixel* pShiftToDepth, OniDepthPixel* pnOutput, XnInt32 nStep, XnBool bVectorize)
+{
+	if (bVectorize)
+	{
+#if defined(XN_NEON)
+		Unpack12to16NEON(pcInput, nElements, pShiftToDepth, pnOutput, nStep);
+		return;
+#elif defined(XN_SSE)
+		Unpack12to16SSSE3(pcInput, nElements, pShiftToDepth, pnOutput, nStep);
+		return;
+#endif
+	}
+
+	XnUInt16 shift[16];
+
+	// Convert the 12bit packed data into 16bit shorts
+	for (XnUInt32 nElem = 0; nElem < nElements; ++nElem)
+	{
+		// input:	0,  1,2,3,  4,5,6,  7,8,9, 10,11,12, 13,14,15, 16,17,18, 19,20,21, 22,23
+		//			-,---,-,-,---,-,-,---,-,-,---,--,--,---,--,--,---,--,--,---,--,--,---,--
+		// bits:	8,4,4,8,8,4,4,8,8,4,4,8,8,4,4, 8, 8,4,4, 8, 8,4,4, 8, 8,4,4, 8, 8,4,4, 8
+		//			---,---,---,---,---,---,---,----,----,----,----,----,----,----,----,----
+		// output:	  0,  1,  2,  3,  4,  5,  6,   7,   8,   9,  10,  11,  12,  13,  14,  15
+
+		shift[0] = (XN_TAKE_BITS(pcInput[0],8,0) << 4) | XN_TAKE_BITS(pcInput[1],4,4);
+		shift[1] = (XN_TAKE_BITS(pcInput[1],4,0) << 8) | XN_TAKE_BITS(pcInput[2],8,0);
+		shift[2] = (XN_TAKE_BITS(pcInput[3],8,0) << 4) | XN_TAKE_BITS(pcInput[4],4,4);
+		shift[3] = (XN_TAKE_BITS(pcInput[4],4,0) << 8) | XN_TAKE_BITS(pcInput[5],8,0);
+		shift[4] = (XN_TAKE_BITS(pcInput[6],8,0) << 4) | XN_TAKE_BITS(pcInput[7],4,4);
+		shift[5] = (XN_TAKE_BITS(pcInput[7],4,0) << 8) | XN_TAKE_BITS(pcInput[8],8,0);
+		shift[6] = (XN_TAKE_BITS(pcInput[9],8,0) << 4) | XN_TAKE_BITS(pcInput[10],4,4);
+		shift[7] = (XN_TAKE_BITS(pcInput[10],4,0) << 8) | XN_TAKE_BITS(pcInput[11],8,0);
+		shift[8] = (XN_TAKE_BITS(pcInput[12],8,0) << 4) | XN_TAKE_BITS(pcInput[13],4,4);
+		shift[9] = (XN_TAKE_BITS(pcInput[13],4,0) << 8) | XN_TAKE_BITS(pcInput[14],8,0);
+		shift[10] = (XN_TAKE_BITS(pcInput[15],8,0) << 4) | XN_TAKE_BITS(pcInput[16],4,4);
+		shift[11] = (XN_TAKE_BITS(pcInput[16],4,0) << 8) | XN_TAKE_BITS(pcInput[17],8,0);
+		shift[12] = (XN_TAKE_BITS(pcInput[18],8,0) << 4) | XN_TAKE_BITS(pcInput[19],4,4);
+		shift[13] = (XN_TAKE_BITS(pcInput[19],4,0) << 8) | XN_TAKE_BITS(pcInput[20],8,0);
+		shift[14] = (XN_TAKE_BITS(pcInput[21],8,0) << 4) | XN_TAKE_BITS(pcInput[22],4,4);
+		shift[15] = (XN_TAKE_BITS(pcInput[22],4,0) << 8) | XN_TAKE_BITS(pcInput[23],8,0);
+
+		shift[0] = (((shift[0]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[0]) : 0);
+		shift[1] = (((shift[1]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[1]) : 0);
+		shift[2] = (((shift[2]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[2]) : 0);
+		shift[3] = (((shift[3]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[3]) : 0);
+		shift[4] = (((shift[4]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[4]) : 0);
+		shift[5] = (((shift[5]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[5]) : 0);
+		shift[6] = (((shift[6]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[6]) : 0);
+		shift[7] = (((shift[7]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[7]) : 0);
+		shift[8] = (((shift[8]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[8]) : 0);
+		shift[9] = (((shift[9]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[9]) : 0);
+		shift[10] = (((shift[10]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[10]) : 0);
+		shift[11] = (((shift[11]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[11]) : 0);
+		shift[12] = (((shift[12]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[12]) : 0);
+		shift[13] = (((shift[13]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[13]) : 0);
+		shift[14] = (((shift[14]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[14]) : 0);
+		shift[15] = (((shift[15]) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (shift[15]) : 0);
+
+		pnOutput[0] = pShiftToDepth[shift[0]];
+		pnOutput[nStep] = pShiftToDepth[shift[1]];
+		pnOutput[2 * nStep] = pShiftToDepth[shift[2]];
+		pnOutput[3 * nStep] = pShiftToDepth[shift[3]];
+		pnOutput[4 * nStep] = pShiftToDepth[shift[4]];
+		pnOutput[5 * nStep] = pShiftToDepth[shift[5]];
+		pnOutput[6 * nStep] = pShiftToDepth[shift[6]];
+		pnOutput[7 * nStep] = pShiftToDepth[shift[7]];
+		pnOutput[8 * nStep] = pShiftToDepth[shift[8]];
+		pnOutput[9 * nStep] = pShiftToDepth[shift[9]];
+		pnOutput[10 * nStep] = pShiftToDepth[shift[10]];
+		pnOutput[11 * nStep] = pShiftToDepth[shift[11]];
+		pnOutput[12 * nStep] = pShiftToDepth[shift[12]];
+		pnOutput[13 * nStep] = pShiftToDepth[shift[13]];
+		pnOutput[14 * nStep] = pShiftToDepth[shift[14]];
+		pnOutput[15 * nStep] = pShiftToDepth[shift[15]];
+
+		pcInput += XN_PACKED_12_INPUT_ELEMENT_SIZE;
+		pnOutput += 16 * nStep;
+	}
+}
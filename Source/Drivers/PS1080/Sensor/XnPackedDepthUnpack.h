@@ -0,0 +1,55 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _XN_PACKED_DEPTH_UNPACK_H_
+#define _XN_PACKED_DEPTH_UNPACK_H_
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <XnPlatform.h>
+#include <OniCTypes.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+/* The size of an 11-bit input element (8 shifts) in the stream. */
+#define XN_PACKED_11_INPUT_ELEMENT_SIZE 11
+/* The size of a 12-bit input element (16 shifts) in the stream. */
+#define XN_PACKED_12_INPUT_ELEMENT_SIZE 24
+
+//---------------------------------------------------------------------------
+// Functions Declaration
+//---------------------------------------------------------------------------
+/* TRUE if this CPU can run the vector (SSSE3 or NEON) unpackers. */
+XnBool XnPackedDepthCanVectorize();
+
+/*
+* Unpacks nElements elements of big-endian 11-bit shifts and looks them up in pShiftToDepth
+* (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE entries). Output pixels are nStep apart, so -1 writes them
+* backwards. Reads exactly nElements * XN_PACKED_11_INPUT_ELEMENT_SIZE bytes. With bVectorize,
+* the vector unpacker does as much as it can and the scalar code does the rest.
+*/
+void XnUnpackPacked11Depth(const XnUInt8* pcInput, XnUInt32 nElements, const OniDepthPixel* pShiftToDepth, OniDepthPixel* pnOutput, XnInt32 nStep, XnBool bVectorize);
+
+/* Same as XnUnpackPacked11Depth(), for 12-bit shifts. Shifts out of the table read as 0. */
+void XnUnpackPacked12Depth(const XnUInt8* pcInput, XnUInt32 nElements, const OniDepthPixel* pShiftToDepth, OniDepthPixel* pnOutput, XnInt32 nStep, XnBool bVectorize);
+
+#endif //_XN_PACKED_DEPTH_UNPACK_H_
@@ -76,6 +76,7 @@ XnSensorDepthStream::XnSensorDepthStream(const XnChar* strName, XnSensorObjects*
 	m_GMCDebug(XN_STREAM_PROPERTY_GMC_DEBUG, "GMCDebug", XN_DEPTH_STREAM_DEFAULT_GMC_DEBUG),
 	m_WavelengthCorrection(XN_STREAM_PROPERTY_WAVELENGTH_CORRECTION, "WavelengthCorrection", XN_DEPTH_STREAM_DEFAULT_WAVELENGTH_CORRECTION),
 	m_WavelengthCorrectionDebug(XN_STREAM_PROPERTY_WAVELENGTH_CORRECTION_DEBUG, "WavelengthCorrectionDebug", XN_DEPTH_STREAM_DEFAULT_WAVELENGTH_CORRECTION_DEBUG),
+	m_bMirroredOnWrite(FALSE),
 	m_depthUtilsHandle(NULL),
 	m_hReferenceSizeChangedCallback(NULL)
 {
@@ -884,7 +885,15 @@ XnStatus XnSensorDepthStream::CropImpl(OniFrame* pFrame, const OniCropping* pCro
 	// if firmware cropping is disabled, crop
 	if (m_FirmwareCropMode.GetValue() == XN_FIRMWARE_CROPPING_MODE_DISABLED)
 	{
-		nRetVal = XnDepthStream::CropImpl(pFrame, pCropping);
+		OniCropping cropping = *pCropping;
+
+		// cropping comes before mirroring, so if the frame is already mirrored, take the mirrored area
+		if (m_bMirroredOnWrite)
+		{
+			cropping.originX = GetXRes() - pCropping->originX - pCropping->width;
+		}
+
+		nRetVal = XnDepthStream::CropImpl(pFrame, &cropping);
 		XN_IS_STATUS_OK(nRetVal);
 	}
 
@@ -895,8 +904,9 @@ XnStatus XnSensorDepthStream::Mirror(OniFrame* pFrame) const
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 
-	// only perform mirror if it's our job. if mirror is performed by FW, we don't need to do anything.
-	if (m_FirmwareMirror.GetValue() == FALSE)
+	// only perform mirror if it's our job. if mirror is performed by FW, or by the processor while
+	// writing the frame, we don't need to do anything.
+	if (m_FirmwareMirror.GetValue() == FALSE && !m_bMirroredOnWrite)
 	{
 		nRetVal = XnDepthStream::Mirror(pFrame);
 		XN_IS_STATUS_OK(nRetVal);
@@ -1026,6 +1036,26 @@ XnStatus XnSensorDepthStream::GetImageCoordinatesOfDepthPixel(XnUInt32 x, XnUInt
 	return nRetVal;
 }
 
+XnStatus XnSensorDepthStream::PrepareImageCoordinatesOfDepthRect(XnUInt32 imageXRes, XnUInt32 imageYRes)
+{
+	if (m_depthUtilsHandle == NULL)
+	{
+		return XN_STATUS_DEVICE_UNSUPPORTED_PARAMETER;
+	}
+
+	return DepthUtilsSetColorResolution(m_depthUtilsHandle, imageXRes, imageYRes);
+}
+
+XnStatus XnSensorDepthStream::GetImageCoordinatesOfDepthRect(const OniDepthPixel* pDepth, XnUInt32 nStride, XnUInt32 x, XnUInt32 y, XnUInt32 width, XnUInt32 height, XnInt32* pImageXY)
+{
+	if (m_depthUtilsHandle == NULL)
+	{
+		return XN_STATUS_DEVICE_UNSUPPORTED_PARAMETER;
+	}
+
+	return DepthUtilsTranslateDepthRect(m_depthUtilsHandle, pDepth, nStride, x, y, width, height, pImageXY);
+}
+
 OniStatus XnSensorDepthStream::GetSensorCalibrationInfo(void* data, int* pDataSize)
 {
 	if ((size_t)*pDataSize < sizeof(DepthUtilsSensorCalibrationInfo))
@@ -119,6 +119,10 @@ protected:
 	virtual XnStatus SetCloseRange(XnBool bCloseRange);
 	virtual XnStatus SetCroppingMode(XnCroppingMode mode);
 	XnStatus GetImageCoordinatesOfDepthPixel(XnUInt32 x, XnUInt32 y, OniDepthPixel z, XnUInt32 imageXRes, XnUInt32 imageYRes, XnUInt32& imageX, XnUInt32& imageY);
+	// Builds the image tables GetImageCoordinatesOfDepthRect() reads. Call before mapping a frame's rects.
+	XnStatus PrepareImageCoordinatesOfDepthRect(XnUInt32 imageXRes, XnUInt32 imageYRes);
+	// Safe to call concurrently for different rects once prepared.
+	XnStatus GetImageCoordinatesOfDepthRect(const OniDepthPixel* pDepth, XnUInt32 nStride, XnUInt32 x, XnUInt32 y, XnUInt32 width, XnUInt32 height, XnInt32* pImageXY);
 	virtual XnStatus SetGMCDebug(XnBool bGMCDebug);
 	virtual XnStatus SetWavelengthCorrection(XnBool bWavelengthCorrection);
 	virtual XnStatus SetWavelengthCorrectionDebug(XnBool bWavelengthCorrectionDebug);
@@ -184,6 +188,9 @@ private:
 	XnActualIntProperty m_WavelengthCorrection;
 	XnActualIntProperty m_WavelengthCorrectionDebug;
 
+	// TRUE if the processor mirrored the current frame while writing it
+	XnBool m_bMirroredOnWrite;
+
 	DepthUtilsHandle m_depthUtilsHandle;
 	DepthUtilsSensorCalibrationInfo m_calibrationInfo;
 	XnCallbackHandle m_hReferenceSizeChangedCallback;
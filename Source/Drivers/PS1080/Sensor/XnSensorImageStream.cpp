@@ -62,7 +62,9 @@ XnSensorImageStream::XnSensorImageStream(const XnChar* StreamName, XnSensorObjec
 
 	m_ActualRead(XN_STREAM_PROPERTY_ACTUAL_READ_DATA, "ActualReadData", FALSE),
 	m_HorizontalFOV(ONI_STREAM_PROPERTY_HORIZONTAL_FOV, "HorizontalFov"),
-	m_VerticalFOV(ONI_STREAM_PROPERTY_VERTICAL_FOV, "VerticalFov")
+	m_VerticalFOV(ONI_STREAM_PROPERTY_VERTICAL_FOV, "VerticalFov"),
+	m_DebayeringMethod(XN_STREAM_PROPERTY_DEBAYERING_METHOD, "DebayeringMethod", XN_IMAGE_STREAM_DEFAULT_DEBAYERING_METHOD),
+	m_DebayeringThreads(XN_STREAM_PROPERTY_DEBAYERING_THREADS, "DebayeringThreads", XN_IMAGE_STREAM_DEFAULT_DEBAYERING_THREADS)
 {
 }
 
@@ -86,10 +88,13 @@ XnStatus XnSensorImageStream::Init()
 	m_Gain.UpdateSetCallback(SetGainCallback, this);
 	m_AutoWhiteBalance.UpdateSetCallback(SetAutoWhiteBalanceCallback, this);
 	m_ActualRead.UpdateSetCallback(SetActualReadCallback, this); 
+	m_DebayeringMethod.UpdateSetCallback(SetDebayeringMethodCallback, this);
+	m_DebayeringThreads.UpdateSetCallback(SetDebayeringThreadsCallback, this);
 
 	// add properties
 	XN_VALIDATE_ADD_PROPERTIES(this, &m_InputFormat, &m_AntiFlicker, &m_ImageQuality, 
-		&m_CroppingMode, &m_ActualRead, &m_HorizontalFOV, &m_VerticalFOV, &m_AutoExposure, &m_AutoWhiteBalance, &m_Exposure, &m_Gain);
+		&m_CroppingMode, &m_ActualRead, &m_HorizontalFOV, &m_VerticalFOV, &m_AutoExposure, &m_AutoWhiteBalance, &m_Exposure, &m_Gain,
+		&m_DebayeringMethod, &m_DebayeringThreads);
 
 	// set base properties default values
 	nRetVal = ResolutionProperty().UnsafeUpdateValue(XN_IMAGE_STREAM_DEFAULT_RESOLUTION);
@@ -178,6 +183,7 @@ XnStatus XnSensorImageStream::Init()
 XnStatus XnSensorImageStream::Free()
 {
 	m_Helper.Free();
+	m_DebayeringThreadPool.Destroy();
 	XnImageStream::Free();
 	return (XN_STATUS_OK);
 }
@@ -755,6 +761,61 @@ XnStatus XnSensorImageStream::SetGain(XnUInt64 nValue)
 	return (XN_STATUS_OK);
 }
 
+XnStatus XnSensorImageStream::SetDebayeringMethod(XnDebayeringMethod method)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	switch (method)
+	{
+	case XN_DEBAYERING_BILINEAR:
+	case XN_DEBAYERING_EDGE_AWARE:
+	case XN_DEBAYERING_EDGE_AWARE_WEIGHTED:
+		break;
+	default:
+		XN_LOG_WARNING_RETURN(XN_STATUS_DEVICE_BAD_PARAM, XN_MASK_DEVICE_SENSOR, "Unknown debayering method: %d", method);
+	}
+
+	// host side only, nothing to tell the firmware
+	nRetVal = m_DebayeringMethod.UnsafeUpdateValue(method);
+	XN_IS_STATUS_OK(nRetVal);
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnSensorImageStream::SetDebayeringThreads(XnUInt32 nThreads)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	XnUInt32 nActualThreads = nThreads;
+	if (nActualThreads == 0 && xnOSGetProcessorCount(&nActualThreads) != XN_STATUS_OK)
+	{
+		nActualThreads = 1;
+	}
+
+	{
+		xnl::AutoCSLocker lock(m_DebayeringCS);
+		m_DebayeringThreadPool.Destroy();
+
+		// the calling thread does its share too
+		if (nActualThreads > 1)
+		{
+			nRetVal = m_DebayeringThreadPool.Create(nActualThreads - 1);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+	}
+
+	nRetVal = m_DebayeringThreads.UnsafeUpdateValue(nThreads);
+	XN_IS_STATUS_OK(nRetVal);
+
+	return (XN_STATUS_OK);
+}
+
+void XnSensorImageStream::Debayer(const XnUInt8* pBayerImage, XnUInt8* pRGBImage, XnUInt32 nXRes, XnUInt32 nYRes)
+{
+	xnl::AutoCSLocker lock(m_DebayeringCS);
+	Bayer2RGB888(pBayerImage, pRGBImage, nXRes, nYRes, 1, (XnDebayeringMethod)m_DebayeringMethod.GetValue(), &m_DebayeringThreadPool);
+}
+
 XnStatus XnSensorImageStream::CropImpl(OniFrame* pFrame, const OniCropping* pCropping)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -940,4 +1001,16 @@ XnStatus XN_CALLBACK_TYPE XnSensorImageStream::SetGainCallback(XnActualIntProper
 {
 	XnSensorImageStream* pStream = (XnSensorImageStream*)pCookie;
 	return pStream->SetGain(nValue);
+}
+
+XnStatus XN_CALLBACK_TYPE XnSensorImageStream::SetDebayeringMethodCallback(XnActualIntProperty*, XnUInt64 nValue, void* pCookie)
+{
+	XnSensorImageStream* pStream = (XnSensorImageStream*)pCookie;
+	return pStream->SetDebayeringMethod((XnDebayeringMethod)nValue);
+}
+
+XnStatus XN_CALLBACK_TYPE XnSensorImageStream::SetDebayeringThreadsCallback(XnActualIntProperty*, XnUInt64 nValue, void* pCookie)
+{
+	XnSensorImageStream* pStream = (XnSensorImageStream*)pCookie;
+	return pStream->SetDebayeringThreads((XnUInt32)nValue);
 }
\ No newline at end of file
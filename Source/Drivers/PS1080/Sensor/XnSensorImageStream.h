@@ -26,6 +26,7 @@
 //---------------------------------------------------------------------------
 #include <DDK/XnImageStream.h>
 #include "XnSensorStreamHelper.h"
+#include <XnThreadPool.h>
 
 //---------------------------------------------------------------------------
 // Defines
@@ -55,6 +56,8 @@
 #define XN_IMAGE_STREAM_DEFAULT_PAN			0
 #define XN_IMAGE_STREAM_DEFAULT_TILT			0
 #define XN_IMAGE_STREAM_DEFAULT_LOW_LIGHT_COMP		TRUE
+#define XN_IMAGE_STREAM_DEFAULT_DEBAYERING_METHOD	XN_DEBAYERING_EDGE_AWARE
+#define XN_IMAGE_STREAM_DEFAULT_DEBAYERING_THREADS	1
 
 //---------------------------------------------------------------------------
 // XnSensorImageStream class
@@ -76,6 +79,9 @@ public:
 
 	inline XnSensorStreamHelper* GetHelper() { return &m_Helper; }
 
+	/** Converts a Bayer image to RGB888 using the configured debayering method and threads. */
+	void Debayer(const XnUInt8* pBayerImage, XnUInt8* pRGBImage, XnUInt32 nXRes, XnUInt32 nYRes);
+
 	friend class XnImageProcessor;
 
 protected:
@@ -112,6 +118,8 @@ protected:
 	virtual XnStatus SetAutoWhiteBalance(XnBool bAutoWhiteBalance);
 	virtual XnStatus SetExposure(XnUInt64 nValue);
 	virtual XnStatus SetGain(XnUInt64 nValue);
+	XnStatus SetDebayeringMethod(XnDebayeringMethod method);
+	XnStatus SetDebayeringThreads(XnUInt32 nThreads);
 private:
 	XnStatus ValidateMode();
 	XnStatus SetCroppingImpl(const OniCropping* pCropping, XnCroppingMode mode);
@@ -127,6 +135,8 @@ private:
 	static XnStatus XN_CALLBACK_TYPE SetAutoWhiteBalanceCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetExposureCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetGainCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE SetDebayeringMethodCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE SetDebayeringThreadsCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 
 	//---------------------------------------------------------------------------
 	// Members
@@ -154,6 +164,12 @@ private:
 
 	XnActualRealProperty m_HorizontalFOV;
 	XnActualRealProperty m_VerticalFOV;
+
+	XnActualIntProperty m_DebayeringMethod;
+	XnActualIntProperty m_DebayeringThreads;
+	xnl::ThreadPool m_DebayeringThreadPool;
+	// guards the pool against being replaced while a frame is debayered
+	xnl::CriticalSection m_DebayeringCS;
 };
 
 #endif //__XN_SENSOR_IMAGE_STREAM_H__
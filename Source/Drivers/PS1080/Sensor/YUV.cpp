@@ -22,14 +22,29 @@
 // Includes
 //---------------------------------------------------------------------------
 #include "YUV.h"
+#include <XnSIMD.h>
 #include <math.h>
 
-#if (XN_PLATFORM == XN_PLATFORM_WIN32)
-	#ifdef __INTEL_COMPILER
-		#include <ia32intrin.h>
-	#else
-		#include <emmintrin.h>
-	#endif
+#ifdef XN_NEON
+#include <arm_neon.h>
+#endif
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+/* The vector code converts blocks of 8 input elements. */
+#define XN_YUV_BLOCK_PIXELS			16
+#define XN_YUV_BLOCK_INPUT_SIZE		(XN_YUV_BLOCK_PIXELS / 2 * YUV422_BPP)
+#define XN_YUV_BLOCK_OUTPUT_SIZE	(XN_YUV_BLOCK_PIXELS * YUV_RGB_BPP)
+
+#ifdef XN_YUV_FLOAT_FORMULA
+/* Windows has always converted two elements at a time, when there is room for all of their output. */
+#define XN_YUV_SCALAR_INPUT_SIZE	XN_YUV_TO_RGB_INPUT_ELEMENT_SIZE
+#define XN_YUV_SCALAR_OUTPUT_ROOM	XN_YUV_TO_RGB_OUTPUT_ELEMENT_SIZE
+#else
+/* The other platforms convert one element at a time, while there is room for one more pixel. */
+#define XN_YUV_SCALAR_INPUT_SIZE	YUV422_BPP
+#define XN_YUV_SCALAR_OUTPUT_ROOM	YUV_RGB_BPP
 #endif
 
 //---------------------------------------------------------------------------
@@ -53,287 +68,259 @@ void YUV444ToRGB888(XnUInt8 cY, XnUInt8 cU, XnUInt8 cV,
 	cB = (XnUInt8)XN_MIN(XN_MAX((nC + 516 * nD           ) >> 8, 0), 255);
 }
 
-#if (XN_PLATFORM == XN_PLATFORM_WIN32)
+#ifdef XN_YUV_FLOAT_FORMULA
+/*
+http://en.wikipedia.org/wiki/YUV
 
-void YUV422ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
-{
-	const XnUInt8* pYUVLast = pYUVImage + nYUVSize - 8;
-	const XnUInt8* pYUVOrig = pYUVImage;
-	const XnUInt8* pRGBOrig = pRGBImage;
-	const XnUInt8* pRGBLast = pRGBImage + *pnRGBSize - 12;
+From YUV to RGB:
+R =     Y + 1.13983 V
+G =     Y - 0.39466 U - 0.58060 V
+B =     Y + 2.03211 U
 
-	const __m128 minus128 = _mm_set_ps1(-128);
-	const __m128 plus113983 = _mm_set_ps1(1.13983F);
-	const __m128 minus039466 = _mm_set_ps1(-0.39466F);
-	const __m128 minus058060 = _mm_set_ps1(-0.58060F);
-	const __m128 plus203211 = _mm_set_ps1(2.03211F);
-	const __m128 zero = _mm_set_ps1(0);
-	const __m128 plus255 = _mm_set_ps1(255);
-
-	// define YUV floats
-	__m128 y;
-	__m128 u;
-	__m128 v;
+Each value is clamped to [0, 255] and rounded to nearest, with SSE single precision operations
+done in this order, so the vector code below gives the exact same output.
+*/
+void YUV444ToRGB888Float(XnUInt8 cY, XnUInt8 cU, XnUInt8 cV,
+						 XnUInt8& cR, XnUInt8& cG, XnUInt8& cB)
+{
+	const __m128 zero = _mm_set_ss(0);
+	const __m128 plus255 = _mm_set_ss(255);
 
-	__m128 temp;
+	__m128 y = _mm_set_ss(cY);
+	__m128 u = _mm_add_ss(_mm_set_ss(cU), _mm_set_ss(-128));
+	__m128 v = _mm_add_ss(_mm_set_ss(cV), _mm_set_ss(-128));
 
-	// define RGB floats
-	__m128 r;
-	__m128 g;
-	__m128 b;
+	__m128 r = _mm_add_ss(y, _mm_mul_ss(_mm_set_ss(1.13983F), v));
+	__m128 g = _mm_add_ss(_mm_add_ss(y, _mm_mul_ss(_mm_set_ss(-0.39466F), u)), _mm_mul_ss(_mm_set_ss(-0.58060F), v));
+	__m128 b = _mm_add_ss(y, _mm_mul_ss(_mm_set_ss(2.03211F), u));
 
-	// define RGB integers
-	__m128i iR;
-	__m128i iG;
-	__m128i iB;
+	cR = (XnUInt8)_mm_cvtss_si32(_mm_min_ss(_mm_max_ss(r, zero), plus255));
+	cG = (XnUInt8)_mm_cvtss_si32(_mm_min_ss(_mm_max_ss(g, zero), plus255));
+	cB = (XnUInt8)_mm_cvtss_si32(_mm_min_ss(_mm_max_ss(b, zero), plus255));
+}
 
-	XnUInt32* piR = (XnUInt32*)&iR;
-	XnUInt32* piG = (XnUInt32*)&iG;
-	XnUInt32* piB = (XnUInt32*)&iB;
+// Converts 8 pixels, whose Y, U and V values are in 16-bit lanes, exactly as YUV444ToRGB888Float() does.
+// The results are left in 16-bit lanes.
+static inline void YUV444ToRGB888x8(__m128i y, __m128i u, __m128i v, __m128i& r, __m128i& g, __m128i& b)
+{
+	const __m128 minus128 = _mm_set_ps1(-128);
+	const __m128 zero = _mm_set_ps1(0);
+	const __m128 plus255 = _mm_set_ps1(255);
+	const __m128i zeroi = _mm_setzero_si128();
 
-	while (pYUVImage <= pYUVLast && pRGBImage <= pRGBLast)
+	// 4 pixels at a time, in 32-bit lanes
+	__m128i rgb[3][2];
+	for (XnUInt32 i = 0; i < 2; ++i)
 	{
-		// process 4 pixels at once (values should be ordered backwards)
-		y = _mm_set_ps(pYUVImage[YUV422_Y2 + YUV422_BPP], pYUVImage[YUV422_Y1 + YUV422_BPP], pYUVImage[YUV422_Y2], pYUVImage[YUV422_Y1]);
-		u = _mm_set_ps(pYUVImage[YUV422_U + YUV422_BPP],  pYUVImage[YUV422_U + YUV422_BPP],  pYUVImage[YUV422_U],  pYUVImage[YUV422_U]);
-		v = _mm_set_ps(pYUVImage[YUV422_V + YUV422_BPP],  pYUVImage[YUV422_V + YUV422_BPP],  pYUVImage[YUV422_V],  pYUVImage[YUV422_V]);
-
-		u = _mm_add_ps(u, minus128); // u -= 128
-		v = _mm_add_ps(v, minus128); // v -= 128
-
-		/*
-
-		http://en.wikipedia.org/wiki/YUV
-
-		From YUV to RGB:
-		R =     Y + 1.13983 V
-		G =     Y - 0.39466 U - 0.58060 V
-		B =     Y + 2.03211 U
-
-		*/ 
-
-		temp = _mm_mul_ps(plus113983, v);
-		r = _mm_add_ps(y, temp);
+		__m128 fY = _mm_cvtepi32_ps(i == 0 ? _mm_unpacklo_epi16(y, zeroi) : _mm_unpackhi_epi16(y, zeroi));
+		__m128 fU = _mm_add_ps(_mm_cvtepi32_ps(i == 0 ? _mm_unpacklo_epi16(u, zeroi) : _mm_unpackhi_epi16(u, zeroi)), minus128);
+		__m128 fV = _mm_add_ps(_mm_cvtepi32_ps(i == 0 ? _mm_unpacklo_epi16(v, zeroi) : _mm_unpackhi_epi16(v, zeroi)), minus128);
 
-		temp = _mm_mul_ps(minus039466, u);
-		g = _mm_add_ps(y, temp);
-		temp = _mm_mul_ps(minus058060, v);
-		g = _mm_add_ps(g, temp);
+		__m128 fR = _mm_add_ps(fY, _mm_mul_ps(_mm_set_ps1(1.13983F), fV));
+		__m128 fG = _mm_add_ps(_mm_add_ps(fY, _mm_mul_ps(_mm_set_ps1(-0.39466F), fU)), _mm_mul_ps(_mm_set_ps1(-0.58060F), fV));
+		__m128 fB = _mm_add_ps(fY, _mm_mul_ps(_mm_set_ps1(2.03211F), fU));
 
-		temp = _mm_mul_ps(plus203211, u);
-		b = _mm_add_ps(y, temp);
+		rgb[0][i] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(fR, zero), plus255));
+		rgb[1][i] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(fG, zero), plus255));
+		rgb[2][i] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(fB, zero), plus255));
+	}
 
-		// make sure no value is smaller than 0
-		r = _mm_max_ps(r, zero);
-		g = _mm_max_ps(g, zero);
-		b = _mm_max_ps(b, zero);
+	r = _mm_packs_epi32(rgb[0][0], rgb[0][1]);
+	g = _mm_packs_epi32(rgb[1][0], rgb[1][1]);
+	b = _mm_packs_epi32(rgb[2][0], rgb[2][1]);
+}
+#elif defined(XN_SSE)
+// Converts 8 pixels, whose Y, U and V values are in 16-bit lanes, exactly as YUV444ToRGB888() does.
+// The results are left in 16-bit lanes, not yet clamped.
+static inline void YUV444ToRGB888x8(__m128i y, __m128i u, __m128i v, __m128i& r, __m128i& g, __m128i& b)
+{
+	// pairs of coefficients, for _mm_madd_epi16(). Green takes its rounding from (e, 1) * (-208, 128).
+	const __m128i coeffsR = _mm_setr_epi16(298, 409, 298, 409, 298, 409, 298, 409);
+	const __m128i coeffsG = _mm_setr_epi16(298, -100, 298, -100, 298, -100, 298, -100);
+	const __m128i coeffsB = _mm_setr_epi16(298, 516, 298, 516, 298, 516, 298, 516);
+	const __m128i coeffsGE = _mm_setr_epi16(-208, 128, -208, 128, -208, 128, -208, 128);
+	const __m128i round = _mm_set1_epi32(128);
+	const __m128i one = _mm_set1_epi16(1);
+
+	__m128i c = _mm_sub_epi16(y, _mm_set1_epi16(16));
+	__m128i d = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	__m128i e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+
+	__m128i ceLo = _mm_unpacklo_epi16(c, e);
+	__m128i ceHi = _mm_unpackhi_epi16(c, e);
+	__m128i cdLo = _mm_unpacklo_epi16(c, d);
+	__m128i cdHi = _mm_unpackhi_epi16(c, d);
+	__m128i e1Lo = _mm_unpacklo_epi16(e, one);
+	__m128i e1Hi = _mm_unpackhi_epi16(e, one);
+
+	r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceLo, coeffsR), round), 8),
+		_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceHi, coeffsR), round), 8));
+	g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, coeffsG), _mm_madd_epi16(e1Lo, coeffsGE)), 8),
+		_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, coeffsG), _mm_madd_epi16(e1Hi, coeffsGE)), 8));
+	b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, coeffsB), round), 8),
+		_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, coeffsB), round), 8));
+}
+#endif
 
-		// make sure no value is bigger than 255
-		r = _mm_min_ps(r, plus255);
-		g = _mm_min_ps(g, plus255);
-		b = _mm_min_ps(b, plus255);
+#ifdef XN_SSE
+// Stores 16 pixels of R, G and B planes as RGB888
+XN_SSSE3_FUNCTION static inline void StoreRGB888x16(XnUInt8* pRGB, __m128i r, __m128i g, __m128i b)
+{
+	const __m128i r0 = _mm_setr_epi8(0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1,-1, 5);
+	const __m128i g0 = _mm_setr_epi8(-1,0,-1, -1,1,-1, -1,2,-1, -1,3,-1, -1,4,-1, -1);
+	const __m128i b0 = _mm_setr_epi8(-1,-1,0, -1,-1,1, -1,-1,2, -1,-1,3, -1,-1,4, -1);
+	const __m128i r1 = _mm_setr_epi8(-1,-1,6, -1,-1,7, -1,-1,8, -1,-1,9, -1,-1,10, -1);
+	const __m128i g1 = _mm_setr_epi8(5,-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1, 10);
+	const __m128i b1 = _mm_setr_epi8(-1,5,-1, -1,6,-1, -1,7,-1, -1,8,-1, -1,9,-1, -1);
+	const __m128i r2 = _mm_setr_epi8(-1,11,-1, -1,12,-1, -1,13,-1, -1,14,-1, -1,15,-1, -1);
+	const __m128i g2 = _mm_setr_epi8(-1,-1,11, -1,-1,12, -1,-1,13, -1,-1,14, -1,-1,15, -1);
+	const __m128i b2 = _mm_setr_epi8(10,-1,-1, 11,-1,-1, 12,-1,-1, 13,-1,-1, 14,-1,-1, 15);
+
+	_mm_storeu_si128((__m128i*)pRGB, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r0), _mm_shuffle_epi8(g, g0)), _mm_shuffle_epi8(b, b0)));
+	_mm_storeu_si128((__m128i*)(pRGB + 16), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r1), _mm_shuffle_epi8(g, g1)), _mm_shuffle_epi8(b, b1)));
+	_mm_storeu_si128((__m128i*)(pRGB + 32), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r2), _mm_shuffle_epi8(g, g2)), _mm_shuffle_epi8(b, b2)));
+}
 
-		// convert floats to int16 (there is no conversion to uint8, just to int8).
-		iR = _mm_cvtps_epi32(r);
-		iG = _mm_cvtps_epi32(g);
-		iB = _mm_cvtps_epi32(b);
+// Converts nBlocks blocks of 8 input elements (16 pixels). nY1, nU, nY2 and nV are the offsets
+// of the values in an element.
+template <int nY1, int nU, int nY2, int nV>
+XN_SSSE3_FUNCTION static void YUVToRGB888SSSE3(const XnUInt8* pYUV, XnUInt8* pRGB, XnUInt32 nBlocks)
+{
+	// the values of each pixel of 4 elements, zero extended to 16 bits
+	const __m128i yShuffle = _mm_setr_epi8(nY1,-1, nY2,-1, nY1+4,-1, nY2+4,-1, nY1+8,-1, nY2+8,-1, nY1+12,-1, nY2+12,-1);
+	const __m128i uShuffle = _mm_setr_epi8(nU,-1, nU,-1, nU+4,-1, nU+4,-1, nU+8,-1, nU+8,-1, nU+12,-1, nU+12,-1);
+	const __m128i vShuffle = _mm_setr_epi8(nV,-1, nV,-1, nV+4,-1, nV+4,-1, nV+8,-1, nV+8,-1, nV+12,-1, nV+12,-1);
 
-		// extract the 4 pixels RGB values.
-		// because we made sure values are between 0 and 255, we can just take the lower byte
-		// of each INT16
-		pRGBImage[0] = (XnUInt8)piR[0];
-		pRGBImage[1] = (XnUInt8)piG[0];
-		pRGBImage[2] = (XnUInt8)piB[0];
+	__m128i r0, g0, b0, r1, g1, b1;
 
-		pRGBImage[3] = (XnUInt8)piR[1];
-		pRGBImage[4] = (XnUInt8)piG[1];
-		pRGBImage[5] = (XnUInt8)piB[1];
+	for (XnUInt32 nBlock = 0; nBlock < nBlocks; ++nBlock)
+	{
+		__m128i in0 = _mm_loadu_si128((const __m128i*)pYUV);
+		__m128i in1 = _mm_loadu_si128((const __m128i*)(pYUV + 16));
 
-		pRGBImage[6] = (XnUInt8)piR[2];
-		pRGBImage[7] = (XnUInt8)piG[2];
-		pRGBImage[8] = (XnUInt8)piB[2];
+		YUV444ToRGB888x8(_mm_shuffle_epi8(in0, yShuffle), _mm_shuffle_epi8(in0, uShuffle), _mm_shuffle_epi8(in0, vShuffle), r0, g0, b0);
+		YUV444ToRGB888x8(_mm_shuffle_epi8(in1, yShuffle), _mm_shuffle_epi8(in1, uShuffle), _mm_shuffle_epi8(in1, vShuffle), r1, g1, b1);
 
-		pRGBImage[9] = (XnUInt8)piR[3];
-		pRGBImage[10] = (XnUInt8)piG[3];
-		pRGBImage[11] = (XnUInt8)piB[3];
+		// packing with unsigned saturation clamps to [0, 255]
+		StoreRGB888x16(pRGB, _mm_packus_epi16(r0, r1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(b0, b1));
 
-		// advance the streams
-		pYUVImage += 8;
-		pRGBImage += 12;
+		pYUV += XN_YUV_BLOCK_INPUT_SIZE;
+		pRGB += XN_YUV_BLOCK_OUTPUT_SIZE;
 	}
-
-	*pnActualRead = (XnUInt32)(pYUVImage - pYUVOrig);
-	*pnRGBSize = (XnUInt32)(pRGBImage - pRGBOrig);
 }
+#endif
 
-#else // not Win32
-
-void YUV422ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
+#ifdef XN_NEON
+// One channel of 8 pixels, (298 * c + nD * d + nE * e + 128) >> 8, clamped to [0, 255]
+static inline uint8x8_t YUV444ToChannelNEON(int16x8_t c, int16x8_t d, int16x8_t e, XnInt16 nD, XnInt16 nE)
 {
-	const XnUInt8* pOrigYUV = pYUVImage;
-	const XnUInt8* pCurrYUV = pYUVImage;
-	const XnUInt8* pOrigRGB = pRGBImage;
-	XnUInt8* pCurrRGB = pRGBImage;
-	const XnUInt8* pLastYUV = pYUVImage + nYUVSize - YUV422_BPP;
-	const XnUInt8* pLastRGB = pRGBImage + *pnRGBSize - YUV_RGB_BPP;
+	int32x4_t lo = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vdupq_n_s32(128), vget_low_s16(c), 298), vget_low_s16(d), nD), vget_low_s16(e), nE);
+	int32x4_t hi = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vdupq_n_s32(128), vget_high_s16(c), 298), vget_high_s16(d), nD), vget_high_s16(e), nE);
+	return vqmovun_s16(vcombine_s16(vqshrn_n_s32(lo, 8), vqshrn_n_s32(hi, 8)));
+}
 
-	while (pCurrYUV <= pLastYUV && pCurrRGB <= pLastRGB)
+// Same as the SSSE3 conversion, with NEON structure loads and stores.
+template <int nY1, int nU, int nY2, int nV>
+static void YUVToRGB888NEON(const XnUInt8* pYUV, XnUInt8* pRGB, XnUInt32 nBlocks)
+{
+	for (XnUInt32 nBlock = 0; nBlock < nBlocks; ++nBlock)
 	{
-		YUV444ToRGB888(pCurrYUV[YUV422_Y1], pCurrYUV[YUV422_U], pCurrYUV[YUV422_V],
-						pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
-		pCurrRGB += YUV_RGB_BPP;
-		YUV444ToRGB888(pCurrYUV[YUV422_Y2], pCurrYUV[YUV422_U], pCurrYUV[YUV422_V],
-						pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
-		pCurrRGB += YUV_RGB_BPP;
-		pCurrYUV += YUV422_BPP;
+		// val[i] holds byte i of each of the 8 elements
+		uint8x8x4_t in = vld4_u8(pYUV);
+
+		int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(in.val[nU], vdup_n_u8(128)));
+		int16x8_t e = vreinterpretq_s16_u16(vsubl_u8(in.val[nV], vdup_n_u8(128)));
+		int16x8_t c1 = vreinterpretq_s16_u16(vsubl_u8(in.val[nY1], vdup_n_u8(16)));
+		int16x8_t c2 = vreinterpretq_s16_u16(vsubl_u8(in.val[nY2], vdup_n_u8(16)));
+
+		// the first and second pixel of each element alternate in the output
+		uint8x8x2_t r = vzip_u8(YUV444ToChannelNEON(c1, d, e, 0, 409), YUV444ToChannelNEON(c2, d, e, 0, 409));
+		uint8x8x2_t g = vzip_u8(YUV444ToChannelNEON(c1, d, e, -100, -208), YUV444ToChannelNEON(c2, d, e, -100, -208));
+		uint8x8x2_t b = vzip_u8(YUV444ToChannelNEON(c1, d, e, 516, 0), YUV444ToChannelNEON(c2, d, e, 516, 0));
+
+		for (XnUInt32 i = 0; i < 2; ++i)
+		{
+			uint8x8x3_t out;
+			out.val[YUV_RED] = r.val[i];
+			out.val[YUV_GREEN] = g.val[i];
+			out.val[YUV_BLUE] = b.val[i];
+			vst3_u8(pRGB + 24 * i, out);
+		}
+
+		pYUV += XN_YUV_BLOCK_INPUT_SIZE;
+		pRGB += XN_YUV_BLOCK_OUTPUT_SIZE;
 	}
-
-	*pnActualRead = pCurrYUV - pOrigYUV;
-	*pnRGBSize = pCurrRGB - pOrigRGB;
 }
-
 #endif
 
-#if (XN_PLATFORM == XN_PLATFORM_WIN32)
-
-void YUYVToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
+// Converts the whole blocks of 16 pixels that fit in both buffers with the vector code, if there is
+// one for this CPU, and returns the number of pixels converted.
+template <int nY1, int nU, int nY2, int nV>
+static XnUInt32 YUVToRGB888Blocks(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32 nRGBSize)
 {
-	const XnUInt8* pYUVLast = pYUVImage + nYUVSize - 8;
-	const XnUInt8* pYUVOrig = pYUVImage;
-	const XnUInt8* pRGBOrig = pRGBImage;
-	const XnUInt8* pRGBLast = pRGBImage + *pnRGBSize - 12;
-
-	const __m128 minus128 = _mm_set_ps1(-128);
-	const __m128 plus113983 = _mm_set_ps1(1.13983F);
-	const __m128 minus039466 = _mm_set_ps1(-0.39466F);
-	const __m128 minus058060 = _mm_set_ps1(-0.58060F);
-	const __m128 plus203211 = _mm_set_ps1(2.03211F);
-	const __m128 zero = _mm_set_ps1(0);
-	const __m128 plus255 = _mm_set_ps1(255);
-
-	// define YUV floats
-	__m128 y;
-	__m128 u;
-	__m128 v;
-
-	__m128 temp;
-
-	// define RGB floats
-	__m128 r;
-	__m128 g;
-	__m128 b;
+	XnUInt32 nBlocks = XN_MIN(nYUVSize / XN_YUV_BLOCK_INPUT_SIZE, nRGBSize / XN_YUV_BLOCK_OUTPUT_SIZE);
 
-	// define RGB integers
-	__m128i iR;
-	__m128i iG;
-	__m128i iB;
-
-	XnUInt32* piR = (XnUInt32*)&iR;
-	XnUInt32* piG = (XnUInt32*)&iG;
-	XnUInt32* piB = (XnUInt32*)&iB;
-
-	while (pYUVImage <= pYUVLast && pRGBImage <= pRGBLast)
+#if defined(XN_NEON)
+	YUVToRGB888NEON<nY1, nU, nY2, nV>(pYUVImage, pRGBImage, nBlocks);
+#elif defined(XN_SSE)
+	if ((xnOSGetCPUFeatures() & XN_CPU_FEATURE_SSSE3) != 0)
 	{
-		// process 4 pixels at once (values should be ordered backwards)
-		y = _mm_set_ps(pYUVImage[YUYV_Y2 + YUYV_BPP], pYUVImage[YUYV_Y1 + YUYV_BPP], pYUVImage[YUYV_Y2], pYUVImage[YUYV_Y1]);
-		u = _mm_set_ps(pYUVImage[YUYV_U + YUYV_BPP],  pYUVImage[YUYV_U + YUYV_BPP],  pYUVImage[YUYV_U],  pYUVImage[YUYV_U]);
-		v = _mm_set_ps(pYUVImage[YUYV_V + YUYV_BPP],  pYUVImage[YUYV_V + YUYV_BPP],  pYUVImage[YUYV_V],  pYUVImage[YUYV_V]);
-
-		u = _mm_add_ps(u, minus128); // u -= 128
-		v = _mm_add_ps(v, minus128); // v -= 128
-
-		/*
-
-		http://en.wikipedia.org/wiki/YUV
-
-		From YUV to RGB:
-		R =     Y + 1.13983 V
-		G =     Y - 0.39466 U - 0.58060 V
-		B =     Y + 2.03211 U
-
-		*/ 
-
-		temp = _mm_mul_ps(plus113983, v);
-		r = _mm_add_ps(y, temp);
-
-		temp = _mm_mul_ps(minus039466, u);
-		g = _mm_add_ps(y, temp);
-		temp = _mm_mul_ps(minus058060, v);
-		g = _mm_add_ps(g, temp);
-
-		temp = _mm_mul_ps(plus203211, u);
-		b = _mm_add_ps(y, temp);
-
-		// make sure no value is smaller than 0
-		r = _mm_max_ps(r, zero);
-		g = _mm_max_ps(g, zero);
-		b = _mm_max_ps(b, zero);
-
-		// make sure no value is bigger than 255
-		r = _mm_min_ps(r, plus255);
-		g = _mm_min_ps(g, plus255);
-		b = _mm_min_ps(b, plus255);
-
-		// convert floats to int16 (there is no conversion to uint8, just to int8).
-		iR = _mm_cvtps_epi32(r);
-		iG = _mm_cvtps_epi32(g);
-		iB = _mm_cvtps_epi32(b);
-
-		// extract the 4 pixels RGB values.
-		// because we made sure values are between 0 and 255, we can just take the lower byte
-		// of each INT16
-		pRGBImage[0] = (XnUInt8)piR[0];
-		pRGBImage[1] = (XnUInt8)piG[0];
-		pRGBImage[2] = (XnUInt8)piB[0];
-
-		pRGBImage[3] = (XnUInt8)piR[1];
-		pRGBImage[4] = (XnUInt8)piG[1];
-		pRGBImage[5] = (XnUInt8)piB[1];
-
-		pRGBImage[6] = (XnUInt8)piR[2];
-		pRGBImage[7] = (XnUInt8)piG[2];
-		pRGBImage[8] = (XnUInt8)piB[2];
-
-		pRGBImage[9] = (XnUInt8)piR[3];
-		pRGBImage[10] = (XnUInt8)piG[3];
-		pRGBImage[11] = (XnUInt8)piB[3];
-
-		// advance the streams
-		pYUVImage += 8;
-		pRGBImage += 12;
+		YUVToRGB888SSSE3<nY1, nU, nY2, nV>(pYUVImage, pRGBImage, nBlocks);
+	}
+	else
+	{
+		nBlocks = 0;
 	}
+#else
+	XN_REFERENCE_VARIABLE(pYUVImage);
+	XN_REFERENCE_VARIABLE(pRGBImage);
+	nBlocks = 0;
+#endif
 
-	*pnActualRead = (XnUInt32)(pYUVImage - pYUVOrig);
-	*pnRGBSize = (XnUInt32)(pRGBImage - pRGBOrig);
+	return nBlocks * XN_YUV_BLOCK_PIXELS;
 }
 
-#else // not Win32
-
-void YUYVToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
+// YUV422ToRGB888() and YUYVToRGB888(). nY1, nU, nY2 and nV are the offsets of the values in an element.
+template <int nY1, int nU, int nY2, int nV>
+static void YUVToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
 {
 	const XnUInt8* pOrigYUV = pYUVImage;
 	const XnUInt8* pCurrYUV = pYUVImage;
 	const XnUInt8* pOrigRGB = pRGBImage;
 	XnUInt8* pCurrRGB = pRGBImage;
-	const XnUInt8* pLastYUV = pYUVImage + nYUVSize - YUYV_BPP;
-	const XnUInt8* pLastRGB = pRGBImage + *pnRGBSize - YUV_RGB_BPP;
+	const XnUInt8* pLastYUV = pYUVImage + nYUVSize - XN_YUV_SCALAR_INPUT_SIZE;
+	const XnUInt8* pLastRGB = pRGBImage + *pnRGBSize - XN_YUV_SCALAR_OUTPUT_ROOM;
+
+	XnUInt32 nPixels = YUVToRGB888Blocks<nY1, nU, nY2, nV>(pCurrYUV, pCurrRGB, nYUVSize, *pnRGBSize);
+	pCurrYUV += nPixels / 2 * YUV422_BPP;
+	pCurrRGB += nPixels * YUV_RGB_BPP;
 
 	while (pCurrYUV <= pLastYUV && pCurrRGB <= pLastRGB)
 	{
-		YUV444ToRGB888(pCurrYUV[YUYV_Y1], pCurrYUV[YUYV_U], pCurrYUV[YUYV_V],
-						pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
-		pCurrRGB += YUV_RGB_BPP;
-		YUV444ToRGB888(pCurrYUV[YUYV_Y2], pCurrYUV[YUYV_U], pCurrYUV[YUYV_V],
-						pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
-		pCurrRGB += YUV_RGB_BPP;
-		pCurrYUV += YUYV_BPP;
+		for (const XnUInt8* pEnd = pCurrYUV + XN_YUV_SCALAR_INPUT_SIZE; pCurrYUV < pEnd; pCurrYUV += YUV422_BPP)
+		{
+			YUV444ToRGB888Reference(pCurrYUV[nY1], pCurrYUV[nU], pCurrYUV[nV],
+									pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
+			pCurrRGB += YUV_RGB_BPP;
+			YUV444ToRGB888Reference(pCurrYUV[nY2], pCurrYUV[nU], pCurrYUV[nV],
+									pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
+			pCurrRGB += YUV_RGB_BPP;
+		}
 	}
 
 	*pnActualRead = pCurrYUV - pOrigYUV;
 	*pnRGBSize = pCurrRGB - pOrigRGB;
 }
 
-#endif
+void YUV422ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
+{
+	YUVToRGB888<YUV422_Y1, YUV422_U, YUV422_Y2, YUV422_V>(pYUVImage, pRGBImage, nYUVSize, pnActualRead, pnRGBSize);
+}
+
+void YUYVToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
+{
+	YUVToRGB888<YUYV_Y1, YUYV_U, YUYV_Y2, YUYV_V>(pYUVImage, pRGBImage, nYUVSize, pnActualRead, pnRGBSize);
+}
 
 void YUV420ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32 /*nRGBSize*/)
 {
@@ -59,9 +59,23 @@
 /* The size of an output element in the stream. */
 #define XN_YUV_TO_RGB_OUTPUT_ELEMENT_SIZE	12
 
+/* Windows has always converted YUV422 and YUYV with a float formula, and the other platforms with
+   YUV444ToRGB888(). Each platform keeps its own output. */
+#if (XN_PLATFORM == XN_PLATFORM_WIN32)
+	#define XN_YUV_FLOAT_FORMULA
+#endif
+
 //---------------------------------------------------------------------------
 // Functions Declaration
 //---------------------------------------------------------------------------
+void YUV444ToRGB888(XnUInt8 cY, XnUInt8 cU, XnUInt8 cV, XnUInt8& cR, XnUInt8& cG, XnUInt8& cB);
+/* YUV444ToRGB888Reference() is the per-pixel conversion YUV422ToRGB888() and YUYVToRGB888() match. */
+#ifdef XN_YUV_FLOAT_FORMULA
+void YUV444ToRGB888Float(XnUInt8 cY, XnUInt8 cU, XnUInt8 cV, XnUInt8& cR, XnUInt8& cG, XnUInt8& cB);
+#define YUV444ToRGB888Reference YUV444ToRGB888Float
+#else
+#define YUV444ToRGB888Reference YUV444ToRGB888
+#endif
 void YUV422ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize);
 void YUYVToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize);
 void YUV420ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32 nRGBSize);
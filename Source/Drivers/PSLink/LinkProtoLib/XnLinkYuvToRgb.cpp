@@ -1,7 +1,9 @@
 #include <XnPlatform.h>
 #include <XnStatusCodes.h>
-#if (XN_PLATFORM == XN_PLATFORM_WIN32)
-	#include <emmintrin.h>
+#include <XnOS.h>
+#include <XnSIMD.h>
+#ifdef XN_NEON
+	#include <arm_neon.h>
 #endif
 
 #include "XnLinkYuvToRgb.h"
@@ -15,9 +17,6 @@
 #define RGB888_GREEN 1
 #define RGB888_BLUE  2
 
-namespace xn
-{
-
 /*
 http://en.wikipedia.org/wiki/YUV
 
@@ -25,126 +24,260 @@ From YUV to RGB:
 R =     Y + 1.13983 V
 G =     Y - 0.39466 U - 0.58060 V
 B =     Y + 2.03211 U
-*/ 
-XnStatus LinkYuvToRgb::Yuv422ToRgb888(const XnUInt8* pSrc, XnSizeT srcSize, XnUInt8* pDst, XnSizeT& dstSize)
-{
-	if (dstSize < srcSize * RGB_888_BYTES_PER_PIXEL / YUV_422_BYTES_PER_PIXEL)
-	{
-		return XN_STATUS_OUTPUT_BUFFER_OVERFLOW;
-	}
 
+Windows has always used the formula in SSE single precision, and keeps its output: each value is
+clamped to [0, 255] and rounded to nearest, with the operations done in this order. The other
+platforms use the coefficients in fixed point, with 13 fraction bits, and results are rounded to nearest.
+*/
 #if (XN_PLATFORM == XN_PLATFORM_WIN32)
-	const XnUInt8* pYUVLast = pSrc + srcSize - 8;
+	#define YUV_FLOAT_FORMULA
+#endif
+
+#define YUV_FRACTION_BITS	13
+#define YUV_Y_COEFF			(1 << YUV_FRACTION_BITS)
+#define YUV_ROUND			(1 << (YUV_FRACTION_BITS - 1))
+#define YUV_V_TO_R			9337
+#define YUV_U_TO_G			-3233
+#define YUV_V_TO_G			-4756
+#define YUV_U_TO_B			16647
+
+/* The vector code converts blocks of 8 input elements. */
+#define YUV_BLOCK_PIXELS	16
+
+namespace xn
+{
+
+#ifdef YUV_FLOAT_FORMULA
+// u and v are already centered around 0
+static inline void Yuv444ToRgb888(XnUInt8 y, XnInt32 u, XnInt32 v, XnUInt8* pRgb)
+{
+	const __m128 zero = _mm_set_ss(0);
+	const __m128 plus255 = _mm_set_ss(255);
 
+	__m128 fY = _mm_set_ss(y);
+	__m128 fU = _mm_set_ss((float)u);
+	__m128 fV = _mm_set_ss((float)v);
+
+	__m128 r = _mm_add_ss(fY, _mm_mul_ss(_mm_set_ss(1.13983F), fV));
+	__m128 g = _mm_add_ss(_mm_add_ss(fY, _mm_mul_ss(_mm_set_ss(-0.39466F), fU)), _mm_mul_ss(_mm_set_ss(-0.58060F), fV));
+	__m128 b = _mm_add_ss(fY, _mm_mul_ss(_mm_set_ss(2.03211F), fU));
+
+	pRgb[RGB888_RED]   = (XnUInt8)_mm_cvtss_si32(_mm_min_ss(_mm_max_ss(r, zero), plus255));
+	pRgb[RGB888_GREEN] = (XnUInt8)_mm_cvtss_si32(_mm_min_ss(_mm_max_ss(g, zero), plus255));
+	pRgb[RGB888_BLUE]  = (XnUInt8)_mm_cvtss_si32(_mm_min_ss(_mm_max_ss(b, zero), plus255));
+}
+
+// Converts 8 pixels, whose Y, U and V values are in 16-bit lanes, exactly as Yuv444ToRgb888() does.
+// The results are left in 16-bit lanes.
+static inline void Yuv444ToRgb888x8(__m128i y, __m128i u, __m128i v, __m128i& r, __m128i& g, __m128i& b)
+{
 	const __m128 minus128 = _mm_set_ps1(-128);
-	const __m128 plus113983 = _mm_set_ps1(1.13983F);
-	const __m128 minus039466 = _mm_set_ps1(-0.39466F);
-	const __m128 minus058060 = _mm_set_ps1(-0.58060F);
-	const __m128 plus203211 = _mm_set_ps1(2.03211F);
 	const __m128 zero = _mm_set_ps1(0);
 	const __m128 plus255 = _mm_set_ps1(255);
+	const __m128i zeroi = _mm_setzero_si128();
 
-	// define YUV floats
-	__m128 y;
-	__m128 u;
-	__m128 v;
+	// 4 pixels at a time, in 32-bit lanes
+	__m128i rgb[3][2];
+	for (XnUInt32 i = 0; i < 2; ++i)
+	{
+		__m128 fY = _mm_cvtepi32_ps(i == 0 ? _mm_unpacklo_epi16(y, zeroi) : _mm_unpackhi_epi16(y, zeroi));
+		__m128 fU = _mm_add_ps(_mm_cvtepi32_ps(i == 0 ? _mm_unpacklo_epi16(u, zeroi) : _mm_unpackhi_epi16(u, zeroi)), minus128);
+		__m128 fV = _mm_add_ps(_mm_cvtepi32_ps(i == 0 ? _mm_unpacklo_epi16(v, zeroi) : _mm_unpackhi_epi16(v, zeroi)), minus128);
+
+		__m128 fR = _mm_add_ps(fY, _mm_mul_ps(_mm_set_ps1(1.13983F), fV));
+		__m128 fG = _mm_add_ps(_mm_add_ps(fY, _mm_mul_ps(_mm_set_ps1(-0.39466F), fU)), _mm_mul_ps(_mm_set_ps1(-0.58060F), fV));
+		__m128 fB = _mm_add_ps(fY, _mm_mul_ps(_mm_set_ps1(2.03211F), fU));
 
-	__m128 temp;
+		rgb[0][i] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(fR, zero), plus255));
+		rgb[1][i] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(fG, zero), plus255));
+		rgb[2][i] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(fB, zero), plus255));
+	}
 
-	// define RGB floats
-	__m128 r;
-	__m128 g;
-	__m128 b;
+	r = _mm_packs_epi32(rgb[0][0], rgb[0][1]);
+	g = _mm_packs_epi32(rgb[1][0], rgb[1][1]);
+	b = _mm_packs_epi32(rgb[2][0], rgb[2][1]);
+}
+#else
+static inline XnUInt8 ClampToByte(XnInt32 nValue)
+{
+	return (XnUInt8)XN_MIN(XN_MAX(nValue, 0), 255);
+}
 
-	// define RGB integers
-	__m128i iR;
-	__m128i iG;
-	__m128i iB;
+// u and v are already centered around 0
+static inline void Yuv444ToRgb888(XnUInt8 y, XnInt32 u, XnInt32 v, XnUInt8* pRgb)
+{
+	XnInt32 nY = y * YUV_Y_COEFF + YUV_ROUND;
 
-	XnUInt32* piR = (XnUInt32*)&iR;
-	XnUInt32* piG = (XnUInt32*)&iG;
-	XnUInt32* piB = (XnUInt32*)&iB;
+	pRgb[RGB888_RED]   = ClampToByte((nY                    + YUV_V_TO_R * v) >> YUV_FRACTION_BITS);
+	pRgb[RGB888_GREEN] = ClampToByte((nY + YUV_U_TO_G * u + YUV_V_TO_G * v) >> YUV_FRACTION_BITS);
+	pRgb[RGB888_BLUE]  = ClampToByte((nY + YUV_U_TO_B * u                   ) >> YUV_FRACTION_BITS);
+}
 
-	while (pSrc <= pYUVLast)
+#ifdef XN_SSE
+// Converts 8 pixels, whose Y, U and V values are in 16-bit lanes, exactly as Yuv444ToRgb888() does.
+// The results are left in 16-bit lanes, not yet clamped.
+static inline void Yuv444ToRgb888x8(__m128i y, __m128i u, __m128i v, __m128i& r, __m128i& g, __m128i& b)
+{
+	// pairs of coefficients, for _mm_madd_epi16(). Green takes its rounding from (v, 1) * (V_TO_G, ROUND).
+	const __m128i coeffsR = _mm_setr_epi16(YUV_Y_COEFF, YUV_V_TO_R, YUV_Y_COEFF, YUV_V_TO_R, YUV_Y_COEFF, YUV_V_TO_R, YUV_Y_COEFF, YUV_V_TO_R);
+	const __m128i coeffsG = _mm_setr_epi16(YUV_Y_COEFF, YUV_U_TO_G, YUV_Y_COEFF, YUV_U_TO_G, YUV_Y_COEFF, YUV_U_TO_G, YUV_Y_COEFF, YUV_U_TO_G);
+	const __m128i coeffsB = _mm_setr_epi16(YUV_Y_COEFF, YUV_U_TO_B, YUV_Y_COEFF, YUV_U_TO_B, YUV_Y_COEFF, YUV_U_TO_B, YUV_Y_COEFF, YUV_U_TO_B);
+	const __m128i coeffsGV = _mm_setr_epi16(YUV_V_TO_G, YUV_ROUND, YUV_V_TO_G, YUV_ROUND, YUV_V_TO_G, YUV_ROUND, YUV_V_TO_G, YUV_ROUND);
+	const __m128i round = _mm_set1_epi32(YUV_ROUND);
+	const __m128i one = _mm_set1_epi16(1);
+
+	u = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	v = _mm_sub_epi16(v, _mm_set1_epi16(128));
+
+	__m128i yvLo = _mm_unpacklo_epi16(y, v);
+	__m128i yvHi = _mm_unpackhi_epi16(y, v);
+	__m128i yuLo = _mm_unpacklo_epi16(y, u);
+	__m128i yuHi = _mm_unpackhi_epi16(y, u);
+	__m128i v1Lo = _mm_unpacklo_epi16(v, one);
+	__m128i v1Hi = _mm_unpackhi_epi16(v, one);
+
+	r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvLo, coeffsR), round), YUV_FRACTION_BITS),
+		_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvHi, coeffsR), round), YUV_FRACTION_BITS));
+	g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuLo, coeffsG), _mm_madd_epi16(v1Lo, coeffsGV)), YUV_FRACTION_BITS),
+		_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuHi, coeffsG), _mm_madd_epi16(v1Hi, coeffsGV)), YUV_FRACTION_BITS));
+	b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuLo, coeffsB), round), YUV_FRACTION_BITS),
+		_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuHi, coeffsB), round), YUV_FRACTION_BITS));
+}
+#endif
+#endif
+
+#ifdef XN_SSE
+// Converts nBlocks blocks of 16 pixels
+XN_SSSE3_FUNCTION static void Yuv422ToRgb888SSSE3(const XnUInt8* pSrc, XnUInt8* pDst, XnSizeT nBlocks)
+{
+	// the values of each pixel of 4 elements, zero extended to 16 bits
+	const __m128i yShuffle = _mm_setr_epi8(1,-1, 3,-1, 5,-1, 7,-1, 9,-1, 11,-1, 13,-1, 15,-1);
+	const __m128i uShuffle = _mm_setr_epi8(0,-1, 0,-1, 4,-1, 4,-1, 8,-1, 8,-1, 12,-1, 12,-1);
+	const __m128i vShuffle = _mm_setr_epi8(2,-1, 2,-1, 6,-1, 6,-1, 10,-1, 10,-1, 14,-1, 14,-1);
+	// RGB888 interleaving of 16 pixels, for each third of the output
+	const __m128i rgbShuffle[3][3] = {
+		{ _mm_setr_epi8(0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1,-1, 5),
+		  _mm_setr_epi8(-1,0,-1, -1,1,-1, -1,2,-1, -1,3,-1, -1,4,-1, -1),
+		  _mm_setr_epi8(-1,-1,0, -1,-1,1, -1,-1,2, -1,-1,3, -1,-1,4, -1) },
+		{ _mm_setr_epi8(-1,-1,6, -1,-1,7, -1,-1,8, -1,-1,9, -1,-1,10, -1),
+		  _mm_setr_epi8(5,-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1, 10),
+		  _mm_setr_epi8(-1,5,-1, -1,6,-1, -1,7,-1, -1,8,-1, -1,9,-1, -1) },
+		{ _mm_setr_epi8(-1,11,-1, -1,12,-1, -1,13,-1, -1,14,-1, -1,15,-1, -1),
+		  _mm_setr_epi8(-1,-1,11, -1,-1,12, -1,-1,13, -1,-1,14, -1,-1,15, -1),
+		  _mm_setr_epi8(10,-1,-1, 11,-1,-1, 12,-1,-1, 13,-1,-1, 14,-1,-1, 15) } };
+
+	__m128i r0, g0, b0, r1, g1, b1;
+
+	for (XnSizeT nBlock = 0; nBlock < nBlocks; ++nBlock)
 	{
-		// process 4 pixels at once (values should be ordered backwards)
-		y = _mm_set_ps(pSrc[YUV422_Y2 + YUV_422_BYTES_PER_PIXEL], pSrc[YUV422_Y1 + YUV_422_BYTES_PER_PIXEL], pSrc[YUV422_Y2], pSrc[YUV422_Y1]);
-		u = _mm_set_ps(pSrc[YUV422_U + YUV_422_BYTES_PER_PIXEL],  pSrc[YUV422_U + YUV_422_BYTES_PER_PIXEL],  pSrc[YUV422_U],  pSrc[YUV422_U]);
-		v = _mm_set_ps(pSrc[YUV422_V + YUV_422_BYTES_PER_PIXEL],  pSrc[YUV422_V + YUV_422_BYTES_PER_PIXEL],  pSrc[YUV422_V],  pSrc[YUV422_V]);
-
-		u = _mm_add_ps(u, minus128); // u -= 128
-		v = _mm_add_ps(v, minus128); // v -= 128
-
-		temp = _mm_mul_ps(plus113983, v);
-		r = _mm_add_ps(y, temp);
-
-		temp = _mm_mul_ps(minus039466, u);
-		g = _mm_add_ps(y, temp);
-		temp = _mm_mul_ps(minus058060, v);
-		g = _mm_add_ps(g, temp);
-
-		temp = _mm_mul_ps(plus203211, u);
-		b = _mm_add_ps(y, temp);
-
-		// make sure no value is smaller than 0
-		r = _mm_max_ps(r, zero);
-		g = _mm_max_ps(g, zero);
-		b = _mm_max_ps(b, zero);
-
-		// make sure no value is bigger than 255
-		r = _mm_min_ps(r, plus255);
-		g = _mm_min_ps(g, plus255);
-		b = _mm_min_ps(b, plus255);
-
-		// convert floats to int16 (there is no conversion to uint8, just to int8).
-		iR = _mm_cvtps_epi32(r);
-		iG = _mm_cvtps_epi32(g);
-		iB = _mm_cvtps_epi32(b);
-
-		// extract the 4 pixels RGB values.
-		// because we made sure values are between 0 and 255, we can just take the lower byte
-		// of each INT16
-		pDst[0] = (XnUInt8)piR[0];
-		pDst[1] = (XnUInt8)piG[0];
-		pDst[2] = (XnUInt8)piB[0];
-
-		pDst[3] = (XnUInt8)piR[1];
-		pDst[4] = (XnUInt8)piG[1];
-		pDst[5] = (XnUInt8)piB[1];
-
-		pDst[6] = (XnUInt8)piR[2];
-		pDst[7] = (XnUInt8)piG[2];
-		pDst[8] = (XnUInt8)piB[2];
-
-		pDst[9] = (XnUInt8)piR[3];
-		pDst[10] = (XnUInt8)piG[3];
-		pDst[11] = (XnUInt8)piB[3];
-
-		// advance the streams
-		pSrc += 8;
-		pDst += 12;
+		__m128i in0 = _mm_loadu_si128((const __m128i*)pSrc);
+		__m128i in1 = _mm_loadu_si128((const __m128i*)(pSrc + 16));
+
+		Yuv444ToRgb888x8(_mm_shuffle_epi8(in0, yShuffle), _mm_shuffle_epi8(in0, uShuffle), _mm_shuffle_epi8(in0, vShuffle), r0, g0, b0);
+		Yuv444ToRgb888x8(_mm_shuffle_epi8(in1, yShuffle), _mm_shuffle_epi8(in1, uShuffle), _mm_shuffle_epi8(in1, vShuffle), r1, g1, b1);
+
+		// packing with unsigned saturation clamps to [0, 255]
+		__m128i r = _mm_packus_epi16(r0, r1);
+		__m128i g = _mm_packus_epi16(g0, g1);
+		__m128i b = _mm_packus_epi16(b0, b1);
+
+		for (XnUInt32 i = 0; i < 3; ++i)
+		{
+			__m128i out = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, rgbShuffle[i][0]), _mm_shuffle_epi8(g, rgbShuffle[i][1])), _mm_shuffle_epi8(b, rgbShuffle[i][2]));
+			_mm_storeu_si128((__m128i*)(pDst + 16 * i), out);
+		}
+
+		pSrc += YUV_BLOCK_PIXELS * LinkYuvToRgb::YUV_422_BYTES_PER_PIXEL;
+		pDst += YUV_BLOCK_PIXELS * LinkYuvToRgb::RGB_888_BYTES_PER_PIXEL;
 	}
-#else
+}
+#endif
+
+#ifdef XN_NEON
+// One channel of 8 pixels, (Y_COEFF * y + nU * u + nV * v + ROUND) >> FRACTION_BITS, clamped to [0, 255]
+static inline uint8x8_t Yuv444ToChannelNEON(int16x8_t y, int16x8_t u, int16x8_t v, XnInt16 nU, XnInt16 nV)
+{
+	int32x4_t lo = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vdupq_n_s32(YUV_ROUND), vget_low_s16(y), YUV_Y_COEFF), vget_low_s16(u), nU), vget_low_s16(v), nV);
+	int32x4_t hi = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vdupq_n_s32(YUV_ROUND), vget_high_s16(y), YUV_Y_COEFF), vget_high_s16(u), nU), vget_high_s16(v), nV);
+	return vqmovun_s16(vcombine_s16(vqshrn_n_s32(lo, YUV_FRACTION_BITS), vqshrn_n_s32(hi, YUV_FRACTION_BITS)));
+}
+
+// Same as the SSSE3 conversion, with NEON structure loads and stores.
+static void Yuv422ToRgb888NEON(const XnUInt8* pSrc, XnUInt8* pDst, XnSizeT nBlocks)
+{
+	for (XnSizeT nBlock = 0; nBlock < nBlocks; ++nBlock)
+	{
+		// val[i] holds byte i of each of the 8 elements
+		uint8x8x4_t in = vld4_u8(pSrc);
+
+		int16x8_t u = vreinterpretq_s16_u16(vsubl_u8(in.val[YUV422_U], vdup_n_u8(128)));
+		int16x8_t v = vreinterpretq_s16_u16(vsubl_u8(in.val[YUV422_V], vdup_n_u8(128)));
+		int16x8_t y1 = vreinterpretq_s16_u16(vmovl_u8(in.val[YUV422_Y1]));
+		int16x8_t y2 = vreinterpretq_s16_u16(vmovl_u8(in.val[YUV422_Y2]));
+
+		// the first and second pixel of each element alternate in the output
+		uint8x8x2_t r = vzip_u8(Yuv444ToChannelNEON(y1, u, v, 0, YUV_V_TO_R), Yuv444ToChannelNEON(y2, u, v, 0, YUV_V_TO_R));
+		uint8x8x2_t g = vzip_u8(Yuv444ToChannelNEON(y1, u, v, YUV_U_TO_G, YUV_V_TO_G), Yuv444ToChannelNEON(y2, u, v, YUV_U_TO_G, YUV_V_TO_G));
+		uint8x8x2_t b = vzip_u8(Yuv444ToChannelNEON(y1, u, v, YUV_U_TO_B, 0), Yuv444ToChannelNEON(y2, u, v, YUV_U_TO_B, 0));
+
+		for (XnUInt32 i = 0; i < 2; ++i)
+		{
+			uint8x8x3_t out;
+			out.val[RGB888_RED] = r.val[i];
+			out.val[RGB888_GREEN] = g.val[i];
+			out.val[RGB888_BLUE] = b.val[i];
+			vst3_u8(pDst + 24 * i, out);
+		}
+
+		pSrc += YUV_BLOCK_PIXELS * LinkYuvToRgb::YUV_422_BYTES_PER_PIXEL;
+		pDst += YUV_BLOCK_PIXELS * LinkYuvToRgb::RGB_888_BYTES_PER_PIXEL;
+	}
+}
+#endif
+
+XnStatus LinkYuvToRgb::Yuv422ToRgb888(const XnUInt8* pSrc, XnSizeT srcSize, XnUInt8* pDst, XnSizeT& dstSize)
+{
+	if (dstSize < srcSize * RGB_888_BYTES_PER_PIXEL / YUV_422_BYTES_PER_PIXEL)
+	{
+		return XN_STATUS_OUTPUT_BUFFER_OVERFLOW;
+	}
+
 	const XnUInt8* pCurrYUV = pSrc;
 	XnUInt8* pCurrRGB = pDst;
-	const XnUInt8* pLastYUV = pSrc + srcSize - YUV_422_BYTES_PER_PIXEL;
+	const XnUInt8* pLastYUV = pSrc + srcSize - 2 * YUV_422_BYTES_PER_PIXEL;
+
+	// whole blocks of 16 pixels go through the vector code, if there is one for this CPU
+	XnSizeT nBlocks = srcSize / (YUV_BLOCK_PIXELS * YUV_422_BYTES_PER_PIXEL);
+#if defined(XN_NEON)
+	Yuv422ToRgb888NEON(pCurrYUV, pCurrRGB, nBlocks);
+#elif defined(XN_SSE)
+	if ((xnOSGetCPUFeatures() & XN_CPU_FEATURE_SSSE3) != 0)
+	{
+		Yuv422ToRgb888SSSE3(pCurrYUV, pCurrRGB, nBlocks);
+	}
+	else
+	{
+		nBlocks = 0;
+	}
+#else
+	nBlocks = 0;
+#endif
+	pCurrYUV += nBlocks * YUV_BLOCK_PIXELS * YUV_422_BYTES_PER_PIXEL;
+	pCurrRGB += nBlocks * YUV_BLOCK_PIXELS * RGB_888_BYTES_PER_PIXEL;
 
 	while (pCurrYUV <= pLastYUV)
 	{
-		pCurrRGB[RGB888_RED]   = XnUInt8(pCurrYUV[YUV422_Y1]                                + 1.13983 * pCurrYUV[YUV422_V] + 0.5);
-		pCurrRGB[RGB888_GREEN] = XnUInt8(pCurrYUV[YUV422_Y1] - 0.39466 * pCurrYUV[YUV422_U] - 0.58060 * pCurrYUV[YUV422_V] + 0.5);
-		pCurrRGB[RGB888_BLUE]  = XnUInt8(pCurrYUV[YUV422_Y1] + 2.03211 * pCurrYUV[YUV422_U]                                + 0.5);
+		XnInt32 u = pCurrYUV[YUV422_U] - 128;
+		XnInt32 v = pCurrYUV[YUV422_V] - 128;
 
+		Yuv444ToRgb888(pCurrYUV[YUV422_Y1], u, v, pCurrRGB);
 		pCurrRGB += RGB_888_BYTES_PER_PIXEL;
 
-		pCurrRGB[RGB888_RED]   = XnUInt8(pCurrYUV[YUV422_Y2]                                + 1.13983 * pCurrYUV[YUV422_V] + 0.5);
-		pCurrRGB[RGB888_GREEN] = XnUInt8(pCurrYUV[YUV422_Y2] - 0.39466 * pCurrYUV[YUV422_U] - 0.58060 * pCurrYUV[YUV422_V] + 0.5);
-		pCurrRGB[RGB888_BLUE]  = XnUInt8(pCurrYUV[YUV422_Y2] + 2.03211 * pCurrYUV[YUV422_U]                                + 0.5);
-
+		Yuv444ToRgb888(pCurrYUV[YUV422_Y2], u, v, pCurrRGB);
 		pCurrRGB += RGB_888_BYTES_PER_PIXEL;
-		pCurrYUV += YUV_422_BYTES_PER_PIXEL;
+
+		pCurrYUV += 2 * YUV_422_BYTES_PER_PIXEL;
 	}
-#endif
 
 	dstSize = srcSize * RGB_888_BYTES_PER_PIXEL / YUV_422_BYTES_PER_PIXEL;
 
@@ -0,0 +1,363 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <gtest/gtest.h>
+#include "PlayerDevice.h"
+#include "DataRecords.h"
+#include "XnPropNames.h"
+#include "Formats/XnCodecIDs.h"
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+namespace
+{
+
+#define XN_TEST_FILE_NAME "PlayerDeviceTests.oni"
+#define XN_TEST_NODE_ID 1
+#define XN_TEST_NODE_NAME "Depth1"
+#define XN_TEST_FRAMES_PER_MODE 3
+#define XN_TEST_MODES 3
+#define XN_TEST_FRAMES (XN_TEST_FRAMES_PER_MODE * XN_TEST_MODES)
+#define XN_TEST_MAX_FRAME_SIZE (8 * 4 * sizeof(OniDepthPixel))
+#define XN_TEST_WAIT_TIMEOUT 10000
+
+// What the recording holds for each part: the output mode, and the cropping applied on top of it.
+struct RecordedMode
+{
+	XnMapOutputMode outputMode;
+	XnCropping cropping;
+};
+
+const RecordedMode g_modes[XN_TEST_MODES] =
+{
+	{ { 4, 2, 30 }, { FALSE, 0, 0, 0, 0 } },
+	{ { 8, 4, 30 }, { FALSE, 0, 0, 0, 0 } },
+	{ { 8, 4, 30 }, { TRUE, 1, 1, 2, 2 } },
+};
+
+XnUInt32 GetFrameWidth(const RecordedMode& mode)
+{
+	return mode.cropping.bEnabled ? mode.cropping.nXSize : mode.outputMode.nXRes;
+}
+
+XnUInt32 GetFrameHeight(const RecordedMode& mode)
+{
+	return mode.cropping.bEnabled ? mode.cropping.nYSize : mode.outputMode.nYRes;
+}
+
+// Writes a recording of a single depth node, record by record.
+class RecordingWriter
+{
+public:
+	RecordingWriter() : m_hFile(XN_INVALID_FILE_HANDLE), m_nStatus(XN_STATUS_OK) {}
+	~RecordingWriter() { Close(); }
+
+	XnStatus Open(const XnChar* strFileName, XnUInt64 nMaxTimeStamp)
+	{
+		XnStatus nRetVal = xnOSOpenFile(strFileName, XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE, &m_hFile);
+		XN_IS_STATUS_OK(nRetVal);
+
+		RecordingHeader header = DEFAULT_RECORDING_HEADER;
+		header.nGlobalMaxTimeStamp = nMaxTimeStamp;
+		header.nMaxNodeID = XN_TEST_NODE_ID;
+		Write(&header, sizeof(header));
+		return m_nStatus;
+	}
+
+	void Close()
+	{
+		if (m_hFile != XN_INVALID_FILE_HANDLE)
+		{
+			xnOSCloseFile(&m_hFile);
+		}
+	}
+
+	void NodeAdded(XnUInt32 nFrames, XnUInt64 nMinTimeStamp, XnUInt64 nMaxTimeStamp)
+	{
+		NodeAddedRecord record(m_buffer, sizeof(m_buffer), FALSE);
+		record.SetNodeName(XN_TEST_NODE_NAME);
+		record.SetNodeType(XN_NODE_TYPE_DEPTH);
+		record.SetCompression(XN_CODEC_UNCOMPRESSED);
+		record.SetNumberOfFrames(nFrames);
+		record.SetMinTimestamp(nMinTimeStamp);
+		record.SetMaxTimestamp(nMaxTimeStamp);
+		record.SetSeekTablePosition(0);
+		Emit(record, record.Encode());
+	}
+
+	void IntProp(const XnChar* strPropName, XnUInt64 nValue)
+	{
+		IntPropRecord record(m_buffer, sizeof(m_buffer), FALSE);
+		record.SetPropName(strPropName);
+		record.SetValue(nValue);
+		Emit(record, record.Encode());
+	}
+
+	void GeneralProp(const XnChar* strPropName, const void* pData, XnUInt32 nSize)
+	{
+		GeneralPropRecord record(m_buffer, sizeof(m_buffer), FALSE);
+		record.SetPropName(strPropName);
+		record.SetPropDataSize(nSize);
+		record.SetPropData(pData);
+		Emit(record, record.Encode());
+	}
+
+	void StateReady()
+	{
+		NodeStateReadyRecord record(m_buffer, sizeof(m_buffer), FALSE);
+		Emit(record, record.Encode());
+	}
+
+	void DataBegin()
+	{
+		NodeDataBeginRecord record(m_buffer, sizeof(m_buffer), FALSE);
+		Emit(record, record.Encode());
+	}
+
+	void NewData(XnUInt64 nTimeStamp, XnUInt32 nFrame, const void* pData, XnUInt32 nSize)
+	{
+		NewDataRecordHeader record(m_buffer, sizeof(m_buffer), FALSE);
+		record.SetTimeStamp(nTimeStamp);
+		record.SetFrameNumber(nFrame);
+		XnStatus nRetVal = record.Encode();
+		record.SetPayloadSize(nSize);
+		Emit(record, nRetVal);
+		Write(pData, nSize);
+	}
+
+	void End()
+	{
+		EndRecord record(m_buffer, sizeof(m_buffer), FALSE);
+		Emit(record, record.Encode());
+	}
+
+	XnStatus GetStatus() const { return m_nStatus; }
+
+private:
+	void Emit(Record& record, XnStatus nEncodeStatus)
+	{
+		if (nEncodeStatus != XN_STATUS_OK)
+		{
+			m_nStatus = nEncodeStatus;
+			return;
+		}
+
+		record.SetNodeID(XN_TEST_NODE_ID);
+		record.SetUndoRecordPos(0);
+		Write(record.GetData(), record.GetSize());
+	}
+
+	void Write(const void* pData, XnUInt32 nSize)
+	{
+		if (m_nStatus == XN_STATUS_OK)
+		{
+			m_nStatus = xnOSWriteFile(m_hFile, pData, nSize);
+		}
+	}
+
+	XN_FILE_HANDLE m_hFile;
+	XnStatus m_nStatus;
+	XnUInt8 m_buffer[1024];
+};
+
+XnUInt64 GetFrameTimeStamp(XnUInt32 nFrame)
+{
+	return nFrame * 1000;
+}
+
+// Records XN_TEST_FRAMES_PER_MODE frames in each of g_modes. Every pixel of a frame holds its frame number.
+XnStatus WriteModeChangeRecording(const XnChar* strFileName)
+{
+	RecordingWriter writer;
+	XnStatus nRetVal = writer.Open(strFileName, GetFrameTimeStamp(XN_TEST_FRAMES));
+	XN_IS_STATUS_OK(nRetVal);
+
+	writer.NodeAdded(XN_TEST_FRAMES, GetFrameTimeStamp(1), GetFrameTimeStamp(XN_TEST_FRAMES));
+	writer.IntProp(XN_PROP_ONI_REQUIRED_FRAME_SIZE, XN_TEST_MAX_FRAME_SIZE);
+	writer.GeneralProp(XN_PROP_MAP_OUTPUT_MODE, &g_modes[0].outputMode, sizeof(XnMapOutputMode));
+	writer.GeneralProp(XN_PROP_CROPPING, &g_modes[0].cropping, sizeof(XnCropping));
+	writer.StateReady();
+	writer.DataBegin();
+
+	OniDepthPixel anPixels[XN_TEST_MAX_FRAME_SIZE / sizeof(OniDepthPixel)];
+	XnUInt32 nFrame = 1;
+	for (XnUInt32 nMode = 0; nMode < XN_TEST_MODES; ++nMode)
+	{
+		const RecordedMode& mode = g_modes[nMode];
+		if (nMode > 0)
+		{
+			writer.GeneralProp(XN_PROP_MAP_OUTPUT_MODE, &mode.outputMode, sizeof(XnMapOutputMode));
+			writer.GeneralProp(XN_PROP_CROPPING, &mode.cropping, sizeof(XnCropping));
+		}
+
+		XnUInt32 nPixels = GetFrameWidth(mode) * GetFrameHeight(mode);
+		for (XnUInt32 i = 0; i < XN_TEST_FRAMES_PER_MODE; ++i, ++nFrame)
+		{
+			for (XnUInt32 j = 0; j < nPixels; ++j)
+			{
+				anPixels[j] = (OniDepthPixel)nFrame;
+			}
+			writer.NewData(GetFrameTimeStamp(nFrame), nFrame, anPixels, nPixels * sizeof(OniDepthPixel));
+		}
+	}
+
+	writer.End();
+	return writer.GetStatus();
+}
+
+// What the stream reported for each frame.
+struct DeliveredFrame
+{
+	int nFrameIndex;
+	int nWidth;
+	int nHeight;
+	int nResolutionX;
+	OniBool bCropping;
+	int nDataSize;
+	OniDepthPixel nFirstPixel;
+};
+
+struct FrameCollector
+{
+	DeliveredFrame aFrames[XN_TEST_FRAMES];
+	XnUInt32 nFrames;
+	xnl::OSEvent allDelivered;
+};
+
+void ONI_CALLBACK_TYPE CollectFrame(oni::driver::StreamBase* /*pStream*/, OniFrame* pFrame, void* pCookie)
+{
+	FrameCollector* pCollector = (FrameCollector*)pCookie;
+	if (pCollector->nFrames == XN_TEST_FRAMES)
+	{
+		return;
+	}
+
+	DeliveredFrame& frame = pCollector->aFrames[pCollector->nFrames++];
+	frame.nFrameIndex = pFrame->frameIndex;
+	frame.nWidth = pFrame->width;
+	frame.nHeight = pFrame->height;
+	frame.nResolutionX = pFrame->videoMode.resolutionX;
+	frame.bCropping = pFrame->croppingEnabled;
+	frame.nDataSize = pFrame->dataSize;
+	frame.nFirstPixel = *(const OniDepthPixel*)pFrame->data;
+
+	if (pCollector->nFrames == XN_TEST_FRAMES)
+	{
+		pCollector->allDelivered.Set();
+	}
+}
+
+// Minimal stream services: frames are allocated on demand, and never wrap the player's buffers.
+int ONI_CALLBACK_TYPE GetDefaultRequiredFrameSize(void* /*streamServices*/)
+{
+	return XN_TEST_MAX_FRAME_SIZE;
+}
+
+OniFrame* ONI_CALLBACK_TYPE AcquireFrame(void* /*streamServices*/)
+{
+	OniFrame* pFrame = XN_NEW(OniFrame);
+	xnOSMemSet(pFrame, 0, sizeof(OniFrame));
+	pFrame->data = xnOSMalloc(XN_TEST_MAX_FRAME_SIZE);
+	return pFrame;
+}
+
+void ONI_CALLBACK_TYPE AddFrameRef(void* /*streamServices*/, OniFrame* /*pFrame*/)
+{
+}
+
+void ONI_CALLBACK_TYPE ReleaseFrame(void* /*streamServices*/, OniFrame* pFrame)
+{
+	xnOSFree(pFrame->data);
+	XN_DELETE(pFrame);
+}
+
+OniFrame* ONI_CALLBACK_TYPE AcquireExternalFrame(void* /*streamServices*/, void* /*data*/, int /*dataSize*/, OniFrameFreeBufferCallback /*freeBuffer*/, void* /*pCookie*/)
+{
+	return NULL;
+}
+
+void ONI_CALLBACK_TYPE SetFrameStageTimestamp(void* /*streamServices*/, OniFrame* /*pFrame*/, OniFrameStage /*stage*/, uint64_t /*timestamp*/)
+{
+}
+
+TEST(PlayerDeviceTests, FramesKeepTheirModeAcrossModeChanges)
+{
+	ASSERT_EQ(XN_STATUS_OK, WriteModeChangeRecording(XN_TEST_FILE_NAME));
+
+	FrameCollector collector;
+	collector.nFrames = 0;
+	ASSERT_EQ(XN_STATUS_OK, collector.allDelivered.Create(TRUE));
+
+	oni::driver::StreamServices services;
+	OniStreamServices& callbacks = services;
+	callbacks.streamServices = NULL;
+	callbacks.getDefaultRequiredFrameSize = GetDefaultRequiredFrameSize;
+	callbacks.acquireFrame = AcquireFrame;
+	callbacks.addFrameRef = AddFrameRef;
+	callbacks.releaseFrame = ReleaseFrame;
+	callbacks.acquireExternalFrame = AcquireExternalFrame;
+	callbacks.setFrameStageTimestamp = SetFrameStageTimestamp;
+
+	{
+		oni_file::PlayerDevice device(XN_TEST_FILE_NAME);
+		ASSERT_EQ(ONI_STATUS_OK, device.Initialize());
+
+		float fSpeed = 0.0f;
+		ASSERT_EQ(ONI_STATUS_OK, device.setProperty(ONI_DEVICE_PROPERTY_PLAYBACK_SPEED, &fSpeed, sizeof(fSpeed)));
+		OniBool bRepeat = FALSE;
+		ASSERT_EQ(ONI_STATUS_OK, device.setProperty(ONI_DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED, &bRepeat, sizeof(bRepeat)));
+
+		oni::driver::StreamBase* pStream = device.createStream(ONI_SENSOR_DEPTH);
+		ASSERT_TRUE(pStream != NULL);
+		pStream->setServices(&services);
+		pStream->setNewFrameCallback(CollectFrame, &collector);
+		ASSERT_EQ(ONI_STATUS_OK, pStream->start());
+
+		EXPECT_EQ(XN_STATUS_OK, collector.allDelivered.Wait(XN_TEST_WAIT_TIMEOUT));
+
+		pStream->stop();
+		device.destroyStream(pStream);
+	}
+
+	xnOSDeleteFile(XN_TEST_FILE_NAME);
+
+	ASSERT_EQ((XnUInt32)XN_TEST_FRAMES, collector.nFrames);
+	for (XnUInt32 i = 0; i < XN_TEST_FRAMES; ++i)
+	{
+		const DeliveredFrame& frame = collector.aFrames[i];
+		const RecordedMode& mode = g_modes[i / XN_TEST_FRAMES_PER_MODE];
+		XnUInt32 nWidth = GetFrameWidth(mode);
+		XnUInt32 nHeight = GetFrameHeight(mode);
+
+		EXPECT_EQ((int)(i + 1), frame.nFrameIndex);
+		EXPECT_EQ((int)(i + 1), frame.nFirstPixel) << "frame " << frame.nFrameIndex;
+		EXPECT_EQ((int)nWidth, frame.nWidth) << "frame " << frame.nFrameIndex;
+		EXPECT_EQ((int)nHeight, frame.nHeight) << "frame " << frame.nFrameIndex;
+		EXPECT_EQ((int)mode.outputMode.nXRes, frame.nResolutionX) << "frame " << frame.nFrameIndex;
+		EXPECT_EQ((OniBool)mode.cropping.bEnabled, frame.bCropping) << "frame " << frame.nFrameIndex;
+		EXPECT_EQ((int)(nWidth * nHeight * sizeof(OniDepthPixel)), frame.nDataSize) << "frame " << frame.nFrameIndex;
+	}
+}
+
+} // namespace
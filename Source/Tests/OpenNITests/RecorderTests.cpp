@@ -0,0 +1,275 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <gtest/gtest.h>
+#include <OpenNI.h>
+#include <XnOS.h>
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+namespace
+{
+
+#define XN_TEST_FILE_NAME "RecorderTests.oni"
+// The dummy device streams depth and color at 30 FPS.
+#define XN_TEST_DEVICE_URI "Dummy"
+#define XN_TEST_STREAMS 2
+#define XN_TEST_RECORDED_FRAMES 45
+#define XN_TEST_MAX_FRAMES 300
+#define XN_TEST_WAIT_TIMEOUT 10000
+
+const openni::SensorType g_sensors[XN_TEST_STREAMS] = { openni::SENSOR_DEPTH, openni::SENSOR_COLOR };
+
+// Copies of the frames read from a stream.
+class FrameLog
+{
+public:
+	FrameLog() : m_nFrames(0) {}
+
+	~FrameLog()
+	{
+		for (int i = 0; i < m_nFrames; ++i)
+		{
+			xnOSFree(m_aFrames[i].pData);
+		}
+	}
+
+	void Add(const openni::VideoFrameRef& frame)
+	{
+		ASSERT_LT(m_nFrames, XN_TEST_MAX_FRAMES);
+		StoredFrame& stored = m_aFrames[m_nFrames++];
+		stored.nTimestamp = frame.getTimestamp();
+		stored.nFrameIndex = frame.getFrameIndex();
+		stored.nDataSize = frame.getDataSize();
+		stored.pData = xnOSMalloc(stored.nDataSize);
+		xnOSMemCopy(stored.pData, frame.getData(), stored.nDataSize);
+	}
+
+	int GetCount() const { return m_nFrames; }
+
+	// The first frame from nStart on holding the same data, or -1.
+	int FindData(int nStart, const void* pData, int nDataSize) const
+	{
+		for (int i = nStart; i < m_nFrames; ++i)
+		{
+			if (m_aFrames[i].nDataSize == nDataSize && xnOSMemCmp(m_aFrames[i].pData, pData, nDataSize) == 0)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	int FindTimestamp(uint64_t nTimestamp) const
+	{
+		for (int i = 0; i < m_nFrames; ++i)
+		{
+			if (m_aFrames[i].nTimestamp == nTimestamp)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	struct StoredFrame
+	{
+		uint64_t nTimestamp;
+		int nFrameIndex;
+		int nDataSize;
+		void* pData;
+	};
+
+	const StoredFrame& operator[](int i) const { return m_aFrames[i]; }
+
+private:
+	StoredFrame m_aFrames[XN_TEST_MAX_FRAMES];
+	int m_nFrames;
+};
+
+// Reads the next frame of any of the streams into its log, and returns the index of that stream or -1.
+int ReadAnyFrame(openni::VideoStream* aStreams, FrameLog* aLogs, int nTimeout)
+{
+	openni::VideoStream* apStreams[XN_TEST_STREAMS];
+	for (int i = 0; i < XN_TEST_STREAMS; ++i)
+	{
+		apStreams[i] = &aStreams[i];
+	}
+
+	int nReady = -1;
+	if (openni::OpenNI::waitForAnyStream(apStreams, XN_TEST_STREAMS, &nReady, nTimeout) != openni::STATUS_OK)
+	{
+		return -1;
+	}
+
+	openni::VideoFrameRef frame;
+	if (aStreams[nReady].readFrame(&frame) != openni::STATUS_OK)
+	{
+		return -1;
+	}
+
+	aLogs[nReady].Add(frame);
+	return nReady;
+}
+
+// Creates and starts the streams, keeping every frame until it is read.
+void StartStreams(openni::Device& device, openni::VideoStream* aStreams)
+{
+	for (int i = 0; i < XN_TEST_STREAMS; ++i)
+	{
+		ASSERT_EQ(openni::STATUS_OK, aStreams[i].create(device, g_sensors[i])) << openni::OpenNI::getExtendedError();
+		ASSERT_EQ(openni::STATUS_OK, aStreams[i].setProperty<int>(openni::STREAM_PROPERTY_FRAME_QUEUE_SIZE, XN_TEST_MAX_FRAMES));
+		ASSERT_EQ(openni::STATUS_OK, aStreams[i].start()) << openni::OpenNI::getExtendedError();
+	}
+}
+
+// Records the live streams of the dummy device, and logs every frame they produced meanwhile.
+void RecordLiveStreams(FrameLog* aLogs)
+{
+	openni::Device device;
+	ASSERT_EQ(openni::STATUS_OK, device.open(XN_TEST_DEVICE_URI)) << openni::OpenNI::getExtendedError();
+
+	openni::VideoStream aStreams[XN_TEST_STREAMS];
+	StartStreams(device, aStreams);
+	if (::testing::Test::HasFatalFailure())
+	{
+		return;
+	}
+
+	openni::Recorder recorder;
+	ASSERT_EQ(openni::STATUS_OK, recorder.create(XN_TEST_FILE_NAME)) << openni::OpenNI::getExtendedError();
+	for (int i = 0; i < XN_TEST_STREAMS; ++i)
+	{
+		// lossless, so played frames must match the live ones exactly
+		ASSERT_EQ(openni::STATUS_OK, recorder.attach(aStreams[i], false)) << openni::OpenNI::getExtendedError();
+	}
+	ASSERT_EQ(openni::STATUS_OK, recorder.start()) << openni::OpenNI::getExtendedError();
+
+	while (aLogs[0].GetCount() < XN_TEST_RECORDED_FRAMES || aLogs[1].GetCount() < XN_TEST_RECORDED_FRAMES)
+	{
+		ASSERT_NE(-1, ReadAnyFrame(aStreams, aLogs, XN_TEST_WAIT_TIMEOUT));
+	}
+
+	// Destroying the recorder writes everything it was given. Every frame recorded by then is still
+	// queued or already logged.
+	recorder.stop();
+	recorder.destroy();
+	while (ReadAnyFrame(aStreams, aLogs, 0) != -1)
+	{
+	}
+
+	for (int i = 0; i < XN_TEST_STREAMS; ++i)
+	{
+		aStreams[i].stop();
+		aStreams[i].destroy();
+	}
+	device.close();
+}
+
+// Plays the recording and logs all of its frames.
+void PlayRecording(FrameLog* aLogs)
+{
+	openni::Device device;
+	ASSERT_EQ(openni::STATUS_OK, device.open(XN_TEST_FILE_NAME)) << openni::OpenNI::getExtendedError();
+	openni::PlaybackControl* pPlayback = device.getPlaybackControl();
+	ASSERT_TRUE(pPlayback != NULL);
+	ASSERT_EQ(openni::STATUS_OK, pPlayback->setRepeatEnabled(false));
+	// Playback starts with the first stream, so hold it until all of them are started.
+	ASSERT_EQ(openni::STATUS_OK, pPlayback->setSpeed(-1.0f));
+
+	openni::VideoStream aStreams[XN_TEST_STREAMS];
+	StartStreams(device, aStreams);
+	if (::testing::Test::HasFatalFailure())
+	{
+		return;
+	}
+
+	// as fast as possible
+	ASSERT_EQ(openni::STATUS_OK, pPlayback->setSpeed(0.0f));
+
+	for (int i = 0; i < XN_TEST_STREAMS; ++i)
+	{
+		int nFrames = pPlayback->getNumberOfFrames(aStreams[i]);
+		EXPECT_GE(nFrames, XN_TEST_RECORDED_FRAMES / 2) << "stream " << i;
+		for (int j = 0; j < nFrames; ++j)
+		{
+			openni::VideoFrameRef frame;
+			ASSERT_EQ(openni::STATUS_OK, aStreams[i].readFrame(&frame)) << "stream " << i << " frame " << j;
+			aLogs[i].Add(frame);
+		}
+	}
+
+	for (int i = 0; i < XN_TEST_STREAMS; ++i)
+	{
+		aStreams[i].stop();
+		aStreams[i].destroy();
+	}
+	device.close();
+}
+
+// The recorder numbers frames from 1 and times them from the first recorded one. Every frame played back
+// must hold the data of the live frame with the same time since that first frame.
+void ExpectPlayedAsRecorded(const FrameLog& live, const FrameLog& played, int nStream)
+{
+	ASSERT_GT(played.GetCount(), 0) << "stream " << nStream;
+	EXPECT_EQ(0U, played[0].nTimestamp) << "stream " << nStream;
+
+	int nFirst = live.FindData(0, played[0].pData, played[0].nDataSize);
+	ASSERT_NE(-1, nFirst) << "stream " << nStream << ": first recorded frame was never read";
+	uint64_t nFirstTimestamp = live[nFirst].nTimestamp;
+
+	for (int i = 0; i < played.GetCount(); ++i)
+	{
+		EXPECT_EQ(i + 1, played[i].nFrameIndex) << "stream " << nStream;
+
+		int nLive = live.FindTimestamp(nFirstTimestamp + played[i].nTimestamp);
+		ASSERT_NE(-1, nLive) << "stream " << nStream << " frame " << played[i].nFrameIndex << ": no live frame at that time";
+		ASSERT_EQ(live[nLive].nDataSize, played[i].nDataSize) << "stream " << nStream << " frame " << played[i].nFrameIndex;
+		EXPECT_EQ(0, xnOSMemCmp(live[nLive].pData, played[i].pData, played[i].nDataSize)) << "stream " << nStream << " frame " << played[i].nFrameIndex;
+	}
+}
+
+// Streams are compressed by the recorder's codec workers in parallel, and must still be written in order.
+TEST(RecorderTests, PlaybackMatchesRecordedFrames)
+{
+	ASSERT_EQ(openni::STATUS_OK, openni::OpenNI::initialize()) << openni::OpenNI::getExtendedError();
+
+	FrameLog aLive[XN_TEST_STREAMS];
+	FrameLog aPlayed[XN_TEST_STREAMS];
+	RecordLiveStreams(aLive);
+	if (!::testing::Test::HasFatalFailure())
+	{
+		PlayRecording(aPlayed);
+	}
+
+	for (int i = 0; i < XN_TEST_STREAMS && !::testing::Test::HasFatalFailure(); ++i)
+	{
+		ExpectPlayedAsRecorded(aLive[i], aPlayed[i], i);
+	}
+
+	xnOSDeleteFile(XN_TEST_FILE_NAME);
+	openni::OpenNI::shutdown();
+}
+
+}
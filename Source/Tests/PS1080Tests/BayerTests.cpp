@@ -0,0 +1,123 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <gtest/gtest.h>
+#include "Bayer.h"
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+// The same code without SSE, see BayerScalar.cpp
+void Bayer2RGB888Scalar(const XnUInt8* pBayerImage, XnUInt8* pRGBImage, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nDownSampleStep, XnDebayeringMethod method, xnl::ThreadPool* pThreadPool);
+
+namespace
+{
+
+#define XN_TEST_GUARD_SIZE 64
+#define XN_TEST_GUARD_VALUE 0xAB
+
+// Widths below, at and around multiples of 16 vector pixels (plus the 4 scalar edge pixels), with
+// odd and even pixel pair counts. The Bayer code itself needs even widths of at least 4.
+const XnUInt32 g_widths[] = { 4, 6, 8, 18, 20, 22, 34, 36, 38, 52, 54, 66, 102, 644 };
+
+// The first and last row pairs alone, one stripe, and several stripes of 16 row pairs with a
+// partial last one. Odd heights leave a last line that is not debayered.
+const XnUInt32 g_heights[] = { 4, 6, 7, 32, 34, 35, 64, 66, 98 };
+
+const XnDebayeringMethod g_methods[] = { XN_DEBAYERING_BILINEAR, XN_DEBAYERING_EDGE_AWARE };
+
+// Fills the image with random values, modulo nRange. Small ranges make many edge-aware ties.
+void FillBayer(XnUInt8* pBayer, XnUInt32 nSize, XnUInt32 nRange)
+{
+	XnUInt32 nRandom = 12345 + nRange;
+	for (XnUInt32 i = 0; i < nSize; ++i)
+	{
+		nRandom = nRandom * 1103515245 + 12345;
+		pBayer[i] = (XnUInt8)((nRandom >> 16) % nRange);
+	}
+}
+
+// Debayers the image both ways and expects the same output everywhere, and nothing written past it.
+void ExpectSameAsScalar(XnUInt32 nXRes, XnUInt32 nYRes, XnDebayeringMethod method, XnUInt32 nRange, xnl::ThreadPool* pThreadPool)
+{
+	XnUInt32 nBayerSize = nXRes * nYRes;
+	XnUInt32 nRGBSize = nBayerSize * BAYER_BPP;
+
+	// the whole buffers sit between guards, so a kernel reading or writing outside the image shows
+	XnUInt8* pBayer = new XnUInt8[nBayerSize + 2 * XN_TEST_GUARD_SIZE];
+	XnUInt8* pExpected = new XnUInt8[nRGBSize + XN_TEST_GUARD_SIZE];
+	XnUInt8* pActual = new XnUInt8[nRGBSize + XN_TEST_GUARD_SIZE];
+
+	xnOSMemSet(pBayer, XN_TEST_GUARD_VALUE, nBayerSize + 2 * XN_TEST_GUARD_SIZE);
+	FillBayer(pBayer + XN_TEST_GUARD_SIZE, nBayerSize, nRange);
+	xnOSMemSet(pExpected, XN_TEST_GUARD_VALUE, nRGBSize + XN_TEST_GUARD_SIZE);
+	xnOSMemSet(pActual, XN_TEST_GUARD_VALUE, nRGBSize + XN_TEST_GUARD_SIZE);
+
+	Bayer2RGB888Scalar(pBayer + XN_TEST_GUARD_SIZE, pExpected, nXRes, nYRes, 1, method, NULL);
+	Bayer2RGB888(pBayer + XN_TEST_GUARD_SIZE, pActual, nXRes, nYRes, 1, method, pThreadPool);
+
+	for (XnUInt32 i = 0; i < nRGBSize + XN_TEST_GUARD_SIZE; ++i)
+	{
+		if (pExpected[i] != pActual[i])
+		{
+			ADD_FAILURE() << nXRes << "x" << nYRes << " method " << method << " range " << nRange << (pThreadPool != NULL ? " stripes" : "")
+				<< ": line " << i / (nXRes * BAYER_BPP) << " pixel " << i % (nXRes * BAYER_BPP) / BAYER_BPP << " component " << i % BAYER_BPP
+				<< " is " << (int)pActual[i] << " instead of " << (int)pExpected[i];
+			break;
+		}
+	}
+
+	delete[] pBayer;
+	delete[] pExpected;
+	delete[] pActual;
+}
+
+void ExpectAllSizesSameAsScalar(xnl::ThreadPool* pThreadPool)
+{
+	for (XnUInt32 nMethod = 0; nMethod < sizeof(g_methods) / sizeof(g_methods[0]); ++nMethod)
+	{
+		for (XnUInt32 nWidth = 0; nWidth < sizeof(g_widths) / sizeof(g_widths[0]); ++nWidth)
+		{
+			for (XnUInt32 nHeight = 0; nHeight < sizeof(g_heights) / sizeof(g_heights[0]); ++nHeight)
+			{
+				ExpectSameAsScalar(g_widths[nWidth], g_heights[nHeight], g_methods[nMethod], 256, pThreadPool);
+				ExpectSameAsScalar(g_widths[nWidth], g_heights[nHeight], g_methods[nMethod], 4, pThreadPool);
+			}
+		}
+	}
+}
+
+// On a CPU without SSSE3 both sides run the scalar code, and the test only checks the stripes.
+TEST(BayerTests, VectorKernelMatchesScalar)
+{
+	ExpectAllSizesSameAsScalar(NULL);
+}
+
+TEST(BayerTests, StripesMatchScalar)
+{
+	xnl::ThreadPool pool;
+	ASSERT_EQ(XN_STATUS_OK, pool.Create(3));
+	ExpectAllSizesSameAsScalar(&pool);
+}
+
+}
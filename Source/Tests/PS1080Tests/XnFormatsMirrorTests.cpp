@@ -0,0 +1,122 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <gtest/gtest.h>
+#include <XnOS.h>
+#include "XnFormats.h"
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+namespace
+{
+
+#define XN_TEST_LINES 3
+#define XN_TEST_MAX_WIDTH 200
+#define XN_TEST_GUARD_VALUE 0xAB
+
+struct MirrorFormat
+{
+	const char* strName;
+	OniPixelFormat format;
+	// bytes and pixels of the unit that is moved as a whole: a pixel, or a YUV element of two pixels
+	XnUInt32 nElementBytes;
+	XnUInt32 nElementPixels;
+	// for YUV elements, the offsets of the two Y values, which trade places
+	XnUInt32 nY1;
+	XnUInt32 nY2;
+};
+
+const MirrorFormat g_formats[] =
+{
+	{ "GRAY8", ONI_PIXEL_FORMAT_GRAY8, 1, 1, 0, 0 },
+	{ "DEPTH_1_MM", ONI_PIXEL_FORMAT_DEPTH_1_MM, 2, 1, 0, 0 },
+	{ "RGB888", ONI_PIXEL_FORMAT_RGB888, 3, 1, 0, 0 },
+	{ "YUV422", ONI_PIXEL_FORMAT_YUV422, 4, 2, 1, 3 },
+	{ "YUYV", ONI_PIXEL_FORMAT_YUYV, 4, 2, 0, 2 },
+};
+
+// Mirrors each line of pSource into pMirrored, one element at a time
+void NaiveMirror(const MirrorFormat& format, const XnUInt8* pSource, XnUInt8* pMirrored, XnUInt32 nXRes, XnUInt32 nLines)
+{
+	XnUInt32 nElements = nXRes / format.nElementPixels;
+	XnUInt32 nLineBytes = nElements * format.nElementBytes;
+
+	for (XnUInt32 nLine = 0; nLine < nLines; ++nLine)
+	{
+		for (XnUInt32 i = 0; i < nElements; ++i)
+		{
+			const XnUInt8* pIn = pSource + nLine * nLineBytes + (nElements - 1 - i) * format.nElementBytes;
+			XnUInt8* pOut = pMirrored + nLine * nLineBytes + i * format.nElementBytes;
+			xnOSMemCopy(pOut, pIn, format.nElementBytes);
+			if (format.nElementPixels == 2)
+			{
+				pOut[format.nY1] = pIn[format.nY2];
+				pOut[format.nY2] = pIn[format.nY1];
+			}
+		}
+	}
+}
+
+// Every width up to XN_TEST_MAX_WIDTH, so each kernel runs with no vector block, with blocks, and with
+// every tail length at the middle of the line. The buffer also ends with part of a line, which must be
+// left alone, and a guard.
+TEST(XnFormatsMirrorTests, MatchesNaiveMirror)
+{
+	XnUInt8 source[(XN_TEST_LINES + 1) * XN_TEST_MAX_WIDTH * 3];
+	XnUInt8 expected[sizeof(source)];
+	XnUInt8 actual[sizeof(source) + 1];
+
+	XnUInt32 nRandom = 12345;
+	for (XnUInt32 i = 0; i < sizeof(source); ++i)
+	{
+		nRandom = nRandom * 1103515245 + 12345;
+		source[i] = (XnUInt8)(nRandom >> 16);
+	}
+
+	for (XnUInt32 nFormat = 0; nFormat < sizeof(g_formats) / sizeof(g_formats[0]); ++nFormat)
+	{
+		const MirrorFormat& format = g_formats[nFormat];
+
+		for (XnUInt32 nXRes = format.nElementPixels; nXRes <= XN_TEST_MAX_WIDTH; nXRes += format.nElementPixels)
+		{
+			XnUInt32 nLineBytes = nXRes / format.nElementPixels * format.nElementBytes;
+			XnUInt32 nBufferSize = XN_TEST_LINES * nLineBytes + nLineBytes / 2;
+
+			xnOSMemCopy(expected, source, nBufferSize);
+			NaiveMirror(format, source, expected, nXRes, XN_TEST_LINES);
+
+			xnOSMemCopy(actual, source, nBufferSize);
+			actual[nBufferSize] = XN_TEST_GUARD_VALUE;
+			ASSERT_EQ(XN_STATUS_OK, XnFormatsMirrorPixelData(format.format, actual, nBufferSize, nXRes));
+
+			for (XnUInt32 i = 0; i < nBufferSize; ++i)
+			{
+				ASSERT_EQ(expected[i], actual[i]) << format.strName << " width " << nXRes << ": line " << i / nLineBytes << " byte " << i % nLineBytes;
+			}
+			ASSERT_EQ(XN_TEST_GUARD_VALUE, actual[nBufferSize]) << format.strName << " width " << nXRes;
+		}
+	}
+}
+
+}
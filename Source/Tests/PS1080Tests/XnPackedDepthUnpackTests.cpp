@@ -0,0 +1,234 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <gtest/gtest.h>
+#include "XnPackedDepthUnpack.h"
+#include "XnDeviceSensor.h"
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+namespace
+{
+
+// A VGA frame
+#define XN_TEST_FRAME_PIXELS (640 * 480)
+
+typedef void (*UnpackFunc)(const XnUInt8* pcInput, XnUInt32 nElements, const OniDepthPixel* pShiftToDepth, OniDepthPixel* pnOutput, XnInt32 nStep, XnBool bVectorize);
+
+struct PackedFormat
+{
+	UnpackFunc pUnpack;
+	XnUInt32 nBits;
+	XnUInt32 nElementSize;
+	XnUInt32 nPixelsPerElement;
+	// Shifts from this value on read as 0
+	XnUInt32 nMaxShift;
+};
+
+const PackedFormat g_packed11 = { XnUnpackPacked11Depth, 11, XN_PACKED_11_INPUT_ELEMENT_SIZE, 8, XN_DEVICE_SENSOR_MAX_SHIFT_VALUE };
+const PackedFormat g_packed12 = { XnUnpackPacked12Depth, 12, XN_PACKED_12_INPUT_ELEMENT_SIZE, 16, XN_DEVICE_SENSOR_MAX_SHIFT_VALUE - 1 };
+
+class XnPackedDepthUnpackTests : public ::testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		m_nRandom = 12345;
+		for (XnUInt32 i = 0; i < XN_DEVICE_SENSOR_MAX_SHIFT_VALUE; ++i)
+		{
+			m_shiftToDepth[i] = (OniDepthPixel)Random();
+		}
+	}
+
+	XnUInt32 Random()
+	{
+		m_nRandom = m_nRandom * 1103515245 + 12345;
+		return m_nRandom >> 8;
+	}
+
+	void FillRandom(XnUInt8* pData, XnUInt32 nSize)
+	{
+		for (XnUInt32 i = 0; i < nSize; ++i)
+		{
+			pData[i] = (XnUInt8)Random();
+		}
+	}
+
+	// Reads the shifts bit by bit, most significant bit first.
+	void UnpackReference(const PackedFormat& format, const XnUInt8* pInput, XnUInt32 nElements, OniDepthPixel* pOutput)
+	{
+		XnUInt32 nPixels = nElements * format.nPixelsPerElement;
+		for (XnUInt32 nPixel = 0; nPixel < nPixels; ++nPixel)
+		{
+			XnUInt32 nShift = 0;
+			for (XnUInt32 nBit = nPixel * format.nBits; nBit < (nPixel + 1) * format.nBits; ++nBit)
+			{
+				nShift = (nShift << 1) | ((pInput[nBit / 8] >> (7 - nBit % 8)) & 1);
+			}
+			pOutput[nPixel] = m_shiftToDepth[nShift < format.nMaxShift ? nShift : 0];
+		}
+	}
+
+	// Unpacks the pixels starting at nFirstPixel of a frame of nFramePixels, from an exactly sized copy of
+	// the input so that reading past it shows up under memory checkers. Mirrored frames are written from
+	// the end, backwards.
+	void Unpack(const PackedFormat& format, const XnUInt8* pInput, XnUInt32 nElements, OniDepthPixel* pFrame, XnUInt32 nFramePixels, XnUInt32 nFirstPixel, XnBool bMirror, XnBool bVectorize)
+	{
+		XnUInt32 nInputSize = nElements * format.nElementSize;
+		XnUInt8* pCopy = new XnUInt8[nInputSize + 1];
+		xnOSMemCopy(pCopy, pInput, nInputSize);
+
+		if (bMirror)
+		{
+			format.pUnpack(pCopy, nElements, m_shiftToDepth, pFrame + nFramePixels - 1 - nFirstPixel, -1, bVectorize);
+		}
+		else
+		{
+			format.pUnpack(pCopy, nElements, m_shiftToDepth, pFrame + nFirstPixel, 1, bVectorize);
+		}
+
+		delete[] pCopy;
+	}
+
+	void ExpectMatchesReference(const PackedFormat& format, XnUInt32 nElements, XnBool bMirror, XnBool bVectorize)
+	{
+		XnUInt32 nPixels = nElements * format.nPixelsPerElement;
+		XnUInt8* pInput = new XnUInt8[nElements * format.nElementSize + 1];
+		OniDepthPixel* pExpected = new OniDepthPixel[nPixels + 1];
+		OniDepthPixel* pActual = new OniDepthPixel[nPixels + 1];
+
+		FillRandom(pInput, nElements * format.nElementSize);
+		UnpackReference(format, pInput, nElements, pExpected);
+		Unpack(format, pInput, nElements, pActual, nPixels, 0, bMirror, bVectorize);
+
+		for (XnUInt32 i = 0; i < nPixels; ++i)
+		{
+			ASSERT_EQ(pExpected[i], pActual[bMirror ? nPixels - 1 - i : i]) << "pixel " << i << " of " << nElements << " elements" <<
+				(bMirror ? ", mirrored" : "") << (bVectorize ? ", vectorized" : ", scalar");
+		}
+
+		delete[] pActual;
+		delete[] pExpected;
+		delete[] pInput;
+	}
+
+	void ExpectAllSizesMatchReference(const PackedFormat& format)
+	{
+		for (XnUInt32 nElements = 0; nElements <= 40; ++nElements)
+		{
+			for (int nMode = 0; nMode < 4; ++nMode)
+			{
+				ExpectMatchesReference(format, nElements, (nMode & 1) != 0, (nMode & 2) != 0);
+			}
+		}
+	}
+
+	// Feeds a frame in packets of random sizes, carrying partial elements over to the next packet the
+	// way the depth processors do, and expects the same pixels as the scalar code unpacking it at once.
+	void ExpectSplitPacketsMatchScalar(const PackedFormat& format, XnBool bMirror)
+	{
+		XnUInt32 nElements = XN_TEST_FRAME_PIXELS / format.nPixelsPerElement;
+		XnUInt32 nFrameSize = nElements * format.nElementSize;
+		XnUInt8* pFrame = new XnUInt8[nFrameSize];
+		OniDepthPixel* pExpected = new OniDepthPixel[XN_TEST_FRAME_PIXELS];
+		OniDepthPixel* pActual = new OniDepthPixel[XN_TEST_FRAME_PIXELS];
+		XnUInt8* pContinuous = new XnUInt8[format.nElementSize];
+		XnUInt32 nContinuous = 0;
+
+		FillRandom(pFrame, nFrameSize);
+		Unpack(format, pFrame, nElements, pExpected, XN_TEST_FRAME_PIXELS, 0, bMirror, FALSE);
+
+		XnUInt32 nPixel = 0;
+		for (XnUInt32 nOffset = 0; nOffset < nFrameSize; )
+		{
+			XnUInt32 nPacketSize = 1 + Random() % 1000;
+			nPacketSize = XN_MIN(nPacketSize, nFrameSize - nOffset);
+			const XnUInt8* pPacket = pFrame + nOffset;
+			nOffset += nPacketSize;
+
+			if (nContinuous != 0)
+			{
+				XnUInt32 nRead = XN_MIN(nPacketSize, format.nElementSize - nContinuous);
+				xnOSMemCopy(pContinuous + nContinuous, pPacket, nRead);
+				nContinuous += nRead;
+				pPacket += nRead;
+				nPacketSize -= nRead;
+
+				if (nContinuous == format.nElementSize)
+				{
+					Unpack(format, pContinuous, 1, pActual, XN_TEST_FRAME_PIXELS, nPixel, bMirror, TRUE);
+					nPixel += format.nPixelsPerElement;
+					nContinuous = 0;
+				}
+			}
+
+			XnUInt32 nPacketElements = nPacketSize / format.nElementSize;
+			Unpack(format, pPacket, nPacketElements, pActual, XN_TEST_FRAME_PIXELS, nPixel, bMirror, TRUE);
+			nPixel += nPacketElements * format.nPixelsPerElement;
+
+			// a packet that didn't complete the carried element has nothing left, so this only appends
+			XnUInt32 nLeftOver = nPacketSize - nPacketElements * format.nElementSize;
+			xnOSMemCopy(pContinuous + nContinuous, pPacket + nPacketElements * format.nElementSize, nLeftOver);
+			nContinuous += nLeftOver;
+		}
+
+		ASSERT_EQ((XnUInt32)XN_TEST_FRAME_PIXELS, nPixel);
+		for (XnUInt32 i = 0; i < XN_TEST_FRAME_PIXELS; ++i)
+		{
+			ASSERT_EQ(pExpected[i], pActual[i]) << "pixel " << i << (bMirror ? ", mirrored" : "");
+		}
+
+		delete[] pContinuous;
+		delete[] pActual;
+		delete[] pExpected;
+		delete[] pFrame;
+	}
+
+	XnUInt32 m_nRandom;
+	OniDepthPixel m_shiftToDepth[XN_DEVICE_SENSOR_MAX_SHIFT_VALUE];
+};
+
+TEST_F(XnPackedDepthUnpackTests, Packed11MatchesReference)
+{
+	ExpectAllSizesMatchReference(g_packed11);
+}
+
+TEST_F(XnPackedDepthUnpackTests, Packed12MatchesReference)
+{
+	ExpectAllSizesMatchReference(g_packed12);
+}
+
+TEST_F(XnPackedDepthUnpackTests, Packed11SplitPacketsMatchScalar)
+{
+	ExpectSplitPacketsMatchScalar(g_packed11, FALSE);
+	ExpectSplitPacketsMatchScalar(g_packed11, TRUE);
+}
+
+TEST_F(XnPackedDepthUnpackTests, Packed12SplitPacketsMatchScalar)
+{
+	ExpectSplitPacketsMatchScalar(g_packed12, FALSE);
+	ExpectSplitPacketsMatchScalar(g_packed12, TRUE);
+}
+
+}
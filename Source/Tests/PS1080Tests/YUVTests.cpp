@@ -0,0 +1,165 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <gtest/gtest.h>
+#include "YUV.h"
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+namespace
+{
+
+// One element for each Y, so every Y/U/V triple is converted once as Y1 and once as Y2.
+#define XN_TEST_ELEMENTS_PER_UV 256
+#define XN_TEST_MAX_ELEMENTS 100
+
+typedef void (*ConvertFunc)(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize);
+
+struct YUVLayout
+{
+	const char* strName;
+	ConvertFunc pConvert;
+	XnUInt32 nY1;
+	XnUInt32 nU;
+	XnUInt32 nY2;
+	XnUInt32 nV;
+};
+
+const YUVLayout g_layouts[] =
+{
+	{ "YUV422", YUV422ToRGB888, YUV422_Y1, YUV422_U, YUV422_Y2, YUV422_V },
+	{ "YUYV", YUYVToRGB888, YUYV_Y1, YUYV_U, YUYV_Y2, YUYV_V },
+};
+
+void ExpectPixel(const XnUInt8* pRGB, XnUInt8 cY, XnUInt8 cU, XnUInt8 cV, const char* strLayout)
+{
+	XnUInt8 cR, cG, cB;
+	YUV444ToRGB888Reference(cY, cU, cV, cR, cG, cB);
+	ASSERT_TRUE(pRGB[YUV_RED] == cR && pRGB[YUV_GREEN] == cG && pRGB[YUV_BLUE] == cB)
+		<< strLayout << " Y=" << (int)cY << " U=" << (int)cU << " V=" << (int)cV;
+}
+
+TEST(YUVTests, AllTriplesMatchReference)
+{
+	XnUInt8 yuv[XN_TEST_ELEMENTS_PER_UV * YUV422_BPP];
+	XnUInt8 rgb[XN_TEST_ELEMENTS_PER_UV * 2 * YUV_RGB_BPP];
+
+	for (XnUInt32 nLayout = 0; nLayout < sizeof(g_layouts) / sizeof(g_layouts[0]); ++nLayout)
+	{
+		const YUVLayout& layout = g_layouts[nLayout];
+
+		for (XnUInt32 nUV = 0; nUV < 256 * 256; ++nUV)
+		{
+			XnUInt8 cU = (XnUInt8)(nUV >> 8);
+			XnUInt8 cV = (XnUInt8)nUV;
+
+			for (XnUInt32 i = 0; i < XN_TEST_ELEMENTS_PER_UV; ++i)
+			{
+				XnUInt8* pElement = yuv + i * YUV422_BPP;
+				pElement[layout.nY1] = (XnUInt8)i;
+				pElement[layout.nU] = cU;
+				pElement[layout.nY2] = (XnUInt8)(255 - i);
+				pElement[layout.nV] = cV;
+			}
+
+			XnUInt32 nRead = 0;
+			XnUInt32 nRGBSize = sizeof(rgb);
+			layout.pConvert(yuv, rgb, sizeof(yuv), &nRead, &nRGBSize);
+			ASSERT_EQ(sizeof(yuv), nRead);
+			ASSERT_EQ(sizeof(rgb), nRGBSize);
+
+			for (XnUInt32 i = 0; i < XN_TEST_ELEMENTS_PER_UV; ++i)
+			{
+				const XnUInt8* pRGB = rgb + i * 2 * YUV_RGB_BPP;
+				ExpectPixel(pRGB, (XnUInt8)i, cU, cV, layout.strName);
+				ExpectPixel(pRGB + YUV_RGB_BPP, (XnUInt8)(255 - i), cU, cV, layout.strName);
+				if (HasFatalFailure())
+				{
+					return;
+				}
+			}
+		}
+	}
+}
+
+// The vector code converts whole blocks only, so check every way the input and output can end
+// inside a block, and that nothing is written past what is reported.
+TEST(YUVTests, PartialBuffersMatchReference)
+{
+	XnUInt8 yuv[XN_TEST_MAX_ELEMENTS * YUV422_BPP];
+	XnUInt8 rgb[XN_TEST_MAX_ELEMENTS * 2 * YUV_RGB_BPP + 1];
+
+	XnUInt32 nRandom = 12345;
+	for (XnUInt32 i = 0; i < sizeof(yuv); ++i)
+	{
+		nRandom = nRandom * 1103515245 + 12345;
+		yuv[i] = (XnUInt8)(nRandom >> 16);
+	}
+
+	for (XnUInt32 nLayout = 0; nLayout < sizeof(g_layouts) / sizeof(g_layouts[0]); ++nLayout)
+	{
+		const YUVLayout& layout = g_layouts[nLayout];
+
+		for (XnUInt32 nYUVSize = YUV422_BPP; nYUVSize <= sizeof(yuv); nYUVSize += 1 + nYUVSize % 5)
+		{
+			for (XnUInt32 nRGBSpace = YUV_RGB_BPP; nRGBSpace < sizeof(rgb); nRGBSpace += 1 + nRGBSpace % 7)
+			{
+				xnOSMemSet(rgb, 0xAB, sizeof(rgb));
+
+				XnUInt32 nRead = 0;
+				XnUInt32 nRGBSize = nRGBSpace;
+				layout.pConvert(yuv, rgb, nYUVSize, &nRead, &nRGBSize);
+
+#ifdef XN_YUV_FLOAT_FORMULA
+				// Pairs of elements are converted while there is room for both, as the Windows code always did.
+				XnUInt32 nElements = 2 * XN_MIN(nYUVSize / XN_YUV_TO_RGB_INPUT_ELEMENT_SIZE, nRGBSpace / XN_YUV_TO_RGB_OUTPUT_ELEMENT_SIZE);
+#else
+				// Elements are converted while there is room for one more pixel, as the scalar code always did.
+				XnUInt32 nElements = XN_MIN(nYUVSize / YUV422_BPP, (nRGBSpace + YUV_RGB_BPP) / (2 * YUV_RGB_BPP));
+#endif
+				ASSERT_EQ(nElements * YUV422_BPP, nRead) << layout.strName << " " << nYUVSize << " " << nRGBSpace;
+				ASSERT_EQ(nElements * 2 * YUV_RGB_BPP, nRGBSize) << layout.strName << " " << nYUVSize << " " << nRGBSpace;
+
+				for (XnUInt32 i = 0; i < nElements; ++i)
+				{
+					const XnUInt8* pElement = yuv + i * YUV422_BPP;
+					const XnUInt8* pRGB = rgb + i * 2 * YUV_RGB_BPP;
+					ExpectPixel(pRGB, pElement[layout.nY1], pElement[layout.nU], pElement[layout.nV], layout.strName);
+					ExpectPixel(pRGB + YUV_RGB_BPP, pElement[layout.nY2], pElement[layout.nU], pElement[layout.nV], layout.strName);
+					if (HasFatalFailure())
+					{
+						return;
+					}
+				}
+
+				for (XnUInt32 i = nRGBSize; i < sizeof(rgb); ++i)
+				{
+					ASSERT_EQ(0xAB, rgb[i]) << layout.strName << " " << nYUVSize << " " << nRGBSpace << " wrote byte " << i;
+				}
+			}
+		}
+	}
+}
+
+}
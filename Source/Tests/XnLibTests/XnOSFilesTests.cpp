@@ -0,0 +1,73 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <gtest/gtest.h>
+#include <XnOS.h>
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+namespace
+{
+
+#define XN_TEST_FILE_NAME "XnOSFilesTests.bin"
+
+const XnChar g_content[] = "mapped file content";
+
+void WriteTestFile()
+{
+	ASSERT_EQ(XN_STATUS_OK, xnOSSaveFile(XN_TEST_FILE_NAME, g_content, sizeof(g_content)));
+}
+
+TEST(XnOSFilesTests, MapFileSeesTheWholeFile)
+{
+	WriteTestFile();
+
+	void* pData = NULL;
+	XnUInt64 nSize = 0;
+	ASSERT_EQ(XN_STATUS_OK, xnOSMapFile(XN_TEST_FILE_NAME, &pData, &nSize));
+	EXPECT_EQ(sizeof(g_content), nSize);
+	EXPECT_EQ(0, xnOSMemCmp(g_content, pData, sizeof(g_content)));
+	EXPECT_EQ(XN_STATUS_OK, xnOSUnmapFile(pData, nSize));
+
+	xnOSDeleteFile(XN_TEST_FILE_NAME);
+}
+
+#if GTEST_HAS_DEATH_TEST
+// Players hand out frames that point into the mapping, so nobody may change the mapped data.
+TEST(XnOSFilesTests, MappedDataIsReadOnly)
+{
+	WriteTestFile();
+
+	void* pData = NULL;
+	XnUInt64 nSize = 0;
+	ASSERT_EQ(XN_STATUS_OK, xnOSMapFile(XN_TEST_FILE_NAME, &pData, &nSize));
+	EXPECT_DEATH(*(volatile XnChar*)pData = 'M', "");
+	EXPECT_EQ(0, xnOSMemCmp(g_content, pData, sizeof(g_content)));
+	EXPECT_EQ(XN_STATUS_OK, xnOSUnmapFile(pData, nSize));
+
+	xnOSDeleteFile(XN_TEST_FILE_NAME);
+}
+#endif
+
+} // namespace
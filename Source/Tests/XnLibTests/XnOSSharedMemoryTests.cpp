@@ -0,0 +1,76 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <gtest/gtest.h>
+#include <XnOS.h>
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+namespace
+{
+
+#define XN_TEST_SHARED_MEMORY_NAME "XnOSSharedMemoryTests"
+#define XN_TEST_SHARED_MEMORY_SIZE 4096
+
+TEST(XnOSSharedMemoryTests, CreateNewOnlyFailsIfTheBlockExists)
+{
+	XN_SHARED_MEMORY_HANDLE hFirst = NULL;
+	ASSERT_EQ(XN_STATUS_OK, xnOSCreateSharedMemory(XN_TEST_SHARED_MEMORY_NAME, XN_TEST_SHARED_MEMORY_SIZE, XN_OS_FILE_READ | XN_OS_FILE_WRITE | XN_OS_FILE_CREATE_NEW_ONLY, &hFirst));
+
+	XnUInt8* pFirst = NULL;
+	ASSERT_EQ(XN_STATUS_OK, xnOSSharedMemoryGetAddress(hFirst, (void**)&pFirst));
+	pFirst[0] = 42;
+
+	XN_SHARED_MEMORY_HANDLE hSecond = NULL;
+	EXPECT_EQ(XN_STATUS_OS_FILE_ALREDY_EXISTS, xnOSCreateSharedMemory(XN_TEST_SHARED_MEMORY_NAME, XN_TEST_SHARED_MEMORY_SIZE, XN_OS_FILE_READ | XN_OS_FILE_WRITE | XN_OS_FILE_CREATE_NEW_ONLY, &hSecond));
+
+	// The failed attempt must leave the existing block alone.
+	XN_SHARED_MEMORY_HANDLE hOpened = NULL;
+	ASSERT_EQ(XN_STATUS_OK, xnOSOpenSharedMemory(XN_TEST_SHARED_MEMORY_NAME, XN_OS_FILE_READ, &hOpened));
+	XnUInt8* pOpened = NULL;
+	ASSERT_EQ(XN_STATUS_OK, xnOSSharedMemoryGetAddress(hOpened, (void**)&pOpened));
+	EXPECT_EQ(42, pOpened[0]);
+
+	xnOSCloseSharedMemory(hOpened);
+	xnOSCloseSharedMemory(hFirst);
+}
+
+#if GTEST_HAS_DEATH_TEST
+TEST(XnOSSharedMemoryTests, ReadOnlyOpenCantWrite)
+{
+	XN_SHARED_MEMORY_HANDLE hCreated = NULL;
+	ASSERT_EQ(XN_STATUS_OK, xnOSCreateSharedMemory(XN_TEST_SHARED_MEMORY_NAME, XN_TEST_SHARED_MEMORY_SIZE, XN_OS_FILE_READ | XN_OS_FILE_WRITE, &hCreated));
+
+	XN_SHARED_MEMORY_HANDLE hOpened = NULL;
+	ASSERT_EQ(XN_STATUS_OK, xnOSOpenSharedMemory(XN_TEST_SHARED_MEMORY_NAME, XN_OS_FILE_READ, &hOpened));
+	XnUInt8* pOpened = NULL;
+	ASSERT_EQ(XN_STATUS_OK, xnOSSharedMemoryGetAddress(hOpened, (void**)&pOpened));
+	EXPECT_DEATH(*(volatile XnUInt8*)pOpened = 1, "");
+
+	xnOSCloseSharedMemory(hOpened);
+	xnOSCloseSharedMemory(hCreated);
+}
+#endif
+
+} // namespace
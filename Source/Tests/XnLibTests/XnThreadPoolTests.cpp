@@ -0,0 +1,138 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <gtest/gtest.h>
+#include <XnThreadPool.h>
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+namespace
+{
+
+#define XN_TEST_MAX_INDICES 64
+
+struct IndexCounters
+{
+	volatile XnInt32 anCalls[XN_TEST_MAX_INDICES];
+};
+
+void XN_CALLBACK_TYPE CountIndex(XnUInt32 nIndex, void* pCookie)
+{
+	IndexCounters* pCounters = (IndexCounters*)pCookie;
+	xnOSAtomicIncrement(&pCounters->anCalls[nIndex]);
+}
+
+void XN_CALLBACK_TYPE CountTask(void* pCookie)
+{
+	xnOSAtomicIncrement((volatile XnInt32*)pCookie);
+}
+
+void ExpectEachIndexOnce(xnl::ThreadPool& pool, XnUInt32 nCount)
+{
+	IndexCounters counters;
+	xnOSMemSet(&counters, 0, sizeof(counters));
+
+	pool.ParallelFor(nCount, CountIndex, &counters);
+
+	for (XnUInt32 i = 0; i < XN_TEST_MAX_INDICES; ++i)
+	{
+		ASSERT_EQ(i < nCount ? 1 : 0, counters.anCalls[i]) << "index " << i << " of " << nCount;
+	}
+}
+
+TEST(XnThreadPoolTests, ParallelForCallsEachIndexOnce)
+{
+	xnl::ThreadPool pool;
+	ASSERT_EQ(XN_STATUS_OK, pool.Create(3));
+
+	for (XnUInt32 nCount = 0; nCount <= XN_TEST_MAX_INDICES; ++nCount)
+	{
+		ExpectEachIndexOnce(pool, nCount);
+	}
+}
+
+TEST(XnThreadPoolTests, ParallelForWithoutThreadsRunsInline)
+{
+	xnl::ThreadPool pool;
+	ExpectEachIndexOnce(pool, 7);
+
+	ASSERT_EQ(XN_STATUS_OK, pool.Create(1));
+	pool.Destroy();
+	ExpectEachIndexOnce(pool, 7);
+}
+
+// Each call returns while helpers may still be on their way out, and the next call reuses the same
+// stack. Helpers must not touch a call's state after it returned.
+TEST(XnThreadPoolTests, BackToBackParallelFor)
+{
+	xnl::ThreadPool pool;
+	ASSERT_EQ(XN_STATUS_OK, pool.Create(4));
+
+	for (XnUInt32 i = 0; i < 20000; ++i)
+	{
+		ExpectEachIndexOnce(pool, 1 + i % 8);
+	}
+}
+
+TEST(XnThreadPoolTests, ConcurrentParallelForCallers)
+{
+	xnl::ThreadPool pool;
+	ASSERT_EQ(XN_STATUS_OK, pool.Create(2));
+
+	struct Caller
+	{
+		static XN_THREAD_PROC Run(XN_THREAD_PARAM pThreadParam)
+		{
+			xnl::ThreadPool* pPool = (xnl::ThreadPool*)pThreadParam;
+			for (XnUInt32 i = 0; i < 5000; ++i)
+			{
+				ExpectEachIndexOnce(*pPool, 1 + i % 5);
+			}
+			XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+		}
+	};
+
+	XN_THREAD_HANDLE hThread;
+	ASSERT_EQ(XN_STATUS_OK, xnOSCreateThread(Caller::Run, &pool, &hThread));
+	Caller::Run(&pool);
+	xnOSWaitForThreadExit(hThread, XN_WAIT_INFINITE);
+	xnOSCloseThread(&hThread);
+}
+
+TEST(XnThreadPoolTests, DestroyRunsQueuedTasks)
+{
+	volatile XnInt32 nDone = 0;
+
+	xnl::ThreadPool pool;
+	ASSERT_EQ(XN_STATUS_OK, pool.Create(2));
+	for (XnUInt32 i = 0; i < 1000; ++i)
+	{
+		ASSERT_EQ(XN_STATUS_OK, pool.Submit(CountTask, (void*)&nDone));
+	}
+	pool.Destroy();
+
+	EXPECT_EQ(1000, nDone);
+}
+
+}
@@ -0,0 +1,274 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <stdio.h>
+#include <XnOS.h>
+#include "YUV.h"
+#include "XnLinkYuvToRgb.h"
+#include "DepthUtils.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_X_RES 640
+#define BENCHMARK_Y_RES 480
+#define BENCHMARK_PIXELS (BENCHMARK_X_RES * BENCHMARK_Y_RES)
+#define BENCHMARK_ITERATIONS 200
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+static XnUInt32 g_nRandom = 12345;
+
+static XnUInt32 Random()
+{
+	g_nRandom = g_nRandom * 1103515245 + 12345;
+	return g_nRandom >> 8;
+}
+
+static XnDouble GetTimeMs()
+{
+	XnUInt64 nNow;
+	xnOSGetHighResTimeStamp(&nNow);
+	return nNow / 1000.0;
+}
+
+static void PrintResult(const char* strName, XnDouble dStart, XnBool bSame)
+{
+	XnDouble dFrameMs = (GetTimeMs() - dStart) / BENCHMARK_ITERATIONS;
+	printf("%-48s %8.3f ms/frame %8.1f MPixels/s  %s\n", strName, dFrameMs, BENCHMARK_PIXELS / dFrameMs / 1000.0, bSame ? "same" : "DIFFERENT");
+}
+
+// The conversion as done before the vector code: this platform's per-pixel formula on each pixel.
+static void YUVToRGB888Reference(const XnUInt8* pYUV, XnUInt8* pRGB, XnUInt32 nY1, XnUInt32 nU, XnUInt32 nY2, XnUInt32 nV)
+{
+	for (XnUInt32 i = 0; i < BENCHMARK_PIXELS / 2; ++i, pYUV += YUV422_BPP, pRGB += 2 * YUV_RGB_BPP)
+	{
+		YUV444ToRGB888Reference(pYUV[nY1], pYUV[nU], pYUV[nV], pRGB[YUV_RED], pRGB[YUV_GREEN], pRGB[YUV_BLUE]);
+		YUV444ToRGB888Reference(pYUV[nY2], pYUV[nU], pYUV[nV], pRGB[YUV_RGB_BPP + YUV_RED], pRGB[YUV_RGB_BPP + YUV_GREEN], pRGB[YUV_RGB_BPP + YUV_BLUE]);
+	}
+}
+
+static XnBool BenchmarkYUV()
+{
+	const XnUInt32 nYUVSize = BENCHMARK_PIXELS / 2 * YUV422_BPP;
+	const XnUInt32 nRGBSize = BENCHMARK_PIXELS * YUV_RGB_BPP;
+
+	XnUInt8* pYUV = (XnUInt8*)xnOSMallocAligned(nYUVSize, XN_DEFAULT_MEM_ALIGN);
+	XnUInt8* pRGB = (XnUInt8*)xnOSMallocAligned(nRGBSize, XN_DEFAULT_MEM_ALIGN);
+	XnUInt8* pExpected = (XnUInt8*)xnOSMallocAligned(nRGBSize, XN_DEFAULT_MEM_ALIGN);
+	if (pYUV == NULL || pRGB == NULL || pExpected == NULL)
+	{
+		printf("Out of memory\n");
+		xnOSFreeAligned(pYUV);
+		xnOSFreeAligned(pRGB);
+		xnOSFreeAligned(pExpected);
+		return FALSE;
+	}
+
+	for (XnUInt32 i = 0; i < nYUVSize; ++i)
+	{
+		pYUV[i] = (XnUInt8)Random();
+	}
+
+	XnBool bAllSame = TRUE;
+	XnBool bSame;
+	XnDouble dStart;
+
+	struct
+	{
+		const char* strName;
+		const char* strReferenceName;
+		void (*pConvert)(const XnUInt8*, XnUInt8*, XnUInt32, XnUInt32*, XnUInt32*);
+		XnUInt32 nY1, nU, nY2, nV;
+	} layouts[] =
+	{
+		{ "YUV422ToRGB888", "YUV422 per-pixel reference", YUV422ToRGB888, YUV422_Y1, YUV422_U, YUV422_Y2, YUV422_V },
+		{ "YUYVToRGB888", "YUYV per-pixel reference", YUYVToRGB888, YUYV_Y1, YUYV_U, YUYV_Y2, YUYV_V },
+	};
+
+	for (XnUInt32 nLayout = 0; nLayout < sizeof(layouts) / sizeof(layouts[0]); ++nLayout)
+	{
+		dStart = GetTimeMs();
+		for (XnUInt32 i = 0; i < BENCHMARK_ITERATIONS; ++i)
+		{
+			YUVToRGB888Reference(pYUV, pExpected, layouts[nLayout].nY1, layouts[nLayout].nU, layouts[nLayout].nY2, layouts[nLayout].nV);
+		}
+		PrintResult(layouts[nLayout].strReferenceName, dStart, TRUE);
+
+		bSame = TRUE;
+		dStart = GetTimeMs();
+		for (XnUInt32 i = 0; i < BENCHMARK_ITERATIONS; ++i)
+		{
+			XnUInt32 nRead = 0;
+			XnUInt32 nWritten = nRGBSize;
+			layouts[nLayout].pConvert(pYUV, pRGB, nYUVSize, &nRead, &nWritten);
+			bSame = bSame && nRead == nYUVSize && nWritten == nRGBSize;
+		}
+		bSame = bSame && xnOSMemCmp(pRGB, pExpected, nRGBSize) == 0;
+		PrintResult(layouts[nLayout].strName, dStart, bSame);
+		bAllSame = bAllSame && bSame;
+	}
+
+	// PSLink rounds differently from the sensor code, so it is only timed.
+	bSame = TRUE;
+	dStart = GetTimeMs();
+	for (XnUInt32 i = 0; i < BENCHMARK_ITERATIONS; ++i)
+	{
+		XnSizeT nWritten = nRGBSize;
+		bSame = bSame && xn::LinkYuvToRgb::Yuv422ToRgb888(pYUV, nYUVSize, pRGB, nWritten) == XN_STATUS_OK && nWritten == nRGBSize;
+	}
+	PrintResult("LinkYuvToRgb::Yuv422ToRgb888", dStart, bSame);
+	bAllSame = bAllSame && bSame;
+
+	xnOSFreeAligned(pYUV);
+	xnOSFreeAligned(pRGB);
+	xnOSFreeAligned(pExpected);
+
+	return bAllSame;
+}
+
+// Registers a depth map the way DepthUtilsTranslateDepthMap() always did: every pixel, in input order,
+// goes through a z-buffer and fills its left and upper neighbors.
+static void RegisterDepthReference(DepthUtilsHandle handle, const unsigned short* pInput, unsigned short* pOutput, XnBool bMirror)
+{
+	xnOSMemSet(pOutput, 0, BENCHMARK_PIXELS * sizeof(unsigned short));
+
+	for (XnUInt32 y = 0; y < BENCHMARK_Y_RES; ++y)
+	{
+		for (XnUInt32 x = 0; x < BENCHMARK_X_RES; ++x)
+		{
+			unsigned short nValue = pInput[y * BENCHMARK_X_RES + x];
+			XnUInt32 nNewX;
+			XnUInt32 nNewY;
+
+			// With the color resolution set to the depth one, this is the registered position, already
+			// mirrored. Row 0 was never written to.
+			if (nValue == 0 || DepthUtilsTranslatePixel(handle, x, y, nValue, &nNewX, &nNewY) != XN_STATUS_OK || nNewY == 0)
+			{
+				continue;
+			}
+
+			XnUInt32 nArrPos = nNewY * BENCHMARK_X_RES + nNewX;
+			XnBool bHasLeft = bMirror ? (nNewX < BENCHMARK_X_RES - 1) : (nNewX > 0);
+			unsigned short nOutValue = pOutput[nArrPos];
+			if (nOutValue == 0 || nOutValue > nValue)
+			{
+				if (bHasLeft)
+				{
+					pOutput[nArrPos - BENCHMARK_X_RES - 1] = nValue;
+					pOutput[nArrPos - 1] = nValue;
+				}
+				pOutput[nArrPos - BENCHMARK_X_RES] = nValue;
+				pOutput[nArrPos] = nValue;
+			}
+		}
+	}
+}
+
+static XnBool BenchmarkRegistration()
+{
+	// A synthetic calibration: a fixed offset between the cameras, and parallax from the depth.
+	DepthUtilsSensorCalibrationInfo calibration;
+	xnOSMemSet(&calibration, 0, sizeof(calibration));
+	calibration.magic = ONI_DEPTH_UTILS_CALIBRATION_INFO_MAGIC;
+	calibration.params1080.zpps = 0.1042;
+	calibration.params1080.zpd = 120;
+	calibration.params1080.dcrcdist = 2.4;
+	calibration.params1080.rgbRegXRes = 640;
+	calibration.params1080.rgbRegYRes = 512;
+	calibration.params1080.cmosVGAOutputXRes = 1280;
+	calibration.params1080.rgbRegXValScale = 16;
+	calibration.params1080.s2dPelConst = 8;
+	calibration.params1080.s2dConstOffset = 0.375;
+	calibration.params1080.padInfo_VGA.nCroppingLines = 3;
+	calibration.params1080.padInfo_VGA.nStartLines = 1;
+	calibration.params1080.registrationInfo_VGA.nRGS_DX_START = 20 << 8;
+	calibration.params1080.registrationInfo_VGA.nRGS_DY_START = 4 << 8;
+
+	DepthUtilsHandle handle = NULL;
+	if (DepthUtilsInitialize(&calibration, &handle) != XN_STATUS_OK)
+	{
+		printf("Failed to initialize depth utils\n");
+		return FALSE;
+	}
+
+	XnUInt32 nSize = BENCHMARK_PIXELS * sizeof(unsigned short);
+	unsigned short* pInput = (unsigned short*)xnOSMallocAligned(nSize, XN_DEFAULT_MEM_ALIGN);
+	unsigned short* pOutput = (unsigned short*)xnOSMallocAligned(nSize, XN_DEFAULT_MEM_ALIGN);
+	unsigned short* pExpected = (unsigned short*)xnOSMallocAligned(nSize, XN_DEFAULT_MEM_ALIGN);
+	if (pInput == NULL || pOutput == NULL || pExpected == NULL)
+	{
+		printf("Out of memory\n");
+		xnOSFreeAligned(pInput);
+		xnOSFreeAligned(pOutput);
+		xnOSFreeAligned(pExpected);
+		DepthUtilsShutdown(&handle);
+		return FALSE;
+	}
+
+	// A slanted surface with some noise and holes, so pixels collide in the z-buffer.
+	for (XnUInt32 i = 0; i < BENCHMARK_PIXELS; ++i)
+	{
+		pInput[i] = (Random() % 20 == 0) ? 0 : (unsigned short)(800 + i % BENCHMARK_X_RES * 4 + Random() % 64);
+	}
+
+	XnBool bAllSame = TRUE;
+
+	for (int nMirror = 0; nMirror < 2; ++nMirror)
+	{
+		DepthUtilsSetDepthConfiguration(handle, BENCHMARK_X_RES, BENCHMARK_Y_RES, ONI_PIXEL_FORMAT_DEPTH_1_MM, nMirror);
+		DepthUtilsSetColorResolution(handle, BENCHMARK_X_RES, BENCHMARK_Y_RES);
+		RegisterDepthReference(handle, pInput, pExpected, nMirror);
+
+		XnBool bSame = TRUE;
+		XnDouble dStart = GetTimeMs();
+		for (XnUInt32 j = 0; j < BENCHMARK_ITERATIONS; ++j)
+		{
+			xnOSMemCopy(pOutput, pInput, nSize);
+			bSame = bSame && DepthUtilsTranslateDepthMap(handle, pOutput) == XN_STATUS_OK;
+		}
+		bSame = bSame && xnOSMemCmp(pOutput, pExpected, nSize) == 0;
+		PrintResult(nMirror ? "DepthUtilsTranslateDepthMap mirrored" : "DepthUtilsTranslateDepthMap", dStart, bSame);
+		bAllSame = bAllSame && bSame;
+	}
+
+	xnOSFreeAligned(pInput);
+	xnOSFreeAligned(pOutput);
+	xnOSFreeAligned(pExpected);
+	DepthUtilsShutdown(&handle);
+
+	return bAllSame;
+}
+
+int main()
+{
+	printf("%dx%d, %d frames each, SSSE3 %s\n", BENCHMARK_X_RES, BENCHMARK_Y_RES, BENCHMARK_ITERATIONS,
+		(xnOSGetCPUFeatures() & XN_CPU_FEATURE_SSSE3) != 0 ? "available" : "not available");
+
+	XnBool bSame = BenchmarkYUV();
+	bSame = BenchmarkRegistration() && bSame;
+
+	// Each result is also compared to the reference, so this can run as a check.
+	return bSame ? 0 : 2;
+}
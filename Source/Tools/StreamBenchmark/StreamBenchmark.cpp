@@ -0,0 +1,344 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <OpenNI.h>
+#include <XnOS.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+// The dummy device streams depth and color at 30 FPS, which leaves the core idle between frames.
+#define BENCHMARK_DEVICE_URI "Dummy"
+#define BENCHMARK_STREAMS 2
+#define BENCHMARK_DEFAULT_SECONDS 10
+// Startup (threads, first allocations) is not measured.
+#define BENCHMARK_WARMUP_MS 1000
+// Callbacks should run within this many microseconds of a frame becoming readable.
+#define BENCHMARK_CALLBACK_TARGET_US 100
+// Without a recording to seek in, one of this length is made from the dummy device.
+#define BENCHMARK_SEEK_FILE_NAME "StreamBenchmark.oni"
+#define BENCHMARK_SEEK_RECORD_SECONDS 20
+#define BENCHMARK_SEEK_ITERATIONS 200
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+static const openni::SensorType g_sensors[BENCHMARK_STREAMS] = { openni::SENSOR_DEPTH, openni::SENSOR_COLOR };
+
+static XnUInt32 g_nRandom = 12345;
+
+static XnUInt32 Random()
+{
+	g_nRandom = g_nRandom * 1103515245 + 12345;
+	return g_nRandom >> 8;
+}
+
+static XnUInt64 GetTimeUs()
+{
+	XnUInt64 nNow;
+	xnOSGetHighResTimeStamp(&nNow);
+	return nNow;
+}
+
+// Reads each frame from its callback, the way event based applications do.
+class ReadingListener : public openni::VideoStream::NewFrameListener
+{
+public:
+	ReadingListener() : m_nFrames(0) {}
+
+	virtual void onNewFrame(openni::VideoStream& stream)
+	{
+		openni::VideoFrameRef frame;
+		if (stream.readFrame(&frame) == openni::STATUS_OK)
+		{
+			++m_nFrames;
+		}
+	}
+
+	int GetFrameCount() const { return m_nFrames; }
+
+private:
+	int m_nFrames;
+};
+
+static void PrintHistogram(const char* strName, const OniLatencyHistogram& histogram)
+{
+	printf("  %-40s %8llu frames  p50 %6llu us  p99 %6llu us  max %6llu us\n", strName,
+		(unsigned long long)histogram.count, (unsigned long long)histogram.p50, (unsigned long long)histogram.p99, (unsigned long long)histogram.max);
+}
+
+// Streams from the dummy device to a listener on each stream, and reports how long frames waited for
+// their callback.
+static XnBool BenchmarkCallbacks(XnUInt32 nSeconds)
+{
+	openni::Device device;
+	if (device.open(BENCHMARK_DEVICE_URI) != openni::STATUS_OK)
+	{
+		printf("Failed to open the dummy device:\n%s\n", openni::OpenNI::getExtendedError());
+		return FALSE;
+	}
+
+	openni::VideoStream streams[BENCHMARK_STREAMS];
+	ReadingListener listeners[BENCHMARK_STREAMS];
+	for (int i = 0; i < BENCHMARK_STREAMS; ++i)
+	{
+		if (streams[i].create(device, g_sensors[i]) != openni::STATUS_OK ||
+			streams[i].addNewFrameListener(&listeners[i]) != openni::STATUS_OK ||
+			streams[i].start() != openni::STATUS_OK)
+		{
+			printf("Failed to start a stream:\n%s\n", openni::OpenNI::getExtendedError());
+			return FALSE;
+		}
+	}
+
+	xnOSSleep(BENCHMARK_WARMUP_MS);
+	for (int i = 0; i < BENCHMARK_STREAMS; ++i)
+	{
+		if (streams[i].setProperty<OniBool>(openni::STREAM_PROPERTY_LATENCY_TRACKING, TRUE) != openni::STATUS_OK)
+		{
+			printf("Failed to track latency:\n%s\n", openni::OpenNI::getExtendedError());
+			return FALSE;
+		}
+	}
+
+	printf("Callbacks: %u seconds of depth and color from the dummy device\n", nSeconds);
+	xnOSSleep(nSeconds * 1000);
+
+	for (int i = 0; i < BENCHMARK_STREAMS; ++i)
+	{
+		streams[i].removeNewFrameListener(&listeners[i]);
+		streams[i].stop();
+	}
+
+	OniMetrics metrics;
+	if (openni::OpenNI::getMetrics(&metrics) != openni::STATUS_OK)
+	{
+		printf("Failed to get the metrics:\n%s\n", openni::OpenNI::getExtendedError());
+		return FALSE;
+	}
+
+	// "waiting" ends when the listener reads the frame, so it is the delay until the callback ran.
+	// "callbackDispatch" also includes the callbacks themselves.
+	XnBool bOnTarget = TRUE;
+	for (int i = 0; i < metrics.streamCount; ++i)
+	{
+		const OniStreamMetrics& stream = metrics.streams[i];
+		int nListener = stream.sensorType == ONI_SENSOR_DEPTH ? 0 : 1;
+		printf("%s stream, %d frames read by the listener\n", nListener == 0 ? "Depth" : "Color", listeners[nListener].GetFrameCount());
+		PrintHistogram("readable to read in the callback", stream.latency.waiting);
+		PrintHistogram("readable to callbacks returned", stream.callbackDispatch);
+		bOnTarget = bOnTarget && stream.latency.waiting.count > 0 && stream.latency.waiting.p99 <= BENCHMARK_CALLBACK_TARGET_US;
+	}
+	openni::OpenNI::releaseMetrics(&metrics);
+
+	printf("p99 callback latency %s the %d us target\n", bOnTarget ? "within" : "OVER", BENCHMARK_CALLBACK_TARGET_US);
+
+	for (int i = 0; i < BENCHMARK_STREAMS; ++i)
+	{
+		streams[i].destroy();
+	}
+	device.close();
+
+	return bOnTarget;
+}
+
+// Records the dummy device the way the Recorder does by default (lossless).
+static XnBool RecordDummyDevice(const char* strFileName, XnUInt32 nSeconds)
+{
+	openni::Device device;
+	if (device.open(BENCHMARK_DEVICE_URI) != openni::STATUS_OK)
+	{
+		printf("Failed to open the dummy device:\n%s\n", openni::OpenNI::getExtendedError());
+		return FALSE;
+	}
+
+	openni::VideoStream streams[BENCHMARK_STREAMS];
+	openni::Recorder recorder;
+	XnBool bRecorded = recorder.create(strFileName) == openni::STATUS_OK;
+	for (int i = 0; i < BENCHMARK_STREAMS && bRecorded; ++i)
+	{
+		bRecorded = streams[i].create(device, g_sensors[i]) == openni::STATUS_OK &&
+			recorder.attach(streams[i]) == openni::STATUS_OK &&
+			streams[i].start() == openni::STATUS_OK;
+	}
+	bRecorded = bRecorded && recorder.start() == openni::STATUS_OK;
+
+	if (bRecorded)
+	{
+		printf("Recording %u seconds of depth and color from the dummy device to %s\n", nSeconds, strFileName);
+		xnOSSleep(nSeconds * 1000);
+	}
+	else
+	{
+		printf("Failed to record:\n%s\n", openni::OpenNI::getExtendedError());
+	}
+
+	recorder.destroy();
+	for (int i = 0; i < BENCHMARK_STREAMS; ++i)
+	{
+		streams[i].destroy();
+	}
+	device.close();
+
+	return bRecorded;
+}
+
+static void PrintSeekResult(const char* strName, XnUInt64 nTotalUs, XnUInt64 nMaxUs, XnUInt32 nWrong)
+{
+	printf("  %-40s avg %8.3f ms  max %8.3f ms  %s\n", strName, nTotalUs / 1000.0 / BENCHMARK_SEEK_ITERATIONS, nMaxUs / 1000.0,
+		nWrong == 0 ? "correct frames" : "WRONG FRAMES");
+}
+
+// Seeks to random moments of a recording, first by timestamp and then by frame index, which is what
+// applications had to do before. Playback is held at manual speed, so the frame read after a seek is the
+// one it landed on. It repeats, as the file is closed when playback ends (after seeking to the last frame).
+static XnBool BenchmarkSeek(const char* strFileName)
+{
+	openni::Device device;
+	if (device.open(strFileName) != openni::STATUS_OK)
+	{
+		printf("Failed to open %s:\n%s\n", strFileName, openni::OpenNI::getExtendedError());
+		return FALSE;
+	}
+
+	openni::PlaybackControl* pPlayback = device.getPlaybackControl();
+	openni::VideoStream stream;
+	if (pPlayback == NULL ||
+		pPlayback->setRepeatEnabled(true) != openni::STATUS_OK ||
+		pPlayback->setSpeed(-1.0f) != openni::STATUS_OK ||
+		stream.create(device, device.hasSensor(openni::SENSOR_DEPTH) ? openni::SENSOR_DEPTH : openni::SENSOR_COLOR) != openni::STATUS_OK ||
+		stream.start() != openni::STATUS_OK)
+	{
+		printf("Failed to play %s:\n%s\n", strFileName, openni::OpenNI::getExtendedError());
+		return FALSE;
+	}
+
+	// The last frame tells how long the recording is.
+	int nFrames = pPlayback->getNumberOfFrames(stream);
+	openni::VideoFrameRef frame;
+	if (nFrames <= 0 ||
+		pPlayback->seek(stream, nFrames) != openni::STATUS_OK ||
+		stream.readFrame(&frame) != openni::STATUS_OK)
+	{
+		printf("Failed to find the end of %s:\n%s\n", strFileName, openni::OpenNI::getExtendedError());
+		return FALSE;
+	}
+	XnUInt64 nDuration = frame.getTimestamp();
+
+	XnUInt64 nFileSize = 0;
+	xnOSGetFileSize64(strFileName, &nFileSize);
+	printf("Seek: %s, %.1f MB, %d %s frames over %.1f seconds, %d seeks each\n", strFileName, nFileSize / 1024.0 / 1024.0, nFrames,
+		stream.getSensorInfo().getSensorType() == openni::SENSOR_DEPTH ? "depth" : "color", nDuration / 1000000.0, BENCHMARK_SEEK_ITERATIONS);
+
+	// A timestamp seek lands on the last frame at or before the requested moment.
+	XnUInt64 nTotal = 0;
+	XnUInt64 nMax = 0;
+	XnUInt32 nWrong = 0;
+	for (XnUInt32 i = 0; i < BENCHMARK_SEEK_ITERATIONS; ++i)
+	{
+		XnUInt64 nTimestamp = (((XnUInt64)Random() << 24) | Random()) % (nDuration + 1);
+		XnUInt64 nStart = GetTimeUs();
+		openni::Status rc = pPlayback->seek(nTimestamp);
+		XnUInt64 nTime = GetTimeUs() - nStart;
+		nTotal += nTime;
+		nMax = XN_MAX(nMax, nTime);
+
+		if (rc != openni::STATUS_OK || stream.readFrame(&frame) != openni::STATUS_OK || frame.getTimestamp() > nTimestamp)
+		{
+			++nWrong;
+		}
+	}
+	PrintSeekResult("seek(timestamp)", nTotal, nMax, nWrong);
+	XnUInt32 nAllWrong = nWrong;
+
+	nTotal = 0;
+	nMax = 0;
+	nWrong = 0;
+	for (XnUInt32 i = 0; i < BENCHMARK_SEEK_ITERATIONS; ++i)
+	{
+		int nFrameIndex = 1 + (int)(Random() % nFrames);
+		XnUInt64 nStart = GetTimeUs();
+		openni::Status rc = pPlayback->seek(stream, nFrameIndex);
+		XnUInt64 nTime = GetTimeUs() - nStart;
+		nTotal += nTime;
+		nMax = XN_MAX(nMax, nTime);
+
+		if (rc != openni::STATUS_OK || stream.readFrame(&frame) != openni::STATUS_OK || frame.getFrameIndex() != nFrameIndex)
+		{
+			++nWrong;
+		}
+	}
+	PrintSeekResult("seek(stream, frameIndex)", nTotal, nMax, nWrong);
+	nAllWrong += nWrong;
+
+	stream.destroy();
+	device.close();
+
+	return nAllWrong == 0;
+}
+
+static void PrintUsage()
+{
+	printf("Usage: StreamBenchmark [callbacks [seconds] | seek [file.oni]]\n");
+	printf("Without a file, seek records %d seconds from the dummy device first.\n", BENCHMARK_SEEK_RECORD_SECONDS);
+}
+
+int main(int argc, char* argv[])
+{
+	const char* strMode = argc > 1 ? argv[1] : "callbacks";
+	XnBool bCallbacks = xnOSStrCmp(strMode, "callbacks") == 0;
+	if (!bCallbacks && xnOSStrCmp(strMode, "seek") != 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (openni::OpenNI::initialize() != openni::STATUS_OK)
+	{
+		printf("Failed to initialize OpenNI:\n%s\n", openni::OpenNI::getExtendedError());
+		return 1;
+	}
+
+	XnBool bOnTarget;
+	if (bCallbacks)
+	{
+		XnUInt32 nSeconds = argc > 2 ? (XnUInt32)atoi(argv[2]) : BENCHMARK_DEFAULT_SECONDS;
+		bOnTarget = BenchmarkCallbacks(nSeconds);
+	}
+	else if (argc > 2)
+	{
+		bOnTarget = BenchmarkSeek(argv[2]);
+	}
+	else
+	{
+		bOnTarget = RecordDummyDevice(BENCHMARK_SEEK_FILE_NAME, BENCHMARK_SEEK_RECORD_SECONDS) && BenchmarkSeek(BENCHMARK_SEEK_FILE_NAME);
+		xnOSDeleteFile(BENCHMARK_SEEK_FILE_NAME);
+	}
+
+	openni::OpenNI::shutdown();
+
+	// Results are also checked against their targets, so this can run as a check.
+	return bOnTarget ? 0 : 2;
+}
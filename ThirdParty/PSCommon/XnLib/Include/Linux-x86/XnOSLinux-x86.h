@@ -162,4 +162,16 @@ typedef struct XnOSTimer
 #define XN_PREPARE_VAR64_IN_BUFFER(var) (var)
 #define XN_PREPARE_VAR_FLOAT_IN_BUFFER(var) (var)
 
+//---------------------------------------------------------------------------
+// Atomic Operations
+//---------------------------------------------------------------------------
+/** Atomically increments a volatile XnInt32 and returns the new value (full barrier). */
+#define xnOSAtomicIncrement(pValue) __sync_add_and_fetch((pValue), 1)
+
+/** Atomically decrements a volatile XnInt32 and returns the new value (full barrier). */
+#define xnOSAtomicDecrement(pValue) __sync_sub_and_fetch((pValue), 1)
+
+/** Atomically replaces *pValue with nNew if it equals nOld. Returns the value held before the call. */
+#define xnOSAtomicCompareExchange(pValue, nNew, nOld) __sync_val_compare_and_swap((pValue), (nOld), (nNew))
+
 #endif //_XN_OSLINUX_X86_H_
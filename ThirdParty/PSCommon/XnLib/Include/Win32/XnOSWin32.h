@@ -148,5 +148,17 @@ typedef struct XnOSTimer
 #define XN_PREPARE_VAR64_IN_BUFFER(var) (var)
 #define XN_PREPARE_VAR_FLOAT_IN_BUFFER(var) (var)
 
+//---------------------------------------------------------------------------
+// Atomic Operations
+//---------------------------------------------------------------------------
+/** Atomically increments a volatile XnInt32 and returns the new value (full barrier). */
+#define xnOSAtomicIncrement(pValue) InterlockedIncrement((volatile LONG*)(pValue))
+
+/** Atomically decrements a volatile XnInt32 and returns the new value (full barrier). */
+#define xnOSAtomicDecrement(pValue) InterlockedDecrement((volatile LONG*)(pValue))
+
+/** Atomically replaces *pValue with nNew if it equals nOld. Returns the value held before the call. */
+#define xnOSAtomicCompareExchange(pValue, nNew, nOld) InterlockedCompareExchange((volatile LONG*)(pValue), (nNew), (nOld))
+
 #endif // _XN_LIB_WIN32_H_
 
@@ -34,6 +34,11 @@ XN_C_API void* XN_C_DECL xnOSReallocAligned(void* pMemory, const XnSizeT nAllocS
 XN_C_API void* XN_C_DECL xnOSRecalloc(void* pMemory, const XnSizeT nAllocNum, const XnSizeT nAllocSize);
 XN_C_API void XN_C_DECL xnOSFree(const void* pMemBlock);
 XN_C_API void XN_C_DECL xnOSFreeAligned(const void* pMemBlock);
+/** Allocates whole pages directly from the OS. When bLargePages is set, large pages are used if the
+    system allows it (nAllocSize should then be a multiple of the large page size), and regular pages otherwise. */
+XN_C_API void* XN_C_DECL xnOSAllocPages(const XnSizeT nAllocSize, XnBool bLargePages);
+/** Frees memory allocated by xnOSAllocPages. nAllocSize must be the size passed to it. */
+XN_C_API void XN_C_DECL xnOSFreePages(void* pMemBlock, const XnSizeT nAllocSize);
 XN_C_API void XN_C_DECL xnOSMemCopy(void* pDest, const void* pSource, XnSizeT nCount);
 XN_C_API XnInt32 XN_C_DECL xnOSMemCmp(const void *pBuf1, const void *pBuf2, XnSizeT nCount);
 XN_C_API void XN_C_DECL xnOSMemSet(void* pDest, XnUInt8 nValue, XnSizeT nCount);
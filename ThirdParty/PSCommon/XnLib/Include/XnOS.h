@@ -66,6 +66,21 @@ typedef XnBool (XN_CALLBACK_TYPE* XnConditionFunc)(void* pConditionData);
 /** The time since Xiron Core was initialized */ 
 extern XnOSTimer g_xnOSHighResGlobalTimer;
 
+//---------------------------------------------------------------------------
+// CPU
+//---------------------------------------------------------------------------
+// CPU features, see xnOSGetCPUFeatures()
+/** SSE2 instructions. */ 
+#define XN_CPU_FEATURE_SSE2			0x01
+/** SSSE3 instructions (pshufb and friends). */ 
+#define XN_CPU_FEATURE_SSSE3		0x02
+/** SSE4.1 instructions. */ 
+#define XN_CPU_FEATURE_SSE41		0x04
+/** AVX2 instructions, also supported by the OS. */ 
+#define XN_CPU_FEATURE_AVX2			0x08
+/** NEON instructions. Only reported when the library was built for NEON. */ 
+#define XN_CPU_FEATURE_NEON			0x10
+
 //---------------------------------------------------------------------------
 // Files
 //---------------------------------------------------------------------------
@@ -311,6 +326,8 @@ typedef enum {
 //---------------------------------------------------------------------------
 // Common
 XN_C_API XnStatus XN_C_DECL xnOSGetInfo(xnOSInfo* pOSInfo);
+/** Returns the XN_CPU_FEATURE_ flags of the CPU the process runs on. Checked once, so it is cheap to call. */ 
+XN_C_API XnUInt32 XN_C_DECL xnOSGetCPUFeatures();
 
 
 #if XN_PLATFORM_VAARGS_TYPE == XN_PLATFORM_USE_WIN32_VAARGS_STYLE
@@ -449,6 +466,9 @@ XN_C_API XnStatus XN_API_DEPRECATED("Use xnOSTellFile64() instead") XN_C_DECL
 XN_C_API XnStatus XN_C_DECL xnOSTellFile64(const XN_FILE_HANDLE File, XnUInt64* nFilePos);
 XN_C_API XnStatus XN_C_DECL xnOSTruncateFile64(const XN_FILE_HANDLE File, XnUInt64 nFilePos);
 XN_C_API XnStatus XN_C_DECL xnOSFlushFile(const XN_FILE_HANDLE File);
+/** Maps a whole file into memory, read-only. Writing to the mapped data is an access violation. */
+XN_C_API XnStatus XN_C_DECL xnOSMapFile(const XnChar* cpFileName, void** ppData, XnUInt64* pnFileSize);
+XN_C_API XnStatus XN_C_DECL xnOSUnmapFile(void* pData, XnUInt64 nFileSize);
 XN_C_API XnStatus XN_C_DECL xnOSDoesFileExist(const XnChar* cpFileName, XnBool* pbResult);
 XN_C_API XnStatus XN_C_DECL xnOSDoesDirectoryExist(const XnChar* cpDirName, XnBool* pbResult);
 XN_C_API XnStatus XN_C_DECL xnOSLoadFile(const XnChar* cpFileName, void* pBuffer, const XnUInt32 nBufferSize);
@@ -553,6 +573,7 @@ XN_C_API XnBool XN_C_DECL xnOSDoesThreadExistByID(XN_THREAD_ID threadId);
 // Processes
 XN_C_API XnStatus XN_C_DECL xnOSGetCurrentProcessID(XN_PROCESS_ID* pProcID);
 XN_C_API XnStatus XN_C_DECL xnOSCreateProcess(const XnChar* strExecutable, XnUInt32 nArgs, const XnChar** pstrArgs, XN_PROCESS_ID* pProcID);
+XN_C_API XnStatus XN_C_DECL xnOSGetProcessorCount(XnUInt32* pnCount);
 
 // Mutex
 XN_C_API XnStatus XN_C_DECL xnOSCreateMutex(XN_MUTEX_HANDLE* pMutexHandle);
@@ -624,7 +645,8 @@ typedef struct XnOSSharedMemory XnOSSharedMemory, *XN_SHARED_MEMORY_HANDLE;
  *
  * @param	strName			[in]	A machine-unique name that will be used by other processes to open this block.
  * @param	nSize			[in]	The size of the buffer.
- * @param	nAccessFlags	[in]	Creation flags. Can contain XN_OS_FILE_READ, XN_OS_FILE_WRITE or both.
+ * @param	nAccessFlags	[in]	Creation flags. Can contain XN_OS_FILE_READ, XN_OS_FILE_WRITE or both, and
+ *									XN_OS_FILE_CREATE_NEW_ONLY to fail with XN_STATUS_OS_FILE_ALREDY_EXISTS if the block exists.
  * @param	phSharedMem		[out]	A handle to the shared-memory block.
  */
 XN_C_API XnStatus XN_C_DECL xnOSCreateSharedMemory(const XnChar* strName, XnUInt32 nSize, XnUInt32 nAccessFlags, XN_SHARED_MEMORY_HANDLE* phSharedMem);
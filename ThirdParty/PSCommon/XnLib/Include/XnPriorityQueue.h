@@ -85,6 +85,11 @@ public:
 		}
 	}
 
+	Queue<T, TAlloc>& GetQueue(int priority)
+	{
+		return m_queues[priority];
+	}
+
 	bool IsEmpty()
 	{
 		for (int i = 0; i < Max; ++i)
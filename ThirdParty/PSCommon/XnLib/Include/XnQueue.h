@@ -44,10 +44,12 @@ public:
 	~Queue() {}
 
 	using typename Base::ConstIterator;
+	using typename Base::Iterator;
 	using Base::IsEmpty;
 	using Base::Begin;
 	using Base::End;
 	using Base::Size;
+	using Base::Remove;
 
 	XnStatus Push(const T& value)
 	{
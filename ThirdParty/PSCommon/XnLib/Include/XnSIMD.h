@@ -35,6 +35,15 @@
 	#endif
 #endif
 
+// Functions marked with XN_SSSE3_FUNCTION may use SSSE3 intrinsics even when the
+// build only targets SSE3. Call them only if xnOSGetCPUFeatures() reports
+// XN_CPU_FEATURE_SSSE3.
+#if defined(XN_SSE) && defined(__GNUC__) && !defined(__SSSE3__)
+	#define XN_SSSE3_FUNCTION __attribute__((target("ssse3")))
+#else
+	#define XN_SSSE3_FUNCTION
+#endif
+
 // Define XN_INT128
 #ifdef XN_NEON
 	#include "XnSIMD-Neon.h"
@@ -0,0 +1,294 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _XN_THREAD_POOL_H_
+#define _XN_THREAD_POOL_H_
+
+#include "XnOSCpp.h"
+#include "XnQueue.h"
+
+namespace xnl
+{
+
+/**
+ * A fixed set of worker threads executing submitted tasks in FIFO order.
+ *
+ * @note ParallelFor() must not be called from within a task of the same pool.
+ */
+class ThreadPool
+{
+public:
+	typedef void (XN_CALLBACK_TYPE* TaskFuncPtr)(void* pCookie);
+	typedef void (XN_CALLBACK_TYPE* IndexedTaskFuncPtr)(XnUInt32 nIndex, void* pCookie);
+
+	ThreadPool() : m_aThreads(NULL), m_nThreads(0), m_bRunning(FALSE) {}
+
+	~ThreadPool()
+	{
+		Destroy();
+	}
+
+	/** Starts the worker threads. A count of 0 means one thread per processor. */
+	XnStatus Create(XnUInt32 nThreads = 0)
+	{
+		XnStatus nRetVal = XN_STATUS_OK;
+
+		if (m_aThreads != NULL)
+		{
+			return XN_STATUS_OK;
+		}
+
+		if (nThreads == 0 && xnOSGetProcessorCount(&nThreads) != XN_STATUS_OK)
+		{
+			nThreads = 1;
+		}
+
+		nRetVal = m_taskEvent.Create(FALSE);
+		XN_IS_STATUS_OK(nRetVal);
+
+		m_aThreads = XN_NEW_ARR(XN_THREAD_HANDLE, nThreads);
+		m_bRunning = TRUE;
+
+		for (m_nThreads = 0; m_nThreads < nThreads; ++m_nThreads)
+		{
+			nRetVal = xnOSCreateThread(WorkerThread, this, &m_aThreads[m_nThreads]);
+			if (nRetVal != XN_STATUS_OK)
+			{
+				Destroy();
+				return (nRetVal);
+			}
+		}
+
+		return (XN_STATUS_OK);
+	}
+
+	/** Runs all tasks that are still queued, then stops the worker threads. */
+	void Destroy()
+	{
+		if (m_aThreads == NULL)
+		{
+			return;
+		}
+
+		m_bRunning = FALSE;
+		m_taskEvent.Set();
+
+		for (XnUInt32 i = 0; i < m_nThreads; ++i)
+		{
+			xnOSWaitForThreadExit(m_aThreads[i], XN_WAIT_INFINITE);
+			xnOSCloseThread(&m_aThreads[i]);
+		}
+
+		XN_DELETE_ARR(m_aThreads);
+		m_aThreads = NULL;
+		m_nThreads = 0;
+		m_taskEvent.Close();
+	}
+
+	XnUInt32 GetThreadCount() const
+	{
+		return m_nThreads;
+	}
+
+	/** Queues a task. If the pool has no threads, the task is executed immediately. */
+	XnStatus Submit(TaskFuncPtr pFunc, void* pCookie)
+	{
+		XnStatus nRetVal = XN_STATUS_OK;
+
+		if (m_aThreads == NULL)
+		{
+			pFunc(pCookie);
+			return (XN_STATUS_OK);
+		}
+
+		{
+			AutoCSLocker locker(m_tasksCS);
+			nRetVal = m_tasks.Push(Task(pFunc, pCookie));
+			XN_IS_STATUS_OK(nRetVal);
+		}
+
+		m_taskEvent.Set();
+		return (XN_STATUS_OK);
+	}
+
+	/**
+	 * Calls pFunc(i, pCookie) for every i in [0, nCount), spreading the calls over
+	 * the worker threads and the calling thread. Returns once all calls have returned.
+	 */
+	void ParallelFor(XnUInt32 nCount, IndexedTaskFuncPtr pFunc, void* pCookie)
+	{
+		XnUInt32 nHelpers = (nCount > 0) ? nCount - 1 : 0;
+		if (nHelpers > m_nThreads)
+		{
+			nHelpers = m_nThreads;
+		}
+
+		// the context is shared with helpers that may still be finishing after we return, so it is
+		// reference counted instead of living on our stack
+		ParallelForContext* pContext = XN_NEW(ParallelForContext);
+		if (pContext == NULL || (nHelpers > 0 && pContext->doneEvent.Create(FALSE) != XN_STATUS_OK))
+		{
+			XN_DELETE(pContext);
+			for (XnUInt32 i = 0; i < nCount; ++i)
+			{
+				pFunc(i, pCookie);
+			}
+			return;
+		}
+
+		pContext->pFunc = pFunc;
+		pContext->pCookie = pCookie;
+		pContext->nCount = nCount;
+		pContext->nNext = 0;
+		pContext->nActiveHelpers = nHelpers;
+		pContext->nRefs = nHelpers + 1;
+
+		for (XnUInt32 i = 0; i < nHelpers; ++i)
+		{
+			if (Submit(ParallelForHelper, pContext) != XN_STATUS_OK)
+			{
+				// this helper will never run
+				xnOSAtomicDecrement(&pContext->nActiveHelpers);
+				ReleaseParallelForContext(pContext);
+			}
+		}
+
+		RunParallelFor(*pContext);
+
+		// pCookie belongs to our caller, so wait until no helper can call pFunc anymore
+		while (pContext->nActiveHelpers != 0)
+		{
+			pContext->doneEvent.Wait(XN_WAIT_INFINITE);
+		}
+
+		ReleaseParallelForContext(pContext);
+	}
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	struct Task
+	{
+		Task() : pFunc(NULL), pCookie(NULL) {}
+		Task(TaskFuncPtr func, void* cookie) : pFunc(func), pCookie(cookie) {}
+
+		TaskFuncPtr pFunc;
+		void* pCookie;
+	};
+
+	struct ParallelForContext
+	{
+		IndexedTaskFuncPtr pFunc;
+		void* pCookie;
+		XnUInt32 nCount;
+		volatile XnInt32 nNext;
+		volatile XnInt32 nActiveHelpers;
+		volatile XnInt32 nRefs;
+		OSEvent doneEvent;
+	};
+
+	static void ReleaseParallelForContext(ParallelForContext* pContext)
+	{
+		if (xnOSAtomicDecrement(&pContext->nRefs) == 0)
+		{
+			XN_DELETE(pContext);
+		}
+	}
+
+	static void RunParallelFor(ParallelForContext& context)
+	{
+		for (;;)
+		{
+			XnUInt32 nIndex = (XnUInt32)(xnOSAtomicIncrement(&context.nNext) - 1);
+			if (nIndex >= context.nCount)
+			{
+				break;
+			}
+			context.pFunc(nIndex, context.pCookie);
+		}
+	}
+
+	static void XN_CALLBACK_TYPE ParallelForHelper(void* pCookie)
+	{
+		ParallelForContext* pContext = (ParallelForContext*)pCookie;
+		RunParallelFor(*pContext);
+		if (xnOSAtomicDecrement(&pContext->nActiveHelpers) == 0)
+		{
+			pContext->doneEvent.Set();
+		}
+		// the caller may have returned already, so this must be our last access
+		ReleaseParallelForContext(pContext);
+	}
+
+	static XN_THREAD_PROC WorkerThread(XN_THREAD_PARAM pThreadParam)
+	{
+		ThreadPool* pThis = (ThreadPool*)pThreadParam;
+		pThis->WorkerMainLoop();
+		XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+	}
+
+	void WorkerMainLoop()
+	{
+		for (;;)
+		{
+			Task task;
+			XnBool bHasTask = FALSE;
+			XnBool bMoreTasks = FALSE;
+			{
+				AutoCSLocker locker(m_tasksCS);
+				bHasTask = (m_tasks.Pop(task) == XN_STATUS_OK);
+				bMoreTasks = !m_tasks.IsEmpty();
+			}
+
+			if (bHasTask)
+			{
+				// the event is auto-reset, so pass the wake-up on to another worker
+				if (bMoreTasks)
+				{
+					m_taskEvent.Set();
+				}
+				task.pFunc(task.pCookie);
+			}
+			else if (!m_bRunning)
+			{
+				// let the next worker know as well
+				m_taskEvent.Set();
+				break;
+			}
+			else
+			{
+				m_taskEvent.Wait(XN_WAIT_INFINITE);
+			}
+		}
+	}
+
+	XN_THREAD_HANDLE* m_aThreads;
+	XnUInt32 m_nThreads;
+	volatile XnBool m_bRunning;
+
+	CriticalSection m_tasksCS;
+	Queue<Task> m_tasks;
+	OSEvent m_taskEvent;
+};
+
+} // xnl
+
+#endif // _XN_THREAD_POOL_H_
@@ -40,6 +40,8 @@
 #include <errno.h>
 #include <limits.h>
 #include <XnLog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 //---------------------------------------------------------------------------
 // Code
@@ -467,6 +469,58 @@ XN_C_API XnStatus xnOSFlushFile(const XN_FILE_HANDLE File)
 	return XN_STATUS_OK;
 }
 
+XN_C_API XnStatus xnOSMapFile(const XnChar* cpFileName, void** ppData, XnUInt64* pnFileSize)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(cpFileName);
+	XN_VALIDATE_OUTPUT_PTR(ppData);
+	XN_VALIDATE_OUTPUT_PTR(pnFileSize);
+
+	int fd = open(cpFileName, O_RDONLY);
+	if (fd == -1)
+	{
+		return (XN_STATUS_OS_FILE_OPEN_FAILED);
+	}
+
+	// Empty files can't be mapped, and the whole file must fit into the address space
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) == -1 || fileStat.st_size == 0 || (XnUInt64)fileStat.st_size > (XnUInt64)(size_t)-1)
+	{
+		close(fd);
+		return (XN_STATUS_OS_FILE_GET_SIZE_FAILED);
+	}
+
+	// Read-only, so a buffer handed out from the mapping can't be changed by whoever holds it
+	void* pData = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping stays valid after the file is closed
+	close(fd);
+
+	if (pData == MAP_FAILED)
+	{
+		return (XN_STATUS_OS_FILE_READ_FAILED);
+	}
+
+	*ppData = pData;
+	*pnFileSize = (XnUInt64)fileStat.st_size;
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus xnOSUnmapFile(void* pData, XnUInt64 nFileSize)
+{
+	XN_VALIDATE_INPUT_PTR(pData);
+
+	if (munmap(pData, (size_t)nFileSize) != 0)
+	{
+		return (XN_STATUS_OS_FILE_CLOSE_FAILED);
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnOSFileExists(const XnChar* cpFileName, XnBool* bResult)
 {
 	// Validate the input/output pointers (to make sure none of them is NULL)
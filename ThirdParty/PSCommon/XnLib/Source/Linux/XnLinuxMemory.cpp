@@ -30,6 +30,7 @@
 	#include <malloc.h>
 #endif
 #include <XnLog.h>
+#include <sys/mman.h>
 
 //---------------------------------------------------------------------------
 // Code
@@ -113,6 +114,46 @@ XN_C_API void  xnOSFreeAligned(const void* pMemBlock)
 	free ((void*)pMemBlock);
 }
 
+XN_C_API void* xnOSAllocPages(const XnSizeT nAllocSize, XnBool bLargePages)
+{
+	void* pResult = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+	if (bLargePages)
+	{
+		// only succeeds if huge pages were reserved (vm.nr_hugepages)
+		pResult = mmap(NULL, nAllocSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	}
+#endif
+
+	if (pResult == MAP_FAILED)
+	{
+		pResult = mmap(NULL, nAllocSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pResult == MAP_FAILED)
+		{
+			return NULL;
+		}
+
+#ifdef MADV_HUGEPAGE
+		if (bLargePages)
+		{
+			// fall back to transparent huge pages
+			madvise(pResult, nAllocSize, MADV_HUGEPAGE);
+		}
+#endif
+	}
+
+	return pResult;
+}
+
+XN_C_API void xnOSFreePages(void* pMemBlock, const XnSizeT nAllocSize)
+{
+	if (pMemBlock != NULL)
+	{
+		munmap(pMemBlock, nAllocSize);
+	}
+}
+
 XN_C_API void xnOSMemCopy(void* pDest, const void* pSource, XnSizeT nCount)
 {
 	memcpy(pDest, pSource, nCount);
@@ -23,6 +23,7 @@
 //---------------------------------------------------------------------------
 #include <XnOS.h>
 #include <errno.h>
+#include <unistd.h>
 #if (XN_PLATFORM == XN_PLATFORM_MACOSX || XN_PLATFORM == XN_PLATFORM_ANDROID_ARM)
 	#include <sys/wait.h>
 #else
@@ -149,3 +150,14 @@ XN_C_API XnStatus XN_C_DECL xnOSGetApplicationLibDir(XnChar* cpDirName, const Xn
 	return (XN_STATUS_OK);
 }
 #endif
+
+XN_C_API XnStatus xnOSGetProcessorCount(XnUInt32* pnCount)
+{
+	// Validate output pointer
+	XN_VALIDATE_OUTPUT_PTR(pnCount);
+
+	long nCount = sysconf(_SC_NPROCESSORS_ONLN);
+	*pnCount = (nCount > 0) ? (XnUInt32)nCount : 1;
+
+	return (XN_STATUS_OK);
+}
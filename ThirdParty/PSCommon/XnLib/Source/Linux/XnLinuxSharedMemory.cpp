@@ -125,14 +125,21 @@ static XnStatus OpenSharedMemoryImpl(const XnChar* strName, XnUInt32 nAccessFlag
 	{
 		nCreateFlags |= O_CREAT;
 		nMode |= S_IRWXU | S_IRWXG | S_IRWXO;
+
+		if ((nAccessFlags & XN_OS_FILE_CREATE_NEW_ONLY) != 0)
+		{
+			nCreateFlags |= O_EXCL;
+		}
 	}
 
 	// open file
 	int fd = shm_open(pHandle->strFileName, nCreateFlags, nMode);
 	if (fd == -1)
 	{
+		int nError = errno;
+		xnLogWarning(XN_MASK_OS, "Could not create file '%s' for shared memory (%d).", pHandle->strFileName, nError);
 		xnOSFree(pHandle);
-		XN_LOG_WARNING_RETURN(XN_STATUS_OS_FAILED_TO_CREATE_SHARED_MEMORY, XN_MASK_OS, "Could not create file '%s' for shared memory (%d).", pHandle->strFileName, errno);
+		return (nError == EEXIST) ? XN_STATUS_OS_FILE_ALREDY_EXISTS : XN_STATUS_OS_FAILED_TO_CREATE_SHARED_MEMORY;
 	}
 
 	if (bCreate)
@@ -159,7 +166,10 @@ static XnStatus OpenSharedMemoryImpl(const XnChar* strName, XnUInt32 nAccessFlag
 	if (pHandle->pAddress == MAP_FAILED)
 	{
 		close(fd);
-		shm_unlink(pHandle->strFileName);
+		if (bCreate)
+		{
+			shm_unlink(pHandle->strFileName);
+		}
 		xnOSFree(pHandle);
 		XN_LOG_WARNING_RETURN(XN_STATUS_OS_FAILED_TO_CREATE_SHARED_MEMORY, XN_MASK_OS, "Could not create file mapping object (%d).", errno);
 	}
@@ -490,6 +490,63 @@ XN_C_API XnStatus xnOSFlushFile(const XN_FILE_HANDLE File)
 	return (XN_STATUS_OK);
 }
 
+XN_C_API XnStatus xnOSMapFile(const XnChar* cpFileName, void** ppData, XnUInt64* pnFileSize)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(cpFileName);
+	XN_VALIDATE_OUTPUT_PTR(ppData);
+	XN_VALIDATE_OUTPUT_PTR(pnFileSize);
+
+	HANDLE hFile = CreateFile(cpFileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return (XN_STATUS_OS_FILE_OPEN_FAILED);
+	}
+
+	// Empty files can't be mapped, and the whole file must fit into the address space
+	LARGE_INTEGER nFileSize;
+	if (!GetFileSizeEx(hFile, &nFileSize) || nFileSize.QuadPart == 0 || (XnUInt64)nFileSize.QuadPart > (XnUInt64)(SIZE_T)-1)
+	{
+		CloseHandle(hFile);
+		return (XN_STATUS_OS_FILE_GET_SIZE_FAILED);
+	}
+
+	// Read-only, so a buffer handed out from the mapping can't be changed by whoever holds it
+	HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(hFile);
+	if (hMapping == NULL)
+	{
+		return (XN_STATUS_OS_FILE_READ_FAILED);
+	}
+
+	// The view keeps the mapping alive after its handle is closed
+	void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(hMapping);
+	if (pData == NULL)
+	{
+		return (XN_STATUS_OS_FILE_READ_FAILED);
+	}
+
+	*ppData = pData;
+	*pnFileSize = (XnUInt64)nFileSize.QuadPart;
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus xnOSUnmapFile(void* pData, XnUInt64 /*nFileSize*/)
+{
+	XN_VALIDATE_INPUT_PTR(pData);
+
+	if (!UnmapViewOfFile(pData))
+	{
+		return (XN_STATUS_OS_FILE_CLOSE_FAILED);
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnOSDeleteFile(const XnChar* cpFileName)
 {
 	// Validate the input/output pointers (to make sure none of them is NULL)
@@ -90,6 +90,36 @@ XN_C_API void  xnOSFreeAligned(const void* pMemBlock)
 	_aligned_free((void*)pMemBlock);
 }
 
+XN_C_API void* xnOSAllocPages(const XnSizeT nAllocSize, XnBool bLargePages)
+{
+	void* pResult = NULL;
+
+	if (bLargePages)
+	{
+		// requires the "Lock pages in memory" privilege, and a size which is a multiple of the large page size
+		SIZE_T nLargePageSize = GetLargePageMinimum();
+		if (nLargePageSize != 0 && (nAllocSize % nLargePageSize) == 0)
+		{
+			pResult = VirtualAlloc(NULL, nAllocSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		}
+	}
+
+	if (pResult == NULL)
+	{
+		pResult = VirtualAlloc(NULL, nAllocSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	}
+
+	return pResult;
+}
+
+XN_C_API void xnOSFreePages(void* pMemBlock, const XnSizeT /*nAllocSize*/)
+{
+	if (pMemBlock != NULL)
+	{
+		VirtualFree(pMemBlock, 0, MEM_RELEASE);
+	}
+}
+
 XN_C_API void xnOSMemCopy(void* pDest, const void* pSource, XnSizeT nCount)
 {
 	memcpy(pDest, pSource, nCount);
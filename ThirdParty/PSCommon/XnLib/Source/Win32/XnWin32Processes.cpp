@@ -75,3 +75,15 @@ XN_C_API XnStatus xnOSCreateProcess(const XnChar* strExecutable, XnUInt32 nArgs,
 	
 	return (XN_STATUS_OK);
 }
+
+XN_C_API XnStatus xnOSGetProcessorCount(XnUInt32* pnCount)
+{
+	// Validate the output pointer
+	XN_VALIDATE_OUTPUT_PTR(pnCount);
+
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	*pnCount = (info.dwNumberOfProcessors > 0) ? info.dwNumberOfProcessors : 1;
+
+	return (XN_STATUS_OK);
+}
@@ -133,6 +133,14 @@ XN_C_API XnStatus XN_C_DECL xnOSCreateSharedMemoryEx(const XnChar* strName, XnUI
 		XN_LOG_ERROR_RETURN(XN_STATUS_OS_FAILED_TO_CREATE_SHARED_MEMORY, XN_MASK_OS, "Could not create file mapping object (%d).", GetLastError());
 	}
 
+	// an existing object is opened instead of created
+	if ((nAccessFlags & XN_OS_FILE_CREATE_NEW_ONLY) != 0 && GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		CloseHandle(pHandle->hMapFile);
+		xnOSFree(pHandle);
+		XN_LOG_WARNING_RETURN(XN_STATUS_OS_FILE_ALREDY_EXISTS, XN_MASK_OS, "Shared memory '%s' already exists.", strName);
+	}
+
 	// map it to the process
 	pHandle->pAddress = MapViewOfFile(
 		pHandle->hMapFile,  // handle to map object
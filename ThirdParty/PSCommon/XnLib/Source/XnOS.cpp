@@ -23,6 +23,13 @@
 //---------------------------------------------------------------------------
 #include <XnOS.h>
 #include <XnLog.h>
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	#include <intrin.h>
+	#define XN_CPUID_MSVC
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	#include <cpuid.h>
+	#define XN_CPUID_GCC
+#endif
 
 //---------------------------------------------------------------------------
 // Code
@@ -73,3 +80,80 @@ XnStatus xnOSWaitForCondition(const XN_EVENT_HANDLE EventHandle, XnUInt32 nMilli
 	// condition was met
 	return (XN_STATUS_OK);
 }
+
+#if defined(XN_CPUID_MSVC) || defined(XN_CPUID_GCC)
+static void GetCPUID(XnUInt32 nLeaf, XnUInt32 nSubLeaf, XnUInt32 regs[4])
+{
+#if defined(XN_CPUID_MSVC)
+	__cpuidex((int*)regs, (int)nLeaf, (int)nSubLeaf);
+#else
+	__cpuid_count(nLeaf, nSubLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static XnUInt64 GetXCR0()
+{
+#if defined(XN_CPUID_MSVC)
+	return _xgetbv(0);
+#else
+	XnUInt32 eax, edx;
+	__asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	return ((XnUInt64)edx << 32) | eax;
+#endif
+}
+
+static XnUInt32 DetectCPUFeatures()
+{
+	XnUInt32 nFeatures = 0;
+	XnUInt32 regs[4] = {0};
+
+	GetCPUID(0, 0, regs);
+	XnUInt32 nMaxLeaf = regs[0];
+	if (nMaxLeaf < 1)
+	{
+		return 0;
+	}
+
+	GetCPUID(1, 0, regs);
+	if (regs[3] & (1 << 26))
+		nFeatures |= XN_CPU_FEATURE_SSE2;
+	if (regs[2] & (1 << 9))
+		nFeatures |= XN_CPU_FEATURE_SSSE3;
+	if (regs[2] & (1 << 19))
+		nFeatures |= XN_CPU_FEATURE_SSE41;
+
+	// AVX2 also needs the OS to save the YMM registers (OSXSAVE, and XCR0 bits 1 and 2)
+	XnBool bOSSavesYMM = (regs[2] & (1 << 27)) != 0 && (GetXCR0() & 0x6) == 0x6;
+	if (bOSSavesYMM && nMaxLeaf >= 7)
+	{
+		GetCPUID(7, 0, regs);
+		if (regs[1] & (1 << 5))
+			nFeatures |= XN_CPU_FEATURE_AVX2;
+	}
+
+	return nFeatures;
+}
+#else
+static XnUInt32 DetectCPUFeatures()
+{
+#if defined(XN_NEON)
+	return XN_CPU_FEATURE_NEON;
+#else
+	return 0;
+#endif
+}
+#endif
+
+XN_C_API XnUInt32 XN_C_DECL xnOSGetCPUFeatures()
+{
+	// Detecting twice is harmless, so there is no need to lock.
+	static volatile XnBool bDetected = FALSE;
+	static volatile XnUInt32 nFeatures = 0;
+	if (!bDetected)
+	{
+		nFeatures = DetectCPUFeatures();
+		bDetected = TRUE;
+	}
+
+	return nFeatures;
+}